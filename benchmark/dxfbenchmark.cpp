@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include "generators.h"
+
+#include <cad/storage/documentsnapshot.h>
+#include <file.h>
+
+#include <cstdio>
+
+using namespace lc;
+using namespace lc::benchmark;
+
+namespace {
+const std::string DXF_PATH = "lcbenchmark.dxf";
+
+/**
+ * Arg 0: lines, 1: arcs, 2: polylines, 3: texts, 4: blocks
+ */
+storage::Document_SPtr dxfDocument(int64_t drawing) {
+    auto document = createDocument();
+    auto layer = document->layerByName("0");
+
+    switch (drawing) {
+        case 0:
+            addEntities(document, uniformLines(layer, 100000));
+            break;
+        case 1:
+            addEntities(document, denseArcs(layer, 100000));
+            break;
+        case 2:
+            addEntities(document, longPolylines(layer, 100, 1000));
+            break;
+        case 3:
+            addEntities(document, texts(layer, 10000));
+            break;
+        default:
+            addBlockHeavyDrawing(document, 100, 100, 100);
+    }
+
+    return document;
+}
+}
+
+static void BM_DxfWrite(::benchmark::State& state) {
+    auto document = dxfDocument(state.range(0));
+
+    for (auto _ : state) {
+        persistence::File::save(document, DXF_PATH, persistence::File::LIBDXFRW_DXF_R2000);
+    }
+
+    std::remove(DXF_PATH.c_str());
+}
+BENCHMARK(BM_DxfWrite)->DenseRange(0, 4)->Unit(::benchmark::kMillisecond);
+
+static void BM_DxfRead(::benchmark::State& state) {
+    persistence::File::save(dxfDocument(state.range(0)), DXF_PATH, persistence::File::LIBDXFRW_DXF_R2000);
+
+    for (auto _ : state) {
+        auto document = createDocument();
+        persistence::File::open(document, DXF_PATH, persistence::File::LIBDXFRW);
+        ::benchmark::DoNotOptimize(document->snapshot()->size());
+    }
+
+    std::remove(DXF_PATH.c_str());
+}
+BENCHMARK(BM_DxfRead)->DenseRange(0, 4)->Unit(::benchmark::kMillisecond);
@@ -0,0 +1,208 @@
+#include "generators.h"
+
+#include <cad/builders/insert.h>
+#include <cad/geometry/georegion.h>
+#include <cad/operations/blockops.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/arc.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/hatch.h>
+#include <cad/primitive/insert.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/lwpolyline.h>
+#include <cad/primitive/text.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using namespace lc;
+using namespace lc::benchmark;
+
+Random::Random(uint32_t seed) :
+    _generator(seed) {
+}
+
+double Random::uniform(double min, double max) {
+    return min + (max - min) * (_generator() / 4294967296.);
+}
+
+geo::Coordinate Random::coordinate() {
+    return coordinate(0., DRAWING_SIZE);
+}
+
+geo::Coordinate Random::coordinate(double min, double max) {
+    auto x = uniform(min, max);
+    return geo::Coordinate(x, uniform(min, max));
+}
+
+storage::Document_SPtr lc::benchmark::createDocument() {
+    return std::make_shared<storage::DocumentImpl>(std::make_shared<storage::StorageManagerImpl>());
+}
+
+void lc::benchmark::addEntities(const storage::Document_SPtr& document, const std::vector<entity::CADEntity_CSPtr>& entities) {
+    auto builder = std::make_shared<operation::EntityBuilder>(document);
+    builder->appendEntities(entities);
+    builder->execute();
+}
+
+std::vector<entity::CADEntity_CSPtr> lc::benchmark::uniformLines(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed) {
+    Random random(seed);
+    std::vector<entity::CADEntity_CSPtr> entities;
+    entities.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        auto start = random.coordinate();
+        auto angle = random.uniform(0., 2. * M_PI);
+        auto length = random.uniform(1., 50.);
+        auto end = start + geo::Coordinate(angle) * length;
+        entities.push_back(std::make_shared<entity::Line>(start, end, layer));
+    }
+
+    return entities;
+}
+
+std::vector<entity::CADEntity_CSPtr> lc::benchmark::denseArcs(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed) {
+    Random random(seed);
+    std::vector<entity::CADEntity_CSPtr> entities;
+    entities.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        auto center = random.coordinate(0., DRAWING_SIZE / 10.);
+        auto radius = random.uniform(0.5, 20.);
+        auto start = random.uniform(0., 2. * M_PI);
+        auto end = start + random.uniform(0.1, 1.9 * M_PI);
+        auto ccw = random.uniform(0., 1.) < 0.5;
+        entities.push_back(std::make_shared<entity::Arc>(center, radius, start, end, ccw, layer));
+    }
+
+    return entities;
+}
+
+std::vector<entity::CADEntity_CSPtr> lc::benchmark::longPolylines(const meta::Layer_CSPtr& layer,
+                                                                  size_t count,
+                                                                  size_t vertexCount,
+                                                                  uint32_t seed) {
+    Random random(seed);
+    std::vector<entity::CADEntity_CSPtr> entities;
+    entities.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        std::vector<entity::LWVertex2D> vertices;
+        vertices.reserve(vertexCount);
+
+        auto location = random.coordinate();
+        auto angle = random.uniform(0., 2. * M_PI);
+        for (size_t v = 0; v < vertexCount; v++) {
+            // One segment out of four is an arc
+            auto bulge = random.uniform(0., 1.) < 0.25 ? random.uniform(-1., 1.) : 0.;
+            vertices.emplace_back(location, bulge);
+
+            angle += random.uniform(-0.5, 0.5);
+            location = location + geo::Coordinate(angle) * random.uniform(1., 10.);
+        }
+
+        entities.push_back(std::make_shared<entity::LWPolyline>(vertices, 0., 0., 0., false, geo::Coordinate(0., 0.), layer));
+    }
+
+    return entities;
+}
+
+std::vector<entity::CADEntity_CSPtr> lc::benchmark::hatches(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed) {
+    Random random(seed);
+    std::vector<entity::CADEntity_CSPtr> entities;
+    entities.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        auto corner = random.coordinate();
+        auto size = random.uniform(5., 100.);
+
+        std::vector<geo::Coordinate> corners {
+            corner, corner + geo::Coordinate(size, 0.), corner + geo::Coordinate(size, size), corner + geo::Coordinate(0., size)
+        };
+        std::vector<entity::CADEntity_CSPtr> border;
+        for (size_t c = 0; c < corners.size(); c++) {
+            border.push_back(std::make_shared<entity::Line>(corners[c], corners[(c + 1) % corners.size()], layer));
+        }
+
+        std::vector<entity::CADEntity_CSPtr> hole {
+            std::make_shared<entity::Arc>(corner + geo::Coordinate(size / 2., size / 2.), size / 4., 0., 2. * M_PI, true, layer)
+        };
+
+        geo::Region region;
+        region.addLoop(geo::Loop(border));
+        region.addLoop(geo::Loop(hole));
+
+        auto hatch = std::make_shared<entity::Hatch>(layer);
+        hatch->setRegion(region);
+        hatch->setSolid(1);
+        entities.push_back(hatch);
+    }
+
+    return entities;
+}
+
+std::vector<entity::CADEntity_CSPtr> lc::benchmark::texts(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed) {
+    Random random(seed);
+    std::vector<entity::CADEntity_CSPtr> entities;
+    entities.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        auto position = random.coordinate();
+        auto height = random.uniform(1., 10.);
+        auto angle = random.uniform(0., 2. * M_PI);
+        entities.push_back(std::make_shared<entity::Text>(
+                               position, "Text " + std::to_string(i), height, angle, "STANDARD",
+                               TextConst::None, TextConst::HALeft, TextConst::VABaseline,
+                               false, false, false, false, layer));
+    }
+
+    return entities;
+}
+
+void lc::benchmark::addBlockHeavyDrawing(const storage::Document_SPtr& document,
+                                         size_t blockCount,
+                                         size_t entitiesPerBlock,
+                                         size_t insertsPerBlock,
+                                         uint32_t seed) {
+    Random random(seed);
+    auto layer = document->layerByName("0");
+    std::vector<entity::CADEntity_CSPtr> entities;
+
+    for (size_t b = 0; b < blockCount; b++) {
+        auto block = std::make_shared<meta::Block>("Block " + std::to_string(b), geo::Coordinate(0., 0.));
+        std::make_shared<operation::AddBlock>(document, block)->execute();
+
+        for (size_t e = 0; e < entitiesPerBlock; e++) {
+            auto start = random.coordinate(0., 20.);
+            if (e % 2 == 0) {
+                auto end = random.coordinate(0., 20.);
+                entities.push_back(std::make_shared<entity::Line>(start, end, layer, nullptr, block));
+            }
+            else {
+                entities.push_back(std::make_shared<entity::Arc>(start, random.uniform(0.5, 5.), 0., M_PI, true, layer, nullptr, block));
+            }
+        }
+    }
+
+    // Inserts are built once their block has its entities, so they compute their bounding box
+    addEntities(document, entities);
+    entities.clear();
+
+    for (size_t b = 0; b < blockCount; b++) {
+        auto block = document->blockByName("Block " + std::to_string(b));
+
+        for (size_t i = 0; i < insertsPerBlock; i++) {
+            builder::InsertBuilder insertBuilder;
+            insertBuilder.setLayer(layer);
+            insertBuilder.setDisplayBlock(block);
+            insertBuilder.setDocument(document);
+            insertBuilder.setCoordinate(random.coordinate());
+            entities.push_back(insertBuilder.build());
+        }
+    }
+
+    addEntities(document, entities);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cad/base/cadentity.h>
+#include <cad/storage/document.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * Synthetic drawings for the benchmarks
+ * Every generator is seeded, the same arguments give the same drawing on every platform.
+ * Entities are spread over DRAWING_SIZE x DRAWING_SIZE drawing units starting at (0, 0).
+ */
+namespace lc {
+namespace benchmark {
+static const double DRAWING_SIZE = 10000.;
+
+/**
+ * @brief Portable random numbers
+ * std::uniform_real_distribution differs between standard libraries, this doesn't.
+ * Draw numbers in separate statements, the evaluation order of function arguments is unspecified.
+ */
+class Random {
+public:
+    explicit Random(uint32_t seed);
+
+    /**
+     * @return number in [min, max)
+     */
+    double uniform(double min, double max);
+
+    /**
+     * @return coordinate in the drawing
+     */
+    geo::Coordinate coordinate();
+
+    /**
+     * @return coordinate with both x and y in [min, max)
+     */
+    geo::Coordinate coordinate(double min, double max);
+
+private:
+    std::mt19937 _generator;
+};
+
+/**
+ * @brief Empty document with a layer "0"
+ */
+storage::Document_SPtr createDocument();
+
+/**
+ * @brief Add the entities to the document in one operation
+ */
+void addEntities(const storage::Document_SPtr& document, const std::vector<entity::CADEntity_CSPtr>& entities);
+
+/**
+ * @brief Lines of random direction, up to 50 units long
+ */
+std::vector<entity::CADEntity_CSPtr> uniformLines(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed = 1);
+
+/**
+ * @brief Small overlapping arcs packed in a tenth of the drawing
+ */
+std::vector<entity::CADEntity_CSPtr> denseArcs(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed = 2);
+
+/**
+ * @brief Random walks of vertexCount vertices, some segments are arcs
+ */
+std::vector<entity::CADEntity_CSPtr> longPolylines(const meta::Layer_CSPtr& layer, size_t count, size_t vertexCount, uint32_t seed = 3);
+
+/**
+ * @brief Solid hatches with a square boundary and a circular hole
+ */
+std::vector<entity::CADEntity_CSPtr> hatches(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed = 4);
+
+/**
+ * @brief Single line texts of various sizes and angles
+ */
+std::vector<entity::CADEntity_CSPtr> texts(const meta::Layer_CSPtr& layer, size_t count, uint32_t seed = 5);
+
+/**
+ * @brief Add blockCount blocks of entitiesPerBlock lines and arcs, each inserted insertsPerBlock times
+ */
+void addBlockHeavyDrawing(const storage::Document_SPtr& document,
+                          size_t blockCount,
+                          size_t entitiesPerBlock,
+                          size_t insertsPerBlock,
+                          uint32_t seed = 6);
+}
+}
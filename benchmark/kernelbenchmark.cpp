@@ -0,0 +1,339 @@
+#include <benchmark/benchmark.h>
+#include "generators.h"
+
+#include <cad/base/visitor.h>
+#include <cad/geometry/georegion.h>
+#include <cad/interface/snapconstrain.h>
+#include <cad/math/intersect.h>
+#include <cad/math/lcmath.h>
+#include <cad/operations/entityops.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/arc.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/ellipse.h>
+#include <cad/primitive/line.h>
+#include <cad/storage/documentsnapshot.h>
+#include <cad/storage/entitycontainer.h>
+#include <cad/storage/quadtree.h>
+
+using namespace lc;
+using namespace lc::benchmark;
+
+namespace {
+const geo::Area DRAWING_AREA(geo::Coordinate(0., 0.), geo::Coordinate(DRAWING_SIZE, DRAWING_SIZE));
+
+meta::Layer_CSPtr benchmarkLayer() {
+    static auto layer = std::make_shared<const meta::Layer>("0");
+    return layer;
+}
+
+/**
+ * Query windows covering 1% of the drawing
+ */
+std::vector<geo::Area> queryWindows(size_t count) {
+    Random random(100);
+    std::vector<geo::Area> windows;
+
+    for (size_t i = 0; i < count; i++) {
+        auto corner = random.coordinate();
+        windows.emplace_back(corner, DRAWING_SIZE / 10., DRAWING_SIZE / 10.);
+    }
+
+    return windows;
+}
+
+/**
+ * Square of random size and location near the origin
+ */
+geo::Loop square(Random& random) {
+    auto corner = random.coordinate(0., 10.);
+    auto size = random.uniform(5., 20.);
+
+    std::vector<entity::CADEntity_CSPtr> loopData;
+    std::vector<geo::Coordinate> corners {
+        corner, corner + geo::Coordinate(size, 0.), corner + geo::Coordinate(size, size), corner + geo::Coordinate(0., size)
+    };
+
+    for (size_t i = 0; i < corners.size(); i++) {
+        loopData.push_back(std::make_shared<entity::Line>(corners[i], corners[(i + 1) % corners.size()], nullptr));
+    }
+
+    return geo::Loop(loopData);
+}
+}
+
+static void BM_QuadTreeInsert(::benchmark::State& state) {
+    auto entities = uniformLines(benchmarkLayer(), state.range(0));
+
+    for (auto _ : state) {
+        storage::QuadTree<entity::CADEntity_CSPtr> tree(DRAWING_AREA);
+        for (const auto& entity : entities) {
+            tree.insert(entity);
+        }
+        ::benchmark::DoNotOptimize(tree.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuadTreeInsert)->Arg(10000)->Arg(100000)->Unit(::benchmark::kMillisecond);
+
+static void BM_QuadTreeErase(::benchmark::State& state) {
+    auto entities = uniformLines(benchmarkLayer(), state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        storage::QuadTree<entity::CADEntity_CSPtr> tree(DRAWING_AREA);
+        for (const auto& entity : entities) {
+            tree.insert(entity);
+        }
+        state.ResumeTiming();
+
+        for (const auto& entity : entities) {
+            tree.erase(entity);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuadTreeErase)->Arg(10000)->Arg(100000)->Unit(::benchmark::kMillisecond);
+
+static void BM_QuadTreeRetrieve(::benchmark::State& state) {
+    storage::QuadTree<entity::CADEntity_CSPtr> tree(DRAWING_AREA);
+    for (const auto& entity : uniformLines(benchmarkLayer(), state.range(0))) {
+        tree.insert(entity);
+    }
+    auto windows = queryWindows(100);
+
+    for (auto _ : state) {
+        for (const auto& window : windows) {
+            ::benchmark::DoNotOptimize(tree.retrieve(window));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * windows.size());
+}
+BENCHMARK(BM_QuadTreeRetrieve)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMicrosecond);
+
+static void BM_EntityContainerWithinArea(::benchmark::State& state) {
+    storage::EntityContainer<entity::CADEntity_CSPtr> container;
+    for (const auto& entity : uniformLines(benchmarkLayer(), state.range(0))) {
+        container.insert(entity);
+    }
+    auto windows = queryWindows(10);
+
+    for (auto _ : state) {
+        for (const auto& window : windows) {
+            ::benchmark::DoNotOptimize(container.entitiesWithinAndCrossingArea(window));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * windows.size());
+}
+BENCHMARK(BM_EntityContainerWithinArea)->Arg(10000)->Arg(100000)->Unit(::benchmark::kMillisecond);
+
+static void BM_EntityContainerNearCoordinate(::benchmark::State& state) {
+    storage::EntityContainer<entity::CADEntity_CSPtr> container;
+    for (const auto& entity : uniformLines(benchmarkLayer(), state.range(0))) {
+        container.insert(entity);
+    }
+    Random random(101);
+    SimpleSnapConstrain constrain(SimpleSnapConstrain::ON_ENTITYPATH, 0, 0.);
+
+    for (auto _ : state) {
+        ::benchmark::DoNotOptimize(container.getEntityPathsNearCoordinate(random.coordinate(), 20., constrain));
+    }
+}
+BENCHMARK(BM_EntityContainerNearCoordinate)->Arg(10000)->Arg(100000)->Unit(::benchmark::kMicrosecond);
+
+static void BM_DocumentSnapshotWithinArea(::benchmark::State& state) {
+    auto document = createDocument();
+    addEntities(document, uniformLines(document->layerByName("0"), state.range(0)));
+    auto snapshot = document->snapshot();
+    auto windows = queryWindows(100);
+
+    for (auto _ : state) {
+        for (const auto& window : windows) {
+            ::benchmark::DoNotOptimize(snapshot->entitiesWithinAndCrossingAreaFast(window));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * windows.size());
+}
+BENCHMARK(BM_DocumentSnapshotWithinArea)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMicrosecond);
+
+/**
+ * Intersections between pairs of random entities of two kinds
+ * Arg 0: line/line, 1: line/arc, 2: arc/arc, 3: circle/ellipse
+ */
+static void BM_IntersectPairs(::benchmark::State& state) {
+    const size_t pairs = 1000;
+    auto layer = benchmarkLayer();
+    Random random(102);
+
+    auto line = [&]() -> entity::CADEntity_CSPtr {
+        auto start = random.coordinate(0., 100.);
+        auto end = start + geo::Coordinate(random.uniform(0., 2. * M_PI)) * 50.;
+        return std::make_shared<entity::Line>(start, end, layer);
+    };
+    auto arc = [&]() -> entity::CADEntity_CSPtr {
+        auto center = random.coordinate(0., 100.);
+        auto radius = random.uniform(5., 50.);
+        auto start = random.uniform(0., 2. * M_PI);
+        return std::make_shared<entity::Arc>(center, radius, start, start + 2., true, layer);
+    };
+    auto circle = [&]() -> entity::CADEntity_CSPtr {
+        auto center = random.coordinate(0., 100.);
+        return std::make_shared<entity::Circle>(center, random.uniform(5., 50.), layer);
+    };
+    auto ellipse = [&]() -> entity::CADEntity_CSPtr {
+        auto center = random.coordinate(0., 100.);
+        auto angle = random.uniform(0., 2. * M_PI);
+        auto majorP = geo::Coordinate(angle) * random.uniform(10., 50.);
+        return std::make_shared<entity::Ellipse>(center, majorP, random.uniform(2., 10.), 0., 2. * M_PI, false, layer);
+    };
+
+    std::vector<std::pair<entity::CADEntity_CSPtr, entity::CADEntity_CSPtr>> entities;
+    for (size_t i = 0; i < pairs; i++) {
+        entity::CADEntity_CSPtr first;
+        entity::CADEntity_CSPtr second;
+
+        switch (state.range(0)) {
+            case 0:
+                first = line();
+                second = line();
+                break;
+            case 1:
+                first = line();
+                second = arc();
+                break;
+            case 2:
+                first = arc();
+                second = arc();
+                break;
+            default:
+                first = circle();
+                second = ellipse();
+        }
+
+        entities.emplace_back(first, second);
+    }
+
+    for (auto _ : state) {
+        for (const auto& pair : entities) {
+            maths::Intersect intersect(maths::Intersect::OnEntity, LCTOLERANCE);
+            visitorDispatcher<bool, GeoEntityVisitor>(intersect, *pair.first, *pair.second);
+            ::benchmark::DoNotOptimize(intersect.result());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * pairs);
+}
+BENCHMARK(BM_IntersectPairs)->DenseRange(0, 3)->Unit(::benchmark::kMicrosecond);
+
+static void BM_QuarticSolverFull(::benchmark::State& state) {
+    Random random(103);
+    std::vector<std::vector<double>> equations;
+    for (int i = 0; i < 1000; i++) {
+        equations.push_back({random.uniform(0.5, 2.), random.uniform(-10., 10.), random.uniform(-10., 10.),
+                             random.uniform(-10., 10.), random.uniform(-10., 10.)});
+    }
+
+    for (auto _ : state) {
+        for (const auto& equation : equations) {
+            ::benchmark::DoNotOptimize(maths::Math::quarticSolverFull(equation));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * equations.size());
+}
+BENCHMARK(BM_QuarticSolverFull)->Unit(::benchmark::kMicrosecond);
+
+static void BM_RegionBooleans(::benchmark::State& state) {
+    Random random(104);
+    std::vector<std::pair<geo::Region, geo::Region>> regions;
+
+    for (int i = 0; i < 100; i++) {
+        geo::Region a;
+        geo::Region b;
+        a.addLoop(square(random));
+        b.addLoop(square(random));
+        regions.emplace_back(a, b);
+    }
+
+    for (auto _ : state) {
+        for (const auto& pair : regions) {
+            ::benchmark::DoNotOptimize(pair.first.unite(pair.second));
+            ::benchmark::DoNotOptimize(pair.first.intersect(pair.second));
+            ::benchmark::DoNotOptimize(pair.first.subtract(pair.second));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * regions.size());
+}
+BENCHMARK(BM_RegionBooleans)->Unit(::benchmark::kMillisecond);
+
+static void BM_EntityBuilderAdd(::benchmark::State& state) {
+    auto layer = benchmarkLayer();
+    auto entities = uniformLines(layer, state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto document = createDocument();
+        state.ResumeTiming();
+
+        addEntities(document, entities);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EntityBuilderAdd)->Arg(10000)->Arg(100000)->Unit(::benchmark::kMillisecond);
+
+static void BM_EntityBuilderMove(::benchmark::State& state) {
+    auto document = createDocument();
+    addEntities(document, uniformLines(document->layerByName("0"), state.range(0)));
+
+    for (auto _ : state) {
+        auto builder = std::make_shared<operation::EntityBuilder>(document);
+        builder->appendEntities(document->snapshot()->asVector());
+        builder->appendOperation(std::make_shared<operation::Push>());
+        builder->appendOperation(std::make_shared<operation::Move>(geo::Coordinate(1., 1.)));
+        builder->execute();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EntityBuilderMove)->Arg(10000)->Arg(100000)->Unit(::benchmark::kMillisecond);
+
+/**
+ * Build whole synthetic drawings
+ * Arg 0: lines, 1: arcs, 2: polylines, 3: hatches, 4: texts, 5: blocks
+ */
+static void BM_BuildDrawing(::benchmark::State& state) {
+    for (auto _ : state) {
+        auto document = createDocument();
+        auto layer = document->layerByName("0");
+
+        switch (state.range(0)) {
+            case 0:
+                addEntities(document, uniformLines(layer, 100000));
+                break;
+            case 1:
+                addEntities(document, denseArcs(layer, 100000));
+                break;
+            case 2:
+                addEntities(document, longPolylines(layer, 1000, 1000));
+                break;
+            case 3:
+                addEntities(document, hatches(layer, 10000));
+                break;
+            case 4:
+                addEntities(document, texts(layer, 100000));
+                break;
+            default:
+                addBlockHeavyDrawing(document, 100, 100, 100);
+        }
+
+        ::benchmark::DoNotOptimize(document->snapshot()->size());
+    }
+}
+BENCHMARK(BM_BuildDrawing)->DenseRange(0, 5)->Unit(::benchmark::kMillisecond);
@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include "generators.h"
+
+#include <cad/operations/builder.h>
+#include <cad/storage/documentsnapshot.h>
+#include <native/journal.h>
+#include <native/nativereader.h>
+#include <native/nativewriter.h>
+
+#include <cstdio>
+
+using namespace lc;
+using namespace lc::benchmark;
+
+namespace {
+const std::string NATIVE_PATH = "lcbenchmark.lcb";
+const std::string JOURNAL_PATH = "lcbenchmark";
+
+storage::Document_SPtr linesDocument(size_t count) {
+    auto document = createDocument();
+    addEntities(document, uniformLines(document->layerByName("0"), count));
+    return document;
+}
+}
+
+static void BM_NativeWrite(::benchmark::State& state) {
+    auto document = linesDocument(state.range(0));
+
+    for (auto _ : state) {
+        ::benchmark::DoNotOptimize(persistence::NativeWriter(document).write(NATIVE_PATH));
+    }
+
+    std::remove(NATIVE_PATH.c_str());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NativeWrite)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMillisecond);
+
+static void BM_NativeOpen(::benchmark::State& state) {
+    persistence::NativeWriter(linesDocument(state.range(0))).write(NATIVE_PATH);
+
+    for (auto _ : state) {
+        persistence::NativeReader reader(NATIVE_PATH);
+        ::benchmark::DoNotOptimize(reader.size());
+    }
+
+    std::remove(NATIVE_PATH.c_str());
+}
+BENCHMARK(BM_NativeOpen)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMicrosecond);
+
+static void BM_NativeQuery(::benchmark::State& state) {
+    persistence::NativeWriter(linesDocument(state.range(0))).write(NATIVE_PATH);
+    persistence::NativeReader reader(NATIVE_PATH);
+    Random random(200);
+
+    for (auto _ : state) {
+        geo::Area window(random.coordinate(), DRAWING_SIZE / 10., DRAWING_SIZE / 10.);
+        ::benchmark::DoNotOptimize(reader.entitiesInArea(window));
+    }
+
+    std::remove(NATIVE_PATH.c_str());
+}
+BENCHMARK(BM_NativeQuery)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMicrosecond);
+
+static void BM_NativeLoad(::benchmark::State& state) {
+    persistence::NativeWriter(linesDocument(state.range(0))).write(NATIVE_PATH);
+
+    for (auto _ : state) {
+        persistence::NativeReader reader(NATIVE_PATH);
+        auto document = createDocument();
+        auto builder = std::make_shared<operation::Builder>(document, "Load");
+        reader.load(document, builder);
+        builder->execute();
+    }
+
+    std::remove(NATIVE_PATH.c_str());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NativeLoad)->Arg(100000)->Unit(::benchmark::kMillisecond);
+
+/**
+ * Time between a commit of 10 lines and its journal record being on disk
+ */
+static void BM_JournalCommit(::benchmark::State& state) {
+    auto document = linesDocument(state.range(0));
+    auto layer = document->layerByName("0");
+
+    {
+        persistence::Journal journal(document, JOURNAL_PATH, std::chrono::milliseconds(1000));
+        journal.flush();
+        uint32_t commit = 0;
+
+        for (auto _ : state) {
+            addEntities(document, uniformLines(layer, 10, commit++));
+            journal.flush();
+        }
+    }
+
+    persistence::Journal::discard(JOURNAL_PATH);
+}
+BENCHMARK(BM_JournalCommit)->Arg(100000)->Unit(::benchmark::kMillisecond);
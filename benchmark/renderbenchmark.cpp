@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include "generators.h"
+
+#include <documentcanvas.h>
+#include <painters/lccairopainter.tcc>
+
+using namespace lc;
+using namespace lc::benchmark;
+
+namespace {
+const unsigned int IMAGE_WIDTH = 1920;
+const unsigned int IMAGE_HEIGHT = 1080;
+
+/**
+ * Headless drawing rendered in an offscreen Cairo image
+ */
+struct RenderFixture {
+    explicit RenderFixture(int64_t drawing) :
+        document(createDocument()),
+        canvas(std::make_shared<viewer::DocumentCanvas>(document)),
+        data(cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, IMAGE_WIDTH) * IMAGE_HEIGHT),
+        painter(data.data(), IMAGE_WIDTH, IMAGE_HEIGHT) {
+        auto layer = document->layerByName("0");
+
+        switch (drawing) {
+            case 0:
+                addEntities(document, uniformLines(layer, 100000));
+                break;
+            case 1:
+                addEntities(document, denseArcs(layer, 100000));
+                break;
+            case 2:
+                addEntities(document, longPolylines(layer, 1000, 1000));
+                break;
+            case 3:
+                addEntities(document, hatches(layer, 10000));
+                break;
+            case 4:
+                addEntities(document, texts(layer, 10000));
+                break;
+            default:
+                addBlockHeavyDrawing(document, 100, 100, 100);
+        }
+
+        canvas->newDeviceSize(IMAGE_WIDTH, IMAGE_HEIGHT);
+        // Measure the fills, not the placeholders of pending hatches
+        canvas->waitForDrawables();
+    }
+
+    storage::Document_SPtr document;
+    viewer::DocumentCanvas_SPtr canvas;
+    std::vector<unsigned char> data;
+    LcCairoPainter<CairoPainter::backend::Image> painter;
+};
+}
+
+/**
+ * Render the whole drawing
+ * Arg 0: lines, 1: arcs, 2: polylines, 3: hatches, 4: texts, 5: blocks
+ */
+static void BM_RenderAll(::benchmark::State& state) {
+    RenderFixture fixture(state.range(0));
+    fixture.canvas->autoScale(fixture.painter);
+
+    for (auto _ : state) {
+        fixture.canvas->render(fixture.painter, viewer::VIEWER_DOCUMENT);
+    }
+}
+BENCHMARK(BM_RenderAll)->DenseRange(0, 5)->Unit(::benchmark::kMillisecond);
+
+/**
+ * Render a window of a tenth of the drawing
+ */
+static void BM_RenderZoomed(::benchmark::State& state) {
+    RenderFixture fixture(state.range(0));
+    fixture.canvas->setDisplayArea(fixture.painter, geo::Area(geo::Coordinate(0., 0.), DRAWING_SIZE / 10., DRAWING_SIZE / 10.));
+
+    for (auto _ : state) {
+        fixture.canvas->render(fixture.painter, viewer::VIEWER_DOCUMENT);
+    }
+}
+BENCHMARK(BM_RenderZoomed)->DenseRange(0, 5)->Unit(::benchmark::kMillisecond);
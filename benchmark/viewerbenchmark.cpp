@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+#include "generators.h"
+
+#include <documentcanvas.h>
+
+using namespace lc;
+using namespace lc::benchmark;
+
+namespace {
+struct ViewerFixture {
+    explicit ViewerFixture(size_t count) :
+        document(createDocument()),
+        canvas(std::make_shared<viewer::DocumentCanvas>(document)) {
+        addEntities(document, uniformLines(document->layerByName("0"), count));
+    }
+
+    storage::Document_SPtr document;
+    viewer::DocumentCanvas_SPtr canvas;
+};
+}
+
+static void BM_CanvasAddEntities(::benchmark::State& state) {
+    auto entities = uniformLines(createDocument()->layerByName("0"), state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto document = createDocument();
+        auto canvas = std::make_shared<viewer::DocumentCanvas>(document);
+        state.ResumeTiming();
+
+        addEntities(document, entities);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CanvasAddEntities)->Arg(10000)->Arg(100000)->Unit(::benchmark::kMillisecond);
+
+/**
+ * Window selection of a tenth of the drawing, entities must be inside
+ */
+static void BM_CanvasWindowSelection(::benchmark::State& state) {
+    ViewerFixture fixture(state.range(0));
+    Random random(300);
+
+    for (auto _ : state) {
+        auto corner = random.coordinate();
+        fixture.canvas->makeSelection(corner.x(), corner.y(), DRAWING_SIZE / 10., DRAWING_SIZE / 10., true);
+        fixture.canvas->closeSelection();
+        ::benchmark::DoNotOptimize(fixture.canvas->selectedDrawables().size());
+        fixture.canvas->removeSelection();
+    }
+}
+BENCHMARK(BM_CanvasWindowSelection)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMicrosecond);
+
+/**
+ * Crossing selection of a tenth of the drawing, entities must intersect
+ */
+static void BM_CanvasCrossingSelection(::benchmark::State& state) {
+    ViewerFixture fixture(state.range(0));
+    Random random(301);
+
+    for (auto _ : state) {
+        auto corner = random.coordinate();
+        fixture.canvas->makeSelection(corner.x(), corner.y(), DRAWING_SIZE / 10., DRAWING_SIZE / 10., false);
+        fixture.canvas->closeSelection();
+        ::benchmark::DoNotOptimize(fixture.canvas->selectedDrawables().size());
+        fixture.canvas->removeSelection();
+    }
+}
+BENCHMARK(BM_CanvasCrossingSelection)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMicrosecond);
+
+static void BM_CanvasSelectAll(::benchmark::State& state) {
+    ViewerFixture fixture(state.range(0));
+
+    for (auto _ : state) {
+        fixture.canvas->selectAll();
+        ::benchmark::DoNotOptimize(fixture.canvas->selectedDrawables().size());
+        fixture.canvas->removeSelection();
+    }
+}
+BENCHMARK(BM_CanvasSelectAll)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMillisecond);
+
+static void BM_CanvasSelectPoint(::benchmark::State& state) {
+    ViewerFixture fixture(state.range(0));
+    Random random(302);
+
+    for (auto _ : state) {
+        auto point = random.coordinate();
+        fixture.canvas->selectPoint(point.x(), point.y());
+        fixture.canvas->removeSelection();
+    }
+}
+BENCHMARK(BM_CanvasSelectPoint)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(::benchmark::kMicrosecond);
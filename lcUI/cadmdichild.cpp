@@ -9,10 +9,21 @@
 #include <file.h>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QProgressDialog>
+#include <QCoreApplication>
+#include <QDir>
+#include <QStandardPaths>
+#include <QUuid>
 
 using namespace lc::ui;
 using namespace lc::viewer;
 
+namespace {
+QString autosaveDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/autosave";
+}
+}
+
 CadMdiChild::CadMdiChild(QWidget* parent) :
     QWidget(parent),
     _activeLayer(nullptr) {
@@ -44,10 +55,19 @@ CadMdiChild::~CadMdiChild() {
     if(_destroyCallback) {
         _destroyCallback();
     }
+
+    stopJournal();
 }
 
 
 void CadMdiChild::newDocument() {
+    createDocument();
+    startJournal();
+}
+
+void CadMdiChild::createDocument() {
+    stopJournal();
+
     // Create a new document with required objects, all objects that are required needs to be passed into the constructor
     _document = std::make_shared<lc::storage::DocumentImpl>(storageManager());
 
@@ -99,9 +119,37 @@ bool CadMdiChild::openFile() {
 
     if(!availableLibraries.empty()) {
         //TODO: if more than once, ask which one to choose
-        newDocument();
+        createDocument();
         _filename = file.toStdString();
-        _fileType = lc::persistence::File::open(_document, _filename, availableLibraries.begin()->first);
+
+        // The file is read in the background, keep the interface responsive and allow to cancel
+        QProgressDialog progressDialog("Opening " + fileInfo.fileName(), "Cancel", 0, 0, this);
+        progressDialog.setWindowModality(Qt::WindowModal);
+        progressDialog.show();
+
+        try {
+            _fileType = lc::persistence::File::open(_document, _filename, availableLibraries.begin()->first,
+                [&progressDialog, &fileInfo](unsigned int nbEntities) {
+                    progressDialog.setLabelText(QString("Opening %1: %2 entities").arg(fileInfo.fileName()).arg(nbEntities));
+                    QCoreApplication::processEvents();
+                    return !progressDialog.wasCanceled();
+                }
+            );
+        }
+        catch(const std::runtime_error& e) {
+            startJournal();
+            _filename = "";
+            QMessageBox::critical(nullptr, "Open error", QString("Can't open %1: %2").arg(fileInfo.fileName(), e.what()));
+            return false;
+        }
+
+        // The autosave starts from the opened file instead of journaling its loading
+        startJournal();
+
+        if(progressDialog.wasCanceled()) {
+            _filename = "";
+            return false;
+        }
     }
     else {
         QMessageBox::critical(nullptr, "Open error", "Unknown file extension ." + fileInfo.suffix());
@@ -113,7 +161,21 @@ bool CadMdiChild::openFile() {
 
 void CadMdiChild::saveFile() {
     if (_filename == "")saveAsFile();
-    else lc::persistence::File::save(_document, _filename, _fileType);// @TODO Needs to fix it later
+    else save(_filename, _fileType);// @TODO Needs to fix it later
+}
+
+bool CadMdiChild::save(const std::string& path, lc::persistence::File::Type type) {
+    try {
+        lc::persistence::File::save(_document, path, type);
+
+        // The saved file contains everything the autosave had
+        startJournal();
+        return true;
+    }
+    catch(const std::runtime_error& e) {
+        QMessageBox::critical(nullptr, "Save error", e.what());
+        return false;
+    }
 }
 
 void CadMdiChild::saveAsFile() {
@@ -155,14 +217,86 @@ void CadMdiChild::saveAsFile() {
         }
     }
 
-    _fileType = type;
-
     //Add extension if not present
     auto fileInfo = QFileInfo(file);
     auto ext = fileInfo.suffix().toStdString();
     if(ext=="")file+=("."+lc::persistence::File::getExtensionForFileType(type)).c_str();
-    _filename = file.toStdString();
-    lc::persistence::File::save(_document, _filename, type);
+
+    if(save(file.toStdString(), type)) {
+        _fileType = type;
+        _filename = file.toStdString();
+    }
+}
+
+bool CadMdiChild::recoverAutosave(const std::string& path) {
+    createDocument();
+
+    bool recovered = false;
+    try {
+        recovered = lc::persistence::Journal::recover(_document, path);
+    }
+    catch(const std::runtime_error& e) {
+        QMessageBox::critical(nullptr, "Recovery error", e.what());
+    }
+
+    // The autosave starts from the recovered drawing instead of journaling the replay
+    startJournal();
+
+    if(!recovered) {
+        return false;
+    }
+
+    _filename = "";
+    _activeLayer = _document->layerByName("0");
+    discardAutosave(path);
+
+    return true;
+}
+
+std::vector<std::string> CadMdiChild::autosaves() {
+    std::vector<std::string> paths;
+
+    QDir directory(autosaveDirectory());
+    for(const auto& snapshot : directory.entryInfoList(QStringList() << "*.lcb", QDir::Files, QDir::Time)) {
+        auto path = snapshot.absolutePath() + "/" + snapshot.completeBaseName();
+
+        // The lock of a crashed instance is stale and can be taken, the age of the lock is ignored
+        QLockFile lock(path + ".lock");
+        lock.setStaleLockTime(0);
+        if(lock.tryLock(0)) {
+            lock.unlock();
+            paths.push_back(path.toStdString());
+        }
+    }
+
+    return paths;
+}
+
+void CadMdiChild::discardAutosave(const std::string& path) {
+    lc::persistence::Journal::discard(path);
+}
+
+void CadMdiChild::startJournal() {
+    stopJournal();
+
+    QDir().mkpath(autosaveDirectory());
+    auto path = autosaveDirectory() + "/" + QUuid::createUuid().toString().mid(1, 36);
+
+    _journalLock.reset(new QLockFile(path + ".lock"));
+    _journalLock->tryLock(0);
+
+    _journalPath = path.toStdString();
+    _journal.reset(new lc::persistence::Journal(_document, _journalPath));
+}
+
+void CadMdiChild::stopJournal() {
+    if(_journal == nullptr) {
+        return;
+    }
+
+    _journal.reset();
+    lc::persistence::Journal::discard(_journalPath);
+    _journalLock.reset();
 }
 
 void CadMdiChild::ctxMenu(const QPoint& pos) {
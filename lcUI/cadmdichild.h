@@ -2,6 +2,7 @@
 #include <QVBoxLayout>
 #include <QWidget>
 #include <QKeyEvent>
+#include <QLockFile>
 #include "lcadviewerproxy.h"
 #include "cad/meta/color.h"
 #include <cad/storage/storagemanager.h>
@@ -11,8 +12,11 @@
 #include <drawables/lccursor.h>
 
 #include <file.h>
+#include <native/journal.h>
 #include <managers/metainfomanager.h>
 
+#include <memory>
+
 extern "C"
 {
 #include "lua.h"
@@ -44,6 +48,25 @@ public:
      */
     bool openFile();
 
+    /**
+     * \brief Replace the document by a drawing autosaved by a LibreCAD instance which wasn't closed properly
+     * The autosave files are removed once the drawing is recovered.
+     * \param path Autosave path, as returned by autosaves()
+     * \return bool True if the drawing was recovered
+     */
+    bool recoverAutosave(const std::string& path);
+
+    /**
+     * \brief List the autosaved drawings which can be recovered
+     * Drawings of running LibreCAD instances are locked and not listed.
+     */
+    static std::vector<std::string> autosaves();
+
+    /**
+     * \brief Remove the files of an autosaved drawing
+     */
+    static void discardAutosave(const std::string& path);
+
     /**
      * \brief Give function to call when window is destroyed
      * \param callback Lua function
@@ -128,6 +151,31 @@ public:
     }
 
 private:
+    /**
+     * @brief Save the document, errors are shown to the user
+     * @return true if the file was written
+     */
+    bool save(const std::string& path, lc::persistence::File::Type type);
+
+    /**
+     * @brief Replace the document by an empty one, without autosave until startJournal() is called
+     */
+    void createDocument();
+
+    /**
+     * @brief Start autosaving the current document, replacing the previous autosave
+     */
+    void startJournal();
+
+    /**
+     * @brief Stop autosaving and remove the autosave files
+     */
+    void stopJournal();
+
+    std::unique_ptr<QLockFile> _journalLock;
+    std::unique_ptr<lc::persistence::Journal> _journal;
+    std::string _journalPath;
+
     std::string _filename;
     lc::persistence::File::Type _fileType = lc::persistence::File::Type::LIBDXFRW_DXF_R2000;
 
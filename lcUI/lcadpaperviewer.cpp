@@ -41,7 +41,8 @@ void LCADPaperViewer::setDocument(std::shared_ptr<lc::storage::Document> documen
     this->documentCanvas()->foreground().connect<drawable::DragPoints, &drawable::DragPoints::onDraw>(_dragPoints.get());
 
     // Undo manager takes care that we can undo/redo entities within a document
-    _undoManager = std::make_shared<lc::storage::UndoManagerImpl>(10);
+    auto undoMemoryBudget = lc::kernel::getSettings().get(SETTINGS_UNDOMEMORYBUDGET)->getDouble() * 1024 * 1024;
+    _undoManager = std::make_shared<lc::storage::UndoManagerImpl>(10, static_cast<size_t>(undoMemoryBudget));
     document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(_undoManager.get());
 }
 
@@ -7,6 +7,7 @@
 #include <cad/logger/logger.h>
 #include "widgets/guiAPI/menu.h"
 #include "managers/contextmenumanager.h"
+#include "painters/opengl/packcache.h"
 
 using namespace lc;
 using namespace lc::ui;
@@ -42,6 +43,11 @@ LCADViewer::LCADViewer(QWidget *parent) :
     _hookManager.append("pan", [&](lc::ui::HookEvent& e)->bool{return panHandler(e);});
     // Inside lambdas to can capture context
     //   bind would be better here but not sure
+
+    // Drawables computed in the background only set a flag, Qt objects are touched from this thread only
+    _drawablesReadyTimer.setInterval(50);
+    connect(&_drawablesReadyTimer, &QTimer::timeout, this, &LCADViewer::_pollDrawablesReady);
+    _drawablesReadyTimer.start();
 }
 
 void LCADViewer::messageLogged(const QOpenGLDebugMessage &msg)
@@ -102,7 +108,12 @@ void LCADViewer::messageLogged(const QOpenGLDebugMessage &msg)
 
 LCADViewer::~LCADViewer()
 {
+    // The painters and the pack cache free their GPU buffers, which needs the context of the viewer
+    QOpenGLWidget::makeCurrent();
     deletePainters();
+    _packCache.reset();
+    QOpenGLWidget::doneCurrent();
+
     _document->commitProcessEvent().disconnect<LCADViewer, &LCADViewer::on_commitProcessEvent>(this);
 }
 
@@ -152,6 +163,10 @@ void LCADViewer::setDocument(std::shared_ptr<lc::storage::Document> document, me
     int width = size().width();
     int height = size().height();
 
+    // The cache of the previous document may be released
+    QOpenGLWidget::makeCurrent();
+    _packCache = lc::viewer::opengl::PackCache::forDocument(document);
+
     deletePainters();
     createPainters(width, height);
 
@@ -189,6 +204,12 @@ void LCADViewer::_selectionChanged() {
     emit selectionChangeEvent();
 }
 
+void LCADViewer::_pollDrawablesReady() {
+    if(_docCanvas != nullptr && _docCanvas->takeDrawablesReady()) {
+        update();
+    }
+}
+
 /**
   * Handle key pressing and release to add additional states to this view
   *
@@ -423,7 +444,7 @@ void LCADViewer::createPainters(unsigned int width, unsigned int height) {
     QImage *m_image;
 
     m_image = new QImage(width, height, QImage::Format_ARGB32);
-    _documentPainter = lc::viewer::createOpenGLPainter(m_image->bits(), width, height);
+    _documentPainter = lc::viewer::createOpenGLPainter(m_image->bits(), width, height, _packCache);
     imagemaps.insert(std::make_pair(_documentPainter, m_image));
 
     if(_docCanvas != nullptr)
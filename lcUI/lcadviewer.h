@@ -8,6 +8,7 @@
 #include <map>
 #include <QOpenGLWidget>
 #include <QOpenGLContext>
+#include <QTimer>
 
 #include "cad/storage/document.h"
 #include "cad/storage/entitycontainer.h"
@@ -138,6 +139,11 @@ public slots:
 private:
     void _selectionChanged();
 
+    /**
+     * @brief Repaints when background geometry became ready, see DocumentCanvas::takeDrawablesReady()
+     */
+    void _pollDrawablesReady();
+
     bool dragHandler(lc::ui::HookEvent&);
     bool selectHandler(lc::ui::HookEvent&);
     bool panHandler(lc::ui::HookEvent&);
@@ -184,7 +190,12 @@ private:
     lc::viewer::LcPainter* _documentPainter;
     lc::viewer::LcPainter* _foregroundPainter;
 
+    // Tessellated entities, shared with the other viewers of the document
+    std::shared_ptr<lc::viewer::opengl::PackCache> _packCache;
+
     int _contextMenuManagerId;
+
+    QTimer _drawablesReadyTimer;
 };
 }
 }
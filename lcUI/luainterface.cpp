@@ -25,6 +25,7 @@ void LuaInterface::initLua(QMainWindow* mainWindow) {
     lcLua.setF_openFileDialog(&LuaInterface::openFileDialog);
     lcLua.addLuaLibs();
     lcLua.importLCKernel();
+    lcLua.importProfilerControl();
 
     luaOpenGUIBridge(_L.state());
 
@@ -19,7 +19,7 @@ int main2(int argc, char* argv[]) {
     QApplication a(argc, argv);
 
     LOGGER;//Init logger
-    lc::persistence::PatternProvider::Instance();//Init pattern loader
+    lc::persistence::PatternProvider::Instance()->preload();//Load the hatch patterns in the background
 
     lc::ui::WindowManager::init();
 
@@ -7,6 +7,10 @@
 #include "managers/contextmenumanager.h"
 
 #include <QStandardPaths>
+#include <QFileDialog>
+#include <QMessageBox>
+
+#include <cad/tools/profiler.h>
 
 #include "widgets/guiAPI/coordinategui.h"
 #include "widgets/guiAPI/entitygui.h"
@@ -95,9 +99,32 @@ void MainWindow::addOtherMenus() {
         textDialog->show();
         });
 
+    state["run_startprofiler"] = kaguya::function([] {
+        lc::tools::Profiler::instance().clear();
+        lc::tools::Profiler::instance().setEnabled(true);
+        });
+    state["run_saveprofile"] = kaguya::function([&] {
+        auto& profiler = lc::tools::Profiler::instance();
+        profiler.setEnabled(false);
+
+        auto file = QFileDialog::getSaveFileName(this, "Save profile", "", "Chrome trace (*.json)");
+        if (file.isEmpty()) {
+            return;
+        }
+
+        try {
+            profiler.writeChromeTrace(file.toStdString());
+        }
+        catch (const std::runtime_error& e) {
+            QMessageBox::critical(this, "Save error", e.what());
+        }
+        });
+
     api::Menu* luaMenu = addMenu("Lua");
     luaMenu->addItem("Run script", state["run_luascript"]);
     luaMenu->addItem("Customize Toolbar", state["run_customizetoolbar"]);
+    luaMenu->addItem("Start Profiling", state["run_startprofiler"]);
+    luaMenu->addItem("Stop Profiling and Save", state["run_saveprofile"]);
 
     api::Menu* viewMenu = addMenu("View");
     state.dostring("changeLayout = function() mainWindow:changeDockLayout(1) end");
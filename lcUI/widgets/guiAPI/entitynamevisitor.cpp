@@ -62,6 +62,10 @@ void EntityNameVisitor::visit(entity::Hatch_CSPtr){
     entityInfo = "Hatch";
 }
 
+void EntityNameVisitor::visit(entity::Insert_CSPtr){
+    entityInfo = "Insert";
+}
+
 std::string EntityNameVisitor::getEntityInformation() const {
     return entityInfo;
 }
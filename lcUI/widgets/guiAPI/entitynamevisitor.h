@@ -25,6 +25,7 @@ namespace lc
                 void visit(entity::LWPolyline_CSPtr) override;
                 void visit(entity::Image_CSPtr) override;
                 void visit(entity::Hatch_CSPtr) override;
+                void visit(entity::Insert_CSPtr) override;
 
                 std::string getEntityInformation() const;
 
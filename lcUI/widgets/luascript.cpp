@@ -16,8 +16,12 @@ LuaScript::LuaScript(lc::ui::MainWindow* mainWindow) :
     lcLua.setF_openFileDialog(&LuaInterface::openFileDialog);
     lcLua.addLuaLibs();
     lcLua.importLCKernel();
+    lcLua.importProfilerControl();
     luaOpenGUIBridge(luaState.state());
     registerGlobalFunctions(luaState);
+
+    _backgroundTimer.setInterval(50);
+    connect(&_backgroundTimer, &QTimer::timeout, this, &LuaScript::commitBackgroundScripts);
 }
 
 LuaScript::~LuaScript() {
@@ -26,6 +30,18 @@ LuaScript::~LuaScript() {
 
 
 void LuaScript::on_luaRun_clicked() {
+    if(ui->background->isChecked()) {
+        if(!_statePool) {
+            _statePool.reset(new lc::lua::LuaStatePool());
+        }
+
+        auto document = _mdiChild->document();
+        auto code = ui->luaInput->toPlainText().toStdString();
+        _backgroundScripts.push_back({document, _statePool->run(code, document->snapshot())});
+        _backgroundTimer.start();
+        return;
+    }
+
     auto lcLua = lc::lua::LCLua(luaState.state());
     lcLua.setDocument(_mdiChild->document());
 
@@ -73,6 +89,30 @@ void LuaScript::on_save_clicked() {
     }
 }
 
+void LuaScript::commitBackgroundScripts() {
+    for(auto it = _backgroundScripts.begin(); it != _backgroundScripts.end();) {
+        if(it->batch.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            it++;
+            continue;
+        }
+
+        auto batch = it->batch.get();
+        if(batch.error().empty()) {
+            batch.entityBuilder(it->document)->execute();
+            _cliCommand->write(std::to_string(batch.size()) + " entities added by the background script");
+        }
+        else {
+            _cliCommand->write(batch.error());
+        }
+
+        it = _backgroundScripts.erase(it);
+    }
+
+    if(_backgroundScripts.empty()) {
+        _backgroundTimer.stop();
+    }
+}
+
 void LuaScript::registerGlobalFunctions(kaguya::State& luaState) {
     // register common functions i.e. run_basic_operation and message
     luaState["mainWindow"] = static_cast<lc::ui::MainWindow*>(_mainWindow);
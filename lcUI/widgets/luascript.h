@@ -5,11 +5,17 @@
 #include <QMdiSubWindow>
 #include <QFileDialog>
 #include <QTextStream>
+#include <QTimer>
 #include <mainwindow.h>
 #include "cadmdichild.h"
 #include "clicommand.h"
 
 #include <lclua.h>
+#include <luastatepool.h>
+
+#include <future>
+#include <memory>
+#include <vector>
 
 namespace Ui {
 class LuaScript;
@@ -21,6 +27,8 @@ namespace widgets {
 /**
  * \brief Widget that allows to enter and run Lua code.
  * This widget runs the code on the selected window in CadMdiChild and display the output in the command line.
+ * In background mode, the code runs in a sandboxed state of a LuaStatePool against a snapshot of the document,
+ * the entities it creates are added to the document when it ends.
  */
 class LuaScript : public QWidget {
     Q_OBJECT
@@ -52,18 +60,33 @@ private slots:
      */
     void on_save_clicked();
 
+    /**
+     * \brief Add the entities of the finished background scripts to their document
+     */
+    void commitBackgroundScripts();
+
 private:
     /**
      * \brief Register helper global functions
      */
     void registerGlobalFunctions(kaguya::State& luaState);
 
+    struct BackgroundScript {
+        lc::storage::Document_SPtr document;
+        std::future<lc::lua::LuaBatch> batch;
+    };
+
 private:
     Ui::LuaScript* ui;
     lc::ui::MainWindow* _mainWindow;
     CadMdiChild* _mdiChild;
     CliCommand* _cliCommand;
     kaguya::State luaState;
+
+    // Destroyed after the pool finished the scripts, the batches are then released on this thread
+    std::vector<BackgroundScript> _backgroundScripts;
+    std::unique_ptr<lc::lua::LuaStatePool> _statePool;
+    QTimer _backgroundTimer;
 };
 }
 }
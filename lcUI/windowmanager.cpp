@@ -2,6 +2,9 @@
 
 #include <QObject>
 #include <QMetaObject>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QtWidgets/QMessageBox>
 
 using namespace lc::ui;
 
@@ -13,6 +16,30 @@ void WindowManager::init()
     MainWindow* window = new MainWindow();
     window->showMaximized();
     mainWindows.push_back(window);
+
+    recoverAutosaves();
+}
+
+void WindowManager::recoverAutosaves()
+{
+    for (const auto& path : CadMdiChild::autosaves())
+    {
+        auto date = QFileInfo(QString::fromStdString(path + ".lcb")).lastModified().toString();
+        auto answer = QMessageBox::question(nullptr, "Recover drawing",
+                                            "LibreCAD was not closed properly. Recover the drawing autosaved on " + date + "?",
+                                            QMessageBox::Yes | QMessageBox::No);
+
+        if (answer != QMessageBox::Yes)
+        {
+            CadMdiChild::discardAutosave(path);
+            continue;
+        }
+
+        MainWindow* window = new MainWindow();
+        window->cadMdiChild()->recoverAutosave(path);
+        window->showMaximized();
+        mainWindows.push_back(window);
+    }
 }
 
 void WindowManager::newFile(MainWindow* prevWindow)
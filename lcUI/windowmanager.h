@@ -19,6 +19,12 @@ namespace lc
             */
             static void init();
 
+            /**
+            * \brief Ask to recover the drawings autosaved by instances which were not closed properly
+            * Each recovered drawing is opened in a new MainWindow.
+            */
+            static void recoverAutosaves();
+
             /**
             * \brief Closes existing window and creates a new MainWindow
             */
@@ -27,8 +27,9 @@ function nearestPointOnPath(insert, coord)
     local d = insert:document()
     local block = insert:displayBlock()
 
-    local entities = d:entitiesByBlock(block):asVector()
-    for k, v in pairs(entities) do
+    local query = d:query()
+    query:setBlock(block)
+    query:each(function(v)
         local tmp = v:nearestPointOnPath(coord)
         local tmpDistance = coord:distanceTo(tmp)
 
@@ -36,7 +37,7 @@ function nearestPointOnPath(insert, coord)
             point = tmp
             distance = tmpDistance
         end
-    end
+    end)
 
     if(point == nil) then
         return Coordinate(0, 0, 0)
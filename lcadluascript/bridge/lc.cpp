@@ -4,11 +4,35 @@
 #include <cad/vo/entitycoordinate.h>
 #include <cad/interface/snapconstrain.h>
 #include <cad/vo/entitydistance.h>
+#include <cad/tools/profiler.h>
 #include "lc.h"
 
 void import_lc_namespace(kaguya::State& state) {
     state["lc"] = kaguya::NewTable();
 
+    state["lc"]["profiler"] = kaguya::NewTable();
+    state["lc"]["profiler"]["enabled"] = kaguya::function([]() {
+        return lc::tools::Profiler::instance().enabled();
+    });
+    state["lc"]["profiler"]["zone"] = kaguya::function([](const std::string& name, kaguya::LuaRef function) {
+        // Zones in Lua can't rely on scopes, the zone covers the call to the function
+        auto& profiler = lc::tools::Profiler::instance();
+        if(!profiler.enabled()) {
+            function();
+            return;
+        }
+
+        auto start = lc::tools::Profiler::Clock::now();
+        function();
+        profiler.addZone(name, start, lc::tools::Profiler::Clock::now());
+    });
+    state["lc"]["profiler"]["count"] = kaguya::function([](const std::string& name, double delta) {
+        LC_PROFILE_COUNT(name, delta);
+    });
+    state["lc"]["profiler"]["gauge"] = kaguya::function([](const std::string& name, double value) {
+        LC_PROFILE_GAUGE(name, value);
+    });
+
     state["lc"]["Visitable"].setClass(kaguya::UserdataMetatable<lc::Visitable>()
                                       .addFunction("accept", &lc::Visitable::accept)
                                      );
@@ -53,3 +77,15 @@ void import_lc_namespace(kaguya::State& state) {
                                            .addFunction("entity", &lc::EntityDistance::entity)
                                           );
 }
+
+void import_lc_profiler_control(kaguya::State& state) {
+    state["lc"]["profiler"]["setEnabled"] = kaguya::function([](bool enabled) {
+        lc::tools::Profiler::instance().setEnabled(enabled);
+    });
+    state["lc"]["profiler"]["clear"] = kaguya::function([]() {
+        lc::tools::Profiler::instance().clear();
+    });
+    state["lc"]["profiler"]["writeChromeTrace"] = kaguya::function([](const std::string& path) {
+        lc::tools::Profiler::instance().writeChromeTrace(path);
+    });
+}
@@ -2,4 +2,9 @@
 
 #include <kaguya/include/kaguya/state.hpp>
 
-void import_lc_namespace(kaguya::State& state);
\ No newline at end of file
+void import_lc_namespace(kaguya::State& state);
+
+/**
+ * Functions changing the profiler or writing its trace, not available in sandboxed states
+ */
+void import_lc_profiler_control(kaguya::State& state);
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <cad/builders/dimradial.h>
 #include <cad/builders/ellipse.h>
 #include <cad/builders/line.h>
+#include <cad/builders/bulk.h>
 #include <cad/builders/spline.h>
 #include <cad/builders/text.h>
 #include <cad/builders/insert.h>
@@ -268,6 +269,16 @@ void import_lc_builder_namespace(kaguya::State& state) {
             .addFunction("build", &lc::builder::LWPolylineBuilder::build)
                                                         );
 
+    state["lc"]["builder"]["BulkBuilder"].setClass(kaguya::UserdataMetatable<lc::builder::BulkBuilder, lc::builder::CADEntityBuilder>()
+            .setConstructors<lc::builder::BulkBuilder()>()
+            .addFunction("appendLines", &lc::builder::BulkBuilder::appendLines)
+            .addFunction("appendCircles", &lc::builder::BulkBuilder::appendCircles)
+            .addFunction("appendArcs", &lc::builder::BulkBuilder::appendArcs)
+            .addFunction("appendPolylines", &lc::builder::BulkBuilder::appendPolylines)
+            .addFunction("size", &lc::builder::BulkBuilder::size)
+            .addFunction("clear", &lc::builder::BulkBuilder::clear)
+                                                        );
+
     state["lc"]["builder"]["InsertBuilder"].setClass(kaguya::UserdataMetatable<lc::builder::InsertBuilder, lc::builder::CADEntityBuilder>()
             .setConstructors<lc::builder::InsertBuilder()>()
             .addFunction("build", &lc::builder::InsertBuilder::build)
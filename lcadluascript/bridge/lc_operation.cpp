@@ -6,6 +6,7 @@
 #include <cad/operations/linepatternops.h>
 #include <cad/operations/blockops.h>
 #include <cad/operations/entitybuilder.h>
+#include <cad/builders/bulk.h>
 #include "lc_operation.h"
 
 void import_lc_operation_namespace(kaguya::State& state) {
@@ -174,6 +175,9 @@ void import_lc_operation_namespace(kaguya::State& state) {
         return std::make_shared<lc::operation::EntityBuilder>(document);
     })
     .addFunction("appendEntity", &lc::operation::EntityBuilder::appendEntity)
+    .addStaticFunction("appendBulk", [](lc::operation::EntityBuilder& entityBuilder, const lc::builder::BulkBuilder& bulkBuilder) {
+        entityBuilder.appendEntities(bulkBuilder.entities());
+    })
     .addFunction("appendOperation", &lc::operation::EntityBuilder::appendOperation)
     .addFunction("processStack", &lc::operation::EntityBuilder::processStack)
     .addFunction("redo", &lc::operation::EntityBuilder::redo)
@@ -5,6 +5,8 @@
 #include <cad/storage/document.h>
 #include <cad/storage/storagemanager.h>
 #include <cad/storage/documentimpl.h>
+#include <cad/storage/documentsnapshot.h>
+#include <cad/storage/entityquery.h>
 #include "lc_storage.h"
 
 void import_lc_storage_namespace(kaguya::State& state) {
@@ -53,6 +55,34 @@ void import_lc_storage_namespace(kaguya::State& state) {
             .addFunction("remove", &lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr>::remove)
                                                       );
 
+    state["lc"]["storage"]["DocumentSnapshot"].setClass(kaguya::UserdataMetatable<lc::storage::DocumentSnapshot>()
+            .addFunction("allMetaTypes", &lc::storage::DocumentSnapshot::allMetaTypes)
+            .addFunction("asVector", &lc::storage::DocumentSnapshot::asVector)
+            .addFunction("blockByName", &lc::storage::DocumentSnapshot::blockByName)
+            .addFunction("entitiesWithinAndCrossingAreaFast", &lc::storage::DocumentSnapshot::entitiesWithinAndCrossingAreaFast)
+            .addFunction("entityByID", &lc::storage::DocumentSnapshot::entityByID)
+            .addFunction("layerByName", &lc::storage::DocumentSnapshot::layerByName)
+            .addFunction("metaTypeByID", &lc::storage::DocumentSnapshot::metaTypeByID)
+            .addFunction("size", &lc::storage::DocumentSnapshot::size)
+                                                       );
+
+    state["lc"]["storage"]["EntityQuery"].setClass(kaguya::UserdataMetatable<lc::storage::EntityQuery>()
+            .setConstructors<lc::storage::EntityQuery(const lc::storage::Document_SPtr&), lc::storage::EntityQuery(lc::storage::DocumentSnapshot_CSPtr)>()
+            .addFunction("setArea", &lc::storage::EntityQuery::setArea)
+            .addFunction("setLayer", &lc::storage::EntityQuery::setLayer)
+            .addFunction("setBlock", &lc::storage::EntityQuery::setBlock)
+            .addFunction("count", &lc::storage::EntityQuery::count)
+            .addFunction("ids", &lc::storage::EntityQuery::ids)
+            .addFunction("asVector", &lc::storage::EntityQuery::asVector)
+            .addStaticFunction("each", [](const lc::storage::EntityQuery& query, kaguya::LuaRef callback) {
+                // The callback returns false to stop, the remaining entities are not visited
+                query.eachWhile([&callback](const lc::entity::CADEntity_CSPtr& entity) {
+                    auto result = callback.call<kaguya::LuaRef>(entity);
+                    return result.type() != LUA_TBOOLEAN || result.get<bool>();
+                });
+            })
+                                                  );
+
     state["lc"]["storage"]["StorageManager"].setClass(kaguya::UserdataMetatable<lc::storage::StorageManager>()
             .addFunction("addDocumentMetaType", &lc::storage::StorageManager::addDocumentMetaType)
             .addFunction("allLayers", &lc::storage::StorageManager::allLayers)
@@ -62,6 +92,7 @@ void import_lc_storage_namespace(kaguya::State& state) {
             .addFunction("entityByID", &lc::storage::StorageManager::entityByID)
             .addFunction("entityContainer", &lc::storage::StorageManager::entityContainer)
             .addFunction("insertEntity", &lc::storage::StorageManager::insertEntity)
+            .addFunction("insertEntities", &lc::storage::StorageManager::insertEntities)
             .addFunction("insertEntityContainer", &lc::storage::StorageManager::insertEntityContainer)
             .addFunction("layerByName", &lc::storage::StorageManager::layerByName)
             .addFunction("linePatternByName", &lc::storage::StorageManager::linePatternByName)
@@ -81,6 +112,7 @@ void import_lc_storage_namespace(kaguya::State& state) {
             .addFunction("entitiesByLayer", &lc::storage::Document::entitiesByLayer)
             .addFunction("entityContainer", &lc::storage::Document::entityContainer)
             .addFunction("insertEntity", &lc::storage::Document::insertEntity)
+            .addFunction("insertEntities", &lc::storage::Document::insertEntities)
             .addFunction("layerByName", &lc::storage::Document::layerByName)
             .addFunction("linePatternByName", &lc::storage::Document::linePatternByName)
             .addFunction("linePatterns", &lc::storage::Document::linePatterns)
@@ -88,6 +120,25 @@ void import_lc_storage_namespace(kaguya::State& state) {
             .addFunction("removeEntity", &lc::storage::Document::removeEntity)
             .addFunction("replaceDocumentMetaType", &lc::storage::Document::replaceDocumentMetaType)
             .addFunction("waitingCustomEntities", &lc::storage::Document::waitingCustomEntities)
+            .addStaticFunction("queryArea", [](const lc::storage::Document_SPtr& document, const lc::geo::Area& area) {
+                // Flat arrays: one ID and minX minY maxX maxY per entity
+                std::vector<ID_DATATYPE> ids;
+                std::vector<double> bounds;
+
+                document->snapshot()->eachWithinAndCrossingArea(area, [&ids, &bounds](const lc::entity::CADEntity_CSPtr& entity) {
+                    auto box = entity->boundingBox();
+                    ids.push_back(entity->id());
+                    bounds.push_back(box.minP().x());
+                    bounds.push_back(box.minP().y());
+                    bounds.push_back(box.maxP().x());
+                    bounds.push_back(box.maxP().y());
+                });
+
+                return std::make_tuple(ids, bounds);
+            })
+            .addStaticFunction("query", [](const lc::storage::Document_SPtr& document) {
+                return std::make_shared<lc::storage::EntityQuery>(document);
+            })
                                                );
 
     state["lc"]["storage"]["DocumentImpl"].setClass(kaguya::UserdataMetatable<lc::storage::DocumentImpl, lc::storage::Document>()
@@ -100,6 +151,7 @@ void import_lc_storage_namespace(kaguya::State& state) {
             .addFunction("entitiesByLayer", &lc::storage::DocumentImpl::entitiesByLayer)
             .addFunction("entityContainer", &lc::storage::DocumentImpl::entityContainer)
             .addFunction("insertEntity", &lc::storage::DocumentImpl::insertEntity)
+            .addFunction("insertEntities", &lc::storage::DocumentImpl::insertEntities)
             .addFunction("layerByName", &lc::storage::DocumentImpl::layerByName)
             .addFunction("linePatternByName", &lc::storage::DocumentImpl::linePatternByName)
             .addFunction("linePatterns", &lc::storage::DocumentImpl::linePatterns)
@@ -121,10 +173,14 @@ void import_lc_storage_namespace(kaguya::State& state) {
             .setConstructors<lc::storage::UndoManagerImpl(unsigned int)>()
             .addFunction("canRedo", &lc::storage::UndoManagerImpl::canRedo)
             .addFunction("canUndo", &lc::storage::UndoManagerImpl::canUndo)
+            .addFunction("maximumBytes", &lc::storage::UndoManagerImpl::maximumBytes)
+            .addFunction("memoryUsage", &lc::storage::UndoManagerImpl::memoryUsage)
             .addFunction("on_CommitProcessEvent", &lc::storage::UndoManagerImpl::on_CommitProcessEvent)
             .addFunction("redo", &lc::storage::UndoManagerImpl::redo)
             .addFunction("removeUndoables", &lc::storage::UndoManagerImpl::removeUndoables)
+            .addFunction("setMaximumBytes", &lc::storage::UndoManagerImpl::setMaximumBytes)
             .addFunction("undo", &lc::storage::UndoManagerImpl::undo)
+            .addFunction("undoLevels", &lc::storage::UndoManagerImpl::undoLevels)
                                                       );
 
     state["lc"]["storage"]["StorageManagerImpl"].setClass(kaguya::UserdataMetatable<lc::storage::StorageManagerImpl, lc::storage::StorageManager>()
@@ -137,6 +193,7 @@ void import_lc_storage_namespace(kaguya::State& state) {
             .addFunction("entityByID", &lc::storage::StorageManagerImpl::entityByID)
             .addFunction("entityContainer", &lc::storage::StorageManagerImpl::entityContainer)
             .addFunction("insertEntity", &lc::storage::StorageManagerImpl::insertEntity)
+            .addFunction("insertEntities", &lc::storage::StorageManagerImpl::insertEntities)
             .addFunction("insertEntityContainer", &lc::storage::StorageManagerImpl::insertEntityContainer)
             .addFunction("layerByName", &lc::storage::StorageManagerImpl::layerByName)
             .addFunction("linePatternByName", &lc::storage::StorageManagerImpl::linePatternByName)
@@ -15,6 +15,15 @@
 
 using namespace lc::lua;
 
+static const luaL_Reg sandboxedlibs[] = {
+    {"_G", luaopen_base},
+    {LUA_COLIBNAME, luaopen_coroutine},
+    {LUA_TABLIBNAME, luaopen_table},
+    {LUA_STRLIBNAME, luaopen_string},
+    {LUA_MATHLIBNAME, luaopen_math},
+    {nullptr, nullptr}
+};
+
 static const luaL_Reg loadedlibs[] = {
     {"_G", luaopen_base},
     {LUA_LOADLIBNAME, luaopen_package},
@@ -67,6 +76,27 @@ void LCLua::addLuaLibs() {
     }
 }
 
+void LCLua::addSandboxedLuaLibs() {
+    const luaL_Reg *lib;
+
+    for (lib = sandboxedlibs; lib->func != nullptr; lib++) {
+        luaL_requiref(_L, lib->name, lib->func, 1);
+        lua_pop(_L, 1);
+    }
+
+    kaguya::State s(_L);
+    s["dofile"] = kaguya::NilValue();
+    s["loadfile"] = kaguya::NilValue();
+    s["registerPlugin"] = kaguya::NilValue();
+    s["microtime"].setFunction(&lua_microtime);
+
+    // Force the text mode, the mode given by the script is ignored. The environment is only passed when given.
+    s.dostring("do "
+               "local textLoad = load "
+               "load = function(chunk, chunkName, mode, ...) return textLoad(chunk, chunkName, 't', ...) end "
+               "end");
+}
+
 void LCLua::setDocument(const lc::storage::Document_SPtr& document) {
     kaguya::State state(_L);
     state["document"] = document;
@@ -122,3 +152,9 @@ void LCLua::importLCKernel() {
     import_lc_event_namespace(state);
     import_lc_operation_namespace(state);
 }
+
+void LCLua::importProfilerControl() {
+    kaguya::State state(_L);
+
+    import_lc_profiler_control(state);
+}
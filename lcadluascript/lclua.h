@@ -20,8 +20,21 @@ public:
      */
     void addLuaLibs();
 
+    /**
+     * @brief Bind the Lua libraries which don't give access to files or native modules
+     * load only accepts text chunks, precompiled bytecode isn't verified by Lua and could escape the sandbox.
+     * Used for the states running scripts in the background, see LuaStatePool
+     */
+    void addSandboxedLuaLibs();
+
     void importLCKernel();
 
+    /**
+     * @brief Bind the functions enabling, clearing and writing the profiler
+     * Must be called after importLCKernel(), never in sandboxed states as writing the trace accesses files.
+     */
+    void importProfilerControl();
+
     void setDocument(const lc::storage::Document_SPtr& document);
 
     std::string runString(const char* code);
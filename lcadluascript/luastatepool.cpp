@@ -0,0 +1,148 @@
+#include "luastatepool.h"
+#include "lclua.h"
+#include <cad/builders/bulk.h>
+#include <kaguya/kaguya.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+using namespace lc::lua;
+
+void LuaBatch::append(const entity::CADEntity_CSPtr& entity) {
+    _entities.push_back(entity);
+}
+
+void LuaBatch::appendEntities(const std::vector<entity::CADEntity_CSPtr>& entities) {
+    _entities.insert(_entities.end(), entities.begin(), entities.end());
+}
+
+const std::vector<lc::entity::CADEntity_CSPtr>& LuaBatch::entities() const {
+    return _entities;
+}
+
+size_t LuaBatch::size() const {
+    return _entities.size();
+}
+
+const std::string& LuaBatch::error() const {
+    return _error;
+}
+
+void LuaBatch::setError(const std::string& error) {
+    _error = error;
+}
+
+const lc::storage::DocumentSnapshot_CSPtr& LuaBatch::snapshot() const {
+    return _snapshot;
+}
+
+void LuaBatch::setSnapshot(storage::DocumentSnapshot_CSPtr snapshot) {
+    _snapshot = std::move(snapshot);
+}
+
+lc::operation::EntityBuilder_SPtr LuaBatch::entityBuilder(const storage::Document_SPtr& document) const {
+    auto entityBuilder = std::make_shared<operation::EntityBuilder>(document);
+    entityBuilder->appendEntities(_entities);
+    return entityBuilder;
+}
+
+LuaStatePool::LuaStatePool(unsigned int nbStates, const std::string& initCode) {
+    if (nbStates == 0) {
+        nbStates = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < nbStates; i++) {
+        auto L = luaL_newstate();
+        _states.push_back(L);
+
+        LCLua lcLua(L);
+        lcLua.addSandboxedLuaLibs();
+        lcLua.importLCKernel();
+
+        kaguya::State state(L);
+        state["LuaBatch"].setClass(kaguya::UserdataMetatable<LuaBatch>()
+                .addFunction("append", &LuaBatch::append)
+                .addStaticFunction("appendBulk", [](LuaBatch& batch, const lc::builder::BulkBuilder& bulkBuilder) {
+                    batch.appendEntities(bulkBuilder.entities());
+                })
+                .addFunction("size", &LuaBatch::size)
+        );
+
+        auto error = lcLua.runString(initCode.c_str());
+        if (!error.empty()) {
+            for (auto state : _states) {
+                lua_close(state);
+            }
+            throw std::runtime_error("Lua state initialisation failed: " + error);
+        }
+    }
+
+    _freeStates = _states;
+    _threadPool.reset(new tools::ThreadPool(nbStates));
+}
+
+LuaStatePool::~LuaStatePool() {
+    // Runs the queued scripts before stopping
+    _threadPool.reset();
+
+    for (auto L : _states) {
+        lua_close(L);
+    }
+}
+
+std::future<LuaBatch> LuaStatePool::run(std::string code, storage::DocumentSnapshot_CSPtr snapshot) {
+    // The task gives its snapshot to the batch, the worker never holds the last reference
+    return _threadPool->enqueue([this, code, snapshot]() mutable {
+        return execute(code, std::move(snapshot));
+    });
+}
+
+unsigned int LuaStatePool::size() const {
+    return _states.size();
+}
+
+LuaBatch LuaStatePool::execute(const std::string& code, storage::DocumentSnapshot_CSPtr snapshot) {
+    lua_State* L;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stateReleased.wait(lock, [this]() {
+            return !_freeStates.empty();
+        });
+
+        L = _freeStates.back();
+        _freeStates.pop_back();
+    }
+
+    LuaBatch batch;
+    batch.setSnapshot(std::move(snapshot));
+    {
+        kaguya::State state(L);
+        state["snapshot"] = batch.snapshot();
+        state["batch"] = &batch;
+
+        try {
+            // Text only, like load in the sandbox
+            if (luaL_loadbufferx(L, code.data(), code.size(), "script", "t") || lua_pcall(L, 0, 0, 0)) {
+                batch.setError(lua_tostring(L, -1));
+                lua_pop(L, 1);
+            }
+        }
+        catch (const std::exception& e) {
+            batch.setError(e.what());
+        }
+
+        // Don't keep the snapshot alive until the next script, it is collected while the batch still holds it
+        state["snapshot"] = kaguya::NilValue();
+        state["batch"] = kaguya::NilValue();
+        lua_gc(L, LUA_GCCOLLECT, 0);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _freeStates.push_back(L);
+    }
+    _stateReleased.notify_one();
+
+    return batch;
+}
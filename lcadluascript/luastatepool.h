@@ -0,0 +1,107 @@
+#pragma once
+
+extern "C" {
+#include "lua.h"
+#include "lualib.h"
+#include "lauxlib.h"
+}
+
+#include <cad/operations/entitybuilder.h>
+#include <cad/storage/documentsnapshot.h>
+#include <cad/tools/threadpool.h>
+
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lc {
+namespace lua {
+/**
+ * @brief Entities created by a background script
+ * Scripts add entities through the global "batch", the batch is committed on the main thread.
+ * The batch holds the snapshot the script ran against, so that the snapshot and its entities are released
+ * with the batch on the main thread instead of on a worker.
+ */
+class LuaBatch {
+public:
+    void append(const entity::CADEntity_CSPtr& entity);
+
+    void appendEntities(const std::vector<entity::CADEntity_CSPtr>& entities);
+
+    const std::vector<entity::CADEntity_CSPtr>& entities() const;
+
+    size_t size() const;
+
+    /**
+     * @return error message of the script, empty if it succeeded
+     */
+    const std::string& error() const;
+
+    void setError(const std::string& error);
+
+    /**
+     * @brief Create the operation adding the entities to a document
+     * The operation must be executed on the main thread.
+     */
+    operation::EntityBuilder_SPtr entityBuilder(const storage::Document_SPtr& document) const;
+
+    const storage::DocumentSnapshot_CSPtr& snapshot() const;
+
+    void setSnapshot(storage::DocumentSnapshot_CSPtr snapshot);
+
+private:
+    storage::DocumentSnapshot_CSPtr _snapshot;
+    std::vector<entity::CADEntity_CSPtr> _entities;
+    std::string _error;
+};
+
+/**
+ * @brief Pool of isolated Lua states running scripts on worker threads
+ * Each state has the LibreCAD kernel bindings and the sandboxed libraries, no file access and no access
+ * to the document or the user interface. A script reads the global "snapshot", an immutable
+ * DocumentSnapshot, and adds its results to the global "batch".
+ *
+ * A state runs one script at a time, globals set by a script are kept for the next one running on the same state.
+ * Scripts shouldn't keep the snapshot or its entities in globals: they would then be released on a worker thread,
+ * while destroying entities such as inserts must happen on the main thread.
+ */
+class LuaStatePool {
+public:
+    /**
+     * @brief Create the states
+     * @param nbStates number of states and worker threads, 0 for one per hardware thread
+     * @param initCode code run once in each state, for example to define the functions called by the scripts
+     * @throw std::runtime_error if initCode fails
+     */
+    explicit LuaStatePool(unsigned int nbStates = 0, const std::string& initCode = "");
+
+    /**
+     * @brief Wait for the running scripts and close the states
+     */
+    ~LuaStatePool();
+
+    LuaStatePool(const LuaStatePool&) = delete;
+    LuaStatePool& operator=(const LuaStatePool&) = delete;
+
+    /**
+     * @brief Queue a script
+     * @return future holding the entities created by the script, or its error
+     */
+    std::future<LuaBatch> run(std::string code, storage::DocumentSnapshot_CSPtr snapshot);
+
+    unsigned int size() const;
+
+private:
+    LuaBatch execute(const std::string& code, storage::DocumentSnapshot_CSPtr snapshot);
+
+    std::vector<lua_State*> _states;
+    std::vector<lua_State*> _freeStates;
+    std::mutex _mutex;
+    std::condition_variable _stateReleased;
+    std::unique_ptr<tools::ThreadPool> _threadPool;
+};
+}
+}
@@ -7,7 +7,7 @@ using namespace entity;
 CADEntity::CADEntity(meta::Layer_CSPtr layer, meta::MetaInfo_CSPtr metaInfo, meta::Block_CSPtr block) :
     ID(),
     _layer(std::move(layer)),
-    _metaInfo(std::move(metaInfo)),
+    _metaInfo(meta::MetaInfo::intern(metaInfo)),
     _block(std::move(block))
 {
 }
@@ -29,7 +29,7 @@ CADEntity::CADEntity(const CADEntity_CSPtr& cadEntity, bool sameID) :
 CADEntity::CADEntity(const lc::builder::CADEntityBuilder& builder) :
     ID(builder.id()),
     _layer(builder.layer()),
-    _metaInfo(builder.metaInfo()),
+    _metaInfo(meta::MetaInfo::intern(builder.metaInfo())),
     _block(builder.block()) {
 }
 
@@ -41,6 +41,11 @@ meta::Block_CSPtr CADEntity::block() const {
     return _block;
 }
 
+size_t CADEntity::memoryUsage() const {
+    // Fixed size estimate of a primitive: geometry, ID, shared pointers and the shared_ptr control block
+    return 256;
+}
+
 PropertiesMap CADEntity::availableProperties() const {
     return std::map<std::string, boost::variant<AngleProperty, double, bool, lc::geo::Coordinate, std::string, std::vector<lc::geo::Coordinate>>>();
 }
@@ -148,10 +148,27 @@ public:
     */
     template<typename T>
     const std::shared_ptr<const T> metaInfo(const std::string& metaName) const {
-        if (_metaInfo && (_metaInfo->find(metaName) != _metaInfo->end())) {
-            auto a=_metaInfo->at(metaName);
-            auto b=std::dynamic_pointer_cast<const T>(a);
-            return b;
+        if (_metaInfo) {
+            auto it = _metaInfo->find(metaName);
+            if (it != _metaInfo->end()) {
+                return std::dynamic_pointer_cast<const T>(it->second);
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+    * Retrieve meta information by slot, see MetaInfo::slot
+    * Same as metaInfo(metaName) without hashing the name
+    * example:
+    * static const auto colorSlot = lc::meta::MetaInfo::slot(lc::meta::MetaColor::LCMETANAME());
+    * auto color = myEntity.metaInfoBySlot<lc::meta::MetaColor>(colorSlot);
+    */
+    template<typename T>
+    const std::shared_ptr<const T> metaInfoBySlot(unsigned int slot) const {
+        if (_metaInfo) {
+            return std::dynamic_pointer_cast<const T>(_metaInfo->get(slot));
         }
 
         return nullptr;
@@ -177,6 +194,15 @@ public:
 
     virtual PropertiesMap availableProperties() const;
 
+    /**
+     * @brief Estimated number of bytes used by this entity
+     * Data shared with other entities (layer, meta info, block) isn't counted.
+     * Used to enforce memory budgets, for example by the undo manager.
+     * Entities holding a variable amount of data should override it.
+     * @return size in bytes
+     */
+    virtual size_t memoryUsage() const;
+
     virtual CADEntity_CSPtr setProperties(const PropertiesMap& propertiesMap) const;
 
 protected:
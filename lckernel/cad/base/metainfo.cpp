@@ -1,9 +1,149 @@
 #include "cad/interface/metatype.h"
 #include "metainfo.h"
+#include "cad/meta/metacolor.h"
+#include "cad/meta/metalinewidth.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <sstream>
 
 using namespace lc::meta;
 
+namespace {
+/**
+ * Interned MetaInfo by key, expired entries are removed when the map doubles in size
+ */
+struct InternPool {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const MetaInfo>> metaInfos;
+    size_t sweepSize = 1024;
+};
+
+InternPool& internPool() {
+    static InternPool pool;
+    return pool;
+}
+
+/**
+ * Exact representation of a double, values which only differ after the 6th decimal stay different
+ */
+std::string bits(double value) {
+    uint64_t raw;
+    std::memcpy(&raw, &value, sizeof(raw));
+
+    std::ostringstream stream;
+    stream << std::hex << raw;
+    return stream.str();
+}
+
+/**
+ * Key of a meta type
+ * Colors and widths are compared by value. Other document meta types, such as line patterns, are compared
+ * by instance: two patterns can share a name and differ. The interned MetaInfo keeps the instance alive,
+ * so its address isn't reused while the entry is valid.
+ */
+std::string internKey(const EntityMetaType& metaType) {
+    if (auto color = dynamic_cast<const MetaColorByValue*>(&metaType)) {
+        return bits(color->red()) + " " + bits(color->green()) + " " + bits(color->blue()) + " " + bits(color->alpha());
+    }
+
+    if (auto width = dynamic_cast<const MetaLineWidthByValue*>(&metaType)) {
+        return bits(width->width());
+    }
+
+    if (dynamic_cast<const DocumentMetaType*>(&metaType) != nullptr) {
+        std::ostringstream stream;
+        stream << "@" << static_cast<const void*>(&metaType);
+        return stream.str();
+    }
+
+    return metaType.id();
+}
+
+std::string internKey(const MetaInfo& metaInfo) {
+    std::vector<std::string> ids;
+    ids.reserve(metaInfo.size());
+
+    for (const auto& metaType : metaInfo) {
+        ids.push_back(metaType.first + "=" + internKey(*metaType.second));
+    }
+    std::sort(ids.begin(), ids.end());
+
+    std::string key;
+    for (const auto& id : ids) {
+        key += id;
+        key += '\n';
+    }
+
+    return key;
+}
+}
+
+MetaInfo::MetaInfo(const MetaInfo& other) :
+    std::enable_shared_from_this<MetaInfo>(),
+    std::unordered_map<std::string, EntityMetaType_CSPtr>(other),
+    _slots(other._slots),
+    _interned(false) {
+}
+
 std::shared_ptr<MetaInfo> MetaInfo::add(EntityMetaType_CSPtr mt) {
-    this->emplace(mt->metaTypeID(), mt);
+    auto index = slot(mt->metaTypeID());
+
+    if (this->emplace(mt->metaTypeID(), mt).second) {
+        if (_slots.size() <= index) {
+            _slots.resize(index + 1);
+        }
+        _slots[index] = std::move(mt);
+    }
+
     return shared_from_this();
 }
+
+unsigned int MetaInfo::slot(const std::string& metaTypeID) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, unsigned int> slots;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return slots.emplace(metaTypeID, slots.size()).first->second;
+}
+
+const EntityMetaType_CSPtr& MetaInfo::get(unsigned int slot) const {
+    static const EntityMetaType_CSPtr none;
+    return slot < _slots.size() ? _slots[slot] : none;
+}
+
+std::shared_ptr<const MetaInfo> MetaInfo::intern(const std::shared_ptr<const MetaInfo>& metaInfo) {
+    if (metaInfo == nullptr || metaInfo->empty() || metaInfo->_interned) {
+        return metaInfo;
+    }
+
+    auto key = internKey(*metaInfo);
+    auto& pool = internPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    auto& entry = pool.metaInfos[key];
+    auto interned = entry.lock();
+    if (interned != nullptr) {
+        return interned;
+    }
+
+    // Keep a copy, the caller may still change its instance
+    auto copy = std::make_shared<MetaInfo>(*metaInfo);
+    copy->_interned = true;
+    entry = copy;
+
+    if (pool.metaInfos.size() >= pool.sweepSize) {
+        for (auto it = pool.metaInfos.begin(); it != pool.metaInfos.end();) {
+            if (it->second.expired()) {
+                it = pool.metaInfos.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        pool.sweepSize = std::max(pool.sweepSize, pool.metaInfos.size() * 2);
+    }
+
+    return copy;
+}
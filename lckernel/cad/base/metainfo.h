@@ -9,6 +9,7 @@
 
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include "cad/interface/metatype.h"
 #include "cad/meta/dxflinepattern.h"
 
@@ -16,12 +17,20 @@ namespace lc {
 namespace meta {
 /**
  * Container to hold meta data for an entity
+ * Meta types must be added with add(), which also stores them by slot for fast lookups.
+ *
+ * Entities intern their MetaInfo: identical sets of meta types are shared by all entities.
+ * A MetaInfo must not be changed once given to an entity.
  */
 /// @todo Container to store meta information on an entity
 class MetaInfo
     : public std::enable_shared_from_this<MetaInfo>,
       public std::unordered_map<std::string, EntityMetaType_CSPtr> {
 public:
+    MetaInfo() = default;
+
+    MetaInfo(const MetaInfo& other);
+
     // Convenience function to add a MetaType to the MetaInfo map
     std::shared_ptr<MetaInfo> add(EntityMetaType_CSPtr mt);
 
@@ -31,6 +40,32 @@ public:
     static std::shared_ptr<MetaInfo> create() {
         return std::make_shared<lc::meta::MetaInfo>();
     }
+
+    /**
+     * @brief Small integer identifying a meta type name
+     * The same name always gives the same slot, callers should keep it in a static variable.
+     * @param metaTypeID name of the meta type, for example MetaColor::LCMETANAME()
+     */
+    static unsigned int slot(const std::string& metaTypeID);
+
+    /**
+     * @brief Return the meta type stored in a slot, without hashing its name
+     * @return meta type or nullptr
+     */
+    const EntityMetaType_CSPtr& get(unsigned int slot) const;
+
+    /**
+     * @brief Return the shared instance equal to the given MetaInfo
+     * Colors and widths are compared by value, other meta types by id(), except document meta types such
+     * as line patterns which are compared by instance. Interned instances are kept as long as an entity uses them.
+     * An empty MetaInfo carries nothing to share and is returned as is.
+     * @return interned MetaInfo, nullptr if metaInfo is nullptr
+     */
+    static std::shared_ptr<const MetaInfo> intern(const std::shared_ptr<const MetaInfo>& metaInfo);
+
+private:
+    std::vector<EntityMetaType_CSPtr> _slots;
+    bool _interned = false;
 };
 
 DECLARE_SHORT_SHARED_PTR(MetaInfo)
@@ -0,0 +1,106 @@
+#include "bulk.h"
+#include <cad/primitive/arc.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/lwpolyline.h>
+
+using namespace lc::builder;
+
+size_t BulkBuilder::prepare(size_t valueCount, size_t valuesPerEntity) {
+    checkValues(true);
+
+    if(valueCount % valuesPerEntity != 0) {
+        throw std::runtime_error("The number of values must be a multiple of " + std::to_string(valuesPerEntity));
+    }
+
+    auto count = valueCount / valuesPerEntity;
+    _entities.reserve(_entities.size() + count);
+    return count;
+}
+
+size_t BulkBuilder::appendLines(const std::vector<double>& values) {
+    auto count = prepare(values.size(), 4);
+
+    for(size_t i = 0; i < values.size(); i += 4) {
+        _entities.push_back(std::make_shared<entity::Line>(
+                geo::Coordinate(values[i], values[i + 1]),
+                geo::Coordinate(values[i + 2], values[i + 3]),
+                layer(), metaInfo(), block()
+        ));
+    }
+
+    return count;
+}
+
+size_t BulkBuilder::appendCircles(const std::vector<double>& values) {
+    auto count = prepare(values.size(), 3);
+
+    for(size_t i = 0; i < values.size(); i += 3) {
+        _entities.push_back(std::make_shared<entity::Circle>(
+                geo::Coordinate(values[i], values[i + 1]),
+                values[i + 2],
+                layer(), metaInfo(), block()
+        ));
+    }
+
+    return count;
+}
+
+size_t BulkBuilder::appendArcs(const std::vector<double>& values, bool isCCW) {
+    auto count = prepare(values.size(), 5);
+
+    for(size_t i = 0; i < values.size(); i += 5) {
+        _entities.push_back(std::make_shared<entity::Arc>(
+                geo::Coordinate(values[i], values[i + 1]),
+                values[i + 2], values[i + 3], values[i + 4],
+                isCCW,
+                layer(), metaInfo(), block()
+        ));
+    }
+
+    return count;
+}
+
+size_t BulkBuilder::appendPolylines(const std::vector<double>& coordinates, const std::vector<unsigned int>& vertexCounts, bool closed) {
+    // Not prepare(), it would reserve one entity per vertex
+    checkValues(true);
+
+    size_t vertexCount = 0;
+    for(auto count : vertexCounts) {
+        vertexCount += count;
+    }
+    if(vertexCount * 2 != coordinates.size()) {
+        throw std::runtime_error("The vertex counts don't match the number of coordinates");
+    }
+
+    _entities.reserve(_entities.size() + vertexCounts.size());
+
+    size_t i = 0;
+    for(auto count : vertexCounts) {
+        std::vector<entity::LWVertex2D> vertices;
+        vertices.reserve(count);
+
+        for(unsigned int j = 0; j < count; j++, i += 2) {
+            vertices.emplace_back(geo::Coordinate(coordinates[i], coordinates[i + 1]));
+        }
+
+        _entities.push_back(std::make_shared<entity::LWPolyline>(
+                std::move(vertices), 0., 0., 0., closed, geo::Coordinate(0., 0.),
+                layer(), metaInfo(), block()
+        ));
+    }
+
+    return vertexCounts.size();
+}
+
+const std::vector<lc::entity::CADEntity_CSPtr>& BulkBuilder::entities() const {
+    return _entities;
+}
+
+size_t BulkBuilder::size() const {
+    return _entities.size();
+}
+
+void BulkBuilder::clear() {
+    _entities.clear();
+}
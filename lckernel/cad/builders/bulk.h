@@ -0,0 +1,72 @@
+/**
+* @file
+* @section DESCRIPTION
+*
+* Bulk Builder
+*/
+
+#pragma once
+
+#include "cadentity.h"
+
+#include <vector>
+
+namespace lc {
+namespace builder {
+/**
+ * @brief Create many entities from packed values
+ * Scripts give the values of a whole batch as a flat array of numbers, no coordinate or builder is created per entity.
+ * All the entities get the layer, meta info and block of the builder.
+ */
+class BulkBuilder : public CADEntityBuilder {
+public:
+    BulkBuilder() = default;
+    virtual ~BulkBuilder() = default;
+
+    /**
+     * @brief Add lines
+     * @param values x1 y1 x2 y2 of each line
+     * @return number of lines added
+     * @throw std::runtime_error if the layer isn't set or the number of values doesn't match
+     */
+    size_t appendLines(const std::vector<double>& values);
+
+    /**
+     * @brief Add circles
+     * @param values cx cy radius of each circle
+     */
+    size_t appendCircles(const std::vector<double>& values);
+
+    /**
+     * @brief Add arcs
+     * @param values cx cy radius startAngle endAngle of each arc
+     */
+    size_t appendArcs(const std::vector<double>& values, bool isCCW);
+
+    /**
+     * @brief Add light weight polylines
+     * @param coordinates x y of the vertices of all the polylines
+     * @param vertexCounts number of vertices of each polyline
+     */
+    size_t appendPolylines(const std::vector<double>& coordinates, const std::vector<unsigned int>& vertexCounts, bool closed);
+
+    /**
+     * @brief Entities created since the last call to clear()
+     */
+    const std::vector<entity::CADEntity_CSPtr>& entities() const;
+
+    size_t size() const;
+
+    void clear();
+
+private:
+    /**
+     * @brief Check the layer and the number of values
+     * @return number of entities
+     */
+    size_t prepare(size_t valueCount, size_t valuesPerEntity);
+
+    std::vector<entity::CADEntity_CSPtr> _entities;
+};
+}
+}
@@ -1,14 +1,282 @@
 #include "georegion.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <cad/math/lcmath.h>
 
 using namespace lc;
 using namespace geo;
 
+namespace {
+/**
+ * Maximum distance between a curve and its approximation, relative to the radius
+ */
+const double CHORD_TOLERANCE = 1.0e-3;
+const unsigned int MAX_CURVE_SEGMENTS = 1024;
+const unsigned int BEZIER_SEGMENTS = 16;
+
+/**
+ * Edge index bands, the index holds at most EDGE_INDEX_OVERHEAD times more entries than edges
+ */
+const size_t MAX_EDGE_INDEX_BANDS = 65536;
+const double EDGE_INDEX_OVERHEAD = 8.;
+
+/**
+ * Boolean operation tolerances, relative to the size of the regions
+ */
+const double BOOLEAN_TOLERANCE = 1.0e-9;
+const double BOOLEAN_SIDE_OFFSET = 1.0e-7;
+
+unsigned int curveSegments(double sweep) {
+    static const double step = 2. * std::acos(1. - CHORD_TOLERANCE);
+    auto nbSegments = static_cast<unsigned int>(std::ceil(std::abs(sweep) / step));
+    return std::min(std::max(nbSegments, 1u), MAX_CURVE_SEGMENTS);
+}
+
+void tessellateArc(const Coordinate& center, double radius, double startAngle, double sweep,
+                   std::vector<Vector>& segments) {
+    auto nbSegments = curveSegments(sweep);
+    auto previous = center + Coordinate(startAngle) * radius;
+
+    for (unsigned int i = 1; i <= nbSegments; i++) {
+        auto point = center + Coordinate(startAngle + sweep * i / nbSegments) * radius;
+        segments.emplace_back(previous, point);
+        previous = point;
+    }
+}
+
+/**
+ * Sweep of an arc like entity, a start angle equal to the end angle is a full turn
+ */
+double sweepAngle(double startAngle, double endAngle, bool CCW) {
+    auto sweep = maths::Math::getAngleDifferenceShort(startAngle, endAngle, CCW);
+    if (sweep < LCARCTOLERANCE) {
+        sweep = 2. * M_PI;
+    }
+
+    return CCW ? sweep : -sweep;
+}
+
+/**
+ * @return true and the position on a of the intersection, if segments a and b intersect in a single point
+ */
+bool segmentIntersection(const Coordinate& aStart, const Coordinate& aDirection, const Vector& b, double& t) {
+    auto bDirection = b.end() - b.start();
+    auto denominator = aDirection.x() * bDirection.y() - aDirection.y() * bDirection.x();
+
+    if (std::abs(denominator) < LCARCTOLERANCE) {
+        return false;
+    }
+
+    auto delta = b.start() - aStart;
+    t = (delta.x() * bDirection.y() - delta.y() * bDirection.x()) / denominator;
+    auto u = (delta.x() * aDirection.y() - delta.y() * aDirection.x()) / denominator;
+
+    return u >= 0. && u <= 1. && t >= 0. && t <= 1.;
+}
+
+/**
+ * Split an edge at its intersections with the candidate edges, and at the ends of the collinear ones
+ * Pieces shorter than tolerance are merged with their neighbour.
+ */
+void splitEdge(const Vector& edge, const std::vector<Vector>& others, const std::vector<unsigned int>& candidates,
+               double tolerance, std::vector<Vector>& pieces) {
+    const auto& start = edge.start();
+    auto direction = edge.end() - start;
+    auto length = direction.magnitude();
+
+    if (length < tolerance) {
+        return;
+    }
+
+    std::vector<double> cuts {0., 1.};
+    for (auto i : candidates) {
+        const auto& other = others[i];
+        double t;
+
+        if (segmentIntersection(start, direction, other, t)) {
+            cuts.push_back(t);
+            continue;
+        }
+
+        for (const auto& point : {other.start(), other.end()}) {
+            auto delta = point - start;
+            if (std::abs(direction.x() * delta.y() - direction.y() * delta.x()) <= tolerance * length) {
+                t = delta.dot(direction) / (length * length);
+                if (t > 0. && t < 1.) {
+                    cuts.push_back(t);
+                }
+            }
+        }
+    }
+
+    std::sort(cuts.begin(), cuts.end());
+
+    std::vector<double> kept {0.};
+    for (size_t i = 1; i < cuts.size(); i++) {
+        if ((cuts[i] - kept.back()) * length > tolerance) {
+            kept.push_back(cuts[i]);
+        }
+    }
+    kept.back() = 1.;
+
+    auto previous = start;
+    for (size_t i = 1; i < kept.size(); i++) {
+        auto point = i + 1 == kept.size() ? edge.end() : start + direction * kept[i];
+        pieces.emplace_back(previous, point);
+        previous = point;
+    }
+}
+
+/**
+ * Chain edges sharing their ends in closed loops of lines, merging consecutive collinear edges
+ */
+std::vector<Loop> chainLoops(const std::vector<Vector>& edges, double tolerance, const meta::Layer_CSPtr& layer) {
+    typedef std::pair<long long, long long> Cell;
+    std::map<Cell, std::vector<size_t>> ends;
+
+    auto cellOf = [tolerance](const Coordinate& point) {
+        return Cell(static_cast<long long>(std::floor(point.x() / tolerance)),
+                    static_cast<long long>(std::floor(point.y() / tolerance)));
+    };
+
+    // End 2 * i is the start of edge i, 2 * i + 1 its end
+    auto endPoint = [&edges](size_t end) -> Coordinate {
+        return end % 2 == 0 ? edges[end / 2].start() : edges[end / 2].end();
+    };
+
+    for (size_t i = 0; i < edges.size() * 2; i++) {
+        ends[cellOf(endPoint(i))].push_back(i);
+    }
+
+    std::vector<bool> used(edges.size(), false);
+
+    auto findNext = [&](const Coordinate& point) -> long long {
+        auto cell = cellOf(point);
+        long long best = -1;
+        double bestDistance = tolerance;
+
+        for (long long x = cell.first - 1; x <= cell.first + 1; x++) {
+            for (long long y = cell.second - 1; y <= cell.second + 1; y++) {
+                auto it = ends.find(Cell(x, y));
+                if (it == ends.end()) {
+                    continue;
+                }
+
+                for (auto end : it->second) {
+                    auto distance = endPoint(end).distanceTo(point);
+                    if (!used[end / 2] && distance <= bestDistance) {
+                        best = end;
+                        bestDistance = distance;
+                    }
+                }
+            }
+        }
+
+        return best;
+    };
+
+    std::vector<Loop> loops;
+    for (size_t i = 0; i < edges.size(); i++) {
+        if (used[i]) {
+            continue;
+        }
+        used[i] = true;
+
+        std::vector<Coordinate> points {edges[i].start(), edges[i].end()};
+        long long next;
+        while (points.back().distanceTo(points.front()) > tolerance && (next = findNext(points.back())) >= 0) {
+            used[next / 2] = true;
+            auto point = endPoint(next % 2 == 0 ? next + 1 : next - 1);
+
+            const auto& a = points[points.size() - 2];
+            const auto& b = points.back();
+            auto cross = (b.x() - a.x()) * (point.y() - a.y()) - (b.y() - a.y()) * (point.x() - a.x());
+            if (std::abs(cross) <= tolerance * a.distanceTo(point) && (b - a).dot(point - b) > 0.) {
+                points.back() = point;
+            }
+            else {
+                points.push_back(point);
+            }
+        }
+
+        if (points.back().distanceTo(points.front()) <= tolerance) {
+            points.back() = points.front();
+        }
+
+        std::vector<entity::CADEntity_CSPtr> lines;
+        for (size_t j = 1; j < points.size(); j++) {
+            lines.push_back(std::make_shared<const entity::Line>(points[j - 1], points[j], layer));
+        }
+        loops.emplace_back(lines);
+    }
+
+    return loops;
+}
+}
+
+void lc::geo::tessellate(const entity::CADEntity_CSPtr& entity, std::vector<Vector>& segments) {
+    auto object = entity.get();
+
+    if (auto vector = dynamic_cast<const Vector*>(object)) {
+        segments.emplace_back(vector->start(), vector->end());
+    }
+    else if (auto arc = dynamic_cast<const geo::Arc*>(object)) {
+        tessellateArc(arc->center(), arc->radius(), arc->startAngle(),
+                      sweepAngle(arc->startAngle(), arc->endAngle(), arc->CCW()), segments);
+    }
+    else if (auto circle = dynamic_cast<const geo::Circle*>(object)) {
+        tessellateArc(circle->center(), circle->radius(), 0., 2. * M_PI, segments);
+    }
+    else if (auto ellipse = dynamic_cast<const geo::Ellipse*>(object)) {
+        auto startAngle = ellipse->isArc() ? ellipse->startAngle() : 0.;
+        auto sweep = ellipse->isArc()
+                     ? sweepAngle(ellipse->startAngle(), ellipse->endAngle(), !ellipse->isReversed())
+                     : 2. * M_PI;
+        auto nbSegments = curveSegments(sweep);
+        auto previous = ellipse->getPoint(startAngle);
+
+        for (unsigned int i = 1; i <= nbSegments; i++) {
+            auto point = ellipse->getPoint(startAngle + sweep * i / nbSegments);
+            segments.emplace_back(previous, point);
+            previous = point;
+        }
+    }
+    else if (auto spline = dynamic_cast<const geo::Spline*>(object)) {
+        auto beziers = spline->beziers();
+
+        if (beziers.empty()) {
+            const auto& controlPoints = spline->controlPoints();
+            for (size_t i = 1; i < controlPoints.size(); i++) {
+                segments.emplace_back(controlPoints[i - 1], controlPoints[i]);
+            }
+        }
+
+        for (const auto& bezier : beziers) {
+            auto previous = bezier->DirectValueAt(0.);
+
+            for (unsigned int i = 1; i <= BEZIER_SEGMENTS; i++) {
+                auto point = bezier->DirectValueAt(static_cast<double>(i) / BEZIER_SEGMENTS);
+                segments.emplace_back(previous, point);
+                previous = point;
+            }
+        }
+    }
+    else if (auto polyline = std::dynamic_pointer_cast<const entity::LWPolyline>(entity)) {
+        for (const auto& part : polyline->asEntities()) {
+            tessellate(part, segments);
+        }
+    }
+}
+
 Loop::Loop(std::vector<entity::CADEntity_CSPtr> loop): _objList(loop) {
     //Calculate bounding box for entity
     _boundingBox =  loop[0]->boundingBox();
     //Merge box of each entities
     for(auto &x:loop) {
         _boundingBox = _boundingBox.merge(x->boundingBox());
+        tessellate(x, _edges);
     }
 }
 
@@ -20,8 +288,89 @@ Region::Region(std::vector<lc::entity::CADEntity_CSPtr> entities) {
     addLoop(loop);
 }
 
+Region::Region(const Region& other) :
+    _loopList(other._loopList),
+    _index(std::atomic_load(&other._index)) {
+}
+
+Region& Region::operator=(const Region& other) {
+    _loopList = other._loopList;
+    std::atomic_store(&_index, std::atomic_load(&other._index));
+    return *this;
+}
+
 void Region::addLoop(Loop loop) {
     _loopList.push_back(loop);
+    std::atomic_store(&_index, std::shared_ptr<const EdgeIndex>());
+}
+
+size_t Region::EdgeIndex::band(double y) const {
+    if (y <= minY) {
+        return 0;
+    }
+
+    return std::min(static_cast<size_t>((y - minY) / bandHeight), bands.size() - 1);
+}
+
+std::shared_ptr<const Region::EdgeIndex> Region::index() const {
+    auto index = std::atomic_load(&_index);
+    if (!index) {
+        // The first index stored wins, so every caller shares the same one
+        std::shared_ptr<const EdgeIndex> expected;
+        auto built = buildIndex();
+        if (std::atomic_compare_exchange_strong(&_index, &expected, built)) {
+            return built;
+        }
+        return expected;
+    }
+
+    return index;
+}
+
+std::shared_ptr<const Region::EdgeIndex> Region::buildIndex() const {
+    auto index = std::make_shared<EdgeIndex>();
+
+    for (const auto& loop : _loopList) {
+        index->edges.insert(index->edges.end(), loop.edges().begin(), loop.edges().end());
+    }
+
+    index->minY = std::numeric_limits<double>::max();
+    index->maxY = std::numeric_limits<double>::lowest();
+    double spans = 0.;
+    for (const auto& edge : index->edges) {
+        index->minY = std::min(index->minY, std::min(edge.start().y(), edge.end().y()));
+        index->maxY = std::max(index->maxY, std::max(edge.start().y(), edge.end().y()));
+        spans += std::abs(edge.end().y() - edge.start().y());
+    }
+
+    // About 2 edges per band, with less bands when long edges would be listed in too many of them
+    auto height = index->maxY - index->minY;
+    size_t nbBands = std::min(index->edges.size() / 2, MAX_EDGE_INDEX_BANDS);
+    if (spans > 0.) {
+        nbBands = std::min(nbBands, static_cast<size_t>(EDGE_INDEX_OVERHEAD * index->edges.size() * height / spans));
+    }
+    nbBands = std::max(nbBands, static_cast<size_t>(1));
+
+    if (height > 0.) {
+        index->bandHeight = height / nbBands;
+    }
+    index->bands.resize(nbBands);
+
+    for (unsigned int i = 0; i < index->edges.size(); i++) {
+        const auto& edge = index->edges[i];
+        auto last = index->band(std::max(edge.start().y(), edge.end().y()));
+
+        for (auto band = index->band(std::min(edge.start().y(), edge.end().y())); band <= last; band++) {
+            index->bands[band].push_back(i);
+        }
+    }
+
+    return index;
+}
+
+std::shared_ptr<const std::vector<lc::geo::Vector>> Region::edges() const {
+    auto index = this->index();
+    return std::shared_ptr<const std::vector<lc::geo::Vector>>(index, &index->edges);
 }
 
 unsigned int Region::numLoops() const {
@@ -30,22 +379,313 @@ unsigned int Region::numLoops() const {
 
 std::vector<lc::geo::Coordinate> Region::getLineIntersection(const lc::geo::Vector& i1) const {
     lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, LCTOLERANCE);
+    lc::geo::Area lineArea(i1.start(), i1.end());
     for(auto &x: _loopList) {
-        for(auto &y: x.entities())
-            visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, i1, *y.get());
+        if (!x.boundingBox().overlaps(lineArea)) {
+            continue;
+        }
+
+        for(auto &y: x.entities()) {
+            if (y->boundingBox().overlaps(lineArea)) {
+                visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, i1, *y.get());
+            }
+        }
     }
     return intersect.result();
 }
 
 bool Region::isPointInside(const geo::Coordinate& testPoint) const {
-    auto bbox = boundingBox();
-    auto minP = bbox.minP();
-    auto testLine = lc::geo::Vector(minP, testPoint);
-    auto intersect = getLineIntersection(testLine);
-    if(intersect.size()%2==0)
+    auto index = this->index();
+    if (index->edges.empty() || testPoint.y() < index->minY || testPoint.y() > index->maxY) {
         return false;
-    else
-        return true;
+    }
+
+    // Count the crossings of a ray going to +x, edges include their lower end only
+    // Every edge crossing the ray is listed in the band of the point
+    bool inside = false;
+
+    for (auto i : index->bands[index->band(testPoint.y())]) {
+        const auto& p1 = index->edges[i].start();
+        const auto& p2 = index->edges[i].end();
+
+        if ((p1.y() > testPoint.y()) != (p2.y() > testPoint.y())) {
+            auto x = p1.x() + (testPoint.y() - p1.y()) * (p2.x() - p1.x()) / (p2.y() - p1.y());
+            if (x > testPoint.x()) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+void Region::edgesInRange(const EdgeIndex& index, double minY, double maxY, std::vector<unsigned int>& candidates) {
+    candidates.clear();
+
+    if (index.edges.empty() || maxY < index.minY || minY > index.maxY) {
+        return;
+    }
+
+    auto first = index.band(minY);
+    auto last = index.band(maxY);
+    for (auto band = first; band <= last; band++) {
+        candidates.insert(candidates.end(), index.bands[band].begin(), index.bands[band].end());
+    }
+
+    if (first != last) {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+}
+
+bool Region::isPointOnEdge(const EdgeIndex& index, const geo::Coordinate& point, double tolerance) {
+    std::vector<unsigned int> candidates;
+    edgesInRange(index, point.y() - tolerance, point.y() + tolerance, candidates);
+
+    const auto& edges = index.edges;
+    for (auto i : candidates) {
+        const auto& edge = edges[i];
+        auto direction = edge.end() - edge.start();
+        auto length2 = direction.squared();
+        auto t = length2 > 0. ? std::min(std::max((point - edge.start()).dot(direction) / length2, 0.), 1.) : 0.;
+
+        if ((edge.start() + direction * t).distanceTo(point) <= tolerance) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<lc::geo::Vector> Region::clip(const lc::geo::Vector& segment) const {
+    std::vector<lc::geo::Vector> parts;
+    const auto& start = segment.start();
+    auto direction = segment.end() - start;
+
+    auto minX = std::min(start.x(), segment.end().x());
+    auto maxX = std::max(start.x(), segment.end().x());
+    auto minY = std::min(start.y(), segment.end().y());
+    auto maxY = std::max(start.y(), segment.end().y());
+
+    auto index = this->index();
+    std::vector<unsigned int> candidates;
+    edgesInRange(*index, minY, maxY, candidates);
+
+    const auto& edges = index->edges;
+    std::vector<double> cuts {0., 1.};
+    for (auto i : candidates) {
+        const auto& edge = edges[i];
+        if (std::max(edge.start().x(), edge.end().x()) < minX || std::min(edge.start().x(), edge.end().x()) > maxX) {
+            continue;
+        }
+
+        double t;
+        if (segmentIntersection(start, direction, edge, t)) {
+            cuts.push_back(t);
+        }
+    }
+
+    std::sort(cuts.begin(), cuts.end());
+
+    // Keep the pieces between two cuts of which the middle is inside, merging consecutive pieces
+    bool open = false;
+    double partStart = 0.;
+    for (size_t i = 1; i < cuts.size(); i++) {
+        if (cuts[i] - cuts[i - 1] < LCARCTOLERANCE) {
+            continue;
+        }
+
+        bool inside = isPointInside(start + direction * ((cuts[i - 1] + cuts[i]) / 2.));
+
+        if (inside && !open) {
+            partStart = cuts[i - 1];
+            open = true;
+        }
+        else if (!inside && open) {
+            parts.emplace_back(start + direction * partStart, start + direction * cuts[i - 1]);
+            open = false;
+        }
+    }
+
+    if (open) {
+        parts.emplace_back(start + direction * partStart, segment.end());
+    }
+
+    return parts;
+}
+
+std::vector<lc::geo::Coordinate> Region::trapezoids() const {
+    std::vector<lc::geo::Coordinate> result;
+
+    // Edges oriented bottom to top, horizontal edges don't bound any trapezoid
+    std::vector<Vector> edges;
+    std::vector<double> ys;
+    for (const auto& loop : _loopList) {
+        for (const auto& edge : loop.edges()) {
+            if (edge.start().y() == edge.end().y()) {
+                continue;
+            }
+
+            if (edge.start().y() < edge.end().y()) {
+                edges.push_back(edge);
+            }
+            else {
+                edges.emplace_back(edge.end(), edge.start());
+            }
+
+            ys.push_back(edge.start().y());
+            ys.push_back(edge.end().y());
+        }
+    }
+
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    std::sort(edges.begin(), edges.end(), [](const Vector& a, const Vector& b) {
+        return a.start().y() < b.start().y();
+    });
+
+    // Sweep the slabs between consecutive vertex heights, keeping the edges crossing the current slab
+    std::vector<const Vector*> active;
+    std::vector<std::pair<double, const Vector*>> crossings;
+    size_t nextEdge = 0;
+
+    for (size_t i = 1; i < ys.size(); i++) {
+        auto bottom = ys[i - 1];
+        auto top = ys[i];
+        auto middle = (bottom + top) / 2.;
+
+        active.erase(std::remove_if(active.begin(), active.end(), [bottom](const Vector* edge) {
+            return edge->end().y() <= bottom;
+        }), active.end());
+
+        while (nextEdge < edges.size() && edges[nextEdge].start().y() <= bottom) {
+            if (edges[nextEdge].end().y() > bottom) {
+                active.push_back(&edges[nextEdge]);
+            }
+            nextEdge++;
+        }
+
+        auto xAt = [](const Vector* edge, double y) {
+            const auto& p1 = edge->start();
+            const auto& p2 = edge->end();
+            return p1.x() + (y - p1.y()) * (p2.x() - p1.x()) / (p2.y() - p1.y());
+        };
+
+        crossings.clear();
+        for (auto edge : active) {
+            crossings.emplace_back(xAt(edge, middle), edge);
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        for (size_t j = 1; j < crossings.size(); j += 2) {
+            auto left = crossings[j - 1].second;
+            auto right = crossings[j].second;
+
+            result.emplace_back(xAt(left, bottom), bottom);
+            result.emplace_back(xAt(right, bottom), bottom);
+            result.emplace_back(xAt(right, top), top);
+            result.emplace_back(xAt(left, top), top);
+        }
+    }
+
+    return result;
+}
+
+Region Region::unite(const Region& other) const {
+    return booleanOperation(other, BooleanOperation::Union);
+}
+
+Region Region::intersect(const Region& other) const {
+    return booleanOperation(other, BooleanOperation::Intersection);
+}
+
+Region Region::subtract(const Region& other) const {
+    return booleanOperation(other, BooleanOperation::Difference);
+}
+
+Region Region::booleanOperation(const Region& other, BooleanOperation operation) const {
+    // An edge is kept when the result is on one side of it only, which handles holes and shared edges alike
+    auto inResult = [&](const Coordinate& point) {
+        auto inThis = isPointInside(point);
+        auto inOther = other.isPointInside(point);
+
+        switch (operation) {
+            case BooleanOperation::Union:
+                return inThis || inOther;
+            case BooleanOperation::Intersection:
+                return inThis && inOther;
+            default:
+                return inThis && !inOther;
+        }
+    };
+
+    auto thisIndex = index();
+    auto otherIndex = other.index();
+
+    double size = 0.;
+    for (const auto* edges : {&thisIndex->edges, &otherIndex->edges}) {
+        for (const auto& edge : *edges) {
+            for (const auto& point : {edge.start(), edge.end()}) {
+                size = std::max(size, std::max(std::abs(point.x()), std::abs(point.y())));
+            }
+        }
+    }
+
+    if (size == 0.) {
+        return Region();
+    }
+
+    auto tolerance = size * BOOLEAN_TOLERANCE;
+    auto offset = size * BOOLEAN_SIDE_OFFSET;
+
+    std::vector<Vector> result;
+    std::vector<Vector> pieces;
+    std::vector<unsigned int> candidates;
+
+    auto addEdges = [&](const EdgeIndex& region, const EdgeIndex& cutter, bool skipShared) {
+        for (const auto& edge : region.edges) {
+            edgesInRange(cutter,
+                         std::min(edge.start().y(), edge.end().y()) - tolerance,
+                         std::max(edge.start().y(), edge.end().y()) + tolerance,
+                         candidates);
+
+            pieces.clear();
+            splitEdge(edge, cutter.edges, candidates, tolerance, pieces);
+
+            for (const auto& piece : pieces) {
+                auto middle = (piece.start() + piece.end()) / 2.;
+
+                // Edges shared by both regions are taken from this region only
+                if (skipShared && isPointOnEdge(cutter, middle, tolerance)) {
+                    continue;
+                }
+
+                auto direction = piece.end() - piece.start();
+                auto normal = Coordinate(-direction.y(), direction.x()) * (offset / direction.magnitude());
+
+                if (inResult(middle + normal) != inResult(middle - normal)) {
+                    result.push_back(piece);
+                }
+            }
+        }
+    };
+
+    addEdges(*thisIndex, *otherIndex, false);
+    addEdges(*otherIndex, *thisIndex, true);
+
+    meta::Layer_CSPtr layer;
+    for (const auto* loops : {&_loopList, &other._loopList}) {
+        if (layer == nullptr && !loops->empty() && !loops->front().entities().empty()) {
+            layer = loops->front().entities().front()->layer();
+        }
+    }
+
+    Region region;
+    for (auto& loop : chainLoops(result, tolerance * 16., layer)) {
+        region._loopList.push_back(loop);
+    }
+
+    return region;
 }
 
 lc::geo::Area Region::boundingBox() const {
@@ -118,49 +758,16 @@ Region Region::mirror(const geo::Coordinate& axis1,
     return reg;
 }
 
-// Approximate function, change if possible
 double Region::Area() const {
-    double area=0.;
-
-    auto bbox = boundingBox();
-    auto minP = bbox.minP();
-    auto maxP = bbox.maxP();
-    unsigned int APPROX_POINTS = 500;
-    float delta = (maxP.y() - minP.y())/(float)APPROX_POINTS;
-    std::vector<float> oldI;
-    float extraSize=-delta;//Comensation if odd intersection is found, delta for first run
-    std::vector<float> oldOk;
-    for (float i=minP.y(); i<=maxP.y(); i+=delta)
-    {
-        std::vector<lc::geo::Coordinate> newIc = getLineIntersection(
-                    lc::geo::Vector(
-                        lc::geo::Coordinate(minP.x()-delta, i),
-                        lc::geo::Coordinate(maxP.x()+delta, i)
-                    )
-                );
-        std::vector<float> newI;
-        for (auto &i : newIc) {
-            newI.push_back(i.x());
-        }//sort
-        sort(newI.begin(), newI.end());
-        if (newI.size()!=oldI.size() || newI.size()%2!=0) {
-            //Proper block not found, approximate with newerData
-            extraSize += delta;
-            oldI = newI;
-            continue;
-        }
-        //Counter for old and new loop
-        for(unsigned int x=0; x<newI.size(); x+=2) {
-            area += (delta+extraSize)*((oldI[x+1]-oldI[x])+(newI[x+1]-newI[x]))/2;
-        }
-        extraSize=0.;
-        oldI = newI;
-        oldOk = newI;
-    }
-    if(extraSize!=0) { //Last size failed too
-        for(unsigned int x=0; x<oldOk.size(); x+=2) {
-            area += extraSize*(oldOk[x+1]-oldOk[x]);
-        }
+    double area = 0.;
+    auto corners = trapezoids();
+
+    for (size_t i = 0; i + 3 < corners.size(); i += 4) {
+        auto height = corners[i + 2].y() - corners[i].y();
+        auto bottom = corners[i + 1].x() - corners[i].x();
+        auto top = corners[i + 2].x() - corners[i + 3].x();
+        area += height * (bottom + top) / 2.;
     }
+
     return area;
 }
@@ -3,6 +3,7 @@
 // I think this is geo then primitive but need primitive to work with
 #include "cad/const.h"
 #include "cad/base/cadentity.h"
+#include <memory>
 #include <vector>
 #include "cad/math/intersect.h"
 #include "cad/base/visitor.h"
@@ -14,9 +15,19 @@
 #include "cad/primitive/arc.h"
 #include "cad/primitive/ellipse.h"
 #include "cad/primitive/spline.h"
+#include "cad/primitive/circle.h"
 
 namespace lc {
 namespace geo {
+/**
+ * @brief Approximate an entity by line segments
+ * Supports lines, circles, arcs, ellipses, splines and polylines, other entities are ignored.
+ * Curves are split so the chord error stays below 1/1000 of their radius.
+ * @param entity entity to approximate
+ * @param segments vector to which the segments are added
+ */
+void tessellate(const lc::entity::CADEntity_CSPtr& entity, std::vector<Vector>& segments);
+
 /**
  * @brief Represents single loop
  *
@@ -42,8 +53,19 @@ public:
     const std::vector<lc::entity::CADEntity_CSPtr>& entities() const {
         return _objList;
     };
+
+    /**
+     * @brief return the loop approximated by line segments
+     * Segments are not ordered, see tessellate()
+     *
+     * @return const std::vector<lc::geo::Vector>&
+     */
+    const std::vector<lc::geo::Vector>& edges() const {
+        return _edges;
+    };
 private:
     std::vector<lc::entity::CADEntity_CSPtr> _objList;
+    std::vector<lc::geo::Vector> _edges;
     lc::geo::Area _boundingBox;
 };
 
@@ -63,9 +85,13 @@ public:
      *
     */
     Region(std::vector<lc::entity::CADEntity_CSPtr>);
+
+    Region(const Region& other);
+    Region& operator=(const Region& other);
+
     /**
      * @brief add a loop to region
-     *
+     * The edge index is rebuilt on the next query.
      */
     void addLoop(Loop);
     /**
@@ -77,10 +103,27 @@ public:
 
     /**
      * @brief Check if point is inside region
+     * Uses the even-odd rule on the approximated loops
      *
      * @return bool
      */
     bool isPointInside(const geo::Coordinate&) const;
+
+    /**
+     * @brief Clip a line segment against the region
+     *
+     * @return parts of the segment inside the region
+     */
+    std::vector<lc::geo::Vector> clip(const lc::geo::Vector& segment) const;
+
+    /**
+     * @brief Decompose the region in trapezoids with horizontal bases
+     * Each trapezoid is given by 4 coordinates: bottom left, bottom right, top right and top left.
+     * Uses the even-odd rule on the approximated loops.
+     *
+     * @return std::vector<lc::geo::Coordinate>
+     */
+    std::vector<lc::geo::Coordinate> trapezoids() const;
     /**
      * @ Get perimeter and area
      *
@@ -94,6 +137,36 @@ public:
      */
     std::vector<lc::geo::Coordinate> getLineIntersection(const lc::geo::Vector&) const;
 
+    /**
+     * @brief Approximated edges of all loops
+     * The edges stay valid when loops are added to the region afterwards.
+     *
+     * @return std::shared_ptr<const std::vector<lc::geo::Vector>>
+     */
+    std::shared_ptr<const std::vector<lc::geo::Vector>> edges() const;
+
+    /**
+     * @brief Union of two regions
+     * The result is made of lines following the approximated loops, chained in closed loops.
+     *
+     * @return lc::geo::Region, empty if both regions are empty
+     */
+    Region unite(const Region& other) const;
+
+    /**
+     * @brief Intersection of two regions
+     *
+     * @return lc::geo::Region, empty if the regions don't overlap
+     */
+    Region intersect(const Region& other) const;
+
+    /**
+     * @brief Difference of two regions, this region minus other
+     *
+     * @return lc::geo::Region
+     */
+    Region subtract(const Region& other) const;
+
     /**
      * @brief Bounding box for region
      *
@@ -115,7 +188,52 @@ public:
     }
 
 private:
+    /**
+     * @brief Edges of all loops, bucketed in horizontal bands
+     * An edge is listed in every band its y range overlaps, so a point is tested against the edges of its band only.
+     * The index is immutable and shared between copies of the region.
+     * It is built on the first query, adding loops only invalidates it.
+     */
+    struct EdgeIndex {
+        std::vector<lc::geo::Vector> edges;
+        std::vector<std::vector<unsigned int>> bands;
+        double minY = 0.;
+        double maxY = 0.;
+        double bandHeight = 1.;
+
+        size_t band(double y) const;
+    };
+
+    enum class BooleanOperation {
+        Union,
+        Intersection,
+        Difference
+    };
+
+    /**
+     * @brief Edge index of the current loops, built on first use
+     * Can be called from several threads, the first index stored is kept and returned to all of them.
+     * A query takes the index once and uses it throughout.
+     */
+    std::shared_ptr<const EdgeIndex> index() const;
+
+    std::shared_ptr<const EdgeIndex> buildIndex() const;
+
+    /**
+     * @brief Indexes of the edges of which the y range may overlap the given range, without duplicates
+     */
+    static void edgesInRange(const EdgeIndex& index, double minY, double maxY, std::vector<unsigned int>& candidates);
+
+    /**
+     * @return true if the point is within tolerance of an edge of the index
+     */
+    static bool isPointOnEdge(const EdgeIndex& index, const geo::Coordinate& point, double tolerance);
+
+    Region booleanOperation(const Region& other, BooleanOperation operation) const;
+
     std::vector<Loop> _loopList;
+    // Accessed with std::atomic_load, std::atomic_store and std::atomic_compare_exchange_strong, see index()
+    mutable std::shared_ptr<const EdgeIndex> _index;
 };
 }
 }
@@ -21,6 +21,7 @@ public:
     virtual void visit(entity::LWPolyline_CSPtr) = 0;
     virtual void visit(entity::Image_CSPtr) = 0;
     virtual void visit(entity::Hatch_CSPtr) = 0;
+    virtual void visit(entity::Insert_CSPtr) = 0;
 };
 }
 // ENTITYDISPATCH_H
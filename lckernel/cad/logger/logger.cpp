@@ -3,8 +3,12 @@
 // Modified from
 // https:://github.com/boostorg/log/blob/develop/example/advanced_usage/main.cpp
 
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <vector>
 #if BOOST_VERSION >= 106100 /// @todo fix version
 #include <boost/core/null_deleter.hpp>
 #else
@@ -30,7 +34,37 @@ namespace keywords = boost::log::keywords;
 //Class starts here..
 //Singleton class
 //Making Supports to console,plain logs
-typedef sinks::synchronous_sink<sinks::text_ostream_backend> text_sink;
+//Records are queued in a ring buffer and written by a sink thread
+//When it is full the logging thread waits, warnings and errors must never be lost
+typedef sinks::asynchronous_sink<
+    sinks::text_ostream_backend,
+    sinks::bounded_fifo_queue<4096, sinks::block_on_overflow>
+> text_sink;
+
+namespace {
+std::atomic<int> logLevel(lc::log::LOG_SEVERITY_DEBUG);
+
+std::mutex sinksMutex;
+std::vector<boost::shared_ptr<text_sink>> asyncSinks;
+
+void addSink(const boost::shared_ptr<text_sink>& sink) {
+    logging::core::get()->add_sink(sink);
+
+    std::lock_guard<std::mutex> guard(sinksMutex);
+    asyncSinks.push_back(sink);
+}
+
+void stopSinks() {
+    std::lock_guard<std::mutex> guard(sinksMutex);
+
+    for (const auto& sink : asyncSinks) {
+        logging::core::get()->remove_sink(sink);
+        sink->stop();
+        sink->flush();
+    }
+    asyncSinks.clear();
+}
+}
 
 template< typename CharT, typename TraitsT >
 inline std::basic_ostream< CharT, TraitsT >& operator<< (
@@ -61,13 +95,30 @@ Logger* Logger::Instance() {
 
     return instance;
 }
+
+SeverityLevel Logger::level() {
+    return static_cast<SeverityLevel>(logLevel.load(std::memory_order_relaxed));
+}
+
+void Logger::setLevel(SeverityLevel level) {
+    logLevel.store(level, std::memory_order_relaxed);
+}
+
+void Logger::flush() {
+    std::lock_guard<std::mutex> guard(sinksMutex);
+
+    for (const auto& sink : asyncSinks) {
+        sink->flush();
+    }
+}
+
 void Logger::enableFileSink() {
     //First sink.. detail ;; to file
     boost::shared_ptr<text_sink> pSink(new text_sink);
     text_sink::locked_backend_ptr pBackend = pSink->locked_backend();
     boost::shared_ptr<std::ofstream> pStream(new std::ofstream("sample.log"));
     pBackend->add_stream(pStream);
-    logging::core::get()->add_sink(pSink);
+    pBackend->auto_flush(false);
     pSink->set_formatter(expr::stream
                          << expr::attr<unsigned int>("LineID")
                          << "[" << expr::format_date_time<boost::posix_time::ptime>("TimeStamp", "%d.%m.%y %H.%M.%S.%f")
@@ -80,6 +131,7 @@ void Logger::enableFileSink() {
                          ]
                          << expr::format_named_scope("Scope", keywords::format = "%n", keywords::iteration = expr::reverse) << "]"
                          << expr::smessage);
+    addSink(pSink);
 }
 void Logger::enableConsoleSink() {
     //Second sink.. brief ;; to file
@@ -93,7 +145,6 @@ void Logger::enableConsoleSink() {
 #endif
                                            );
     pBackend->add_stream(pStream);
-    logging::core::get()->add_sink(pSink);
     pSink->set_formatter(expr::stream
                          << "[" << expr::attr<SeverityLevel>("Severity")
                          << "]: " << expr::if_(expr::has_attr("Tag"))
@@ -105,12 +156,15 @@ void Logger::enableConsoleSink() {
     pSink->set_filter(
         expr::attr<SeverityLevel>("Severity").or_default(LOG_SEVERITY_INFO) > LOG_SEVERITY_INFO // warning or greater, or
         || expr::begins_with(expr::attr<std::string>("Tag").or_default(std::string()), "IMPORTANT")); //specially tagged
+    addSink(pSink);
 }
 
 Logger::Logger() {
     //Creating sinks
     enableFileSink();
     enableConsoleSink();
+    // Write the queued records before the program exits
+    std::atexit(stopSinks);
     //Enable attrs
     logging::add_common_attributes();
     BOOST_LOG_SCOPED_THREAD_ATTR("Uptime", attrs::timer());
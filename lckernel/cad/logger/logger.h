@@ -20,6 +20,20 @@ class Logger {
 public:
     static Logger* Instance();
 
+    /**
+     * @brief Minimum severity of the messages which are sent to the sinks
+     * Messages below this level are not formatted. Default is LOG_SEVERITY_DEBUG.
+     * Levels below LC_LOG_MIN_LEVEL are removed at compile time and can't be enabled.
+     */
+    static SeverityLevel level();
+
+    static void setLevel(SeverityLevel level);
+
+    /**
+     * @brief Write the messages waiting in the asynchronous sinks
+     */
+    void flush();
+
 private:
     void enableFileSink();
     void enableConsoleSink();
@@ -31,10 +45,27 @@ private:
 }
 }
 
+/**
+ * Messages with a lower severity are not compiled.
+ * By default, trace and debug messages are only compiled in debug builds.
+ */
+#ifndef LC_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LC_LOG_MIN_LEVEL 2 // lc::log::LOG_SEVERITY_INFO
+#else
+#define LC_LOG_MIN_LEVEL 0 // lc::log::LOG_SEVERITY_TRACE
+#endif
+#endif
+
 #define LOGGER lc::log::Logger::Instance()
 
-#define LOG_TRACE BOOST_LOG_SEV(lcGlobalLogger::get(), lc::log::LOG_SEVERITY_TRACE)
-#define LOG_DEBUG BOOST_LOG_SEV(lcGlobalLogger::get(), lc::log::LOG_SEVERITY_DEBUG)
-#define LOG_INFO BOOST_LOG_SEV(lcGlobalLogger::get(), lc::log::LOG_SEVERITY_INFO)
-#define LOG_WARNING BOOST_LOG_SEV(lcGlobalLogger::get(), lc::log::LOG_SEVERITY_WARNING)
-#define LOG_ERROR BOOST_LOG_SEV(lcGlobalLogger::get(), lc::log::LOG_SEVERITY_ERROR)
+// The stream arguments are only evaluated when the message is logged
+#define LC_LOG(severity) \
+    if (!((severity) >= LC_LOG_MIN_LEVEL && (severity) >= lc::log::Logger::level())) {} \
+    else BOOST_LOG_SEV(lcGlobalLogger::get(), (severity))
+
+#define LOG_TRACE LC_LOG(lc::log::LOG_SEVERITY_TRACE)
+#define LOG_DEBUG LC_LOG(lc::log::LOG_SEVERITY_DEBUG)
+#define LOG_INFO LC_LOG(lc::log::LOG_SEVERITY_INFO)
+#define LOG_WARNING LC_LOG(lc::log::LOG_SEVERITY_WARNING)
+#define LOG_ERROR LC_LOG(lc::log::LOG_SEVERITY_ERROR)
@@ -47,7 +47,7 @@ public:
     virtual const std::string id() const override {
         /// @todo create proper ID
         return LCMETANAME() + "_" + std::to_string(red()) + "_" + std::to_string(green()) + "_" +
-               std::to_string(blue());
+               std::to_string(blue()) + "_" + std::to_string(alpha());
     }
 
     Color color() const {
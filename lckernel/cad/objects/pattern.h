@@ -1,13 +1,22 @@
 #pragma once
 
+#include "cad/geometry/geoarea.h"
+#include "cad/geometry/geovector.h"
+#include <string>
+#include <vector>
+
 // Defination for hatch pattern
 // May be this must be in diffrent namespace
 namespace lc {
 namespace objects {
+/**
+ * Hatch pattern tile, repeated on a grid of boundingBox.maxP() steps
+ * The entities of the pattern file are stored as line segments, arcs are tessellated when the pattern is loaded.
+ */
 struct Pattern {
     lc::geo::Area boundingBox;
     std::string name;
-    std::vector<lc::entity::CADEntity_CSPtr> entities;
+    std::vector<lc::geo::Vector> segments;
 };
 }
 }
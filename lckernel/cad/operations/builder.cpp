@@ -28,6 +28,22 @@ void Builder::redo() const {
     }
 }
 
+void Builder::retainedEntities(const std::function<void(const entity::CADEntity_CSPtr&)>& func) const {
+    for(const auto& operation : _operations) {
+        operation->retainedEntities(func);
+    }
+}
+
+size_t Builder::memoryUsage() const {
+    auto size = Undoable::memoryUsage() + sizeof(*this) - sizeof(Undoable);
+
+    for(const auto& operation : _operations) {
+        size += operation->memoryUsage();
+    }
+
+    return size;
+}
+
 void Builder::processInternal() {
     for(const auto& operation : _operations) {
         operation->processInternal();
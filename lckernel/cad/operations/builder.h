@@ -24,6 +24,10 @@ public:
     void undo() const override;
     void redo() const override;
 
+    void retainedEntities(const std::function<void(const entity::CADEntity_CSPtr&)>& func) const override;
+
+    size_t memoryUsage() const override;
+
 protected:
     virtual void processInternal() override;
 
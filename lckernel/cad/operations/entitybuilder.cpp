@@ -13,6 +13,11 @@ EntityBuilder* EntityBuilder::appendEntity(entity::CADEntity_CSPtr cadEntity) {
     return this;
 }
 
+EntityBuilder* EntityBuilder::appendEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities) {
+    _workingBuffer.insert(_workingBuffer.end(), cadEntities.begin(), cadEntities.end());
+    return this;
+}
+
 EntityBuilder* EntityBuilder::appendOperation(Base_SPtr operation) {
     _stack.push_back(std::move(operation));
     return this;
@@ -21,7 +26,7 @@ EntityBuilder* EntityBuilder::appendOperation(Base_SPtr operation) {
 void EntityBuilder::processInternal() {
     processStack();
 
-    auto ec = document()->entityContainer();
+    const auto& ec = document()->entityContainer();
 
     // Build a buffer with all entities we need to remove during a undo cycle
     for (const auto& entity : _workingBuffer) {
@@ -38,9 +43,12 @@ void EntityBuilder::processInternal() {
     }
 
     // Add/Update all entities in the document
-    for (const auto& entity : _workingBuffer) {
-        document()->insertEntity(entity);
-    }
+    document()->insertEntities(_workingBuffer);
+
+    // The buffers are kept in the undo history, release the unused capacity
+    _workingBuffer.shrink_to_fit();
+    _entitiesThatWhereUpdated.shrink_to_fit();
+    _entitiesThatNeedsRemoval.shrink_to_fit();
 }
 
 void EntityBuilder::undo() const {
@@ -48,13 +56,8 @@ void EntityBuilder::undo() const {
         document()->removeEntity(entity);
     }
 
-    for (const auto& entity : _entitiesThatWhereUpdated) {
-        document()->insertEntity(entity);
-    }
-
-    for (const auto& entity : _entitiesThatNeedsRemoval) {
-        document()->insertEntity(entity);
-    }
+    document()->insertEntities(_entitiesThatWhereUpdated);
+    document()->insertEntities(_entitiesThatNeedsRemoval);
 }
 
 void EntityBuilder::redo() const {
@@ -62,9 +65,27 @@ void EntityBuilder::redo() const {
         document()->removeEntity(entity);
     }
 
+    document()->insertEntities(_workingBuffer);
+}
+
+void EntityBuilder::retainedEntities(const std::function<void(const entity::CADEntity_CSPtr&)>& func) const {
     for (const auto& entity : _workingBuffer) {
-        document()->insertEntity(entity);
+        func(entity);
+    }
+
+    for (const auto& entity : _entitiesThatWhereUpdated) {
+        func(entity);
     }
+
+    for (const auto& entity : _entitiesThatNeedsRemoval) {
+        func(entity);
+    }
+}
+
+size_t EntityBuilder::memoryUsage() const {
+    return Undoable::memoryUsage() + sizeof(*this) - sizeof(Undoable) +
+           (_workingBuffer.capacity() + _entitiesThatWhereUpdated.capacity() + _entitiesThatNeedsRemoval.capacity()) *
+           sizeof(entity::CADEntity_CSPtr);
 }
 
 void EntityBuilder::processStack() {
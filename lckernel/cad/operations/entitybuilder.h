@@ -30,6 +30,13 @@ public:
      */
     EntityBuilder* appendEntity(entity::CADEntity_CSPtr cadEntity);
 
+    /**
+     * @brief append entities to the stack
+     * @param cadEntities
+     * @return EntityOperation
+     */
+    EntityBuilder* appendEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities);
+
     /**
      * @brief Append operation to the stack
      * @param operation
@@ -40,6 +47,10 @@ public:
     virtual void undo() const;
     virtual void redo() const;
 
+    void retainedEntities(const std::function<void(const entity::CADEntity_CSPtr&)>& func) const override;
+
+    size_t memoryUsage() const override;
+
     /**
      * @brief Apply the operations
      * Apply operations on the entities without updating the document, and clear the stack.
@@ -1,10 +1,53 @@
 #include "entityops.h"
 #include "cad/storage/document.h"
+#include "cad/primitive/insert.h"
+#include "cad/tools/threadpool.h"
+
+#include <algorithm>
 
 #include "cad/storage/storagemanager.h"
 using namespace lc;
 using namespace lc::operation;
 
+namespace {
+/**
+ * Minimum number of entities handled by a single thread when a transformation is split over the thread pool
+ */
+const size_t PARALLEL_CHUNK_SIZE = 1024;
+
+/**
+ * @brief Apply a transformation on each entity
+ * The work is split over the kernel thread pool when the set is large enough. The order of the entities is kept.
+ * Inserts connect themselves to the document signals when they are created, which isn't thread safe,
+ * so a set containing an Insert is transformed in the calling thread.
+ */
+template<typename F>
+std::vector<entity::CADEntity_CSPtr> transformEntities(const std::vector<entity::CADEntity_CSPtr>& entities,
+                                                       F transformation) {
+    std::vector<entity::CADEntity_CSPtr> newQueue(entities.size());
+
+    auto transformRange = [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++) {
+            newQueue[i] = transformation(entities[i]);
+        }
+    };
+
+    bool parallel = entities.size() > PARALLEL_CHUNK_SIZE &&
+                    std::none_of(entities.begin(), entities.end(), [](const entity::CADEntity_CSPtr& entity) {
+                        return dynamic_cast<const entity::Insert*>(entity.get()) != nullptr;
+                    });
+
+    if (parallel) {
+        tools::ThreadPool::instance().parallelFor(entities.size(), PARALLEL_CHUNK_SIZE, transformRange);
+    }
+    else {
+        transformRange(0, entities.size());
+    }
+
+    return newQueue;
+}
+}
+
 /********************************************************************************************************/
 /** Base                                                                                              ***/
 /********************************************************************************************************/
@@ -12,11 +55,11 @@ Begin::Begin() :  Base() {
 }
 
 std::vector<entity::CADEntity_CSPtr> Begin::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
     _entities.insert(_entities.end(), entities.begin(), entities.end());
     return entities;
 }
@@ -33,27 +76,12 @@ Loop::Loop(const int numTimes) :  Base(), _numTimes(numTimes) {
 }
 
 std::vector<entity::CADEntity_CSPtr> Loop::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> final;
-
-    // Find the start
-    std::vector<entity::CADEntity_CSPtr> _start;
-
-    for (const auto& base : operationStack) {
-        /// @todo can we get rid of dynamic_cast??
-        auto begin = dynamic_cast<const lc::operation::Begin*>(base.get());
-
-        if (begin != nullptr) {
-            auto entities = begin->getEntities();
-            _start.insert(_start.end(), entities.begin(), entities.end());
-        }
-    }
-
-    // run the operation queue
+    const std::vector<Base_SPtr>& operationStack) {
+    // run the operation queue, each pass works on the result of the previous one
     std::vector<entity::CADEntity_CSPtr> entitySet2(entities);
 
     for (int n = 0; n < _numTimes - 1; n++) {
@@ -74,19 +102,14 @@ Move::Move(geo::Coordinate offset) :
 }
 
 std::vector<entity::CADEntity_CSPtr>  Move::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
-
-    for (const auto& entity : entities) {
-        auto e = entity->move(_offset);
-        newQueue.push_back(e);
-    }
-
-    return newQueue;
+    const std::vector<Base_SPtr>& operationStack) {
+    return transformEntities(entities, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->move(_offset);
+    });
 }
 
 /********************************************************************************************************/
@@ -98,20 +121,16 @@ Copy::Copy(geo::Coordinate offset) :
 }
 
 std::vector<entity::CADEntity_CSPtr> Copy::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
-
-    for (const auto& entity : entities) {
-        auto e = entity->copy(_offset);
-        workingBuffer.push_back(entity);
-        newQueue.push_back(e);
-    }
+    const std::vector<Base_SPtr>& operationStack) {
+    workingBuffer.insert(workingBuffer.end(), entities.begin(), entities.end());
 
-    return newQueue;
+    return transformEntities(entities, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->copy(_offset);
+    });
 }
 
 /********************************************************************************************************/
@@ -124,19 +143,14 @@ Scale::Scale(geo::Coordinate scale_center, geo::Coordinate scale_factor) :
 }
 
 std::vector<entity::CADEntity_CSPtr> Scale::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
-
-    for (const auto& entity : entities) {
-        auto e = entity->scale(_scale_center, _scale_factor);
-        newQueue.push_back(e);
-    }
-
-    return newQueue;
+    const std::vector<Base_SPtr>& operationStack) {
+    return transformEntities(entities, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->scale(_scale_center, _scale_factor);
+    });
 }
 
 /********************************************************************************************************/
@@ -149,19 +163,14 @@ Rotate::Rotate(geo::Coordinate rotation_center, const double rotation_angle) :
 }
 
 std::vector<entity::CADEntity_CSPtr> Rotate::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
-
-    for (const auto& entity : entities) {
-        auto e = entity->rotate(_rotation_center, _rotation_angle);
-        newQueue.push_back(e);
-    }
-
-    return newQueue;
+    const std::vector<Base_SPtr>& operationStack) {
+    return transformEntities(entities, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->rotate(_rotation_center, _rotation_angle);
+    });
 }
 
 /********************************************************************************************************/
@@ -171,11 +180,11 @@ Push::Push() : Base() {
 }
 
 std::vector<entity::CADEntity_CSPtr> Push::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
     std::vector<entity::CADEntity_CSPtr> newQueue(workingBuffer);
     newQueue.insert(newQueue.end(), entities.begin(), entities.end());
     workingBuffer.clear();
@@ -191,11 +200,11 @@ SelectByLayer::SelectByLayer(meta::Layer_CSPtr layer) :
 }
 
 std::vector<entity::CADEntity_CSPtr> SelectByLayer::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
 
     std::vector<entity::CADEntity_CSPtr> e;
 
@@ -220,11 +229,11 @@ Remove::Remove() : Base() {
 }
 
 std::vector<entity::CADEntity_CSPtr> Remove::process(
-    const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::shared_ptr<storage::Document>& document,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
     removals.insert(removals.end(), entities.begin(), entities.end());
     std::vector<entity::CADEntity_CSPtr> e;
     return e;
@@ -24,11 +24,11 @@ public:
     virtual ~Base() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        const std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack
+        const std::vector<Base_SPtr>& operationStack
     ) = 0;
 };
 
@@ -56,11 +56,11 @@ public:
     virtual ~Loop() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const storage::Document_SPtr document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const storage::Document_SPtr& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 
 private:
     int _numTimes;
@@ -92,11 +92,11 @@ public:
     virtual ~Begin() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 
     std::vector<entity::CADEntity_CSPtr> getEntities() const;
 
@@ -130,11 +130,11 @@ public:
     virtual ~Move() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 
 private:
     geo::Coordinate _offset;
@@ -166,11 +166,11 @@ public:
     virtual ~Copy() = default;
 
     std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack) override;
+        const std::vector<Base_SPtr>& operationStack) override;
 
 private:
     geo::Coordinate _offset;
@@ -202,11 +202,11 @@ public:
     virtual ~Rotate() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 
 private:
     geo::Coordinate _rotation_center;
@@ -221,11 +221,11 @@ public:
     virtual ~Scale() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 
 private:
     geo::Coordinate _scale_center;
@@ -260,11 +260,11 @@ public:
     virtual ~Push() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector<entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 };
 DECLARE_SHORT_SHARED_PTR(Push)
 
@@ -292,11 +292,11 @@ public:
     virtual ~SelectByLayer() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector <entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 
 private:
     meta::Layer_CSPtr _layer;
@@ -327,11 +327,11 @@ public:
     virtual ~Remove() = default;
 
     virtual std::vector<entity::CADEntity_CSPtr> process(
-        const std::shared_ptr<storage::Document> document,
-        std::vector<entity::CADEntity_CSPtr> entities,
+        const std::shared_ptr<storage::Document>& document,
+        const std::vector<entity::CADEntity_CSPtr>& entities,
         std::vector <entity::CADEntity_CSPtr>& workingBuffer,
         std::vector<entity::CADEntity_CSPtr>& removals,
-        const std::vector<Base_SPtr> operationStack);
+        const std::vector<Base_SPtr>& operationStack);
 };
 DECLARE_SHORT_SHARED_PTR(Remove)
 }
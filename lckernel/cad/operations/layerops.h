@@ -38,6 +38,8 @@ public:
     void undo() const override;
     void redo() const override;
 
+    void retainedEntities(const std::function<void(const entity::CADEntity_CSPtr&)>& func) const override;
+
 private:
 
 protected:
@@ -2,12 +2,17 @@
 
 #include <string>
 #include "cad/const.h"
+#include <functional>
 #include <memory>
 namespace lc {
 namespace storage {
 class Document;
 }
 
+namespace entity {
+class CADEntity;
+}
+
 namespace operation {
 
 /**
@@ -61,6 +66,22 @@ public:
         return _text;
     }
 
+    /*!
+     * \brief Call a function for each entity kept by this operation to be able to undo or redo it
+     *
+     * Used by the undo manager to compute the memory used by the undo history.
+     * Entities shared between operations are only counted once.
+     */
+    virtual void retainedEntities(const std::function<void(const std::shared_ptr<const entity::CADEntity>&)>& func) const {
+    }
+
+    /*!
+     * \brief Estimated number of bytes used by the operation itself, without the retained entities
+     */
+    virtual size_t memoryUsage() const {
+        return sizeof(*this) + _text.capacity();
+    }
+
 private:
     std::string _text;
 };
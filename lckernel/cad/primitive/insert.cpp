@@ -1,4 +1,5 @@
 #include "insert.h"
+#include "cad/interface/entitydispatch.h"
 
 using namespace lc;
 using namespace entity;
@@ -88,7 +89,7 @@ CADEntity_CSPtr Insert::modify(meta::Layer_CSPtr layer, meta::MetaInfo_CSPtr met
 }
 
 void Insert::dispatch(EntityDispatch& dispatch) const {
-    /// @todo
+    dispatch.visit(shared_from_this());
 }
 
 std::map<unsigned int, geo::Coordinate> entity::Insert::dragPoints() const {
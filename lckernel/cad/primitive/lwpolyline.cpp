@@ -519,3 +519,9 @@ CADEntity_CSPtr LWPolyline::setProperties(const PropertiesMap& propertiesMap) co
     newLWPolyline->setID(this->id());
     return newLWPolyline;
 }
+
+size_t LWPolyline::memoryUsage() const {
+    return CADEntity::memoryUsage() +
+           _vertex.capacity() * sizeof(LWVertex2D) +
+           _entities.size() * CADEntity::memoryUsage();
+}
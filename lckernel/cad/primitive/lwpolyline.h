@@ -217,6 +217,8 @@ public:
 
     CADEntity_CSPtr setProperties(const PropertiesMap& propertiesMap) const override;
 
+    size_t memoryUsage() const override;
+
 public:
     std::map<unsigned int, lc::geo::Coordinate> dragPoints() const override;
     CADEntity_CSPtr setDragPoints(std::map<unsigned int, lc::geo::Coordinate> dragPoints) const override;
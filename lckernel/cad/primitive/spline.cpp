@@ -390,3 +390,9 @@ CADEntity_CSPtr Spline::setProperties(const PropertiesMap& propertiesMap) const
     newSpline->setID(this->id());
     return newSpline;
 }
+
+size_t Spline::memoryUsage() const {
+    return CADEntity::memoryUsage() +
+           (controlPoints().size() + fitPoints().size()) * sizeof(geo::Coordinate) +
+           knotPoints().size() * sizeof(double);
+}
@@ -80,6 +80,7 @@ public:
     CADEntity_CSPtr setDragPoints(std::map<unsigned int, lc::geo::Coordinate> dragPoints) const override;
     PropertiesMap availableProperties() const override;
     CADEntity_CSPtr setProperties(const PropertiesMap& propertiesMap) const override;
+    size_t memoryUsage() const override;
 
 private:
     void calculateBoundingBox();
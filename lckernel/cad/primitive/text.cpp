@@ -277,3 +277,7 @@ CADEntity_CSPtr Text::setProperties(const PropertiesMap& propertiesMap) const {
     textEntity->setID(this->id());
     return textEntity;
 }
+
+size_t Text::memoryUsage() const {
+    return CADEntity::memoryUsage() + _text_value.capacity() + _style.capacity();
+}
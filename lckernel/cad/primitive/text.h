@@ -145,6 +145,8 @@ public:
     PropertiesMap availableProperties() const override;
 
     CADEntity_CSPtr setProperties(const PropertiesMap& propertiesMap) const override;
+
+    size_t memoryUsage() const override;
 };
 
 DECLARE_SHORT_SHARED_PTR(Text)
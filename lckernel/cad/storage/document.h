@@ -40,6 +40,18 @@ DECLARE_SHORT_SHARED_PTR(DocumentOperation)
 }
 
 namespace storage {
+/**
+ * @brief Document
+ * Concurrency model: one writer, many readers.
+ * Operations are executed, undone and redone one at a time with the document locked exclusively.
+ * The accessors returning values (entityByID, entitiesByLayer, layerByName...) lock the document shared,
+ * so they can be called from any thread. They don't lock when called from the thread running the operation.
+ * Mutators such as insertEntity must only be called by operations.
+ * Signals are sent from the writer thread.
+ *
+ * entityContainer() returns a reference to the live container and must only be used from the writer thread.
+ * Other threads should read from snapshot(), which never blocks and never changes once published.
+ */
 class Document {
 public:
     Document();
@@ -155,6 +167,13 @@ public:
      */
     virtual void insertEntity(const entity::CADEntity_CSPtr& cadEntity) = 0;
 
+    /*!
+     * \brief add a set of entities to the document.
+     * Entities are stored in one pass before the events are sent.
+     * \param cadEntities Entities to be added, an entity with an existing ID replaces the old one
+     */
+    virtual void insertEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities) = 0;
+
     /*!
      * \brief removes an entity from the document.
      * \param id ID of the entity to be removed.
@@ -193,9 +212,18 @@ public:
      */
     virtual EntityContainer<entity::CADEntity_CSPtr> entitiesByBlock(const lc::meta::Block_CSPtr& block) = 0;
 
+    /**
+     * @brief entitiesByType
+     * Return all entities of the model space of a given type
+     * \param type type of the entities, for example typeid(entity::Line)
+     * @return
+     */
+    virtual EntityContainer<entity::CADEntity_CSPtr> entitiesByType(const std::type_index& type) = 0;
+
     /**
      * @brief entityContainer
-     * Return a copy of all entities within the document
+     * Return all entities within the document
+     * The container is modified by operations, only use it from the thread executing them
      * @return
      */
     virtual EntityContainer<entity::CADEntity_CSPtr>& entityContainer() = 0;
@@ -243,6 +271,25 @@ public:
      */
     virtual entity::CADEntity_CSPtr entityByID(ID_DATATYPE id) const = 0;
 
+    /**
+     * @brief snapshot
+     * Immutable state of the document as of the last commit, undo or redo.
+     * Snapshots can be read from any thread without locking the document.
+     */
+    virtual DocumentSnapshot_CSPtr snapshot() const = 0;
+
+    /**
+     * @brief undo an operation previously executed on this document
+     * The document is locked during the undo and a new snapshot is published afterwards
+     */
+    virtual void undoOperation(const operation::DocumentOperation_SPtr& operation) = 0;
+
+    /**
+     * @brief redo an operation previously undone on this document
+     * The document is locked during the redo and a new snapshot is published afterwards
+     */
+    virtual void redoOperation(const operation::DocumentOperation_SPtr& operation) = 0;
+
 public:
     friend class lc::operation::DocumentOperation;
 
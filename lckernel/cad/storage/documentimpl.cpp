@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <memory>
@@ -5,27 +6,83 @@
 #include "documentimpl.h"
 #include <cad/primitive/insert.h>
 #include <cad/primitive/customentity.h>
+#include <cad/tools/profiler.h>
 
 using namespace lc;
 using namespace lc::storage;
 
 DocumentImpl::DocumentImpl(StorageManager_SPtr storageManager) :
     Document(),
+    _writer(std::thread::id()),
     _storageManager(std::move(storageManager)) {
     _storageManager->addDocumentMetaType(std::make_shared<meta::Layer>("0", meta::MetaLineWidthByValue(1.0), Color(255, 255, 255)));
     //Add papers too
     _storageManager->addDocumentMetaType(std::make_shared<lc::meta::Block>("*Paper_Space", geo::Coordinate()));
     _storageManager->addDocumentMetaType(std::make_shared<lc::meta::Block>("*Paper_Space0", geo::Coordinate()));
+    publishSnapshot();
 }
 
 void DocumentImpl::execute(const operation::DocumentOperation_SPtr& operation) {
+    LC_PROFILE_ZONE("DocumentImpl::execute");
     {
-        std::lock_guard<std::mutex> lck(_documentMutex);
+        WriteLock lck(*this);
         begin(operation);
         this->operationProcess(operation);
         commit(operation);
     }
 
+    sendNewWaitingCustomEntityEvents();
+}
+
+void DocumentImpl::undoOperation(const operation::DocumentOperation_SPtr& operation) {
+    {
+        WriteLock lck(*this);
+        operation->undo();
+        _storageManager->optimise();
+        publishSnapshot();
+    }
+
+    sendNewWaitingCustomEntityEvents();
+}
+
+void DocumentImpl::redoOperation(const operation::DocumentOperation_SPtr& operation) {
+    {
+        WriteLock lck(*this);
+        operation->redo();
+        _storageManager->optimise();
+        publishSnapshot();
+    }
+
+    sendNewWaitingCustomEntityEvents();
+}
+
+DocumentImpl::WriteLock::WriteLock(const DocumentImpl& document) :
+    _document(document),
+    _lock(document._documentMutex) {
+    _document._writer = std::this_thread::get_id();
+}
+
+DocumentImpl::WriteLock::~WriteLock() {
+    _document._writer = std::thread::id();
+}
+
+std::shared_lock<std::shared_timed_mutex> DocumentImpl::readLock() const {
+    if (_writer == std::this_thread::get_id()) {
+        return std::shared_lock<std::shared_timed_mutex>(_documentMutex, std::defer_lock);
+    }
+
+    return std::shared_lock<std::shared_timed_mutex>(_documentMutex);
+}
+
+DocumentSnapshot_CSPtr DocumentImpl::snapshot() const {
+    return std::atomic_load(&_snapshot);
+}
+
+void DocumentImpl::publishSnapshot() {
+    std::atomic_store(&_snapshot, _storageManager->snapshot());
+}
+
+void DocumentImpl::sendNewWaitingCustomEntityEvents() {
     auto tmp = _newWaitingCustomEntities;
     _newWaitingCustomEntities.clear();
     for (const auto& insert : tmp) {
@@ -42,6 +99,7 @@ void DocumentImpl::begin(const operation::DocumentOperation_SPtr& operation) {
 
 void DocumentImpl::commit(const operation::DocumentOperation_SPtr& operation) {
     _storageManager->optimise();
+    publishSnapshot();
     event::CommitProcessEvent event(operation);
     commitProcessEvent()(event);
 }
@@ -55,6 +113,40 @@ void DocumentImpl::insertEntity(const entity::CADEntity_CSPtr& cadEntity) {
     event::AddEntityEvent event(cadEntity);
     addEntityEvent()(event);
 
+    addWaitingCustomEntity(cadEntity);
+}
+
+void DocumentImpl::insertEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities) {
+    // When the same ID is present more than once, only the last entity is kept, as if they were inserted one by one
+    std::vector<entity::CADEntity_CSPtr> entities;
+    entities.reserve(cadEntities.size());
+    std::unordered_set<ID_DATATYPE> ids;
+    ids.reserve(cadEntities.size());
+
+    for (auto it = cadEntities.rbegin(); it != cadEntities.rend(); ++it) {
+        if (ids.insert((*it)->id()).second) {
+            entities.push_back(*it);
+        }
+    }
+    std::reverse(entities.begin(), entities.end());
+
+    for (const auto& entity : entities) {
+        if (_storageManager->entityByID(entity->id()) != nullptr) {
+            removeEntity(entity);
+        }
+    }
+
+    _storageManager->insertEntities(entities);
+
+    for (const auto& entity : entities) {
+        event::AddEntityEvent event(entity);
+        addEntityEvent()(event);
+
+        addWaitingCustomEntity(entity);
+    }
+}
+
+void DocumentImpl::addWaitingCustomEntity(const entity::CADEntity_CSPtr& cadEntity) {
     auto insert = std::dynamic_pointer_cast<const entity::Insert>(cadEntity);
     if (insert != nullptr && std::dynamic_pointer_cast<const entity::CustomEntity>(cadEntity) == nullptr) {
         auto ces = std::dynamic_pointer_cast<const meta::CustomEntityStorage>(insert->displayBlock());
@@ -144,24 +236,27 @@ void DocumentImpl::replaceDocumentMetaType(const meta::DocumentMetaType_CSPtr& o
 }
 
 std::map<std::string, lc::meta::DocumentMetaType_CSPtr, lc::tools::StringHelper::cmpCaseInsensetive> DocumentImpl::allMetaTypes() {
+    auto lck = readLock();
     return _storageManager->allMetaTypes();
 }
 
 EntityContainer<lc::entity::CADEntity_CSPtr> DocumentImpl::entitiesByLayer(const meta::Layer_CSPtr& layer) {
-//    std::lock_guard<std::mutex> lck(_documentMutex);
+    auto lck = readLock();
     return _storageManager->entitiesByLayer(layer);
 }
 
 EntityContainer<lc::entity::CADEntity_CSPtr>& DocumentImpl::entityContainer() {
-    //   std::lock_guard<std::mutex> lck(_documentMutex);
+    // The reference outlives any lock taken here, see Document::entityContainer()
     return _storageManager->entityContainer();
 }
 
 std::map<std::string, lc::meta::Layer_CSPtr> DocumentImpl::allLayers() const {
+    auto lck = readLock();
     return _storageManager->allLayers();
 }
 
 lc::meta::Layer_CSPtr DocumentImpl::layerByName(const std::string& layerName) const {
+    auto lck = readLock();
     auto x =  _storageManager->layerByName(layerName);
     return x;
 }
@@ -170,11 +265,13 @@ lc::meta::Block_CSPtr DocumentImpl::blockByName(const std::string& blockName) co
     if(blockName=="*Model_Space") {
         return nullptr;
     }
+    auto lck = readLock();
     auto x =  _storageManager->blockByName(blockName);
     return x;
 }
 
 lc::meta::DxfLinePatternByValue_CSPtr DocumentImpl::linePatternByName(const std::string& linePatternName) const {
+    auto lck = readLock();
     return _storageManager->linePatternByName(linePatternName);
 }
 
@@ -183,21 +280,36 @@ lc::meta::DxfLinePatternByValue_CSPtr DocumentImpl::linePatternByName(const std:
  * @todo probably change this to metaTypes<T>()
  */
 std::vector<lc::meta::DxfLinePatternByValue_CSPtr> DocumentImpl::linePatterns() const {
+    auto lck = readLock();
     return _storageManager->metaTypes<const meta::DxfLinePatternByValue>();
 }
 
 EntityContainer<lc::entity::CADEntity_CSPtr> DocumentImpl::entitiesByBlock(const lc::meta::Block_CSPtr& block) {
+    auto lck = readLock();
     return _storageManager->entitiesByBlock(block);
 }
 
+EntityContainer<lc::entity::CADEntity_CSPtr> DocumentImpl::entitiesByType(const std::type_index& type) {
+    auto lck = readLock();
+    return _storageManager->entitiesByType(type);
+}
+
 std::vector<lc::meta::Block_CSPtr> DocumentImpl::blocks() const {
+    auto lck = readLock();
     return _storageManager->metaTypes<const lc::meta::Block>();
 }
 
 std::unordered_set<lc::entity::Insert_CSPtr> DocumentImpl::waitingCustomEntities(const std::string& pluginName) {
-    return _waitingCustomEntities[pluginName];
+    auto lck = readLock();
+    auto it = _waitingCustomEntities.find(pluginName);
+    if (it == _waitingCustomEntities.end()) {
+        return std::unordered_set<lc::entity::Insert_CSPtr>();
+    }
+
+    return it->second;
 }
 
 entity::CADEntity_CSPtr DocumentImpl::entityByID(ID_DATATYPE id) const {
+    auto lck = readLock();
     return _storageManager->entityByID(id);
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <vector>
 #include <string>
 #include <unordered_set>
@@ -13,6 +16,11 @@
 
 namespace lc {
 namespace storage {
+/**
+ * @brief Default document implementation
+ * Operations, undo and redo take the document lock exclusively. The read accessors take it shared,
+ * except when called from the thread running the operation, which already holds it.
+ */
 class DocumentImpl : public Document {
 public:
     DocumentImpl(StorageManager_SPtr storageManager);
@@ -22,6 +30,8 @@ public:
 public:
     void insertEntity(const entity::CADEntity_CSPtr& cadEntity) override;
 
+    void insertEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities) override;
+
     void removeEntity(const entity::CADEntity_CSPtr& entity) override;
 
     void addDocumentMetaType(const meta::DocumentMetaType_CSPtr& dmt) override;
@@ -38,6 +48,8 @@ public:
 
     EntityContainer<entity::CADEntity_CSPtr> entitiesByBlock(const meta::Block_CSPtr& block) override;
 
+    EntityContainer<entity::CADEntity_CSPtr> entitiesByType(const std::type_index& type) override;
+
     EntityContainer<entity::CADEntity_CSPtr>& entityContainer() override;
 
     std::map<std::string, meta::Layer_CSPtr> allLayers() const override;
@@ -52,6 +64,12 @@ public:
 
     entity::CADEntity_CSPtr entityByID(ID_DATATYPE id) const override;
 
+    DocumentSnapshot_CSPtr snapshot() const override;
+
+    void undoOperation(const operation::DocumentOperation_SPtr& operation) override;
+
+    void redoOperation(const operation::DocumentOperation_SPtr& operation) override;
+
 protected:
     void execute(const operation::DocumentOperation_SPtr& operation) override;
 
@@ -65,12 +83,50 @@ public:
     std::vector<lc::meta::Block_CSPtr> blocks() const override;
 
 private:
-    std::mutex _documentMutex;
+    /**
+     * @brief Register the entity in the waiting custom entities list if it's an unmanaged custom entity
+     */
+    void addWaitingCustomEntity(const entity::CADEntity_CSPtr& cadEntity);
+
+    /**
+     * @brief Send the events of the custom entities which were added since the last call
+     */
+    void sendNewWaitingCustomEntityEvents();
+
+    /**
+     * @brief Make the current content of the storage manager available to snapshot()
+     */
+    void publishSnapshot();
+
+    /**
+     * @brief Exclusive lock held while an operation, undo or redo runs
+     */
+    class WriteLock {
+    public:
+        explicit WriteLock(const DocumentImpl& document);
+        ~WriteLock();
+
+    private:
+        const DocumentImpl& _document;
+        std::unique_lock<std::shared_timed_mutex> _lock;
+    };
+
+    /**
+     * @brief Shared lock for the read accessors
+     * Returned unlocked when the calling thread is the writer
+     */
+    std::shared_lock<std::shared_timed_mutex> readLock() const;
+
+    mutable std::shared_timed_mutex _documentMutex;
+    mutable std::atomic<std::thread::id> _writer;
     // AI am considering remove the shared_ptr from this one so we can never get a shared object from it
     StorageManager_SPtr _storageManager;
 
     std::map<std::string, std::unordered_set<entity::Insert_CSPtr>> _waitingCustomEntities;
     std::unordered_set<entity::Insert_CSPtr> _newWaitingCustomEntities;
+
+    // Only accessed with std::atomic_load and std::atomic_store
+    DocumentSnapshot_CSPtr _snapshot;
 };
 }
 }
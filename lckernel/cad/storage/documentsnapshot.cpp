@@ -0,0 +1,155 @@
+#include "documentsnapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+
+using namespace lc;
+using namespace lc::storage;
+
+namespace {
+/**
+ * Meta types are looked up case insensitive, like in StorageManagerImpl
+ */
+std::string metaKey(std::string id) {
+    std::transform(id.begin(), id.end(), id.begin(), [](unsigned char c) {
+        return std::tolower(c);
+    });
+    return id;
+}
+}
+
+uint64_t EditToken::next() {
+    static std::atomic<uint64_t> counter(1);
+    return counter++;
+}
+
+DocumentSnapshot::DocumentSnapshot() :
+    // Same bounds as EntityContainer
+    _modelSpace(geo::Area(geo::Coordinate(-500000., -500000.), geo::Coordinate(500000., 500000.))) {
+}
+
+void DocumentSnapshot::insertEntity(const entity::CADEntity_CSPtr& entity) {
+    auto existing = _entities.find(entity->id());
+    if (existing != nullptr) {
+        if ((*existing)->block() == nullptr) {
+            _modelSpace.erase(*existing);
+        }
+        else {
+            eraseBlockEntity(*existing);
+        }
+    }
+
+    _entities.insert(entity->id(), entity);
+
+    if (entity->block() == nullptr) {
+        _modelSpace.insert(entity);
+    }
+    else {
+        insertBlockEntity(entity);
+    }
+}
+
+void DocumentSnapshot::removeEntity(const entity::CADEntity_CSPtr& entity) {
+    auto existing = _entities.find(entity->id());
+    if (existing == nullptr) {
+        return;
+    }
+
+    // Use the stored entity, its bounding box locates it in the tree
+    auto stored = *existing;
+    if (stored->block() == nullptr) {
+        _modelSpace.erase(stored);
+    }
+    else {
+        eraseBlockEntity(stored);
+    }
+
+    _entities.erase(entity->id());
+}
+
+std::string DocumentSnapshot::blockKey(const meta::Block& block) {
+    return metaKey(block.name());
+}
+
+void DocumentSnapshot::insertBlockEntity(const entity::CADEntity_CSPtr& entity) {
+    auto key = blockKey(*entity->block());
+    auto existing = _blockEntities.find(key);
+
+    // Shares the nodes of the stored map, only the path to the entity is copied
+    auto entities = existing != nullptr ? *existing : EntityMap();
+    entities.insert(entity->id(), entity);
+    _blockEntities.insert(key, entities);
+}
+
+void DocumentSnapshot::eraseBlockEntity(const entity::CADEntity_CSPtr& entity) {
+    auto key = blockKey(*entity->block());
+    auto existing = _blockEntities.find(key);
+    if (existing == nullptr) {
+        return;
+    }
+
+    auto entities = *existing;
+    entities.erase(entity->id());
+    if (entities.empty()) {
+        _blockEntities.erase(key);
+    }
+    else {
+        _blockEntities.insert(key, entities);
+    }
+}
+
+void DocumentSnapshot::addDocumentMetaType(const meta::DocumentMetaType_CSPtr& dmt) {
+    _metaTypes.insert(metaKey(dmt->id()), dmt);
+}
+
+void DocumentSnapshot::removeDocumentMetaType(const meta::DocumentMetaType_CSPtr& dmt) {
+    _metaTypes.erase(metaKey(dmt->id()));
+}
+
+entity::CADEntity_CSPtr DocumentSnapshot::entityByID(ID_DATATYPE id) const {
+    auto entity = _entities.find(id);
+    return entity != nullptr ? *entity : nullptr;
+}
+
+size_t DocumentSnapshot::size() const {
+    return _entities.size();
+}
+
+std::vector<entity::CADEntity_CSPtr> DocumentSnapshot::asVector() const {
+    return _modelSpace.retrieve();
+}
+
+std::vector<entity::CADEntity_CSPtr> DocumentSnapshot::entitiesWithinAndCrossingAreaFast(const geo::Area& area) const {
+    std::vector<entity::CADEntity_CSPtr> entities;
+
+    eachWithinAndCrossingArea(area, [&entities](const entity::CADEntity_CSPtr& entity) {
+        entities.push_back(entity);
+    });
+
+    return entities;
+}
+
+meta::DocumentMetaType_CSPtr DocumentSnapshot::metaTypeByID(const std::string& id) const {
+    auto dmt = _metaTypes.find(metaKey(id));
+    return dmt != nullptr ? *dmt : nullptr;
+}
+
+meta::Layer_CSPtr DocumentSnapshot::layerByName(const std::string& layerName) const {
+    return std::dynamic_pointer_cast<const meta::Layer>(metaTypeByID(meta::Layer::LCMETANAME() + "_" + layerName));
+}
+
+meta::Block_CSPtr DocumentSnapshot::blockByName(const std::string& blockName) const {
+    return std::dynamic_pointer_cast<const meta::Block>(metaTypeByID(meta::Block::LCMETANAME() + "_" + blockName));
+}
+
+std::vector<meta::DocumentMetaType_CSPtr> DocumentSnapshot::allMetaTypes() const {
+    std::vector<meta::DocumentMetaType_CSPtr> metaTypes;
+    metaTypes.reserve(_metaTypes.size());
+
+    _metaTypes.each([&metaTypes](const std::string&, const meta::DocumentMetaType_CSPtr& dmt) {
+        metaTypes.push_back(dmt);
+    });
+
+    return metaTypes;
+}
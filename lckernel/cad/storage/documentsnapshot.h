@@ -0,0 +1,182 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "cad/const.h"
+#include "cad/base/id.h"
+#include "cad/base/cadentity.h"
+#include "cad/interface/metatype.h"
+#include "cad/meta/block.h"
+#include "cad/meta/layer.h"
+#include "cad/storage/persistentmap.h"
+#include "cad/storage/persistentquadtree.h"
+
+namespace lc {
+namespace storage {
+/**
+ * @brief Immutable version of the document content
+ * A snapshot holds all entities and meta types of a document as they were after a commit.
+ * Snapshots share their structure with the document, taking one is O(1) and doesn't copy entities.
+ *
+ * A published snapshot is never modified, any number of threads can read it while the document is being edited.
+ * This allows rendering, exports and scripts to work on a consistent state without locking the document.
+ *
+ * StorageManagerImpl keeps a working snapshot up to date with each change and hands out copies of it.
+ */
+class DocumentSnapshot {
+public:
+    DocumentSnapshot();
+
+    /**
+     * @brief Insert or replace an entity
+     */
+    void insertEntity(const entity::CADEntity_CSPtr& entity);
+
+    /**
+     * @brief Remove an entity
+     */
+    void removeEntity(const entity::CADEntity_CSPtr& entity);
+
+    void addDocumentMetaType(const meta::DocumentMetaType_CSPtr& dmt);
+
+    void removeDocumentMetaType(const meta::DocumentMetaType_CSPtr& dmt);
+
+    /**
+     * @brief entityByID
+     * Return an entity of the model space or of a block
+     * @return entity or nullptr
+     */
+    entity::CADEntity_CSPtr entityByID(ID_DATATYPE id) const;
+
+    /**
+     * @return number of entities, including block entities
+     */
+    size_t size() const;
+
+    /**
+     * @return all entities of the model space
+     */
+    std::vector<entity::CADEntity_CSPtr> asVector() const;
+
+    /**
+     * @brief entitiesWithinAndCrossingAreaFast
+     * Model space entities of which the bounding box overlaps the given area
+     */
+    std::vector<entity::CADEntity_CSPtr> entitiesWithinAndCrossingAreaFast(const geo::Area& area) const;
+
+    /**
+     * @brief Call func(entity) for each model space entity of which the bounding box overlaps the given area
+     * Same entities as entitiesWithinAndCrossingAreaFast(), without building a list.
+     */
+    template<typename F>
+    void eachWithinAndCrossingArea(const geo::Area& area, F func) const {
+        _modelSpace.each(area, [&area, &func](const entity::CADEntity_CSPtr& entity) {
+            if (entity->boundingBox().overlaps(area)) {
+                func(entity);
+            }
+        });
+    }
+
+    /**
+     * @brief Same as eachWithinAndCrossingArea(), stops when func(entity) returns false
+     * @return false if func stopped the iteration
+     */
+    template<typename F>
+    bool eachWithinAndCrossingAreaWhile(const geo::Area& area, F func) const {
+        return _modelSpace.eachWhile(area, [&area, &func](const entity::CADEntity_CSPtr& entity) {
+            return !entity->boundingBox().overlaps(area) || func(entity);
+        });
+    }
+
+    /**
+     * @brief Call func(entity) for each entity of the model space
+     */
+    template<typename F>
+    void eachInModelSpace(F func) const {
+        _modelSpace.each(func);
+    }
+
+    /**
+     * @brief Same as eachInModelSpace(), stops when func(entity) returns false
+     * @return false if func stopped the iteration
+     */
+    template<typename F>
+    bool eachInModelSpaceWhile(F func) const {
+        return _modelSpace.eachWhile(func);
+    }
+
+    /**
+     * @brief Call func(entity) for each entity of a block until it returns false
+     * Blocks are indexed by name, the cost is about the number of entities of the block.
+     * @return false if func stopped the iteration
+     */
+    template<typename F>
+    bool eachInBlockWhile(const meta::Block_CSPtr& block, F func) const {
+        auto entities = _blockEntities.find(blockKey(*block));
+        return entities == nullptr || entities->eachWhile([&func](ID_DATATYPE, const entity::CADEntity_CSPtr& entity) {
+            return func(entity);
+        });
+    }
+
+    /**
+     * @brief Call func(entity) for each entity, including block entities
+     */
+    template<typename F>
+    void each(F func) const {
+        _entities.each([&func](ID_DATATYPE, const entity::CADEntity_CSPtr& entity) {
+            func(entity);
+        });
+    }
+
+    /**
+     * @brief Call func(oldEntity, newEntity) for each entity which changed since a previous snapshot
+     * oldEntity is nullptr for added entities, newEntity is nullptr for removed entities.
+     * Only the parts which are not shared by both snapshots are visited, comparing two consecutive
+     * snapshots costs about the size of the change.
+     */
+    template<typename F>
+    void diffEntities(const DocumentSnapshot& previous, F func) const {
+        _entities.diff(previous._entities, [&func](ID_DATATYPE, const entity::CADEntity_CSPtr* oldEntity, const entity::CADEntity_CSPtr* newEntity) {
+            func(oldEntity != nullptr ? *oldEntity : nullptr, newEntity != nullptr ? *newEntity : nullptr);
+        });
+    }
+
+    /**
+     * @brief Call func(oldMetaType, newMetaType) for each meta type which changed since a previous snapshot
+     * See diffEntities()
+     */
+    template<typename F>
+    void diffMetaTypes(const DocumentSnapshot& previous, F func) const {
+        _metaTypes.diff(previous._metaTypes, [&func](const std::string&, const meta::DocumentMetaType_CSPtr* oldMetaType, const meta::DocumentMetaType_CSPtr* newMetaType) {
+            func(oldMetaType != nullptr ? *oldMetaType : nullptr, newMetaType != nullptr ? *newMetaType : nullptr);
+        });
+    }
+
+    meta::DocumentMetaType_CSPtr metaTypeByID(const std::string& id) const;
+
+    meta::Layer_CSPtr layerByName(const std::string& layerName) const;
+
+    meta::Block_CSPtr blockByName(const std::string& blockName) const;
+
+    std::vector<meta::DocumentMetaType_CSPtr> allMetaTypes() const;
+
+private:
+    using EntityMap = PersistentMap<ID_DATATYPE, entity::CADEntity_CSPtr>;
+
+    static std::string blockKey(const meta::Block& block);
+
+    void insertBlockEntity(const entity::CADEntity_CSPtr& entity);
+
+    void eraseBlockEntity(const entity::CADEntity_CSPtr& entity);
+
+    EntityMap _entities;
+    PersistentQuadTree<entity::CADEntity_CSPtr> _modelSpace;
+    // Entities of each block, by block key
+    PersistentMap<std::string, EntityMap> _blockEntities;
+    PersistentMap<std::string, meta::DocumentMetaType_CSPtr> _metaTypes;
+};
+
+DECLARE_SHORT_SHARED_PTR(DocumentSnapshot)
+}
+}
@@ -155,16 +155,16 @@ public:
      * \brief entitiesByMetaType
      * Return all entities that contain's a specific metaInfo
      * \param metaTypeName
-     * @todo this does nothing
      * \return
      */
     EntityContainer entitiesByMetaType(const std::string& metaName) const {
         EntityContainer container;
 
         for (auto i : asVector(std::numeric_limits<short>::max())) {
-            //       if (i->metaInfo(metaName) != nullptr) {
-            //           container.insert(i);
-            // }
+            auto metaInfo = i->metaInfo();
+            if (metaInfo != nullptr && metaInfo->find(metaName) != metaInfo->end()) {
+                container.insert(i);
+            }
         }
 
         return container;
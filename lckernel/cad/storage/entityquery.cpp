@@ -0,0 +1,56 @@
+#include "entityquery.h"
+
+using namespace lc;
+using namespace lc::storage;
+
+EntityQuery::EntityQuery(const Document_SPtr& document) :
+    EntityQuery(document->snapshot()) {
+}
+
+EntityQuery::EntityQuery(DocumentSnapshot_CSPtr snapshot) :
+    _snapshot(std::move(snapshot)),
+    _hasArea(false) {
+}
+
+void EntityQuery::setArea(const geo::Area& area) {
+    _area = area;
+    _hasArea = true;
+}
+
+void EntityQuery::setLayer(const meta::Layer_CSPtr& layer) {
+    _layer = layer;
+}
+
+void EntityQuery::setBlock(const meta::Block_CSPtr& block) {
+    _block = block;
+}
+
+size_t EntityQuery::count() const {
+    size_t count = 0;
+
+    each([&count](const entity::CADEntity_CSPtr&) {
+        count++;
+    });
+
+    return count;
+}
+
+std::vector<entity::CADEntity_CSPtr> EntityQuery::asVector() const {
+    std::vector<entity::CADEntity_CSPtr> entities;
+
+    each([&entities](const entity::CADEntity_CSPtr& entity) {
+        entities.push_back(entity);
+    });
+
+    return entities;
+}
+
+std::vector<ID_DATATYPE> EntityQuery::ids() const {
+    std::vector<ID_DATATYPE> ids;
+
+    each([&ids](const entity::CADEntity_CSPtr& entity) {
+        ids.push_back(entity->id());
+    });
+
+    return ids;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+
+#include "cad/storage/document.h"
+#include "cad/storage/documentsnapshot.h"
+
+namespace lc {
+namespace storage {
+/**
+ * @brief Query on the entities of a document snapshot
+ * A query is a lightweight handle: it holds the snapshot and the filters, and reads the snapshot index
+ * only when the results are requested. Nothing is copied, each() costs about the size of the result
+ * when an area is set, the size of the block when a block is set and the size of the model space otherwise.
+ *
+ * Without any filter, the query returns the model space entities.
+ */
+class EntityQuery {
+public:
+    /**
+     * @brief Query the last published snapshot of a document
+     */
+    explicit EntityQuery(const Document_SPtr& document);
+
+    explicit EntityQuery(DocumentSnapshot_CSPtr snapshot);
+
+    /**
+     * @brief Only return entities of which the bounding box overlaps the area
+     */
+    void setArea(const geo::Area& area);
+
+    /**
+     * @brief Only return entities of a layer
+     */
+    void setLayer(const meta::Layer_CSPtr& layer);
+
+    /**
+     * @brief Return the entities of a block instead of the model space
+     */
+    void setBlock(const meta::Block_CSPtr& block);
+
+    /**
+     * @brief Call func(entity) for each entity matching the filters, in no particular order
+     */
+    template<typename F>
+    void each(F func) const {
+        eachWhile([&func](const entity::CADEntity_CSPtr& entity) {
+            func(entity);
+            return true;
+        });
+    }
+
+    /**
+     * @brief Call func(entity) for each entity matching the filters until it returns false
+     * The remaining entities are not visited.
+     * @return false if func stopped the iteration
+     */
+    template<typename F>
+    bool eachWhile(F func) const {
+        auto filter = [this, &func](const entity::CADEntity_CSPtr& entity) {
+            if ((_layer == nullptr || entity->layer() == _layer) &&
+                (!_hasArea || entity->boundingBox().overlaps(_area))) {
+                return func(entity);
+            }
+            return true;
+        };
+
+        if (_block != nullptr) {
+            // The index is by name, entities of a replaced block with the same name are skipped
+            return _snapshot->eachInBlockWhile(_block, [this, &filter](const entity::CADEntity_CSPtr& entity) {
+                return entity->block() != _block || filter(entity);
+            });
+        }
+        else if (_hasArea) {
+            return _snapshot->eachWithinAndCrossingAreaWhile(_area, filter);
+        }
+        else {
+            return _snapshot->eachInModelSpaceWhile(filter);
+        }
+    }
+
+    /**
+     * @return number of matching entities
+     */
+    size_t count() const;
+
+    /**
+     * @return matching entities
+     */
+    std::vector<entity::CADEntity_CSPtr> asVector() const;
+
+    /**
+     * @return IDs of the matching entities
+     */
+    std::vector<ID_DATATYPE> ids() const;
+
+private:
+    DocumentSnapshot_CSPtr _snapshot;
+    geo::Area _area;
+    bool _hasArea;
+    meta::Layer_CSPtr _layer;
+    meta::Block_CSPtr _block;
+};
+
+DECLARE_SHORT_SHARED_PTR(EntityQuery)
+}
+}
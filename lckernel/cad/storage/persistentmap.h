@@ -0,0 +1,483 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "cad/tools/bits.h"
+
+namespace lc {
+namespace storage {
+/**
+ * @brief Source of edit tokens for the persistent containers
+ * Each node of a persistent container is tagged with the token of the container which created it.
+ * A container only modifies in place the nodes tagged with its own token, other nodes are copied.
+ * Tokens are never reused.
+ */
+class EditToken {
+public:
+    static uint64_t next();
+};
+
+/**
+ * @brief Persistent hash map
+ * Hash array mapped trie with structural sharing. Copying a map is O(1) and both copies share all their nodes.
+ * A modification only copies the nodes on the path to the modified key, the other nodes are shared.
+ *
+ * Nodes created since the last copy are owned by the map and modified in place, so filling a map
+ * without taking copies in between costs about the same as a regular hash map.
+ *
+ * A map can be read from multiple threads as long as no thread modifies that map object.
+ * Copies can be modified independently.
+ */
+template<typename K, typename V, typename Hash = std::hash<K>>
+class PersistentMap {
+public:
+    PersistentMap() :
+        _size(0),
+        _edit(EditToken::next()) {
+    }
+
+    PersistentMap(const PersistentMap& other) :
+        _root(other._root),
+        _size(other._size),
+        _edit(EditToken::next()) {
+        // Nodes are now shared, none of the maps can modify them in place anymore
+        other._edit = EditToken::next();
+    }
+
+    PersistentMap& operator=(const PersistentMap& other) {
+        if (this != &other) {
+            _root = other._root;
+            _size = other._size;
+            _edit = EditToken::next();
+            other._edit = EditToken::next();
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Insert or replace a value
+     */
+    void insert(const K& key, V value) {
+        bool added = false;
+        _root = assoc(_root, 0, Hash()(key), key, std::move(value), added);
+
+        if (added) {
+            _size++;
+        }
+    }
+
+    /**
+     * @brief Remove a value
+     * @return true if the key was present
+     */
+    bool erase(const K& key) {
+        bool removed = false;
+        _root = dissoc(_root, 0, Hash()(key), key, removed);
+
+        if (removed) {
+            _size--;
+        }
+
+        return removed;
+    }
+
+    /**
+     * @brief Find a value
+     * @return pointer to the value or nullptr when the key isn't present
+     */
+    const V* find(const K& key) const {
+        auto hash = Hash()(key);
+        const Node* node = _root.get();
+        unsigned int shift = 0;
+
+        while (node != nullptr) {
+            if (shift >= HASH_BITS) {
+                for (const auto& entry : node->entries) {
+                    if (entry.key == key) {
+                        return &entry.value;
+                    }
+                }
+                return nullptr;
+            }
+
+            auto bit = bitFor(hash, shift);
+            if ((node->bitmap & bit) == 0) {
+                return nullptr;
+            }
+
+            const auto& entry = node->entries[index(node->bitmap, bit)];
+            if (entry.child) {
+                node = entry.child.get();
+                shift += BITS;
+            }
+            else {
+                return entry.key == key ? &entry.value : nullptr;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @return number of values in the map
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @brief Call func(key, value) for each value of the map, in no particular order
+     */
+    template<typename F>
+    void each(F func) const {
+        eachWhile([&func](const K& key, const V& value) {
+            func(key, value);
+            return true;
+        });
+    }
+
+    /**
+     * @brief Call func(key, value) for each value of the map until it returns false
+     * @return false if func stopped the iteration
+     */
+    template<typename F>
+    bool eachWhile(F func) const {
+        return !_root || eachWhile(*_root, func);
+    }
+
+    /**
+     * @brief Call func(key, oldValue, newValue) for each key which differs between previous and this map
+     * oldValue is nullptr for added keys, newValue is nullptr for removed keys.
+     * Nodes shared by both maps are skipped, so comparing a map with an older copy costs about the size of the change.
+     * Values are compared with ==.
+     */
+    template<typename F>
+    void diff(const PersistentMap& previous, F func) const {
+        diff(previous._root.get(), _root.get(), 0, func);
+    }
+
+private:
+    struct Node;
+    using Node_SPtr = std::shared_ptr<Node>;
+
+    /**
+     * A slot of a node, holds either a key/value pair or a sub node
+     */
+    struct Entry {
+        K key;
+        V value;
+        Node_SPtr child;
+    };
+
+    /**
+     * Bitmap indexed node, only the slots in use are stored.
+     * Nodes below the last hash level hold colliding keys in a plain list.
+     */
+    struct Node {
+        uint64_t edit;
+        uint32_t bitmap;
+        std::vector<Entry> entries;
+    };
+
+    static const unsigned int BITS = 5;
+    static const unsigned int HASH_BITS = std::numeric_limits<size_t>::digits;
+
+    static uint32_t bitFor(size_t hash, unsigned int shift) {
+        return 1u << ((hash >> shift) & ((1u << BITS) - 1));
+    }
+
+    static size_t index(uint32_t bitmap, uint32_t bit) {
+        return tools::Bits::count(bitmap & (bit - 1));
+    }
+
+    Node_SPtr newNode() const {
+        auto node = std::make_shared<Node>();
+        node->edit = _edit;
+        node->bitmap = 0;
+        return node;
+    }
+
+    /**
+     * Return the node itself when it's owned by this map, a copy otherwise
+     */
+    Node_SPtr editable(const Node_SPtr& node) const {
+        if (node->edit == _edit) {
+            return node;
+        }
+
+        auto copy = std::make_shared<Node>(*node);
+        copy->edit = _edit;
+        return copy;
+    }
+
+    Node_SPtr assoc(const Node_SPtr& node, unsigned int shift, size_t hash, const K& key, V&& value, bool& added) {
+        if (shift >= HASH_BITS) {
+            auto n = node ? editable(node) : newNode();
+
+            for (auto& entry : n->entries) {
+                if (entry.key == key) {
+                    entry.value = std::move(value);
+                    return n;
+                }
+            }
+
+            n->entries.push_back(Entry{key, std::move(value), nullptr});
+            added = true;
+            return n;
+        }
+
+        auto bit = bitFor(hash, shift);
+
+        if (!node || (node->bitmap & bit) == 0) {
+            auto n = node ? editable(node) : newNode();
+            n->entries.insert(n->entries.begin() + index(n->bitmap, bit), Entry{key, std::move(value), nullptr});
+            n->bitmap |= bit;
+            added = true;
+            return n;
+        }
+
+        auto idx = index(node->bitmap, bit);
+        const auto& entry = node->entries[idx];
+
+        if (entry.child) {
+            auto child = assoc(entry.child, shift + BITS, hash, key, std::move(value), added);
+            if (child == entry.child) {
+                return node;
+            }
+
+            auto n = editable(node);
+            n->entries[idx].child = std::move(child);
+            return n;
+        }
+
+        if (entry.key == key) {
+            auto n = editable(node);
+            n->entries[idx].value = std::move(value);
+            return n;
+        }
+
+        // Two keys share this slot, move both in a sub node
+        bool subAdded = false;
+        Node_SPtr sub;
+        V existingValue = entry.value;
+        sub = assoc(sub, shift + BITS, Hash()(entry.key), entry.key, std::move(existingValue), subAdded);
+        sub = assoc(sub, shift + BITS, hash, key, std::move(value), added);
+
+        auto n = editable(node);
+        n->entries[idx] = Entry{K(), V(), std::move(sub)};
+        return n;
+    }
+
+    Node_SPtr dissoc(const Node_SPtr& node, unsigned int shift, size_t hash, const K& key, bool& removed) {
+        if (!node) {
+            return node;
+        }
+
+        if (shift >= HASH_BITS) {
+            for (size_t i = 0; i < node->entries.size(); i++) {
+                if (node->entries[i].key == key) {
+                    auto n = editable(node);
+                    n->entries.erase(n->entries.begin() + i);
+                    removed = true;
+                    return n->entries.empty() ? nullptr : n;
+                }
+            }
+
+            return node;
+        }
+
+        auto bit = bitFor(hash, shift);
+        if ((node->bitmap & bit) == 0) {
+            return node;
+        }
+
+        auto idx = index(node->bitmap, bit);
+        const auto& entry = node->entries[idx];
+
+        if (entry.child) {
+            auto child = dissoc(entry.child, shift + BITS, hash, key, removed);
+            if (!removed || child == entry.child) {
+                return node;
+            }
+
+            auto n = editable(node);
+            if (!child) {
+                n->entries.erase(n->entries.begin() + idx);
+                n->bitmap &= ~bit;
+            }
+            else if (shift + BITS < HASH_BITS && child->entries.size() == 1 && !child->entries[0].child) {
+                // Keep the trie compact by pulling a lone key/value pair up
+                n->entries[idx] = child->entries[0];
+            }
+            else {
+                n->entries[idx].child = std::move(child);
+            }
+
+            return n->entries.empty() ? nullptr : n;
+        }
+
+        if (!(entry.key == key)) {
+            return node;
+        }
+
+        auto n = editable(node);
+        n->entries.erase(n->entries.begin() + idx);
+        n->bitmap &= ~bit;
+        removed = true;
+        return n->entries.empty() ? nullptr : n;
+    }
+
+    template<typename F>
+    static bool eachWhile(const Node& node, F& func) {
+        for (const auto& entry : node.entries) {
+            if (entry.child ? !eachWhile(*entry.child, func) : !func(entry.key, entry.value)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<typename F>
+    static void diff(const Node* oldNode, const Node* newNode, unsigned int shift, F& func) {
+        if (oldNode == newNode) {
+            return;
+        }
+
+        if (oldNode == nullptr) {
+            auto added = [&func](const K& key, const V& value) {
+                func(key, static_cast<const V*>(nullptr), &value);
+                return true;
+            };
+            eachWhile(*newNode, added);
+            return;
+        }
+
+        if (newNode == nullptr) {
+            auto removed = [&func](const K& key, const V& value) {
+                func(key, &value, static_cast<const V*>(nullptr));
+                return true;
+            };
+            eachWhile(*oldNode, removed);
+            return;
+        }
+
+        if (shift >= HASH_BITS) {
+            diffLists(*oldNode, *newNode, func);
+            return;
+        }
+
+        auto bitmap = oldNode->bitmap | newNode->bitmap;
+        while (bitmap != 0) {
+            auto bit = bitmap & (~bitmap + 1);
+            bitmap &= ~bit;
+
+            auto oldEntry = (oldNode->bitmap & bit) ? &oldNode->entries[index(oldNode->bitmap, bit)] : nullptr;
+            auto newEntry = (newNode->bitmap & bit) ? &newNode->entries[index(newNode->bitmap, bit)] : nullptr;
+
+            if (oldEntry != nullptr && newEntry != nullptr && oldEntry->child && newEntry->child) {
+                diff(oldEntry->child.get(), newEntry->child.get(), shift + BITS, func);
+            }
+            else if (oldEntry != nullptr && newEntry != nullptr && !oldEntry->child && !newEntry->child &&
+                     oldEntry->key == newEntry->key) {
+                if (!(oldEntry->value == newEntry->value)) {
+                    func(oldEntry->key, &oldEntry->value, &newEntry->value);
+                }
+            }
+            else {
+                // A key and a sub node, or two different keys, in the same slot
+                diffEntries(oldEntry, newEntry, func);
+            }
+        }
+    }
+
+    /**
+     * Compare the content of two slots of which the shapes differ.
+     * At least one of them is a single key or empty, the cost is linear in the size of the other one.
+     */
+    template<typename F>
+    static void diffEntries(const Entry* oldEntry, const Entry* newEntry, F& func) {
+        std::vector<const Entry*> oldEntries;
+        std::vector<const Entry*> newEntries;
+        collect(oldEntry, oldEntries);
+        collect(newEntry, newEntries);
+        diffEntries(oldEntries, newEntries, func);
+    }
+
+    /**
+     * Compare two lists of colliding keys
+     */
+    template<typename F>
+    static void diffLists(const Node& oldNode, const Node& newNode, F& func) {
+        std::vector<const Entry*> oldEntries;
+        std::vector<const Entry*> newEntries;
+        collect(oldNode, oldEntries);
+        collect(newNode, newEntries);
+        diffEntries(oldEntries, newEntries, func);
+    }
+
+    template<typename F>
+    static void diffEntries(const std::vector<const Entry*>& oldEntries, const std::vector<const Entry*>& newEntries, F& func) {
+        std::vector<bool> matched(newEntries.size(), false);
+
+        for (auto oldEntry : oldEntries) {
+            bool found = false;
+
+            for (size_t i = 0; i < newEntries.size(); i++) {
+                if (!matched[i] && newEntries[i]->key == oldEntry->key) {
+                    matched[i] = true;
+                    found = true;
+
+                    if (!(oldEntry->value == newEntries[i]->value)) {
+                        func(oldEntry->key, &oldEntry->value, &newEntries[i]->value);
+                    }
+                    break;
+                }
+            }
+
+            if (!found) {
+                func(oldEntry->key, &oldEntry->value, static_cast<const V*>(nullptr));
+            }
+        }
+
+        for (size_t i = 0; i < newEntries.size(); i++) {
+            if (!matched[i]) {
+                func(newEntries[i]->key, static_cast<const V*>(nullptr), &newEntries[i]->value);
+            }
+        }
+    }
+
+    static void collect(const Entry* entry, std::vector<const Entry*>& entries) {
+        if (entry == nullptr) {
+            return;
+        }
+
+        if (entry->child) {
+            collect(*entry->child, entries);
+        }
+        else {
+            entries.push_back(entry);
+        }
+    }
+
+    static void collect(const Node& node, std::vector<const Entry*>& entries) {
+        for (const auto& entry : node.entries) {
+            collect(&entry, entries);
+        }
+    }
+
+    Node_SPtr _root;
+    size_t _size;
+    mutable std::atomic<uint64_t> _edit;
+};
+}
+}
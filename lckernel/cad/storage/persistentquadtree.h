@@ -0,0 +1,351 @@
+#pragma once
+
+#include <array>
+#include <climits>
+#include <memory>
+#include <vector>
+#include "cad/geometry/geoarea.h"
+#include "cad/storage/persistentmap.h"
+
+namespace lc {
+namespace storage {
+/**
+ * @brief Persistent quad tree
+ * Same layout as QuadTree, but nodes are shared between copies of the tree.
+ * Copying a tree is O(1), inserting or erasing an entity copies the nodes on the path to that entity only.
+ * Nodes created since the last copy are modified in place, see PersistentMap.
+ *
+ * The tree doesn't keep an ID cache, erase() must be called with the entity as stored in the tree
+ * so it can be located using its bounding box.
+ */
+template<typename E>
+class PersistentQuadTree {
+public:
+    PersistentQuadTree(const geo::Area& bounds, short maxLevels = 10, short maxObjects = 25) :
+        _bounds(bounds),
+        _maxLevels(maxLevels),
+        _maxObjects(maxObjects),
+        _size(0),
+        _edit(EditToken::next()) {
+    }
+
+    PersistentQuadTree(const PersistentQuadTree& other) :
+        _root(other._root),
+        _bounds(other._bounds),
+        _maxLevels(other._maxLevels),
+        _maxObjects(other._maxObjects),
+        _size(other._size),
+        _edit(EditToken::next()) {
+        other._edit = EditToken::next();
+    }
+
+    PersistentQuadTree& operator=(const PersistentQuadTree& other) {
+        if (this != &other) {
+            _root = other._root;
+            _bounds = other._bounds;
+            _maxLevels = other._maxLevels;
+            _maxObjects = other._maxObjects;
+            _size = other._size;
+            _edit = EditToken::next();
+            other._edit = EditToken::next();
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief insert
+     * Insert entity into the quad tree
+     */
+    void insert(const E& entity) {
+        if (!_root) {
+            _root = newNode(0, _bounds);
+        }
+
+        _root = insert(_root, entity, entity->boundingBox());
+        _size++;
+    }
+
+    /**
+     * @brief erase
+     * Remove entity from the quad tree
+     * @return true if the entity was found
+     */
+    bool erase(const E& entity) {
+        if (!_root) {
+            return false;
+        }
+
+        bool removed = false;
+        _root = erase(_root, entity, entity->boundingBox(), removed);
+
+        if (removed) {
+            _size--;
+        }
+
+        return removed;
+    }
+
+    /**
+     * @brief retrieve
+     * all object's located in the nodes overlapping a given area
+     * The result can hold entities outside the area, the caller is expected to filter them.
+     */
+    std::vector<E> retrieve(const geo::Area& area) const {
+        std::vector<E> list;
+        if (_root) {
+            retrieve(*_root, list, &area);
+        }
+        return list;
+    }
+
+    /**
+     * @brief retrieve
+     * all object's within the tree
+     */
+    std::vector<E> retrieve() const {
+        std::vector<E> list;
+        list.reserve(_size);
+        if (_root) {
+            retrieve(*_root, list, nullptr);
+        }
+        return list;
+    }
+
+    /**
+     * @brief Call func(entity) for each object located in the nodes overlapping a given area
+     * Same objects as retrieve(area), without building a list.
+     */
+    template<typename F>
+    void each(const geo::Area& area, F func) const {
+        eachWhile(area, [&func](const E& object) {
+            func(object);
+            return true;
+        });
+    }
+
+    /**
+     * @brief Call func(entity) for each object located in the nodes overlapping a given area, until it returns false
+     * @return false if func stopped the iteration
+     */
+    template<typename F>
+    bool eachWhile(const geo::Area& area, F func) const {
+        return !_root || eachWhile(*_root, func, &area);
+    }
+
+    /**
+     * @brief Call func(entity) for each object within the tree
+     */
+    template<typename F>
+    void each(F func) const {
+        eachWhile([&func](const E& object) {
+            func(object);
+            return true;
+        });
+    }
+
+    /**
+     * @brief Call func(entity) for each object within the tree until it returns false
+     * @return false if func stopped the iteration
+     */
+    template<typename F>
+    bool eachWhile(F func) const {
+        return !_root || eachWhile(*_root, func, nullptr);
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    geo::Area bounds() const {
+        return _bounds;
+    }
+
+private:
+    struct Node;
+    using Node_SPtr = std::shared_ptr<Node>;
+
+    struct Node {
+        uint64_t edit;
+        short level;
+        geo::Area bounds;
+        std::vector<E> objects;
+        std::array<Node_SPtr, 4> nodes;
+    };
+
+    Node_SPtr newNode(short level, const geo::Area& bounds) const {
+        auto node = std::make_shared<Node>(Node{_edit, level, bounds, {}, {}});
+        return node;
+    }
+
+    Node_SPtr editable(const Node_SPtr& node) const {
+        if (node->edit == _edit) {
+            return node;
+        }
+
+        auto copy = std::make_shared<Node>(*node);
+        copy->edit = _edit;
+        return copy;
+    }
+
+    Node_SPtr insert(const Node_SPtr& node, const E& entity, const geo::Area& boundingBox) {
+        auto n = editable(node);
+
+        if (n->nodes[0]) {
+            short index = quadrantIndex(*n, boundingBox);
+
+            if (index != -1) {
+                n->nodes[index] = insert(n->nodes[index], entity, boundingBox);
+                return n;
+            }
+        }
+
+        n->objects.push_back(entity);
+
+        if (!n->nodes[0] && n->objects.size() >= _maxObjects && n->level < _maxLevels) {
+            split(*n);
+
+            for (auto it = n->objects.begin(); it != n->objects.end();) {
+                auto objectBoundingBox = (*it)->boundingBox();
+                short index = quadrantIndex(*n, objectBoundingBox);
+
+                if (index != -1) {
+                    n->nodes[index] = insert(n->nodes[index], *it, objectBoundingBox);
+                    it = n->objects.erase(it);
+                }
+                else {
+                    it++;
+                }
+            }
+        }
+
+        return n;
+    }
+
+    Node_SPtr erase(const Node_SPtr& node, const E& entity, const geo::Area& boundingBox, bool& removed) {
+        if (node->nodes[0]) {
+            short index = quadrantIndex(*node, boundingBox);
+
+            if (index != -1) {
+                auto child = erase(node->nodes[index], entity, boundingBox, removed);
+
+                if (removed) {
+                    if (child == node->nodes[index]) {
+                        return node;
+                    }
+
+                    auto n = editable(node);
+                    n->nodes[index] = std::move(child);
+                    return n;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < node->objects.size(); i++) {
+            if (node->objects[i]->id() == entity->id()) {
+                auto n = editable(node);
+                n->objects.erase(n->objects.begin() + i);
+                removed = true;
+                return n;
+            }
+        }
+
+        return node;
+    }
+
+    static void retrieve(const Node& node, std::vector<E>& list, const geo::Area* area) {
+        if (node.nodes[0]) {
+            for (const auto& child : node.nodes) {
+                if (area == nullptr || includes(*child, *area)) {
+                    retrieve(*child, list, area);
+                }
+            }
+        }
+
+        list.insert(list.end(), node.objects.begin(), node.objects.end());
+    }
+
+    template<typename F>
+    static bool eachWhile(const Node& node, F& func, const geo::Area* area) {
+        if (node.nodes[0]) {
+            for (const auto& child : node.nodes) {
+                if ((area == nullptr || includes(*child, *area)) && !eachWhile(*child, func, area)) {
+                    return false;
+                }
+            }
+        }
+
+        for (const auto& object : node.objects) {
+            if (!func(object)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void split(Node& node) const {
+        const auto& b = node.bounds;
+        double subWidth = b.width() / 2.;
+        double subHeight = b.height() / 2.;
+        double x = b.minP().x();
+        double y = b.minP().y();
+        short level = node.level + 1;
+
+        node.nodes[0] = newNode(level, geo::Area(geo::Coordinate(x + subWidth, y + subHeight), b.maxP()));
+        node.nodes[1] = newNode(level, geo::Area(geo::Coordinate(x, y + subHeight), geo::Coordinate(x + subWidth, b.maxP().y())));
+        node.nodes[2] = newNode(level, geo::Area(geo::Coordinate(x, y), geo::Coordinate(x + subWidth, y + subHeight)));
+        node.nodes[3] = newNode(level, geo::Area(geo::Coordinate(x + subWidth, y), geo::Coordinate(b.maxP().x(), y + subHeight)));
+    }
+
+    /**
+     * @return quadrant in which the area fits or -1, same rules as QuadTreeSub
+     */
+    static short quadrantIndex(const Node& node, const geo::Area& pRect) {
+        const auto& b = node.bounds;
+        double verticalMidpoint = b.minP().x() + (b.width() / 2.);
+        double horizontalMidpoint = b.minP().y() + (b.height() / 2.);
+
+        bool topQuadrant = (pRect.minP().y() >= horizontalMidpoint) && (pRect.maxP().y() < b.maxP().y());
+        bool bottomQuadrant = (pRect.minP().y() > b.minP().y()) && (pRect.maxP().y() <= horizontalMidpoint);
+
+        if (!(topQuadrant || bottomQuadrant)) {
+            return -1;
+        }
+
+        bool leftQuadrant = (pRect.minP().x() > b.minP().x()) && (pRect.maxP().x() <= verticalMidpoint);
+        bool rightQuadrant = (pRect.minP().x() >= verticalMidpoint) && (pRect.maxP().x() < b.maxP().x());
+
+        if (!(leftQuadrant || rightQuadrant)) {
+            return -1;
+        }
+        else if (topQuadrant && rightQuadrant) {
+            return 0;
+        }
+        else if (topQuadrant && leftQuadrant) {
+            return 1;
+        }
+        else if (bottomQuadrant && leftQuadrant) {
+            return 2;
+        }
+
+        return 3;
+    }
+
+    static bool includes(const Node& node, const geo::Area& area) {
+        const auto& b = node.bounds;
+        return !(area.maxP().x() <= b.minP().x() ||
+                 area.minP().x() >= b.maxP().x() ||
+                 area.maxP().y() <= b.minP().y() ||
+                 area.minP().y() >= b.maxP().y());
+    }
+
+    Node_SPtr _root;
+    geo::Area _bounds;
+    short _maxLevels;
+    unsigned short _maxObjects;
+    size_t _size;
+    mutable std::atomic<uint64_t> _edit;
+};
+}
+}
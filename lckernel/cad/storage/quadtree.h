@@ -11,6 +11,7 @@
 #include <typeinfo>
 #include <iostream>
 #include "cad/const.h"
+#include "cad/tools/profiler.h"
 
 namespace lc {
 namespace storage {
@@ -171,6 +172,7 @@ public:
      * @param area
      */
     std::vector<E> retrieve(const geo::Area& area, const short maxLevel = SHRT_MAX) const {
+        LC_PROFILE_ZONE("QuadTree::retrieve");
         std::vector<E> list;
         _retrieve(list, area, maxLevel);
         return list;
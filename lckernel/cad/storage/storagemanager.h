@@ -4,8 +4,10 @@
 #include "cad/base/cadentity.h"
 #include "cad/meta/layer.h"
 #include "cad/storage/entitycontainer.h"
+#include "cad/storage/documentsnapshot.h"
 #include <cad/tools/string_helper.h>
 #include <map>
+#include <typeindex>
 #include <cad/meta/dxflinepattern.h>
 
 namespace lc {
@@ -21,6 +23,13 @@ public:
      */
     virtual void insertEntity(entity::CADEntity_CSPtr) = 0;
 
+    /**
+     * @brief insertEntities
+     * Insert a set of entities in one pass
+     * \param std::vector<entity::CADEntity_CSPtr>
+     */
+    virtual void insertEntities(const std::vector<entity::CADEntity_CSPtr>&) = 0;
+
     /**
      * @brief insertEntityContainer
      * \param EntityContainer<entity::CADEntity_CSPtr>
@@ -50,6 +59,13 @@ public:
 
     virtual EntityContainer <entity::CADEntity_CSPtr> entitiesByBlock(meta::Block_CSPtr block) const = 0;
 
+    /**
+     * @brief Returns entities of the model space by type
+     * @param type type of the entities, for example typeid(entity::Line)
+     * @return EntityContainer<entity::CADEntity_CSPtr> entities of this type
+     */
+    virtual EntityContainer <entity::CADEntity_CSPtr> entitiesByType(const std::type_index& type) const = 0;
+
     /**
     * @brief returns layer By Name
     * @param layerName
@@ -80,6 +96,13 @@ public:
      */
     virtual EntityContainer <entity::CADEntity_CSPtr>& entityContainer() = 0;
 
+    /*!
+     * \brief snapshot
+     * Immutable copy of the current content, see DocumentSnapshot
+     * \return
+     */
+    virtual DocumentSnapshot_CSPtr snapshot() const = 0;
+
     /**
     *  \brief add a document meta type
     *  \param layer layer to be added.
@@ -7,61 +7,135 @@ StorageManagerImpl::StorageManagerImpl() : StorageManager() {
 }
 
 void StorageManagerImpl::insertEntity(entity::CADEntity_CSPtr entity) {
+    _snapshot.insertEntity(entity);
+
+    auto container = &_entities;
     if (entity->block() != nullptr) {
-        auto it = _blocksEntities.find(entity->block()->name());
-
-        if (it == _blocksEntities.end()) {
-            EntityContainer<entity::CADEntity_CSPtr> ec;
-            ec.insert(entity);
-            _blocksEntities.insert(std::pair<std::string, EntityContainer<entity::CADEntity_CSPtr>>(
-                                       entity->block()->name(),
-                                       ec
-                                   ));
-        }
-        else {
-            it->second.insert(entity);
-        }
-    }
-    else {
-        _entities.insert(entity);
+        container = &_blocksEntities[entity->block()->name()];
     }
+
+    container->insert(entity);
+    addToIndexes(entity, container);
 }
 
-void StorageManagerImpl::removeEntity(entity::CADEntity_CSPtr entity) {
-    if (entity->block() != nullptr)
-    {
-        auto it = _blocksEntities.find(entity->block()->name());
+void StorageManagerImpl::insertEntities(const std::vector<entity::CADEntity_CSPtr>& entities) {
+    // Entities of a same block usually follow each other, keep the last container to avoid a lookup per entity
+    meta::Block_CSPtr lastBlock;
+    EntityContainer<entity::CADEntity_CSPtr>* container = &_entities;
+    _entityLocations.reserve(_entityLocations.size() + entities.size());
 
-        if (it == _blocksEntities.end()) {
-            // nothing
-        }
-        else {
-            it->second.remove(entity);
+    for (const auto& entity : entities) {
+        _snapshot.insertEntity(entity);
+
+        if (entity->block() != lastBlock) {
+            lastBlock = entity->block();
+
+            if (lastBlock == nullptr) {
+                container = &_entities;
+            }
+            else {
+                container = &_blocksEntities[lastBlock->name()];
+            }
         }
+
+        container->insert(entity);
+        addToIndexes(entity, container);
+    }
+}
+
+void StorageManagerImpl::removeEntity(entity::CADEntity_CSPtr entity) {
+    auto location = _entityLocations.find(entity->id());
+    if (location == _entityLocations.end()) {
+        return;
     }
 
+    // The indexes must be updated with the stored entity, the given one can be a newer version with another layer
+    auto container = location->second;
+    auto stored = container->entityByID(entity->id());
 
-    else
-        _entities.remove(entity);
+    _snapshot.removeEntity(entity);
+    removeFromIndexes(stored, container);
+    _entityLocations.erase(location);
+    container->remove(stored);
 }
 
 void StorageManagerImpl::insertEntityContainer(const EntityContainer<entity::CADEntity_CSPtr>& entities) {
     _entities.combine(entities);
+
+    for (const auto& entity : entities.asVector(std::numeric_limits<short>::max())) {
+        _snapshot.insertEntity(entity);
+        addToIndexes(entity, &_entities);
+    }
     /// @todo add metadata types where they do not exists
 }
 
 entity::CADEntity_CSPtr StorageManagerImpl::entityByID(ID_DATATYPE id) const {
-    //check for block
-    for(auto &it: _blocksEntities) {
-        auto out = it.second.entityByID(id);
-        if(out)
-            return out;
+    auto location = _entityLocations.find(id);
+    if (location == _entityLocations.end()) {
+        return nullptr;
     }
-    return _entities.entityByID(id);
+
+    return location->second->entityByID(id);
 }
 
 EntityContainer<entity::CADEntity_CSPtr> StorageManagerImpl::entitiesByLayer(meta::Layer_CSPtr layer) const {
-    return _entities.entitiesByLayer(layer);
+    EntityContainer<entity::CADEntity_CSPtr> container;
+
+    auto it = _entitiesByLayer.find(layer);
+    if (it != _entitiesByLayer.end()) {
+        for (const auto& entity : it->second) {
+            container.insert(entity.second);
+        }
+    }
+
+    return container;
+}
+
+EntityContainer<entity::CADEntity_CSPtr> StorageManagerImpl::entitiesByType(const std::type_index& type) const {
+    EntityContainer<entity::CADEntity_CSPtr> container;
+
+    auto it = _entitiesByType.find(type);
+    if (it != _entitiesByType.end()) {
+        for (const auto& entity : it->second) {
+            container.insert(entity.second);
+        }
+    }
+
+    return container;
+}
+
+void StorageManagerImpl::addToIndexes(const entity::CADEntity_CSPtr& entity,
+                                      EntityContainer<entity::CADEntity_CSPtr>* container) {
+    _entityLocations[entity->id()] = container;
+
+    // Layer and type indexes cover the model space, like the containers they replace
+    if (container == &_entities) {
+        _entitiesByLayer[entity->layer()][entity->id()] = entity;
+        _entitiesByType[typeid(*entity)][entity->id()] = entity;
+    }
+}
+
+void StorageManagerImpl::removeFromIndexes(const entity::CADEntity_CSPtr& entity,
+                                           EntityContainer<entity::CADEntity_CSPtr>* container) {
+    if (container != &_entities || entity == nullptr) {
+        return;
+    }
+
+    auto layer = _entitiesByLayer.find(entity->layer());
+    if (layer != _entitiesByLayer.end()) {
+        layer->second.erase(entity->id());
+        if (layer->second.empty()) {
+            _entitiesByLayer.erase(layer);
+        }
+    }
+
+    auto type = _entitiesByType.find(typeid(*entity));
+    if (type != _entitiesByType.end()) {
+        type->second.erase(entity->id());
+        if (type->second.empty()) {
+            _entitiesByType.erase(type);
+        }
+    }
 }
 
 
@@ -93,6 +167,10 @@ EntityContainer<entity::CADEntity_CSPtr> & StorageManagerImpl::entityContainer()
     return _entities;
 }
 
+DocumentSnapshot_CSPtr StorageManagerImpl::snapshot() const {
+    return std::make_shared<const DocumentSnapshot>(_snapshot);
+}
+
 void StorageManagerImpl::optimise() {
     _entities.optimise();
     for (auto ec : _blocksEntities) {
@@ -101,12 +179,15 @@ void StorageManagerImpl::optimise() {
 }
 
 void StorageManagerImpl::addDocumentMetaType(meta::DocumentMetaType_CSPtr dmt) {
-    _documentMetaData.emplace(std::make_pair(dmt->id(), dmt));
+    if (_documentMetaData.emplace(std::make_pair(dmt->id(), dmt)).second) {
+        _snapshot.addDocumentMetaType(dmt);
+    }
 }
 
 
 void StorageManagerImpl::removeDocumentMetaType(meta::DocumentMetaType_CSPtr dmt) {
     _documentMetaData.erase(dmt->id());
+    _snapshot.removeDocumentMetaType(dmt);
 }
 
 
@@ -114,6 +195,7 @@ void StorageManagerImpl::replaceDocumentMetaType(meta::DocumentMetaType_CSPtr ol
     if (oldDmt->id() == newDmt->id()) {
         _documentMetaData.erase(oldDmt->id());
         _documentMetaData.emplace(std::make_pair(newDmt->id(), newDmt));
+        _snapshot.addDocumentMetaType(newDmt);
     } else {
         // LOG4CXX_DEBUG(logger, "Layer names are not equal, no replacement was performed");
     }
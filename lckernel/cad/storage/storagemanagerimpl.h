@@ -15,6 +15,8 @@
 #include "cad/meta/dxflinepattern.h"
 #include "cad/tools/string_helper.h"
 #include <map>
+#include <typeindex>
+#include <unordered_map>
 #include <utility>
 #include <string>
 
@@ -37,15 +39,18 @@ public:
     virtual ~StorageManagerImpl() = default;
 
     void insertEntity(entity::CADEntity_CSPtr) override;
+    void insertEntities(const std::vector<entity::CADEntity_CSPtr>&) override;
     void removeEntity(entity::CADEntity_CSPtr) override;
     void insertEntityContainer(const EntityContainer <entity::CADEntity_CSPtr>&) override;
     entity::CADEntity_CSPtr entityByID(ID_DATATYPE id) const override;
     EntityContainer<entity::CADEntity_CSPtr> entitiesByLayer(const meta::Layer_CSPtr layer) const override;
+    EntityContainer<entity::CADEntity_CSPtr> entitiesByType(const std::type_index& type) const override;
     meta::Layer_CSPtr layerByName(const std::string& layerName) const override;
     meta::Block_CSPtr blockByName(const std::string& blockName) const override;
     meta::DxfLinePatternByValue_CSPtr linePatternByName(const std::string& linePatternName) const override;
     std::map<std::string, meta::Layer_CSPtr> allLayers() const override;
     EntityContainer <entity::CADEntity_CSPtr>& entityContainer() override;
+    DocumentSnapshot_CSPtr snapshot() const override;
     void addDocumentMetaType(meta::DocumentMetaType_CSPtr dmt) override;
     void removeDocumentMetaType(meta::DocumentMetaType_CSPtr dmt) override;
     void replaceDocumentMetaType(meta::DocumentMetaType_CSPtr oldDmt, meta::DocumentMetaType_CSPtr newDmt) override;
@@ -56,9 +61,28 @@ public:
 private:
     meta::DocumentMetaType_CSPtr _metaDataTypeByName(const std::string& id) const override;
 
+    /**
+     * @brief Register an entity stored in the given container in the secondary indexes
+     */
+    void addToIndexes(const entity::CADEntity_CSPtr& entity, EntityContainer<entity::CADEntity_CSPtr>* container);
+
+    /**
+     * @brief Remove a stored entity from the secondary indexes, except the location index
+     */
+    void removeFromIndexes(const entity::CADEntity_CSPtr& entity, EntityContainer<entity::CADEntity_CSPtr>* container);
+
     EntityContainer <entity::CADEntity_CSPtr> _entities;
     std::map<std::string, meta::DocumentMetaType_CSPtr, tools::StringHelper::cmpCaseInsensetive> _documentMetaData;
     std::map<std::string, EntityContainer<entity::CADEntity_CSPtr> > _blocksEntities;
+
+    // Secondary indexes, updated on each insert and remove
+    // Containers of _blocksEntities are never removed, so their address is stable
+    std::unordered_map<ID_DATATYPE, EntityContainer<entity::CADEntity_CSPtr>*> _entityLocations;
+    std::unordered_map<meta::Layer_CSPtr, std::unordered_map<ID_DATATYPE, entity::CADEntity_CSPtr>> _entitiesByLayer;
+    std::unordered_map<std::type_index, std::unordered_map<ID_DATATYPE, entity::CADEntity_CSPtr>> _entitiesByType;
+
+    // Kept in sync with the containers above, copies of it are handed out by snapshot()
+    DocumentSnapshot _snapshot;
 };
 }
 }
@@ -1,14 +1,18 @@
 #include "undomanagerimpl.h"
 
+#include "cad/base/cadentity.h"
 #include "cad/operations/documentoperation.h"
 #include "cad/operations/undoable.h"
+#include "cad/storage/document.h"
 #include <nano-signal-slot/nano_signal_slot.hpp>
 
 using namespace lc;
 using namespace lc::storage;
 
-UndoManagerImpl::UndoManagerImpl(unsigned int maximumUndoLevels) :
-    _maximumUndoLevels(maximumUndoLevels) {
+UndoManagerImpl::UndoManagerImpl(unsigned int maximumUndoLevels, size_t maximumBytes) :
+    _maximumUndoLevels(maximumUndoLevels),
+    _maximumBytes(maximumBytes),
+    _memoryUsage(0) {
 }
 
 void UndoManagerImpl::on_CommitProcessEvent(const event::CommitProcessEvent& event) {
@@ -17,24 +21,19 @@ void UndoManagerImpl::on_CommitProcessEvent(const event::CommitProcessEvent& eve
     if (undoable != nullptr) {
         // // LOG4CXX_DEBUG(logger, "Process: " + undoable->text());
 
-        // Check if Redo is possible, if so we might need to purge objects from memory
+        // Check if Redo is possible, if so we need to purge objects from memory
         // as long as we can redo, purge these objects
         while (canRedo()) {
-            operation::Undoable_SPtr undoable = _reDoables.top();
+            release(_reDoables.top());
             _reDoables.pop();
-            // Need to get a list of absolute entities, they are all entities that are created in the _reDoables list
-            // document()->absolueteEntity(entity);
         }
 
         // Add undoable to stack
         _unDoables.push_back(undoable);
+        retain(undoable);
 
         // Remove old undoables
-        if (_unDoables.size() > this->_maximumUndoLevels) {
-            // Need to get a list of absolute entities, they are all entities that are deleted in the _unDoables list
-            // document()->absolueteEntity(entity);
-            _unDoables.erase(_unDoables.begin(), _unDoables.begin() + 1);
-        }
+        trim();
     }
 }
 
@@ -43,7 +42,7 @@ void UndoManagerImpl::redo() {
     if (canRedo()) {
         operation::Undoable_SPtr undoable = _reDoables.top();
         _reDoables.pop();
-        undoable->redo();
+        redo(undoable);
         _unDoables.push_back(undoable);
     }
 }
@@ -51,11 +50,34 @@ void UndoManagerImpl::undo() {
     if (canUndo()) {
         operation::Undoable_SPtr undoable = _unDoables.back();
         _unDoables.pop_back();
-        undoable->undo();
+        undo(undoable);
         _reDoables.push(undoable);
     }
 }
 
+void UndoManagerImpl::undo(const operation::Undoable_SPtr& undoable) {
+    // Document operations are undone by their document so it can lock itself and publish a new snapshot
+    auto documentOperation = std::dynamic_pointer_cast<operation::DocumentOperation>(undoable);
+
+    if (documentOperation != nullptr && documentOperation->document() != nullptr) {
+        documentOperation->document()->undoOperation(documentOperation);
+    }
+    else {
+        undoable->undo();
+    }
+}
+
+void UndoManagerImpl::redo(const operation::Undoable_SPtr& undoable) {
+    auto documentOperation = std::dynamic_pointer_cast<operation::DocumentOperation>(undoable);
+
+    if (documentOperation != nullptr && documentOperation->document() != nullptr) {
+        documentOperation->document()->redoOperation(documentOperation);
+    }
+    else {
+        undoable->redo();
+    }
+}
+
 bool UndoManagerImpl::canRedo() const {
     return !_reDoables.empty();
 }
@@ -69,4 +91,55 @@ void UndoManagerImpl::removeUndoables() {
     while (!_reDoables.empty()) {
         _reDoables.pop();
     }
+
+    _entityReferences.clear();
+    _memoryUsage = 0;
+}
+
+size_t UndoManagerImpl::memoryUsage() const {
+    return _memoryUsage;
+}
+
+size_t UndoManagerImpl::maximumBytes() const {
+    return _maximumBytes;
+}
+
+void UndoManagerImpl::setMaximumBytes(size_t maximumBytes) {
+    _maximumBytes = maximumBytes;
+    trim();
+}
+
+size_t UndoManagerImpl::undoLevels() const {
+    return _unDoables.size();
+}
+
+void UndoManagerImpl::retain(const operation::Undoable_SPtr& undoable) {
+    _memoryUsage += undoable->memoryUsage();
+
+    undoable->retainedEntities([this](const entity::CADEntity_CSPtr& entity) {
+        if (_entityReferences[entity.get()]++ == 0) {
+            _memoryUsage += entity->memoryUsage();
+        }
+    });
+}
+
+void UndoManagerImpl::release(const operation::Undoable_SPtr& undoable) {
+    _memoryUsage -= undoable->memoryUsage();
+
+    undoable->retainedEntities([this](const entity::CADEntity_CSPtr& entity) {
+        auto it = _entityReferences.find(entity.get());
+
+        if (it != _entityReferences.end() && --it->second == 0) {
+            _memoryUsage -= entity->memoryUsage();
+            _entityReferences.erase(it);
+        }
+    });
+}
+
+void UndoManagerImpl::trim() {
+    while (_unDoables.size() > _maximumUndoLevels ||
+           (_unDoables.size() > 1 && _maximumBytes != 0 && _memoryUsage > _maximumBytes)) {
+        release(_unDoables.front());
+        _unDoables.pop_front();
+    }
 }
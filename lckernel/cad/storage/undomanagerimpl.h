@@ -1,7 +1,8 @@
 #pragma once
 
+#include <deque>
 #include <stack>
-#include <vector>
+#include <unordered_map>
 
 #include "cad/const.h"
 
@@ -15,11 +16,17 @@ namespace storage {
 /**
  * UndoManagerImpl manages a stack of operations and allows for
  * undo or re-do operations that where done on a canvas
+ *
+ * The history can be limited in number of levels and in bytes. The memory usage is an estimate based on
+ * Undoable::memoryUsage() and CADEntity::memoryUsage(). Entities kept by more than one operation, for example
+ * an entity added by one operation and modified by the next one, are only counted once.
+ * When a limit is exceeded the oldest undo levels are released.
  * @param maximumUndoLevels
+ * @param maximumBytes memory budget of the undo and redo history, 0 for no budget
  */
 class UndoManagerImpl : public UndoManager {
 public:
-    UndoManagerImpl(unsigned int maximumUndoLevels);
+    UndoManagerImpl(unsigned int maximumUndoLevels, size_t maximumBytes = 0);
 
     virtual ~UndoManagerImpl() = default;
 
@@ -66,10 +73,61 @@ public:
      */
     virtual void removeUndoables();
 
+    /*!
+     * \brief Estimated number of bytes used by the undo and redo history
+     */
+    size_t memoryUsage() const;
+
+    /*!
+     * \brief Memory budget of the undo and redo history, 0 when there is no budget
+     */
+    size_t maximumBytes() const;
+
+    /*!
+     * \brief Change the memory budget, old undo levels are released when the new budget is exceeded
+     * \param maximumBytes budget in bytes, 0 to disable
+     */
+    void setMaximumBytes(size_t maximumBytes);
+
+    /*!
+     * \brief Number of operations which can be undone
+     */
+    size_t undoLevels() const;
+
 private:
-    std::vector<operation::Undoable_SPtr> _unDoables; /*!< Undo list */
+    /*!
+     * \brief Undo a single operation, through its document when it has one
+     */
+    void undo(const operation::Undoable_SPtr& undoable);
+
+    /*!
+     * \brief Redo a single operation, through its document when it has one
+     */
+    void redo(const operation::Undoable_SPtr& undoable);
+
+    /*!
+     * \brief Add the memory used by an operation to the history
+     */
+    void retain(const operation::Undoable_SPtr& undoable);
+
+    /*!
+     * \brief Remove the memory used by an operation from the history
+     */
+    void release(const operation::Undoable_SPtr& undoable);
+
+    /*!
+     * \brief Release the oldest undo levels until the history is within its limits
+     * The memory budget never releases the last operation.
+     */
+    void trim();
+
+    std::deque<operation::Undoable_SPtr> _unDoables; /*!< Undo list */
     std::stack<operation::Undoable_SPtr> _reDoables; /*!< Redo stack */
     const unsigned int _maximumUndoLevels; /*!< Maximum undo level */
+    size_t _maximumBytes; /*!< Memory budget */
+
+    std::unordered_map<const entity::CADEntity*, unsigned int> _entityReferences; /*!< Number of operations keeping an entity */
+    size_t _memoryUsage; /*!< Estimated memory used by the history */
 
 public:
     void on_CommitProcessEvent(const lc::event::CommitProcessEvent& event);
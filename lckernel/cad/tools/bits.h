@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lc {
+namespace tools {
+/**
+ * @brief Bit operations using the compiler builtins when available
+ */
+class Bits {
+public:
+    /**
+     * @return number of bits set
+     */
+    static size_t count(uint64_t word);
+
+    /**
+     * @return index of the lowest bit set, word must not be 0
+     */
+    static unsigned int lowest(uint64_t word);
+};
+
+inline size_t Bits::count(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    size_t count = 0;
+    for(; word != 0; word &= word - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+inline unsigned int Bits::lowest(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctzll(word));
+#else
+    unsigned int bit = 0;
+    while((word & 1) == 0) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace lc {
+namespace tools {
+/**
+ * @brief FIFO queue with a maximum size, shared between producer and consumer threads
+ * push() blocks while the queue is full and pop() while it is empty, which keeps a fast producer
+ * from filling the memory. Closing the queue makes push() fail, the consumer can still pop what is left.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) :
+        _capacity(capacity),
+        _closed(false) {
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Add a value at the end of the queue, waits while the queue is full
+     * @return false if the queue was closed, value is then left untouched
+     */
+    bool push(T&& value) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock, [this]() {
+            return _closed || _values.size() < _capacity;
+        });
+
+        if (_closed) {
+            return false;
+        }
+
+        _values.push_back(std::move(value));
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Take the first value of the queue, waits while the queue is empty
+     * @return false if the queue is closed and empty
+     */
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notEmpty.wait(lock, [this]() {
+            return _closed || !_values.empty();
+        });
+
+        if (_values.empty()) {
+            return false;
+        }
+
+        value = std::move(_values.front());
+        _values.pop_front();
+        _notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Refuse new values and wake up all waiting threads
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+        _notFull.notify_all();
+        _notEmpty.notify_all();
+    }
+
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _closed;
+    }
+
+private:
+    const size_t _capacity;
+    bool _closed;
+    std::deque<T> _values;
+    mutable std::mutex _mutex;
+    std::condition_variable _notFull;
+    std::condition_variable _notEmpty;
+};
+}
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cad/base/id.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace lc {
+namespace tools {
+/**
+ * @brief Hash map from entity IDs to values
+ * Open addressing with linear probing in a flat array, the slots of consecutive IDs are spread by
+ * Fibonacci hashing. Removal shifts the following slots back, there are no tombstones.
+ * Unlike std::map::operator[], find() never inserts.
+ * Pointers returned by find() are valid until the next insertion or removal.
+ */
+template<typename V>
+class IDMap {
+public:
+    IDMap() :
+        _size(0),
+        _shift(64) {
+    }
+
+    /**
+     * @return pointer to the value, nullptr if the ID isn't in the map
+     */
+    V* find(ID_DATATYPE id) {
+        if(_size == 0) {
+            return nullptr;
+        }
+
+        for(size_t i = home(id);; i = next(i)) {
+            auto& slot = _slots[i];
+            if(!slot.used) {
+                return nullptr;
+            }
+            if(slot.id == id) {
+                return &slot.value;
+            }
+        }
+    }
+
+    const V* find(ID_DATATYPE id) const {
+        return const_cast<IDMap*>(this)->find(id);
+    }
+
+    bool contains(ID_DATATYPE id) const {
+        return find(id) != nullptr;
+    }
+
+    /**
+     * @brief Insert or replace a value
+     * @return true if the ID wasn't in the map
+     */
+    bool insert(ID_DATATYPE id, V value) {
+        if((_size + 1) * 4 > _slots.size() * 3) {
+            rehash(_slots.empty() ? 16 : _slots.size() * 2);
+        }
+
+        for(size_t i = home(id);; i = next(i)) {
+            auto& slot = _slots[i];
+            if(!slot.used) {
+                slot.used = true;
+                slot.id = id;
+                slot.value = std::move(value);
+                _size++;
+                return true;
+            }
+            if(slot.id == id) {
+                slot.value = std::move(value);
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @return true if the ID was in the map
+     */
+    bool erase(ID_DATATYPE id) {
+        if(_size == 0) {
+            return false;
+        }
+
+        size_t i = home(id);
+        for(;; i = next(i)) {
+            if(!_slots[i].used) {
+                return false;
+            }
+            if(_slots[i].id == id) {
+                break;
+            }
+        }
+
+        // Move back the following slots which can't be reached anymore from their home slot
+        for(size_t j = next(i);; j = next(j)) {
+            if(!_slots[j].used) {
+                break;
+            }
+
+            size_t h = home(_slots[j].id);
+            if(((j - h) & mask()) >= ((j - i) & mask())) {
+                _slots[i].id = _slots[j].id;
+                _slots[i].value = std::move(_slots[j].value);
+                i = j;
+            }
+        }
+
+        _slots[i].used = false;
+        _slots[i].value = V();
+        _size--;
+        return true;
+    }
+
+    void clear() {
+        _slots.clear();
+        _size = 0;
+        _shift = 64;
+    }
+
+    /**
+     * @brief Make room for a number of values without rehashing
+     */
+    void reserve(size_t count) {
+        size_t capacity = 16;
+        while(count * 4 > capacity * 3) {
+            capacity *= 2;
+        }
+
+        if(capacity > _slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @brief Call func(id, value) for each value, in no particular order
+     */
+    template<typename F>
+    void each(F func) const {
+        for(const auto& slot : _slots) {
+            if(slot.used) {
+                func(slot.id, slot.value);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        Slot() :
+            id(0),
+            used(false),
+            value() {
+        }
+
+        ID_DATATYPE id;
+        bool used;
+        V value;
+    };
+
+    size_t mask() const {
+        return _slots.size() - 1;
+    }
+
+    size_t home(ID_DATATYPE id) const {
+        return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> _shift);
+    }
+
+    size_t next(size_t i) const {
+        return (i + 1) & mask();
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> slots(capacity);
+        std::swap(slots, _slots);
+
+        _shift = 64;
+        for(size_t c = capacity; c > 1; c >>= 1) {
+            _shift--;
+        }
+
+        _size = 0;
+        for(auto& slot : slots) {
+            if(slot.used) {
+                insert(slot.id, std::move(slot.value));
+            }
+        }
+    }
+
+    std::vector<Slot> _slots;
+    size_t _size;
+    unsigned int _shift;
+};
+}
+}
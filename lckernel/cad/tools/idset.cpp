@@ -0,0 +1,186 @@
+#include "idset.h"
+#include <algorithm>
+
+using namespace lc::tools;
+
+IDSet::Page::Page() :
+    count(0) {
+    words.fill(0);
+}
+
+IDSet::IDSet() :
+    _size(0) {
+}
+
+bool IDSet::contains(ID_DATATYPE id) const {
+    auto it = _pages.find(id / PAGE_SIZE);
+    if(it == _pages.end()) {
+        return false;
+    }
+
+    auto bit = id % PAGE_SIZE;
+    return (it->second.words[bit / 64] >> (bit % 64)) & 1;
+}
+
+bool IDSet::insert(ID_DATATYPE id) {
+    auto& page = _pages[id / PAGE_SIZE];
+    auto bit = id % PAGE_SIZE;
+    uint64_t mask = uint64_t(1) << (bit % 64);
+    auto& word = page.words[bit / 64];
+
+    if(word & mask) {
+        return false;
+    }
+
+    word |= mask;
+    page.count++;
+    _size++;
+    return true;
+}
+
+bool IDSet::erase(ID_DATATYPE id) {
+    auto it = _pages.find(id / PAGE_SIZE);
+    if(it == _pages.end()) {
+        return false;
+    }
+
+    auto bit = id % PAGE_SIZE;
+    uint64_t mask = uint64_t(1) << (bit % 64);
+    auto& word = it->second.words[bit / 64];
+
+    if((word & mask) == 0) {
+        return false;
+    }
+
+    word &= ~mask;
+    _size--;
+    if(--it->second.count == 0) {
+        _pages.erase(it);
+    }
+    return true;
+}
+
+bool IDSet::toggle(ID_DATATYPE id) {
+    if(erase(id)) {
+        return false;
+    }
+
+    insert(id);
+    return true;
+}
+
+void IDSet::clear() {
+    _pages.clear();
+    _size = 0;
+}
+
+size_t IDSet::size() const {
+    return _size;
+}
+
+bool IDSet::empty() const {
+    return _size == 0;
+}
+
+IDSet& IDSet::unite(const IDSet& other) {
+    for(const auto& otherPage : other._pages) {
+        auto& page = _pages[otherPage.first];
+        _size -= page.count;
+        page.count = 0;
+
+        for(size_t i = 0; i < WORDS_PER_PAGE; i++) {
+            page.words[i] |= otherPage.second.words[i];
+            page.count += Bits::count(page.words[i]);
+        }
+        _size += page.count;
+    }
+
+    return *this;
+}
+
+IDSet& IDSet::subtract(const IDSet& other) {
+    for(const auto& otherPage : other._pages) {
+        auto it = _pages.find(otherPage.first);
+        if(it == _pages.end()) {
+            continue;
+        }
+
+        auto& page = it->second;
+        _size -= page.count;
+        page.count = 0;
+
+        for(size_t i = 0; i < WORDS_PER_PAGE; i++) {
+            page.words[i] &= ~otherPage.second.words[i];
+            page.count += Bits::count(page.words[i]);
+        }
+
+        _size += page.count;
+        if(page.count == 0) {
+            _pages.erase(it);
+        }
+    }
+
+    return *this;
+}
+
+IDSet& IDSet::toggle(const IDSet& other) {
+    for(const auto& otherPage : other._pages) {
+        auto& page = _pages[otherPage.first];
+        _size -= page.count;
+        page.count = 0;
+
+        for(size_t i = 0; i < WORDS_PER_PAGE; i++) {
+            page.words[i] ^= otherPage.second.words[i];
+            page.count += Bits::count(page.words[i]);
+        }
+
+        _size += page.count;
+        if(page.count == 0) {
+            _pages.erase(otherPage.first);
+        }
+    }
+
+    return *this;
+}
+
+std::vector<ID_DATATYPE> IDSet::ids() const {
+    std::vector<ID_DATATYPE> pages;
+    pages.reserve(_pages.size());
+    for(const auto& page : _pages) {
+        pages.push_back(page.first);
+    }
+    std::sort(pages.begin(), pages.end());
+
+    // Bits of a page are visited in increasing order
+    std::vector<ID_DATATYPE> result;
+    result.reserve(_size);
+    for(auto pageIndex : pages) {
+        const auto& page = _pages.at(pageIndex);
+        ID_DATATYPE base = pageIndex * PAGE_SIZE;
+
+        for(size_t i = 0; i < WORDS_PER_PAGE; i++) {
+            uint64_t word = page.words[i];
+            while(word != 0) {
+                result.push_back(base + i * 64 + Bits::lowest(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    return result;
+}
+
+bool IDSet::operator==(const IDSet& other) const {
+    if(_size != other._size || _pages.size() != other._pages.size()) {
+        return false;
+    }
+
+    for(const auto& page : _pages) {
+        auto it = other._pages.find(page.first);
+        if(it == other._pages.end() || it->second.words != page.second.words) {
+            return false;
+        }
+    }
+
+    return true;
+}
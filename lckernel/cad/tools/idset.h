@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cad/base/id.h>
+#include <cad/tools/bits.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lc {
+namespace tools {
+/**
+ * @brief Set of entity IDs
+ * IDs are stored in bitmaps of PAGE_SIZE consecutive IDs, the pages are kept in a hash map.
+ * Membership, insertion and removal are O(1). Union, difference and symmetric difference
+ * work on whole 64 bits words, IDs created together share pages which keeps them fast.
+ */
+class IDSet {
+public:
+    static const ID_DATATYPE PAGE_SIZE = 4096;
+
+    IDSet();
+
+    bool contains(ID_DATATYPE id) const;
+
+    /**
+     * @return true if the ID wasn't in the set
+     */
+    bool insert(ID_DATATYPE id);
+
+    /**
+     * @return true if the ID was in the set
+     */
+    bool erase(ID_DATATYPE id);
+
+    /**
+     * @brief Insert the ID if it isn't in the set, remove it otherwise
+     * @return true if the ID is in the set after the call
+     */
+    bool toggle(ID_DATATYPE id);
+
+    void clear();
+
+    size_t size() const;
+
+    bool empty() const;
+
+    /**
+     * @brief Add the IDs of another set
+     */
+    IDSet& unite(const IDSet& other);
+
+    /**
+     * @brief Remove the IDs of another set
+     */
+    IDSet& subtract(const IDSet& other);
+
+    /**
+     * @brief Toggle the IDs of another set (symmetric difference)
+     * Inverting a selection is toggling it with the set of all the entities.
+     */
+    IDSet& toggle(const IDSet& other);
+
+    /**
+     * @return IDs of the set in increasing order
+     */
+    std::vector<ID_DATATYPE> ids() const;
+
+    /**
+     * @brief Call func(id) for each ID of the set, in no particular order
+     */
+    template<typename F>
+    void each(F func) const {
+        for(const auto& page : _pages) {
+            ID_DATATYPE base = page.first * PAGE_SIZE;
+            for(size_t i = 0; i < WORDS_PER_PAGE; i++) {
+                uint64_t word = page.second.words[i];
+                while(word != 0) {
+                    func(base + i * 64 + Bits::lowest(word));
+                    word &= word - 1;
+                }
+            }
+        }
+    }
+
+    bool operator==(const IDSet& other) const;
+
+    bool operator!=(const IDSet& other) const {
+        return !(*this == other);
+    }
+
+private:
+    static const size_t WORDS_PER_PAGE = PAGE_SIZE / 64;
+
+    struct Page {
+        Page();
+
+        std::array<uint64_t, WORDS_PER_PAGE> words;
+        size_t count;
+    };
+
+    std::unordered_map<ID_DATATYPE, Page> _pages;
+    size_t _size;
+};
+}
+}
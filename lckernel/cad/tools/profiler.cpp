@@ -0,0 +1,172 @@
+#include "profiler.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace lc::tools;
+
+namespace {
+void writeJsonString(std::ostream& stream, const std::string& value) {
+    stream << '"';
+
+    for (unsigned char c : value) {
+        switch (c) {
+            case '"':
+                stream << "\\\"";
+                break;
+
+            case '\\':
+                stream << "\\\\";
+                break;
+
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    stream << escaped;
+                }
+                else {
+                    stream << c;
+                }
+        }
+    }
+
+    stream << '"';
+}
+}
+
+const size_t Profiler::MAX_EVENTS;
+
+Profiler::Profiler() :
+    _enabled(false),
+    _start(Clock::now()),
+    _dropped(0) {
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::setEnabled(bool enabled) {
+    _enabled = enabled;
+}
+
+void Profiler::addZone(std::string name, Clock::time_point start, Clock::time_point end) {
+    auto timestamp = microseconds(start);
+    addEvent({std::move(name), 'X', timestamp, microseconds(end) - timestamp, 0., threadNumber()});
+}
+
+void Profiler::count(const std::string& name, double delta) {
+    auto timestamp = microseconds(Clock::now());
+
+    double total;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        total = _counters[name] += delta;
+    }
+
+    addEvent({name, 'C', timestamp, 0., total, threadNumber()});
+}
+
+void Profiler::gauge(const std::string& name, double value) {
+    addEvent({name, 'C', microseconds(Clock::now()), 0., value, threadNumber()});
+}
+
+size_t Profiler::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _events.size();
+}
+
+double Profiler::zoneDuration(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    double duration = 0.;
+    for (const auto& event : _events) {
+        if (event.phase == 'X' && event.name == name) {
+            duration += event.duration;
+        }
+    }
+
+    return duration;
+}
+
+size_t Profiler::dropped() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _events.clear();
+    _counters.clear();
+    _dropped = 0;
+}
+
+std::string Profiler::chromeTrace() const {
+    std::ostringstream stream;
+    stream.precision(15);
+    stream << "{\"traceEvents\":[";
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool first = true;
+    for (const auto& event : _events) {
+        if (!first) {
+            stream << ",";
+        }
+        first = false;
+
+        stream << "\n{\"name\":";
+        writeJsonString(stream, event.name);
+        stream << ",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp
+               << ",\"pid\":1,\"tid\":" << event.thread;
+
+        if (event.phase == 'X') {
+            stream << ",\"dur\":" << event.duration;
+        }
+        else {
+            stream << ",\"args\":{\"value\":" << event.value << "}";
+        }
+
+        stream << "}";
+    }
+
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return stream.str();
+}
+
+void Profiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Unable to open " + path);
+    }
+
+    file << chromeTrace();
+
+    if (!file) {
+        throw std::runtime_error("Unable to write " + path);
+    }
+}
+
+void Profiler::addEvent(Event event) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_events.size() >= MAX_EVENTS) {
+        _dropped++;
+        return;
+    }
+
+    _events.push_back(std::move(event));
+}
+
+double Profiler::microseconds(Clock::time_point time) const {
+    return std::chrono::duration<double, std::micro>(time - _start).count();
+}
+
+unsigned int Profiler::threadNumber() {
+    static std::atomic<unsigned int> next(1);
+    thread_local unsigned int number = next++;
+    return number;
+}
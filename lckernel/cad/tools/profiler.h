@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lc {
+namespace tools {
+/**
+ * @brief Records timed zones, counters and gauges
+ * The profiler is always compiled in and disabled by default. When disabled, a zone costs one
+ * atomic load and nothing is recorded.
+ *
+ * The recording can be exported as a Chrome trace JSON file, which can be opened in
+ * chrome://tracing or in the Perfetto UI.
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Profiler shared by the whole application
+     */
+    static Profiler& instance();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    bool enabled() const {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Record a zone which ran on the current thread
+     */
+    void addZone(std::string name, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * @brief Add delta to a counter
+     * The trace shows the total of the counter over time.
+     */
+    void count(const std::string& name, double delta = 1.);
+
+    /**
+     * @brief Record the current value of a gauge
+     */
+    void gauge(const std::string& name, double value);
+
+    /**
+     * @return number of recorded events
+     */
+    size_t size() const;
+
+    /**
+     * @return total duration of the recorded zones with this name, in microseconds
+     */
+    double zoneDuration(const std::string& name) const;
+
+    /**
+     * @return number of events which were not recorded because the buffer was full
+     */
+    size_t dropped() const;
+
+    /**
+     * @brief Remove the recorded events and reset the counters
+     */
+    void clear();
+
+    /**
+     * @return recorded events in the Chrome trace event format
+     */
+    std::string chromeTrace() const;
+
+    /**
+     * @brief Write the recorded events in the Chrome trace event format
+     * @throw std::runtime_error if the file can't be written
+     */
+    void writeChromeTrace(const std::string& path) const;
+
+    /**
+     * Maximum number of recorded events, older events are kept
+     */
+    static const size_t MAX_EVENTS = 1000000;
+
+private:
+    Profiler();
+
+    struct Event {
+        std::string name;
+        char phase;
+        double timestamp;
+        double duration;
+        double value;
+        unsigned int thread;
+    };
+
+    void addEvent(Event event);
+
+    double microseconds(Clock::time_point time) const;
+
+    static unsigned int threadNumber();
+
+    std::atomic<bool> _enabled;
+    Clock::time_point _start;
+
+    mutable std::mutex _mutex;
+    std::vector<Event> _events;
+    std::map<std::string, double> _counters;
+    size_t _dropped;
+};
+
+/**
+ * @brief Zone covering the lifetime of the object
+ * The name must outlive the zone, use string literals.
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) :
+        _name(name),
+        _active(Profiler::instance().enabled()) {
+        if (_active) {
+            _start = Profiler::Clock::now();
+        }
+    }
+
+    ~ProfileZone() {
+        if (_active) {
+            Profiler::instance().addZone(_name, _start, Profiler::Clock::now());
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* _name;
+    bool _active;
+    Profiler::Clock::time_point _start;
+};
+}
+}
+
+#define LC_PROFILE_CONCAT_(a, b) a##b
+#define LC_PROFILE_CONCAT(a, b) LC_PROFILE_CONCAT_(a, b)
+
+/**
+ * Profile the rest of the current scope
+ */
+#define LC_PROFILE_ZONE(name) lc::tools::ProfileZone LC_PROFILE_CONCAT(_profileZone, __LINE__)(name)
+
+/**
+ * Add to a counter, only evaluates the arguments when the profiler is enabled
+ */
+#define LC_PROFILE_COUNT(name, delta) \
+    do { \
+        if (lc::tools::Profiler::instance().enabled()) { \
+            lc::tools::Profiler::instance().count(name, delta); \
+        } \
+    } while (false)
+
+/**
+ * Record a gauge value, only evaluates the arguments when the profiler is enabled
+ */
+#define LC_PROFILE_GAUGE(name, value) \
+    do { \
+        if (lc::tools::Profiler::instance().enabled()) { \
+            lc::tools::Profiler::instance().gauge(name, value); \
+        } \
+    } while (false)
@@ -0,0 +1,144 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+using namespace lc::tools;
+
+namespace {
+/**
+ * State shared between the caller of parallelFor and the helper tasks
+ * Chunks are taken from a shared counter, so the caller can process all chunks itself
+ * when every worker is busy (for example when parallelFor is nested)
+ */
+struct ParallelForState {
+    std::function<void(size_t, size_t)> func;
+    size_t count;
+    size_t chunkSize;
+    size_t nbChunks;
+    std::atomic<size_t> nextChunk;
+    size_t doneChunks;
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    void run() {
+        size_t chunk;
+        while ((chunk = nextChunk++) < nbChunks) {
+            auto begin = chunk * chunkSize;
+            auto end = std::min(begin + chunkSize, count);
+
+            try {
+                func(begin, end);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++doneChunks == nbChunks) {
+                condition.notify_all();
+            }
+        }
+    }
+};
+}
+
+ThreadPool::ThreadPool(unsigned int nbThreads) :
+    _stop(false) {
+    if (nbThreads == 0) {
+        nbThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < nbThreads; i++) {
+        _workers.emplace_back(&ThreadPool::worker, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+
+    _condition.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+unsigned int ThreadPool::size() const {
+    return _workers.size();
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& func) {
+    minChunkSize = std::max<size_t>(1, minChunkSize);
+
+    if (count <= minChunkSize || _workers.size() < 2) {
+        if (count > 0) {
+            func(0, count);
+        }
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->func = func;
+    state->count = count;
+    state->chunkSize = std::max(minChunkSize, (count + _workers.size() - 1) / _workers.size());
+    state->nbChunks = (count + state->chunkSize - 1) / state->chunkSize;
+    state->nextChunk = 0;
+    state->doneChunks = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 1; i < state->nbChunks; i++) {
+            _tasks.emplace([state]() {
+                state->run();
+            });
+        }
+    }
+    _condition.notify_all();
+
+    state->run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&state]() {
+        return state->doneChunks == state->nbChunks;
+    });
+
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+void ThreadPool::worker() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() {
+                return _stop || !_tasks.empty();
+            });
+
+            if (_stop && _tasks.empty()) {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace lc {
+namespace tools {
+/**
+ * @brief Fixed size pool of worker threads
+ * Tasks are executed in FIFO order. The pool is used by the kernel for data parallel work
+ * such as running the EntityBuilder operation stack over large entity sets.
+ *
+ * Tasks must not touch the document signals, those are not thread safe.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Create a pool
+     * @param nbThreads number of workers, 0 for one per hardware thread
+     */
+    explicit ThreadPool(unsigned int nbThreads = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Shared pool used by the kernel
+     */
+    static ThreadPool& instance();
+
+    /**
+     * @return number of worker threads
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Queue a task
+     * @return future which will hold the result of the task
+     */
+    template<typename F>
+    std::future<typename std::result_of<F()>::type> enqueue(F task);
+
+    /**
+     * @brief Split [0, count) in chunks and run func(begin, end) on each chunk
+     * Blocks until all chunks are done. Runs in the calling thread when count is below minChunkSize.
+     * The first exception thrown by a chunk is re-thrown in the calling thread.
+     * @param count number of items
+     * @param minChunkSize minimum number of items per chunk
+     * @param func function called with the item range of a chunk
+     */
+    void parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& func);
+
+private:
+    void worker();
+
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stop;
+};
+
+template<typename F>
+std::future<typename std::result_of<F()>::type> ThreadPool::enqueue(F task) {
+    using ReturnType = typename std::result_of<F()>::type;
+
+    auto packagedTask = std::make_shared<std::packaged_task<ReturnType()>>(std::move(task));
+    auto future = packagedTask->get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.emplace([packagedTask]() {
+            (*packagedTask)();
+        });
+    }
+
+    _condition.notify_one();
+    return future;
+}
+}
+}
@@ -3,9 +3,11 @@
 using namespace lc::storage::settings;
 
 auto lcTolerance = DoubleSettingValue(1.0e-10);
+auto undoMemoryBudget = DoubleSettingValue(512); // MiB
 
 ModuleSettings settings({
-    {SETTINGS_LCTOLERANCE, &lcTolerance}
+    {SETTINGS_LCTOLERANCE, &lcTolerance},
+    {SETTINGS_UNDOMEMORYBUDGET, &undoMemoryBudget}
 });
 
 const ModuleSettings& lc::kernel::getSettings() {
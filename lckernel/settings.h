@@ -2,6 +2,7 @@
 
 #include <cad/storage/settings/modulesettings.h>
 #define SETTINGS_LCTOLERANCE "Tolerance"
+#define SETTINGS_UNDOMEMORYBUDGET "UndoMemoryBudget"
 
 namespace lc {
 namespace kernel {
@@ -1,6 +1,7 @@
 #include "documentcanvas.h"
 #include <cad/meta/metacolor.h>
 #include <cad/storage/document.h>
+#include <cad/storage/documentsnapshot.h>
 #include <cad/storage/quadtree.h>
 #include <cad/geometry/geoarea.h>
 #include <cad/primitive/line.h>
@@ -9,6 +10,8 @@
 #include <cad/primitive/text.h>
 #include <cad/primitive/image.h>
 #include <cad/primitive/insert.h>
+#include <cad/interface/entitydispatch.h>
+#include <cad/tools/profiler.h>
 #include "lcdrawoptions.h"
 #include "drawitems/lcvcircle.h"
 #include "drawitems/lcvhatch.h"
@@ -34,6 +37,7 @@
 #include <cad/meta/metalinewidth.h>
 
 #include <cad/const.h>
+#include <algorithm>
 #include <cmath>
 
 #include <typeinfo>
@@ -41,6 +45,87 @@
 using namespace lc;
 using namespace lc::viewer;
 
+namespace {
+/**
+ * Create the drawable of an entity, without trying each type in turn
+ */
+class DrawableFactory : public lc::EntityDispatch {
+public:
+    explicit DrawableFactory(const std::function<void()>& ready) :
+        ready(ready) {
+    }
+
+    void visit(lc::entity::Line_CSPtr line) override {
+        drawable = std::make_shared<LCVLine>(line);
+    }
+
+    void visit(lc::entity::Point_CSPtr point) override {
+        // Point cannot be cached since it change size(constant size)
+        drawable = std::make_shared<LCVPoint>(point);
+        drawable->cacheable(false);
+    }
+
+    void visit(lc::entity::Circle_CSPtr circle) override {
+        drawable = std::make_shared<LCVCircle>(circle);
+    }
+
+    void visit(lc::entity::Arc_CSPtr arc) override {
+        drawable = std::make_shared<LCVArc>(arc);
+    }
+
+    void visit(lc::entity::Ellipse_CSPtr ellipse) override {
+        drawable = std::make_shared<LCVEllipse>(ellipse);
+    }
+
+    void visit(lc::entity::Text_CSPtr text) override {
+        drawable = std::make_shared<LCVText>(text);
+    }
+
+    void visit(lc::entity::Spline_CSPtr spline) override {
+        drawable = std::make_shared<LCVSpline>(spline);
+    }
+
+    void visit(lc::entity::DimAligned_CSPtr dimAligned) override {
+        drawable = std::make_shared<LCDimAligned>(dimAligned);
+    }
+
+    void visit(lc::entity::DimAngular_CSPtr dimAngular) override {
+        drawable = std::make_shared<LCDimAngular>(dimAngular);
+    }
+
+    void visit(lc::entity::DimDiametric_CSPtr dimDiametric) override {
+        drawable = std::make_shared<LCDimDiametric>(dimDiametric);
+    }
+
+    void visit(lc::entity::DimLinear_CSPtr dimLinear) override {
+        drawable = std::make_shared<LCDimLinear>(dimLinear);
+    }
+
+    void visit(lc::entity::DimRadial_CSPtr dimRadial) override {
+        drawable = std::make_shared<LCDimRadial>(dimRadial);
+    }
+
+    void visit(lc::entity::LWPolyline_CSPtr lwPolyline) override {
+        drawable = std::make_shared<LCLWPolyline>(lwPolyline);
+    }
+
+    void visit(lc::entity::Image_CSPtr image) override {
+        drawable = std::make_shared<LCImage>(image);
+    }
+
+    void visit(lc::entity::Hatch_CSPtr hatch) override {
+        drawable = std::make_shared<LCVHatch>(hatch, ready);
+    }
+
+    void visit(lc::entity::Insert_CSPtr insert) override {
+        drawable = std::make_shared<LCVInsert>(insert, ready);
+    }
+
+    std::function<void()> ready;
+    LCVDrawItem_SPtr drawable;
+};
+}
+
 DocumentCanvas::DocumentCanvas(const std::shared_ptr<lc::storage::Document>& document, std::function<void(double*, double*)> deviceToUser, meta::Block_CSPtr viewport) :
     _document(document),
     _zoomMin(0.005),
@@ -49,13 +134,28 @@ DocumentCanvas::DocumentCanvas(const std::shared_ptr<lc::storage::Document>& doc
     _deviceHeight(0),
     _selectedArea(nullptr),
     _selectedAreaIntersects(false),
+    _selectedDrawablesValid(true),
     _deviceToUser(std::move(deviceToUser)),
     _painterPtr(nullptr),
+    _styleGeneration(1),
+    _nextStyleId(0),
+    _drawablesReady(std::make_shared<std::atomic<bool>>(false)),
     _viewport(viewport)
 {
+    // Drawables may outlive the canvas, the flag is released with the last of them
+    auto drawablesReady = _drawablesReady;
+    _onDrawableReady = [drawablesReady]() {
+        drawablesReady->store(true);
+    };
+
     document->addEntityEvent().connect<DocumentCanvas, &DocumentCanvas::on_addEntityEvent>(this);
     document->removeEntityEvent().connect<DocumentCanvas, &DocumentCanvas::on_removeEntityEvent>(this);
     document->commitProcessEvent().connect<DocumentCanvas, &DocumentCanvas::on_commitProcessEvent>(this);
+    document->replaceLayerEvent().connect<DocumentCanvas, &DocumentCanvas::on_replaceLayerEvent>(this);
+    document->removeLayerEvent().connect<DocumentCanvas, &DocumentCanvas::on_removeLayerEvent>(this);
+    document->addLinePatternEvent().connect<DocumentCanvas, &DocumentCanvas::on_addLinePatternEvent>(this);
+    document->replaceLinePatternEvent().connect<DocumentCanvas, &DocumentCanvas::on_replaceLinePatternEvent>(this);
+    document->removeLinePatternEvent().connect<DocumentCanvas, &DocumentCanvas::on_removeLinePatternEvent>(this);
 
     // Render code for selected area
     _selectedAreaPainter = [](LcPainter & painter, lc::geo::Area area, bool occupies) {
@@ -96,6 +196,11 @@ DocumentCanvas::~DocumentCanvas() {
     _document->addEntityEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_addEntityEvent>(this);
     _document->removeEntityEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_removeEntityEvent>(this);
     _document->commitProcessEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_commitProcessEvent>(this);
+    _document->replaceLayerEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_replaceLayerEvent>(this);
+    _document->removeLayerEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_removeLayerEvent>(this);
+    _document->addLinePatternEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_addLinePatternEvent>(this);
+    _document->replaceLinePatternEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_replaceLinePatternEvent>(this);
+    _document->removeLinePatternEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_removeLinePatternEvent>(this);
 
     if (_selectedArea != nullptr) {
         delete _selectedArea;
@@ -181,6 +286,7 @@ void DocumentCanvas::setDisplayArea(LcPainter& painter, const lc::geo::Area& are
 }
 
 void DocumentCanvas::render(LcPainter& painter, PainterType type) {
+    LC_PROFILE_ZONE("DocumentCanvas::render");
     lc::geo::Area visibleUserArea;
 
     {
@@ -211,32 +317,72 @@ void DocumentCanvas::render(LcPainter& painter, PainterType type) {
         painter.source_rgb(1., 1., 1.);
         painter.lineWidthCompensation(0.5);
         painter.enable_antialias();
-        auto visibleEntities = entityContainer().entitiesWithinAndCrossingAreaFast(visibleUserArea);
+        // The phases are profiled separately: query, style, tessellate (caching painters only) and draw
         std::vector<lc::viewer::LCVDrawItem_SPtr> visibleDrawables;
-        visibleEntities.each< const lc::entity::CADEntity >([&](lc::entity::CADEntity_CSPtr entity) {
-            auto di = _entityDrawItem[entity->id()];
-            if(di) {
-                visibleDrawables.push_back(di);
+        {
+            LC_PROFILE_ZONE("DocumentCanvas::query");
+            std::vector<lc::entity::CADEntity_CSPtr> visibleEntities;
+            if(_viewport == nullptr) {
+                visibleEntities = _document->snapshot()->entitiesWithinAndCrossingAreaFast(visibleUserArea);
             }
-        });
-        for(const auto& di: visibleDrawables) {
-            if(painter.isCachingEnabled() && di->cacheable())
-            {
-                if(painter.isEntityCached( (di->entity())->id() ) == true)
-                {
-                    drawCachedEntity(painter,di);
+            else {
+                visibleEntities = entityContainer().entitiesWithinAndCrossingAreaFast(visibleUserArea).asVector();
+            }
+            LC_PROFILE_GAUGE("Visible entities", visibleEntities.size());
+
+            visibleDrawables.reserve(visibleEntities.size());
+            for(const auto& entity : visibleEntities) {
+                auto di = _entityDrawItem.find(entity->id());
+                if(di != nullptr && *di) {
+                    visibleDrawables.push_back(*di);
                 }
-                else
-                {
-                    cacheEntity((di->entity())->id(), di);
-                    drawCachedEntity(painter, di);
+            }
+        }
+
+        // Cached entities and inserts are drawn one by one in this order, the others are grouped by style
+        std::vector<LCVDrawItem_SPtr> orderedDrawables;
+        std::vector<LCVDrawItem_SPtr> uncachedDrawables;
+        std::vector<std::pair<LCVDrawStyle_CSPtr, LCVDrawItem_SPtr>> styledDrawables;
+        styledDrawables.reserve(visibleDrawables.size());
+        {
+            LC_PROFILE_ZONE("DocumentCanvas::style");
+            for(const auto& di: visibleDrawables) {
+                // Pending drawables draw a placeholder, they are cached once ready
+                if(painter.isCachingEnabled() && di->cacheable() && !di->pending()) {
+                    if(!painter.isEntityCached(di->entity()->id())) {
+                        uncachedDrawables.push_back(di);
+                    }
+                    orderedDrawables.push_back(di);
+                }
+                else if(std::dynamic_pointer_cast<const LCVInsert>(di) != nullptr) {
+                    orderedDrawables.push_back(di);
+                }
+                else {
+                    styledDrawables.emplace_back(drawStyle(di, nullptr), di);
                 }
             }
-            else
-            {
-                drawEntity(painter, di);
+        }
+
+        if(!uncachedDrawables.empty()) {
+            LC_PROFILE_ZONE("DocumentCanvas::tessellate");
+            for(const auto& di: uncachedDrawables) {
+                cacheEntity(di->entity()->id(), di);
             }
-        };
+        }
+
+        {
+            LC_PROFILE_ZONE("DocumentCanvas::draw");
+            for(const auto& di: orderedDrawables) {
+                if(painter.isCachingEnabled() && di->cacheable() && !di->pending()) {
+                    drawCachedEntity(painter, di);
+                }
+                else {
+                    drawEntity(painter, di);
+                }
+            }
+            drawStyled(painter, styledDrawables);
+        }
+
         painter.line_width(1.);
         painter.source_rgb(1., 1., 1.);
         painter.lineWidthCompensation(0.);
@@ -255,7 +401,8 @@ void DocumentCanvas::render(LcPainter& painter, PainterType type) {
 }
 
 double DocumentCanvas::drawWidth(const lc::entity::CADEntity_CSPtr& entity, const lc::entity::Insert_CSPtr& insert) {
-    auto entityLineWidth = entity->metaInfo<lc::meta::MetaLineWidth>(lc::meta::MetaLineWidthByValue::LCMETANAME());
+    static const auto lineWidthSlot = lc::meta::MetaInfo::slot(lc::meta::MetaLineWidth::LCMETANAME());
+    auto entityLineWidth = entity->metaInfoBySlot<lc::meta::MetaLineWidth>(lineWidthSlot);
     auto entityLineWidthByValue = std::dynamic_pointer_cast<const lc::meta::MetaLineWidthByValue>(entityLineWidth);
 
     if (entityLineWidthByValue != nullptr) {
@@ -263,7 +410,7 @@ double DocumentCanvas::drawWidth(const lc::entity::CADEntity_CSPtr& entity, cons
     }
     else if(insert != nullptr &&
             std::dynamic_pointer_cast<const lc::meta::MetaLineWidthByBlock>(entityLineWidth) != nullptr) {
-        auto insertLW = insert->metaInfo<lc::meta::MetaLineWidthByValue>(lc::meta::MetaLineWidth::LCMETANAME());
+        auto insertLW = insert->metaInfoBySlot<lc::meta::MetaLineWidthByValue>(lineWidthSlot);
 
         if(insertLW != nullptr) {
             return insertLW->width();
@@ -283,15 +430,20 @@ std::vector<double> DocumentCanvas::drawLinePattern(
     double width) {
     auto layer = entity->layer();
 
-    lc::meta::DxfLinePattern_CSPtr entityLinePattern = entity->metaInfo<lc::meta::DxfLinePattern>(lc::meta::DxfLinePattern::LCMETANAME());
+    static const auto linePatternSlot = lc::meta::MetaInfo::slot(lc::meta::DxfLinePattern::LCMETANAME());
+    lc::meta::DxfLinePattern_CSPtr entityLinePattern = entity->metaInfoBySlot<lc::meta::DxfLinePattern>(linePatternSlot);
     auto linePatternByValue = std::dynamic_pointer_cast<const lc::meta::DxfLinePatternByValue>(entityLinePattern);
     auto linePatternByBlock = std::dynamic_pointer_cast<const lc::meta::DxfLinePatternByBlock>(entityLinePattern);
 
-    if (linePatternByValue != nullptr && !(linePatternByValue->lcPattern(width).empty())) {
-        return linePatternByValue->lcPattern(width);
+    if (linePatternByValue != nullptr) {
+        auto pattern = linePatternByValue->lcPattern(width);
+        if (!pattern.empty()) {
+            return pattern;
+        }
     }
-    else if(linePatternByBlock != nullptr && insert != nullptr) {
-        auto insertLP = insert->metaInfo<lc::meta::DxfLinePatternByValue>(lc::meta::DxfLinePattern::LCMETANAME());
+
+    if(linePatternByBlock != nullptr && insert != nullptr) {
+        auto insertLP = insert->metaInfoBySlot<lc::meta::DxfLinePatternByValue>(linePatternSlot);
 
         if(insertLP != nullptr) {
             return insertLP->lcPattern(width);
@@ -300,29 +452,24 @@ std::vector<double> DocumentCanvas::drawLinePattern(
             return insert->layer()->linePattern()->lcPattern(width);
         }
     }
-    else if(layer->linePattern() != nullptr && !(layer->linePattern()->lcPattern(width).empty())) {
+    else if(layer->linePattern() != nullptr) {
         return layer->linePattern()->lcPattern(width);
     }
 
     return std::vector<double>();
 }
 
-lc::Color DocumentCanvas::drawColor(const lc::entity::CADEntity_CSPtr& entity, const lc::entity::Insert_CSPtr& insert,
-                                    bool selected) {
-    LcDrawOptions lcDrawOptions;
-
-    lc::meta::MetaColor_CSPtr entityColor = entity->metaInfo<lc::meta::MetaColor>(lc::meta::MetaColor::LCMETANAME());
+lc::Color DocumentCanvas::drawColor(const lc::entity::CADEntity_CSPtr& entity, const lc::entity::Insert_CSPtr& insert) {
+    static const auto colorSlot = lc::meta::MetaInfo::slot(lc::meta::MetaColor::LCMETANAME());
+    lc::meta::MetaColor_CSPtr entityColor = entity->metaInfoBySlot<lc::meta::MetaColor>(colorSlot);
     lc::meta::MetaColorByValue_CSPtr colorByValue = std::dynamic_pointer_cast<const lc::meta::MetaColorByValue>(entityColor);
 
-    if (selected) {
-        return lcDrawOptions.selectedColor();
-    }
-    else if (colorByValue != nullptr) {
+    if (colorByValue != nullptr) {
         return colorByValue->color();
     }
     else if(insert != nullptr &&
             std::dynamic_pointer_cast<const lc::meta::MetaColorByBlock>(entityColor) != nullptr) {
-        auto insertColor = insert->metaInfo<lc::meta::MetaColorByValue>(lc::meta::MetaColor::LCMETANAME());
+        auto insertColor = insert->metaInfoBySlot<lc::meta::MetaColorByValue>(colorSlot);
 
         if(insertColor != nullptr) {
             return insertColor->color();
@@ -336,53 +483,131 @@ lc::Color DocumentCanvas::drawColor(const lc::entity::CADEntity_CSPtr& entity, c
     }
 }
 
-void DocumentCanvas::drawEntity(LcPainter& painter, const LCVDrawItem_CSPtr& drawable,
-                                const lc::entity::Insert_CSPtr& insert) {
-    LcDrawOptions lcDrawOptions;
+LCVDrawStyle_CSPtr DocumentCanvas::drawStyle(const LCVDrawItem_CSPtr& drawable, const lc::entity::Insert_CSPtr& insert) {
+    auto style = drawable->style(_styleGeneration);
+    if (style != nullptr) {
+        return style;
+    }
 
-    double x = 0.;
-    double y = 0.;
-    double w = _deviceWidth;
-    double h = _deviceHeight;
-    painter.device_to_user(&x, &y);
-    painter.device_to_user_distance(&w, &h);
-    lc::geo::Area visibleUserArea = lc::geo::Area(lc::geo::Coordinate(x, y), w, h);
+    auto entity = drawable->entity();
+    auto key = std::make_tuple(entity->metaInfo(), entity->layer(), insert);
+    auto it = _styles.find(key);
 
-    auto asInsert = std::dynamic_pointer_cast<const LCVInsert>(drawable);
-    if(asInsert != nullptr) {
-        asInsert->draw(shared_from_this(), painter);
-        return;
+    if (it != _styles.end()) {
+        style = it->second;
     }
+    else {
+        // Keeps the map from holding on to removed layers and inserts forever
+        if (_styles.size() >= 4096) {
+            _styles.clear();
+        }
 
-    painter.save();
+        auto newStyle = std::make_shared<LCVDrawStyle>();
+        newStyle->color = drawColor(entity, insert);
 
-    lc::entity::CADEntity_CSPtr ci = drawable->entity();
+        // Decide on line width
+        // We multiply for now by 3 to ensure that 1mm lines will still appear thicker on screen
+        // TODO: Find a better algo
+        newStyle->width = drawWidth(entity, insert) * 1.5;
+        newStyle->dashes = drawLinePattern(entity, insert, newStyle->width);
+        newStyle->id = _nextStyleId++;
+
+        style = newStyle;
+        _styles.emplace(key, style);
+    }
+
+    drawable->style(style, _styleGeneration);
+    return style;
+}
 
+void DocumentCanvas::applyStyle(LcPainter& painter, const LCVDrawStyle& style, bool selected) const {
+    LcDrawOptions lcDrawOptions;
 
     // Used to give the illusation from slightly thinner lines. Not sure yet what to d with it and if I will keep it
     double alpha_compensation = 0.9;
 
-    // Decide on line width
-    // We multiply for now by 3 to ensure that 1mm lines will still appear thicker on screen
-    // TODO: Find a better algo
-    double width = drawWidth(ci, insert) * 1.5;
-
     // Is this correct? May be we should decide on a different minimum width then 0.1, because may be on some devices 0.11 isn't visible?
-    painter.line_width(std::max(width, MINIMUM_READER_LINEWIDTH));
+    painter.line_width(std::max(style.width, MINIMUM_READER_LINEWIDTH));
 
-    auto path = drawLinePattern(ci, insert, width);
-    painter.set_dash(path.data(), path.size(), 0., true);
+    painter.set_dash(style.dashes.data(), style.dashes.size(), 0., true);
 
     // Decide what color to render the entity into
-
-    auto color = drawColor(ci, insert, drawable->selected());
+    const auto& color = selected ? lcDrawOptions.selectedColor() : style.color;
     painter.source_rgba(
         color.red(),
         color.green(),
         color.blue(),
         color.alpha() * alpha_compensation
     );
+}
+
+void DocumentCanvas::drawStyled(LcPainter& painter, std::vector<std::pair<LCVDrawStyle_CSPtr, LCVDrawItem_SPtr>>& drawables) {
+    if (drawables.empty()) {
+        return;
+    }
+
+    LcDrawOptions lcDrawOptions;
+
+    double x = 0.;
+    double y = 0.;
+    double w = _deviceWidth;
+    double h = _deviceHeight;
+    painter.device_to_user(&x, &y);
+    painter.device_to_user_distance(&w, &h);
+    lc::geo::Area visibleUserArea = lc::geo::Area(lc::geo::Coordinate(x, y), w, h);
+
+    // Sorted by creation order of the styles, not by address, so the overlap of the groups doesn't change between runs
+    std::stable_sort(drawables.begin(), drawables.end(), [](
+                         const std::pair<LCVDrawStyle_CSPtr, LCVDrawItem_SPtr>& a,
+                         const std::pair<LCVDrawStyle_CSPtr, LCVDrawItem_SPtr>& b) {
+        return std::make_pair(a.first->id, a.second->selected()) < std::make_pair(b.first->id, b.second->selected());
+    });
+
+    const LCVDrawStyle* style = nullptr;
+    bool selected = false;
+
+    for (const auto& drawable : drawables) {
+        if (drawable.first.get() != style || drawable.second->selected() != selected) {
+            if (style != nullptr) {
+                painter.restore();
+                painter.dash_destroy();
+            }
+
+            style = drawable.first.get();
+            selected = drawable.second->selected();
+
+            painter.save();
+            applyStyle(painter, *style, selected);
+        }
+
+        drawable.second->draw(painter, lcDrawOptions, visibleUserArea);
+    }
+
+    painter.restore();
+    painter.dash_destroy();
+}
+
+void DocumentCanvas::drawEntity(LcPainter& painter, const LCVDrawItem_CSPtr& drawable,
+                                const lc::entity::Insert_CSPtr& insert) {
+    LcDrawOptions lcDrawOptions;
+
+    double x = 0.;
+    double y = 0.;
+    double w = _deviceWidth;
+    double h = _deviceHeight;
+    painter.device_to_user(&x, &y);
+    painter.device_to_user_distance(&w, &h);
+    lc::geo::Area visibleUserArea = lc::geo::Area(lc::geo::Coordinate(x, y), w, h);
+
+    auto asInsert = std::dynamic_pointer_cast<const LCVInsert>(drawable);
+    if(asInsert != nullptr) {
+        asInsert->draw(shared_from_this(), painter);
+        return;
+    }
 
+    painter.save();
+
+    applyStyle(painter, *drawStyle(drawable, insert), drawable->selected());
 
     drawable->draw(painter, lcDrawOptions, visibleUserArea);
 
@@ -408,12 +633,10 @@ void DocumentCanvas::drawCachedEntity(LcPainter& painter, const LCVDrawItem_CSPt
         asInsert->draw(shared_from_this(), painter);
         return;
     }
-    // getting CADEntity_CSPtr
-    lc::entity::CADEntity_CSPtr ce = drawable->entity();
     double alpha_compensation = 0.9;
     painter.save();
     // Decide what color to render the entity into
-    auto color = drawColor(ce, insert, drawable->selected());
+    auto color = drawable->selected() ? lcDrawOptions.selectedColor() : drawStyle(drawable, insert)->color;
     painter.source_rgba(
         color.red(),
         color.green(),
@@ -448,32 +671,7 @@ void DocumentCanvas::cacheEntity(unsigned long id, const LCVDrawItem_CSPtr& draw
     cachepainter->startcaching();
     cachepainter->save();
 
-    lc::entity::CADEntity_CSPtr ci = drawable->entity();
-
-
-    // Used to give the illusation from slightly thinner lines. Not sure yet what to d with it and if I will keep it
-    double alpha_compensation = 0.9;
-
-    // Decide on line width
-    // We multiply for now by 3 to ensure that 1mm lines will still appear thicker on screen
-    // TODO: Find a better algo
-    double width = drawWidth(ci, insert) * 1.5;
-
-    // Is this correct? May be we should decide on a different minimum width then 0.1, because may be on some devices 0.11 isn't visible?
-    cachepainter->line_width(std::max(width, MINIMUM_READER_LINEWIDTH));
-
-    auto path = drawLinePattern(ci, insert, width);
-    cachepainter->set_dash(path.data(), path.size(), 0., true);
-
-    // Decide what color to render the entity into
-
-    auto color = drawColor(ci, insert, drawable->selected());
-    cachepainter->source_rgba(
-        color.red(),
-        color.green(),
-        color.blue(),
-        color.alpha() * alpha_compensation
-    );
+    applyStyle(*cachepainter, *drawStyle(drawable, insert), drawable->selected());
 
     //===========Here caching happens==============
     drawable->draw( (*cachepainter), lcDrawOptions, visibleUserArea);
@@ -490,8 +688,14 @@ void DocumentCanvas::on_commitProcessEvent(const lc::event::CommitProcessEvent&
 // This assumes that the entity has already been added to _document->entityContainer()
 void DocumentCanvas::on_addEntityEvent(const lc::event::AddEntityEvent& event) {
     auto entity = event.entity();
-    auto drawable = asDrawable(entity);
-    _entityDrawItem.insert(std::make_pair(entity->id(), drawable));
+    auto drawable = asDrawable(entity, _onDrawableReady);
+    _entityDrawItem.insert(entity->id(), drawable);
+
+    // Entities keep their ID when they are modified
+    if(drawable != nullptr && _selection.contains(entity->id())) {
+        drawable->selected(true);
+        _selectedDrawablesValid = false;
+    }
 }
 
 void DocumentCanvas::on_removeEntityEvent(const lc::event::RemoveEntityEvent& event) {
@@ -501,6 +705,38 @@ void DocumentCanvas::on_removeEntityEvent(const lc::event::RemoveEntityEvent& ev
         (*_painterPtr).deleteEntityCached( (event.entity())->id() );  // Delete the cacahed pack
 }
 
+void DocumentCanvas::on_replaceLayerEvent(const lc::event::ReplaceLayerEvent& event) {
+    invalidateStyles();
+}
+
+void DocumentCanvas::on_removeLayerEvent(const lc::event::RemoveLayerEvent& event) {
+    invalidateStyles();
+}
+
+void DocumentCanvas::on_addLinePatternEvent(const lc::event::AddLinePatternEvent& event) {
+    invalidateStyles();
+}
+
+void DocumentCanvas::on_replaceLinePatternEvent(const lc::event::ReplaceLinePatternEvent& event) {
+    invalidateStyles();
+}
+
+void DocumentCanvas::on_removeLinePatternEvent(const lc::event::RemoveLinePatternEvent& event) {
+    invalidateStyles();
+}
+
+void DocumentCanvas::invalidateStyles() {
+    _styleGeneration++;
+    _styles.clear();
+
+    // Cached entities contain the old width and dashes
+    if(_painterPtr != nullptr && _painterPtr->isCachingEnabled()) {
+        _entityDrawItem.each([this](ID_DATATYPE id, const LCVDrawItem_SPtr&) {
+            _painterPtr->deleteEntityCached(id);
+        });
+    }
+}
+
 std::shared_ptr<lc::storage::Document> DocumentCanvas::document() const {
     return _document;
 }
@@ -523,16 +759,14 @@ void DocumentCanvas::makeSelection(double x, double y, double w, double h, bool
     // std::cout << *_selectedArea << std::endl;
     _selectedAreaIntersects = occupies;
 
-    // remove old new selection
-    for(const auto& di: _newSelection) {
-        di->selected(false);
-    }
-    _newSelection.clear();
-
     // Refresh: old new selection has been canceled
-    for(const auto& di: _selectedDrawables) {
-        di->selected(true);
-    }
+    _newSelection.each([this](ID_DATATYPE id) {
+        auto di = drawableByID(id);
+        if(di) {
+            di->selected(_selection.contains(id));
+        }
+    });
+    _newSelection.clear();
 
     lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr> entitiesInSelection;
     if (occupies) {
@@ -542,17 +776,20 @@ void DocumentCanvas::makeSelection(double x, double y, double w, double h, bool
         entitiesInSelection = entityContainer().entitiesWithinAndCrossingArea(*_selectedArea);
     }
     entitiesInSelection.each< const lc::entity::CADEntity >([&](lc::entity::CADEntity_CSPtr entity) {
-        auto di = _entityDrawItem[entity->id()];
         // add if it does not previously exist
-        auto iter = std::find(_newSelection.begin(), _newSelection.end(), di);
-        if(iter == _newSelection.end())
-            _newSelection.push_back(di);// indicate needs update
-        di->selected(!di->selected());
+        if(!_newSelection.insert(entity->id())) {
+            return;
+        }
+
+        auto di = drawableByID(entity->id());
+        if(di) {
+            di->selected(!_selection.contains(entity->id()));
+        }
     });
 }
 
 lc::viewer::LCVDrawItem_SPtr DocumentCanvas::getDrawable(const lc::entity::CADEntity_CSPtr& entity) {
-    return _entityDrawItem[entity->id()];
+    return drawableByID(entity->id());
 }
 
 void DocumentCanvas::makeSelectionDevice(LcPainter& painter, unsigned int x, unsigned int y, unsigned int w, unsigned int h, bool occupies) {
@@ -571,29 +808,15 @@ void DocumentCanvas::makeSelectionDevice(LcPainter& painter, unsigned int x, uns
 }
 
 void DocumentCanvas::closeSelection() {
-    _updatedSelection.clear();
-    for(const auto& drawable: _newSelection) {
-        auto iter = std::find(_selectedDrawables.begin(), _selectedDrawables.end(), drawable);
-        if(iter == _selectedDrawables.end()) {
-            if(drawable->selected())
-                _selectedDrawables.push_back(drawable);
-            _updatedSelection.push_back(drawable);
-        } else {
-            if(!drawable->selected()) {
-                _updatedSelection.push_back(drawable);
-                _selectedDrawables.erase(iter);
-                drawable->selected(false);
-            }
-        }
-    };
+    // The entities in the area are toggled
+    lc::tools::IDSet added = _newSelection;
+    added.subtract(_selection);
+
+    lc::tools::IDSet removed = _newSelection;
+    removed.subtract(added);
 
     _newSelection.clear();
-    // Refresh
-    for(const auto& di: _selectedDrawables) {
-        di->selected(true);
-    }
-    if(_updatedSelection.size())
-        _selectionChanged();
+    changeSelection(added, removed);
 }
 
 void DocumentCanvas::removeSelectionArea() {
@@ -604,46 +827,74 @@ void DocumentCanvas::removeSelectionArea() {
 }
 
 void DocumentCanvas::selectAll() {
-    _selectedDrawables.clear();
     _newSelection.clear();
 
-    entityContainer().each< const lc::entity::CADEntity >([&](lc::entity::CADEntity_CSPtr entity) {
-        _entityDrawItem[entity->id()]->selected(true);
-        _selectedDrawables.push_back(_entityDrawItem[entity->id()]);
-    });
-    selectionChanged();
+    auto added = viewportEntities();
+    added.subtract(_selection);
+    changeSelection(added, lc::tools::IDSet());
 }
 
 void DocumentCanvas::removeSelection() {
-    for(const auto& di: _selectedDrawables) {
-        di->selected(false);
-    };
-
-    _selectedDrawables.clear();
-    selectionChanged();
+    auto removed = _selection;
+    changeSelection(lc::tools::IDSet(), removed);
 }
 
 void DocumentCanvas::inverseSelection() {
-    std::vector<lc::viewer::LCVDrawItem_SPtr> selectedDrawables;
     _newSelection.clear();
 
-    entityContainer().each< const lc::entity::CADEntity >([&](lc::entity::CADEntity_CSPtr entity) {
-        lc::viewer::LCVDrawItem_SPtr item = _entityDrawItem[entity->id()];
-        auto iter = std::find(_selectedDrawables.begin(), _selectedDrawables.end(), item);
-        if (iter != _selectedDrawables.end())
-        {
-            item->selected(false);
+    auto added = viewportEntities();
+    added.subtract(_selection);
+
+    auto removed = _selection;
+    changeSelection(added, removed);
+}
+
+void DocumentCanvas::changeSelection(const lc::tools::IDSet& added, const lc::tools::IDSet& removed) {
+    if(added.empty() && removed.empty()) {
+        return;
+    }
+
+    _selection.subtract(removed);
+    _selection.unite(added);
+
+    removed.each([this](ID_DATATYPE id) {
+        auto di = drawableByID(id);
+        if(di) {
+            di->selected(false);
         }
-        else
-        {
-            item->selected(true);
-            selectedDrawables.push_back(item);
+    });
+    added.each([this](ID_DATATYPE id) {
+        auto di = drawableByID(id);
+        if(di) {
+            di->selected(true);
         }
     });
-    _selectedDrawables = selectedDrawables;
+
+    _selectionChange.added = added.ids();
+    _selectionChange.removed = removed.ids();
+    _selectedDrawablesValid = false;
     _selectionChanged();
 }
 
+lc::tools::IDSet DocumentCanvas::viewportEntities() const {
+    lc::tools::IDSet entities;
+    _document->snapshot()->each([&](const lc::entity::CADEntity_CSPtr& entity) {
+        auto block = entity->block();
+        if(_viewport == nullptr ? block == nullptr : block != nullptr && block->name() == _viewport->name()) {
+            entities.insert(entity->id());
+        }
+    });
+    return entities;
+}
+
+LCVDrawItem_SPtr DocumentCanvas::drawableByID(ID_DATATYPE id) const {
+    auto drawable = _entityDrawItem.find(id);
+    if(drawable == nullptr) {
+        return nullptr;
+    }
+    return *drawable;
+}
+
 Nano::Signal<void(lc::viewer::event::DrawEvent const & event)> & DocumentCanvas::background ()  {
     return _background;
 }
@@ -655,152 +906,75 @@ Nano::Signal<void()> & DocumentCanvas::selectionChanged()  {
     return _selectionChanged;
 }
 
-LCVDrawItem_SPtr DocumentCanvas::asDrawable(const lc::entity::CADEntity_CSPtr& entity) {
-    // Add a line
-    auto line = std::dynamic_pointer_cast<const lc::entity::Line>(entity);
-
-    if (line != nullptr) {
-        return std::make_shared<LCVLine>(line);
-    }
-
-    // Add a hatch
-    auto hatch = std::dynamic_pointer_cast<const lc::entity::Hatch>(entity);
-
-    if (hatch != nullptr) {
-        return std::make_shared<LCVHatch>(hatch);
-    }
-
-    // Add a circle
-    auto circle = std::dynamic_pointer_cast<const lc::entity::Circle>(entity);
-
-    if (circle != nullptr) {
-        return std::make_shared<LCVCircle>(circle);
-    }
-
-    // Add a Arc
-    auto arc = std::dynamic_pointer_cast<const lc::entity::Arc>(entity);
-
-    if (arc != nullptr) {
-        return std::make_shared<LCVArc>(arc);
-    }
-
-
-    // Add Ellipse
-    auto ellipse = std::dynamic_pointer_cast<const lc::entity::Ellipse>(entity);
-
-    if (ellipse != nullptr) {
-        return std::make_shared<LCVEllipse>(ellipse);
-    }
-
-    // Add Text
-    auto text = std::dynamic_pointer_cast<const lc::entity::Text>(entity);
-
-    if (text != nullptr) {
-        return std::make_shared<LCVText>(text);
-    }
-
-    // Add 'Point' or 'Coordinate'
-    auto coord = std::dynamic_pointer_cast<const lc::entity::Point>(entity);
-
-    // Point cannot be cached since it change size(constant size)
-    if (coord != nullptr) {
-        auto di = std::make_shared<LCVPoint>(coord);
-        di->cacheable(false);
-        return di;
-    }
-
-    // Add 'DimRadial'
-    auto dimRadial = std::dynamic_pointer_cast<const lc::entity::DimRadial>(entity);
-
-    if (dimRadial != nullptr) {
-        return std::make_shared<LCDimRadial>(dimRadial);
-    }
-
-    // Add 'DimDiametric'
-    auto dimDiametric = std::dynamic_pointer_cast<const lc::entity::DimDiametric>(entity);
-
-    if (dimDiametric != nullptr) {
-        return std::make_shared<LCDimDiametric>(dimDiametric);
-    }
-
-    // Add 'DimLinear'
-    auto dimLinear = std::dynamic_pointer_cast<const lc::entity::DimLinear>(entity);
-
-    if (dimLinear != nullptr) {
-        return std::make_shared<LCDimLinear>(dimLinear);
-    }
-
-    // Add 'DimAligned'
-    auto dimAligned = std::dynamic_pointer_cast<const lc::entity::DimAligned>(entity);
-
-    if (dimAligned != nullptr) {
-        return std::make_shared<LCDimAligned>(dimAligned);
-    }
-
-    // Add 'DimAngular'
-    auto dimAngular = std::dynamic_pointer_cast<const lc::entity::DimAngular>(entity);
-
-    if (dimAngular != nullptr) {
-        return std::make_shared<LCDimAngular>(dimAngular);
-    }
-
-    // Add 'LWPolyline'
-    auto lwPolyline = std::dynamic_pointer_cast<const lc::entity::LWPolyline>(entity);
-
-    if (lwPolyline != nullptr) {
-        return std::make_shared<LCLWPolyline>(lwPolyline);
-    }
-
-    // Add 'Spline'
-    auto spline = std::dynamic_pointer_cast<const lc::entity::Spline>(entity);
-
-    if (spline != nullptr) {
-        return std::make_shared<LCVSpline>(spline);
-    }
-
-    // Add 'Image'
-    auto image = std::dynamic_pointer_cast<const lc::entity::Image>(entity);
-
-    if (image != nullptr) {
-        return std::make_shared<LCImage>(image);
-    }
+bool DocumentCanvas::takeDrawablesReady() {
+    return _drawablesReady->exchange(false);
+}
 
-    // Add 'Insert'
-    auto insert = std::dynamic_pointer_cast<const lc::entity::Insert>(entity);
+void DocumentCanvas::waitForDrawables() const {
+    _entityDrawItem.each([](ID_DATATYPE, const LCVDrawItem_SPtr& drawable) {
+        if(drawable != nullptr) {
+            drawable->wait();
+        }
+    });
+}
 
-    if (insert != nullptr) {
-        return std::make_shared<LCVInsert>(insert);
+LCVDrawItem_SPtr DocumentCanvas::asDrawable(const lc::entity::CADEntity_CSPtr& entity, const std::function<void()>& ready) {
+    if(entity == nullptr) {
+        return nullptr;
     }
 
-    return nullptr;
+    DrawableFactory factory(ready);
+    entity->dispatch(factory);
+    return factory.drawable;
 }
 
 void DocumentCanvas::updateSelection() {
-    std::vector<lc::viewer::LCVDrawItem_SPtr> newSelection;
-    for(const auto& di: _selectedDrawables) {
-        auto oldEntity=di->entity();
-        auto newEntity=_document->entityByID(oldEntity->id());
-        if(oldEntity!=newEntity) {
-            auto newdi = _entityDrawItem[oldEntity->id()];
-            if(newdi) {
-                newSelection.push_back(newdi);
-                newdi->selected(true);
-            }
+    // Modified entities have new drawables with the same ID
+    lc::tools::IDSet removed;
+    _selection.each([&](ID_DATATYPE id) {
+        auto di = drawableByID(id);
+        if(di) {
+            di->selected(true);
         }
-        else
-            newSelection.push_back(di);
-    }
-    _selectedDrawables = newSelection;
+        else {
+            removed.insert(id);
+        }
+    });
+    _selection.subtract(removed);
+
+    _selectionChange.added.clear();
+    _selectionChange.removed = removed.ids();
+    _selectedDrawablesValid = false;
     _selectionChanged();
 }
 
 std::vector<lc::viewer::LCVDrawItem_SPtr>& DocumentCanvas::selectedDrawables() {
+    if(!_selectedDrawablesValid) {
+        _selectedDrawables.clear();
+        _selectedDrawables.reserve(_selection.size());
+        _selection.each([this](ID_DATATYPE id) {
+            auto di = drawableByID(id);
+            if(di) {
+                _selectedDrawables.push_back(di);
+            }
+        });
+        _selectedDrawablesValid = true;
+    }
+
     return _selectedDrawables;
 }
 
+const lc::tools::IDSet& DocumentCanvas::selection() const {
+    return _selection;
+}
+
+const SelectionChange& DocumentCanvas::lastSelectionChange() const {
+    return _selectionChange;
+}
+
 lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr> DocumentCanvas::selectedEntities() {
     lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr> entitiesInSelection;
-    for(const auto& di: _selectedDrawables) {
+    for(const auto& di: selectedDrawables()) {
         entitiesInSelection.insert(di->entity());
     }
     return entitiesInSelection;
@@ -823,10 +997,18 @@ void DocumentCanvas::selectPoint(double x, double y) {
     auto point = geo::Coordinate(x,y);
     double mwh = sqrt(2)*w;
 
-    _updatedSelection.clear();
+    lc::tools::IDSet added;
+    lc::tools::IDSet removed;
     lc::geo::Area selectionArea(lc::geo::Coordinate(x - w, y - w), w * 2, w * 2);
-    auto entities = entityContainer().entitiesWithinAndCrossingAreaFast(selectionArea);
-    entities.each< const lc::entity::CADEntity >([=](lc::entity::CADEntity_CSPtr entity) {
+    std::vector<lc::entity::CADEntity_CSPtr> entities;
+    if(_viewport == nullptr) {
+        entities = _document->snapshot()->entitiesWithinAndCrossingAreaFast(selectionArea);
+    }
+    else {
+        entities = entityContainer().entitiesWithinAndCrossingAreaFast(selectionArea).asVector();
+    }
+
+    for(const auto& entity : entities) {
         //Check if it is on entity
         auto snapable = std::dynamic_pointer_cast<const lc::entity::Snapable>(entity);
 
@@ -836,29 +1018,23 @@ void DocumentCanvas::selectPoint(double x, double y) {
             //std::cout << nearestPoint << std::endl;
             //std::cout << point << std::endl;
             if (distance>mwh)
-                return;
+                continue;
         };
-        auto di = _entityDrawItem[entity->id()];
-        auto iter = std::find(_selectedDrawables.begin(), _selectedDrawables.end(), di);
-        //if not found in selected drawables
-        if (iter==_selectedDrawables.end()) {
-            di->selected(true);
-            _selectedDrawables.push_back(di);
-            _updatedSelection.push_back(di);
+        if (_selection.contains(entity->id())) {
+            removed.insert(entity->id());
         } else {
-            di->selected(false);
-            _selectedDrawables.erase(iter);
-            _updatedSelection.push_back(di);
+            added.insert(entity->id());
         }
-    });
-    if(_updatedSelection.size())
-        _selectionChanged();
+    }
+    changeSelection(added, removed);
 }
 
 void DocumentCanvas::selectEntity(lc::entity::CADEntity_CSPtr entityPtr) {
-    lc::viewer::LCVDrawItem_SPtr entityDrawable = getDrawable(entityPtr);
-    entityDrawable->selected(true);
-    _selectedDrawables.push_back(entityDrawable);
+    lc::tools::IDSet added;
+    if(!_selection.contains(entityPtr->id())) {
+        added.insert(entityPtr->id());
+    }
+    changeSelection(added, lc::tools::IDSet());
 }
 
 std::vector<std::string> DocumentCanvas::getFontList() const {
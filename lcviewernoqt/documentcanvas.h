@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <tuple>
 #include <utility>
 
 #include "painters/lcpainter.h"
@@ -13,9 +15,16 @@
 #include <cad/events/addentityevent.h>
 #include <cad/events/commitprocessevent.h>
 #include <cad/events/removeentityevent.h>
+#include <cad/events/replacelayerevent.h>
+#include <cad/events/removelayerevent.h>
+#include <cad/events/addlinepatternevent.h>
+#include <cad/events/replacelinepatternevent.h>
+#include <cad/events/removelinepatternevent.h>
 #include <nano-signal-slot/nano_signal_slot.hpp>
 
 #include <cad/storage/document.h>
+#include <cad/tools/idmap.h>
+#include <cad/tools/idset.h>
 
 // Minimum linewidth we render, below this the lines might start to look 'jagged'
 // We might want to consider at lower linewidth to simply reduce alpha to get a similar effect of smaller line?
@@ -30,6 +39,14 @@ enum PainterType {
 };
 
 
+/**
+ * @brief IDs of the entities added to and removed from the selection by a change
+ */
+struct SelectionChange {
+    std::vector<ID_DATATYPE> added;
+    std::vector<ID_DATATYPE> removed;
+};
+
 class DocumentCanvas : public std::enable_shared_from_this<DocumentCanvas> {
 public:
     DocumentCanvas(const std::shared_ptr<lc::storage::Document>& document,
@@ -178,11 +195,27 @@ public:
 
     /**
     * @brief Updates the selected entities based on ID
+    * Entities which are not in the document anymore are removed from the selection.
     */
     void updateSelection();
 
+    /**
+     * @brief Drawables of the selected entities, in no particular order
+     * The vector is built again after each selection change.
+     */
     std::vector<lc::viewer::LCVDrawItem_SPtr>& selectedDrawables();
 
+    /**
+     * @brief IDs of the selected entities
+     */
+    const lc::tools::IDSet& selection() const;
+
+    /**
+     * @brief Entities added to and removed from the selection by the last change
+     * Valid when selectionChanged() is emitted.
+     */
+    const SelectionChange& lastSelectionChange() const;
+
     lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr> selectedEntities();
 
     /**
@@ -194,6 +227,18 @@ public:
     Nano::Signal<void(event::DrawEvent const& drawEvent)>& foreground();
     Nano::Signal<void()>& selectionChanged();
 
+    /**
+     * @brief Check if drawables finished computing their geometry in the background since the last call
+     * Set from worker threads, polled from the UI thread which then repaints.
+     */
+    bool takeDrawablesReady();
+
+    /**
+     * @brief Block until all drawables computed their geometry
+     * Needed before rendering a single frame, such as an export, which must not show placeholders.
+     */
+    void waitForDrawables() const;
+
     /**
      * Return the underlaying document
      */
@@ -207,8 +252,10 @@ public:
 
     /**
      * Return CADEntity as LCVDrawItem
+     * @param ready Called from a worker thread when a drawable computed in the background becomes ready
      */
-    static LCVDrawItem_SPtr asDrawable(const lc::entity::CADEntity_CSPtr& entity);
+    static LCVDrawItem_SPtr asDrawable(const lc::entity::CADEntity_CSPtr& entity,
+                                       const std::function<void()>& ready = nullptr);
 
     /**
      * @brief Convert device coordinate to user coordinate
@@ -245,6 +292,37 @@ private:
 
     void on_commitProcessEvent(const lc::event::CommitProcessEvent&);
 
+    void on_replaceLayerEvent(const lc::event::ReplaceLayerEvent&);
+
+    void on_removeLayerEvent(const lc::event::RemoveLayerEvent&);
+
+    void on_addLinePatternEvent(const lc::event::AddLinePatternEvent&);
+
+    void on_replaceLinePatternEvent(const lc::event::ReplaceLinePatternEvent&);
+
+    void on_removeLinePatternEvent(const lc::event::RemoveLinePatternEvent&);
+
+    /**
+     * @brief Drop all resolved styles, they are computed again when the items are drawn
+     */
+    void invalidateStyles();
+
+    /**
+     * @brief Return the resolved style of a draw item
+     * The style is cached in the item until the layers or line patterns change
+     */
+    LCVDrawStyle_CSPtr drawStyle(const LCVDrawItem_CSPtr& drawable, const lc::entity::Insert_CSPtr& insert);
+
+    /**
+     * @brief Set line width, dashes and color of the painter
+     */
+    void applyStyle(LcPainter& painter, const LCVDrawStyle& style, bool selected) const;
+
+    /**
+     * @brief Draw items grouped by style, the painter state only changes between groups
+     */
+    void drawStyled(LcPainter& painter, std::vector<std::pair<LCVDrawStyle_CSPtr, LCVDrawItem_SPtr>>& drawables);
+
     double drawWidth(const lc::entity::CADEntity_CSPtr& entity, const lc::entity::Insert_CSPtr& insert);
 
     std::vector<double> drawLinePattern(
@@ -254,14 +332,13 @@ private:
     );
 
     lc::Color drawColor(const lc::entity::CADEntity_CSPtr& entity,
-                        const lc::entity::Insert_CSPtr& insert,
-                        bool selected);
+                        const lc::entity::Insert_CSPtr& insert);
 
     // Original document
     std::shared_ptr<lc::storage::Document> _document;
 
-    // Map of cad entity to drawitem
-    std::map<unsigned long, lc::viewer::LCVDrawItem_SPtr> _entityDrawItem;
+    // Drawable of each entity, by entity ID
+    lc::tools::IDMap<lc::viewer::LCVDrawItem_SPtr> _entityDrawItem;
 
     // map with key=id
     std::map< unsigned long, std::pair <lc::entity::CADEntity_CSPtr, lc::viewer::LCVDrawItem_SPtr> > _cachedEntites;
@@ -269,10 +346,17 @@ private:
     // Painter
     lc::viewer::LcPainter* _painterPtr;
 
+    // Resolved styles by meta info, layer and insert. Changes when the layers or line patterns change
+    unsigned int _styleGeneration;
+    unsigned long _nextStyleId;
+    std::map<std::tuple<lc::meta::MetaInfo_CSPtr, lc::meta::Layer_CSPtr, lc::entity::Insert_CSPtr>, LCVDrawStyle_CSPtr> _styles;
+
     //Signals
     Nano::Signal<void(event::DrawEvent const& event)> _background;
     Nano::Signal<void(event::DrawEvent const& event)> _foreground;
     Nano::Signal<void()> _selectionChanged;
+    std::shared_ptr<std::atomic<bool>> _drawablesReady;
+    std::function<void()> _onDrawableReady;
 
     // Maximum and minimum allowed scale factors
     double _zoomMin;
@@ -292,9 +376,31 @@ private:
     // Functor to draw a selected area, that's the green or read area...
     std::function<void(lc::viewer::LcPainter&, lc::geo::Area, bool)> _selectedAreaPainter;
 
+    /**
+     * @brief Return the drawable of an entity, nullptr if it isn't drawn by this canvas
+     */
+    LCVDrawItem_SPtr drawableByID(ID_DATATYPE id) const;
+
+    /**
+     * @brief IDs of all the entities of the viewport
+     * Read from the document snapshot, which avoids copying the entity container
+     */
+    lc::tools::IDSet viewportEntities() const;
+
+    /**
+     * @brief Apply a change to the selection, update the drawables and emit selectionChanged()
+     */
+    void changeSelection(const lc::tools::IDSet& added, const lc::tools::IDSet& removed);
+
+    // Selected entities
+    lc::tools::IDSet _selection;
+    // Entities inside the selection area which is being drawn, their selected state is toggled
+    lc::tools::IDSet _newSelection;
+    SelectionChange _selectionChange;
+
+    // Built from _selection when requested
     std::vector<lc::viewer::LCVDrawItem_SPtr> _selectedDrawables;
-    std::vector<lc::viewer::LCVDrawItem_SPtr> _newSelection;
-    std::vector<lc::viewer::LCVDrawItem_SPtr> _updatedSelection;
+    bool _selectedDrawablesValid;
 
     std::function<void(double*, double*)> _deviceToUser;
 
@@ -9,17 +9,26 @@ TempEntities::TempEntities(DocumentCanvas_SPtr docCanvas) :
 }
 
 void TempEntities::addEntity(lc::entity::CADEntity_CSPtr entity) {
-    _entities.insert(std::move(entity));
+    _drawables.insert(entity->id(), DocumentCanvas::asDrawable(entity));
     requestUpdateEvent()();
 }
 
 void TempEntities::removeEntity(lc::entity::CADEntity_CSPtr entity) {
-    _entities.remove(std::move(entity));
+    _drawables.erase(entity->id());
+    requestUpdateEvent()();
+}
+
+void TempEntities::replaceEntities(const std::vector<lc::entity::CADEntity_CSPtr>& entities) {
+    for(const auto& entity : entities) {
+        _drawables.insert(entity->id(), DocumentCanvas::asDrawable(entity));
+    }
     requestUpdateEvent()();
 }
 
 void TempEntities::onDraw(lc::viewer::event::DrawEvent const &event) {
-    _entities.each<const lc::entity::CADEntity>([&](lc::entity::CADEntity_CSPtr entity) {
-        _docCanvas->drawEntity(event.painter(), _docCanvas->asDrawable(entity));
+    _drawables.each([&](ID_DATATYPE id, const LCVDrawItem_SPtr& drawable) {
+        if(drawable) {
+            _docCanvas->drawEntity(event.painter(), drawable);
+        }
     });
 }
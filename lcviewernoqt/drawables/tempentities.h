@@ -1,7 +1,7 @@
 #pragma once
 
 #include <cad/base/cadentity.h>
-#include <cad/storage/entitycontainer.h>
+#include <cad/tools/idmap.h>
 #include "../drawitems/lcvdrawitem.h"
 #include "../events/drawevent.h"
 #include "../documentcanvas.h"
@@ -33,6 +33,13 @@ public:
      */
     void removeEntity(lc::entity::CADEntity_CSPtr entity);
 
+    /**
+     * \brief Add entities, replacing the entities with the same ID
+     * Only one update is requested.
+     * \param entities Entities to add
+     */
+    void replaceEntities(const std::vector<lc::entity::CADEntity_CSPtr>& entities);
+
     /**
      * \brief Draw all the entities
      */
@@ -43,7 +50,8 @@ public:
 
 private:
     DocumentCanvas_SPtr _docCanvas;
-    lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr> _entities;
+    // Drawables are created once, when the entity is added
+    lc::tools::IDMap<LCVDrawItem_SPtr> _drawables;
     Nano::Signal<void()> _requestUpdateEvent;
 };
 
@@ -6,7 +6,8 @@ LCVDrawItem::LCVDrawItem(const lc::entity::CADEntity_CSPtr& entity, bool selecta
     _selectable(selectable),
     _selected(false),
     _cacheable(true),
-    _autostroke(true) {
+    _autostroke(true),
+    _styleGeneration(0) {
 }
 
 bool LCVDrawItem::selectable() const {
@@ -37,3 +38,12 @@ void LCVDrawItem::autostroke(bool stroke) {
     _autostroke = stroke;
 }
 
+
+LCVDrawStyle_CSPtr LCVDrawItem::style(unsigned int generation) const {
+    return _styleGeneration == generation ? _style : nullptr;
+}
+
+void LCVDrawItem::style(const LCVDrawStyle_CSPtr& style, unsigned int generation) const {
+    _style = style;
+    _styleGeneration = generation;
+}
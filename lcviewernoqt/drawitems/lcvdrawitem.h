@@ -1,8 +1,10 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <cad/const.h>
 #include <cad/base/cadentity.h>
+#include <cad/meta/color.h>
 
 namespace lc {
 namespace geo {
@@ -14,6 +16,19 @@ namespace viewer {
 class LcDrawOptions;
 class LcPainter;
 
+/**
+ * Color, line width and dash pattern of an entity after resolving ByLayer and ByBlock
+ * Items with the same meta info, layer and insert share the same style.
+ */
+struct LCVDrawStyle {
+    lc::Color color;
+    double width;
+    std::vector<double> dashes;
+    unsigned long id; // Creation order, styles are drawn in this order
+};
+
+DECLARE_SHORT_SHARED_PTR(LCVDrawStyle)
+
 /**
 * LCVDrawItem is a abstract class that any class needs to implement if it wants to draw an entity on backgrounds or foregrounds
 * For other objects (Cursor, ...) see files in drawables folder
@@ -43,6 +58,32 @@ public:
     bool autostroke() const;
     void autostroke(bool stroke);
 
+    /**
+     * @brief Return true while the geometry is computed in the background
+     * Pending items draw a placeholder, they must not be cached.
+     */
+    virtual bool pending() const {
+        return false;
+    }
+
+    /**
+     * @brief Block until the geometry computed in the background is ready
+     */
+    virtual void wait() const {
+    }
+
+    /**
+     * @brief Return the resolved style if it was computed for the given generation
+     * @return style or nullptr
+     */
+    LCVDrawStyle_CSPtr style(unsigned int generation) const;
+
+    /**
+     * @brief Store the resolved style, computed by DocumentCanvas
+     * The style is a cache and can be set on a const item.
+     */
+    void style(const LCVDrawStyle_CSPtr& style, unsigned int generation) const;
+
     /**
      * @brief Return the entity which is drawn
      * @return Entity
@@ -54,6 +95,9 @@ private:
     bool _selected;
     bool _cacheable;
     bool _autostroke;
+
+    mutable LCVDrawStyle_CSPtr _style;
+    mutable unsigned int _styleGeneration;
 };
 
 DECLARE_SHORT_SHARED_PTR(LCVDrawItem)
@@ -1,178 +1,182 @@
 #include "lcvhatch.h"
 #include "../painters/lcpainter.h"
 #include "../lcdrawoptions.h"
-#include "cad/primitive/arc.h"
-#include "cad/primitive/line.h"
-#include "cad/primitive/ellipse.h"
-#include "cad/primitive/spline.h"
-#include "cad/primitive/lwpolyline.h"
-#include <documentcanvas.h>
-#include <cad/math/intersect.h>
+#include <cad/tools/threadpool.h>
+#include <chrono>
+#include <cmath>
+#include <mutex>
 
 using namespace lc::viewer;
-LCVHatch::LCVHatch(const lc::entity::Hatch_CSPtr& hatch) :
+
+namespace {
+/**
+ * Number of pattern rows clipped per task
+ */
+const size_t PATTERN_ROWS_PER_TASK = 4;
+
+/**
+ * Pattern lines of a hatch, clipped by its region
+ * The pattern tile is repeated on a grid which is rotated with the pattern
+ */
+std::vector<lc::geo::Vector> patternSegments(const lc::entity::Hatch_CSPtr& hatch) {
+    std::vector<lc::geo::Vector> result;
+    const auto& region = hatch->getRegion();
+    const auto& pattern = hatch->getPattern();
+    double hsize = pattern.boundingBox.maxP().x();
+    double vsize = pattern.boundingBox.maxP().y();
+    double scale = hatch->getScale();
+    double angle = hatch->getAngle();
+
+    if (region.numLoops() == 0 || hsize <= 0. || vsize <= 0. || scale <= 0.) {
+        return result;
+    }
+
+    const auto& tile = pattern.segments;
+
+    // Bounds of the region in pattern space
+    auto bbox = region.boundingBox();
+    auto toPattern = [angle, scale](const lc::geo::Coordinate& point) {
+        return point.rotate(-angle) / scale;
+    };
+    auto patternBounds = lc::geo::Area(toPattern(bbox.minP()), toPattern(bbox.maxP()))
+                         .merge(toPattern(lc::geo::Coordinate(bbox.minP().x(), bbox.maxP().y())))
+                         .merge(toPattern(lc::geo::Coordinate(bbox.maxP().x(), bbox.minP().y())));
+
+    // One extra tile on each side, pattern entities can go beyond their tile
+    int xmin = static_cast<int>(std::floor(patternBounds.minP().x() / hsize)) - 1;
+    int xmax = static_cast<int>(std::floor(patternBounds.maxP().x() / hsize)) + 1;
+    int ymin = static_cast<int>(std::floor(patternBounds.minP().y() / vsize)) - 1;
+    int ymax = static_cast<int>(std::floor(patternBounds.maxP().y() / vsize)) + 1;
+
+    std::mutex resultMutex;
+    lc::tools::ThreadPool::instance().parallelFor(ymax - ymin + 1, PATTERN_ROWS_PER_TASK, [&](size_t begin, size_t end) {
+        std::vector<lc::geo::Vector> segments;
+
+        for (size_t row = begin; row < end; row++) {
+            int j = ymin + static_cast<int>(row);
+
+            for (int i = xmin; i <= xmax; i++) {
+                lc::geo::Coordinate offset(i * hsize, j * vsize);
+
+                for (const auto& segment : tile) {
+                    auto start = ((segment.start() + offset) * scale).rotate(angle);
+                    auto end = ((segment.end() + offset) * scale).rotate(angle);
+
+                    if (!lc::geo::Area(start, end).overlaps(bbox)) {
+                        continue;
+                    }
+
+                    auto parts = region.clip(lc::geo::Vector(start, end));
+                    segments.insert(segments.end(), parts.begin(), parts.end());
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result.insert(result.end(), segments.begin(), segments.end());
+    });
+
+    return result;
+}
+}
+
+LCVHatch::LCVHatch(const lc::entity::Hatch_CSPtr& hatch, const std::function<void()>& ready) :
     LCVDrawItem(hatch, true),
     _hatch(hatch) {
-}
+    // The fill is set before calling ready, a repaint requested by ready never sees a pending fill
+    auto fill = std::make_shared<std::promise<std::shared_ptr<const Fill>>>();
+    _fill = fill->get_future().share();
 
-void LCVHatch::drawSolid(LcPainter& painter, const LcDrawOptions &options, const lc::geo::Area& rect) const {
-    // Hatch for solid fill based on approximation
-    auto& reg = _hatch->getRegion();
-    auto bbox = reg.boundingBox();
-    auto minP = bbox.minP();
-    auto maxP = bbox.maxP();
-    unsigned int APPROX_POINTS = 300;
-    float delta = (maxP.y() - minP.y())/(float)APPROX_POINTS;
-    std::vector<float> oldI;
-    float oldIY=minP.y();
-    float extraSize=-delta;//Comensation if odd intersection is found, delta for first run
-    std::vector<float> oldOk;
-    for (float i=minP.y(); i<=maxP.y(); i+=delta)
-    {
-        std::vector<lc::geo::Coordinate> newIc = reg.getLineIntersection(
-                    lc::geo::Vector(
-                        lc::geo::Coordinate(minP.x()-delta, i),
-                        lc::geo::Coordinate(maxP.x()+delta, i)
-                    )
-                );
-        std::vector<float> newI;
-        for (auto &i : newIc) {
-            newI.push_back(i.x());
-        }//sort
-        sort(newI.begin(), newI.end());
-        if (newI.size()!=oldI.size() || newI.size()%2!=0) {
-            //Proper block not found, approximate with newerData
-            extraSize += delta;
-            oldI = newI;
-            oldIY = i;
-            continue;
+    lc::tools::ThreadPool::instance().enqueue([hatch, ready, fill]() {
+        try {
+            fill->set_value(computeFill(hatch));
         }
-        //Counter for old and new loop
-        for(unsigned int x=0; x<newI.size(); x+=2) {
-            auto oldY = i-delta-extraSize;
-            painter.move_to(oldI[x], oldY);
-            painter.line_to(newI[x], i);
-            painter.line_to(newI[x+1], i);
-            painter.line_to(oldI[x+1], oldY);
-            painter.close_path();
-            painter.fill();
+        catch (...) {
+            fill->set_exception(std::current_exception());
         }
-        extraSize=0.;
-        oldI = newI;
-        oldIY = i;
-        oldOk = newI;
+
+        if (ready) {
+            ready();
+        }
+    });
+}
+
+std::shared_ptr<const LCVHatch::Fill> LCVHatch::computeFill(const lc::entity::Hatch_CSPtr& hatch) {
+    auto fill = std::make_shared<Fill>();
+
+    if (hatch->isSolid()) {
+        fill->trapezoids = hatch->getRegion().trapezoids();
     }
-    if(extraSize!=0) { //Last size failed too
-        for(unsigned int x=0; x<oldOk.size(); x+=2) {
-            auto oldY = oldIY-delta;
-            auto newY = oldY+extraSize;
-            painter.move_to(oldOk[x], oldY);
-            painter.line_to(oldOk[x], newY);
-            painter.line_to(oldOk[x+1], newY);
-            painter.line_to(oldOk[x+1], oldY);
-            painter.close_path();
-            painter.fill();
+    else {
+        fill->segments = patternSegments(hatch);
+    }
+
+    return fill;
+}
+
+void LCVHatch::drawSolid(LcPainter& painter, const Fill& fill, const lc::geo::Area& rect) const {
+    const auto& trapezoids = fill.trapezoids;
+
+    for (size_t i = 0; i + 3 < trapezoids.size(); i += 4) {
+        // Trapezoids have horizontal bases, skip the ones above or below the visible area
+        if (trapezoids[i + 2].y() < rect.minP().y() || trapezoids[i].y() > rect.maxP().y()) {
+            continue;
         }
+
+        painter.move_to(trapezoids[i].x(), trapezoids[i].y());
+        painter.line_to(trapezoids[i + 1].x(), trapezoids[i + 1].y());
+        painter.line_to(trapezoids[i + 2].x(), trapezoids[i + 2].y());
+        painter.line_to(trapezoids[i + 3].x(), trapezoids[i + 3].y());
+        painter.close_path();
+        painter.fill();
     }
 }
 
-std::vector<lc::entity::CADEntity_CSPtr> getPatterrnEntitiesFromHatch(const lc::entity::Hatch_CSPtr& hatch) {
-    std::vector<lc::entity::CADEntity_CSPtr> entities;
-    auto& reg = hatch->getRegion();
-    auto bbox = reg.boundingBox();
-    auto scale = hatch->getScale();
-    auto angle = hatch->getAngle();
-    float hsize = hatch->getPattern().boundingBox.maxP().x();
-    float vsize = hatch->getPattern().boundingBox.maxP().y();
-
-    int xmin,xmax,ymin,ymax;
-    xmin = floor(bbox.minP().x()/hsize/scale);
-    ymin = floor(bbox.minP().y()/hsize/scale);
-    xmax = floor(bbox.maxP().x()/vsize/scale);
-    ymax = floor(bbox.maxP().y()/vsize/scale);
-
-    //Create new entities for the bounding box
-    if(angle!=0) {
-        xmin-=1;
-        ymin-=1;
-        xmax+=1;
-        ymax+=1;
+void LCVHatch::drawPattern(LcPainter& painter, const Fill& fill) const {
+    for (const auto& segment : fill.segments) {
+        painter.move_to(segment.start().x(), segment.start().y());
+        painter.line_to(segment.end().x(), segment.end().y());
     }
-    for(int i=xmin; i<=xmax; i++)
-        for(int j=ymin; j<=ymax; j++) {
-            for(const auto& entity : hatch->getPattern().entities) {
-                entities.push_back(
-                    entity
-                    ->scale(lc::geo::Coordinate(0,0), lc::geo::Coordinate(scale,scale))
-                    ->rotate(lc::geo::Coordinate(0,0), angle)
-                    ->move(lc::geo::Coordinate(i*scale*hsize,j*scale*vsize)
-                          ));
-            }
-        }
-    return entities;
-};
-
-void trimEntities(const std::vector<lc::geo::Coordinate>& cutPoints, std::vector<lc::entity::CADEntity_CSPtr>& spiltedEntities) {
-    for(auto& cutPoint : cutPoints) {
-        std::vector<lc::entity::CADEntity_CSPtr> tempEntities;
-        for(auto& se: spiltedEntities) {
-            if (auto splitable2 = std::dynamic_pointer_cast<const lc::entity::Splitable>(se)) {
-                auto ent2 = splitable2->splitEntity(cutPoint);
-                if(ent2.size()==0)
-                    tempEntities.push_back(se);
-                else
-                    for(auto& jsx: ent2)
-                        tempEntities.push_back(jsx);
-            }
-        }
-        spiltedEntities=tempEntities;
+
+    if (autostroke()) {
+        painter.stroke();
     }
 }
 
-// This fails when intersection fails
-void LCVHatch::drawPattern(LcPainter& painter, const LcDrawOptions &options, const lc::geo::Area& rect) const {
-    auto& reg = _hatch->getRegion();
-    auto bbox = reg.boundingBox();
-    std::vector<lc::entity::CADEntity_CSPtr> entities = getPatterrnEntitiesFromHatch(_hatch);
-    std::vector<lc::entity::CADEntity_CSPtr> finalEntities;
-    for(const auto& entity : entities) {
-        if (!entity->boundingBox().overlaps(bbox))//optimization
-            continue;// It decreased the rendering time from ~5sec to <1s
-        if (auto splitable = std::dynamic_pointer_cast<const lc::entity::Splitable>(entity)) {
-            lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, LCTOLERANCE);
-            for(auto &x: reg.loopList()) {
-                //if(!entity->boundingBox().overlaps(x.boundingBox())) continue;//not needed i think
-                for(auto &y: x.entities()) {
-                    if(entity->boundingBox().overlaps(y->boundingBox()))
-                        visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *y.get(), *entity.get());
-                }
-            }
-            auto cutPoints = intersect.result();
-            if(cutPoints.size()==0) {
-                if(reg.isPointInside(splitable->representingPoint()))
-                    finalEntities.push_back(entity);
-            } else {
-                std::vector<lc::entity::CADEntity_CSPtr> spiltedEntities;
-                spiltedEntities.push_back(entity);
-                trimEntities(cutPoints, spiltedEntities);
-                for(auto& se: spiltedEntities)
-                    if(auto splitable2 = std::dynamic_pointer_cast<const lc::entity::Splitable>(se))
-                        if(reg.isPointInside(splitable2->representingPoint()))
-                            finalEntities.push_back(se);
-            }
-        }
+void LCVHatch::drawBoundary(LcPainter& painter) const {
+    auto edges = _hatch->getRegion().edges();
+    for (const auto& edge : *edges) {
+        painter.move_to(edge.start().x(), edge.start().y());
+        painter.line_to(edge.end().x(), edge.end().y());
     }
 
-    for(const auto& entity : finalEntities) {
-        DocumentCanvas::asDrawable(entity)->draw(painter, options, rect);
+    if (autostroke()) {
+        painter.stroke();
     }
 }
 
+bool LCVHatch::pending() const {
+    return _fill.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+void LCVHatch::wait() const {
+    _fill.wait();
+}
+
 void LCVHatch::draw(LcPainter& painter, const LcDrawOptions &options, const lc::geo::Area& rect) const {
-    if(_hatch->isSolid())
-        drawSolid(painter, options, rect);
-    else
-        drawPattern(painter, options, rect);
+    // Never wait for the fill, the ready callback requests another frame
+    if (pending()) {
+        drawBoundary(painter);
+        return;
+    }
+
+    const auto& fill = *_fill.get();
+    if (_hatch->isSolid()) {
+        drawSolid(painter, fill, rect);
+    }
+    else {
+        drawPattern(painter, fill);
+    }
 }
 
 lc::entity::CADEntity_CSPtr LCVHatch::entity() const {
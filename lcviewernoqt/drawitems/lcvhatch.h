@@ -2,32 +2,62 @@
 
 #include "lcvdrawitem.h"
 #include "cad/primitive/hatch.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
 
 namespace lc {
 namespace viewer {
 class LcDrawOptions;
 class LcPainter;
 
+/**
+ * @brief Drawable of a hatch
+ * The fill geometry is computed once, in a background task started by the constructor.
+ * Until the task is done, only the boundary of the hatch is drawn.
+ * Hatches are immutable once in the document, a modified hatch gets a new drawable.
+ */
 class LCVHatch : public LCVDrawItem {
 public:
-    LCVHatch(const lc::entity::Hatch_CSPtr& circle);
+    /**
+     * @param ready Called from a worker thread once the fill is computed
+     */
+    LCVHatch(const lc::entity::Hatch_CSPtr& hatch, const std::function<void()>& ready = nullptr);
 
     virtual ~LCVHatch() = default;
 
     /**
-     * @brief draw, Draws the circle
+     * @brief draw, Draws the hatch, or its boundary while the fill is pending
      * @param LcPainter painter, surface to be painted
      * @param LcDrawOptions options
      * @param geo::Area rect
      */
-    void draw(LcPainter& painter, const LcDrawOptions& options, const lc::geo::Area& rect) const;
-    void drawSolid(LcPainter& painter, const LcDrawOptions& options, const lc::geo::Area& rect) const;
-    void drawPattern(LcPainter& painter, const LcDrawOptions& options, const lc::geo::Area& rect) const;
+    void draw(LcPainter& painter, const LcDrawOptions& options, const lc::geo::Area& rect) const override;
+
+    bool pending() const override;
+
+    void wait() const override;
 
     lc::entity::CADEntity_CSPtr entity() const override;
 
 private:
+    /**
+     * @brief Flat fill geometry of a hatch
+     */
+    struct Fill {
+        std::vector<lc::geo::Vector> segments; /*!< Pattern lines clipped by the region */
+        std::vector<lc::geo::Coordinate> trapezoids; /*!< Solid fill, 4 corners per trapezoid */
+    };
+
+    static std::shared_ptr<const Fill> computeFill(const lc::entity::Hatch_CSPtr& hatch);
+
+    void drawSolid(LcPainter& painter, const Fill& fill, const lc::geo::Area& rect) const;
+    void drawPattern(LcPainter& painter, const Fill& fill) const;
+    void drawBoundary(LcPainter& painter) const;
+
     lc::entity::Hatch_CSPtr _hatch;
+    std::shared_future<std::shared_ptr<const Fill>> _fill;
 };
 }
 }
@@ -2,9 +2,10 @@
 
 using namespace lc::viewer;
 
-LCVInsert::LCVInsert(lc::entity::Insert_CSPtr& insert) :
+LCVInsert::LCVInsert(lc::entity::Insert_CSPtr& insert, const std::function<void()>& ready) :
     LCVDrawItem(insert, true),
-    _insert(insert) {
+    _insert(insert),
+    _ready(ready) {
 
     _offset = _insert->position() - _insert->displayBlock()->base();
 
@@ -22,7 +23,7 @@ LCVInsert::~LCVInsert() {
 }
 
 void LCVInsert::append(const lc::entity::CADEntity_CSPtr& entity) {
-    auto drawable = DocumentCanvas::asDrawable(entity->move(_offset));
+    auto drawable = DocumentCanvas::asDrawable(entity->move(_offset), _ready);
 
     if(drawable == nullptr) {
         return;
@@ -73,6 +74,12 @@ void LCVInsert::selected(bool selected) {
     }
 }
 
+void LCVInsert::wait() const {
+    for(const auto& entity : _entities) {
+        entity.second->wait();
+    }
+}
+
 lc::entity::CADEntity_CSPtr LCVInsert::entity() const {
     return _insert;
 }
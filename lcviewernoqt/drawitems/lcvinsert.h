@@ -3,6 +3,7 @@
 #include <cad/primitive/insert.h>
 #include <cad/storage/entitycontainer.h>
 #include <cad/storage/document.h>
+#include <functional>
 #include <unordered_set>
 #include "lcvdrawitem.h"
 #include "../documentcanvas.h"
@@ -11,12 +12,17 @@ namespace lc {
 namespace viewer {
 class LCVInsert : public LCVDrawItem {
 public:
-    LCVInsert(lc::entity::Insert_CSPtr& insert);
+    /**
+     * @param ready Passed to the drawables of the block entities, see DocumentCanvas::asDrawable()
+     */
+    LCVInsert(lc::entity::Insert_CSPtr& insert, const std::function<void()>& ready = nullptr);
 
     virtual ~LCVInsert();
 
     void selected(bool selected) override;
 
+    void wait() const override;
+
     void draw(LcPainter& _painter, const LcDrawOptions& options, const lc::geo::Area& updateRect) const override;
 
     void draw(const DocumentCanvas_SPtr& docCanvas, LcPainter& painter) const;
@@ -33,6 +39,7 @@ private:
 private:
     lc::entity::Insert_CSPtr _insert;
     lc::geo::Coordinate _offset;
+    std::function<void()> _ready;
     std::map<ID_DATATYPE, LCVDrawItem_SPtr> _entities;
 };
 }
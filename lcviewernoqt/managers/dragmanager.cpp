@@ -56,9 +56,9 @@ void DragManager::moveEntities() {
 
         auto newEntity = draggable->setDragPoints(entityDragPoints);
         replacementEntities.push_back(newEntity);
-        _tempEntities->removeEntity(entity);
-        _tempEntities->addEntity(newEntity);
     }
+    // Entities keep their ID, the previews are replaced
+    _tempEntities->replaceEntities(replacementEntities);
     _replacementEntities=replacementEntities;
 }
 
@@ -4,6 +4,7 @@
 #include <cad/base/visitor.h>
 #include <cad/base/cadentity.h>
 #include <cad/math/intersect.h>
+#include <cad/tools/profiler.h>
 
 using namespace lc;
 using namespace lc::viewer;
@@ -25,6 +26,7 @@ SnapManagerImpl::SnapManagerImpl(DocumentCanvas_SPtr view, lc::entity::Snapable_
  * are done based on some functor where we can change the order.
  */
 void SnapManagerImpl::setDeviceLocation(int x, int y) {
+    LC_PROFILE_ZONE("SnapManagerImpl::setDeviceLocation");
     double x_ = x;
     double y_ = y;
 
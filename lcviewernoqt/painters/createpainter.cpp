@@ -14,8 +14,13 @@ LcPainter* createCairoImagePainter(unsigned char* data, const unsigned int width
 }
 #endif
 
-LcPainter* createOpenGLPainter(unsigned char* data, const unsigned int width, const unsigned int height) {
-    return new OpenglRenderPainter(width,height);
+LcPainter* createOpenGLPainter(unsigned char* data, const unsigned int width, const unsigned int height,
+                               std::shared_ptr<opengl::PackCache> packs) {
+    if(packs == nullptr) {
+        packs = std::make_shared<opengl::PackCache>();
+    }
+
+    return new OpenglRenderPainter(width, height, std::move(packs));
 }
 }
 }
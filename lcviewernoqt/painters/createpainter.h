@@ -2,6 +2,8 @@
 
 #include "lcpainter.h"
 
+#include <memory>
+
 /**
  * \brief Create new Cairo painter for images.
  * Used to remove dependencies of Qt Widget with Cairo.
@@ -9,7 +11,17 @@
  */
 namespace lc {
 namespace viewer {
+namespace opengl {
+class PackCache;
+}
+
 LcPainter* createCairoImagePainter(unsigned char* data, const unsigned int width, const unsigned int height);
-LcPainter* createOpenGLPainter(unsigned char* data, const unsigned int width, const unsigned int height);
+
+/**
+ * \brief Create new OpenGL painter
+ * \param packs Cache of the tessellated entities, shared by the painters of a document. A new cache is created if null.
+ */
+LcPainter* createOpenGLPainter(unsigned char* data, const unsigned int width, const unsigned int height,
+                               std::shared_ptr<opengl::PackCache> packs = nullptr);
 }
 }
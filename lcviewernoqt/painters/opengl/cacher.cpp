@@ -1,7 +1,8 @@
 #include "cacher.h"
 using namespace lc::viewer::opengl;
 
-Cacher::Cacher()
+Cacher::Cacher(std::shared_ptr<PackCache> packs) :
+    _packs(std::move(packs))
 {
     _model=glm::mat4(1.0f);
     readyFreshPack();
@@ -108,7 +109,7 @@ void Cacher::readyFreshPack()
 //--------------------------------cache entity pack-----------------
 void Cacher::savePack(unsigned long id)
 {
-    _gl_pack_map.insert(std::make_pair( id, _current_gl_pack ) );
+    _packs->savePack(id, _current_gl_pack);
     readyFreshPack();
 }
 
@@ -116,37 +117,15 @@ void Cacher::savePack(unsigned long id)
 
 bool Cacher::isPackCached(unsigned long id)
 {
-    std::map< unsigned long, GL_Pack* >::iterator it;
-
-    it = _gl_pack_map.find(id);
-
-    if (it != _gl_pack_map.end())
-        return true;
-    else
-        return false;
+    return _packs->getPack(id) != NULL;
 }
 
 GL_Pack* Cacher::getCachedPack(unsigned long id)
 {
-    std::map< unsigned long, GL_Pack* >::iterator it;
-
-    it = _gl_pack_map.find(id);
-
-    if (it != _gl_pack_map.end())
-        return (it->second);
-    else
-        return NULL;
+    return _packs->getPack(id);
 }
 
 void Cacher::erasePack(unsigned long id)
 {
-    std::map< unsigned long, GL_Pack* >::iterator it;
-
-    it = _gl_pack_map.find(id);
-
-    if (it != _gl_pack_map.end())
-    {
-        (it->second)->freePackGPU();
-        _gl_pack_map.erase(it);
-    }
+    _packs->erasePack(id);
 }
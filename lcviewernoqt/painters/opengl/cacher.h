@@ -6,6 +6,9 @@
 #include "font_book.h"
 #include "gl_font.h"
 #include "manager.h"
+#include "packcache.h"
+
+#include <memory>
 namespace lc
 {
 namespace viewer
@@ -23,10 +26,10 @@ private:
     Shaders_book _shaders;
     Font_Book _fonts;
 
-    std::map < unsigned long, GL_Pack* > _gl_pack_map;
+    std::shared_ptr<PackCache> _packs;    // Shared with the other viewers of the document
 
 public:
-    Cacher();
+    Cacher(std::shared_ptr<PackCache> packs);
     ~Cacher();
 
     void setShaderBook(struct Shaders_book& book);
@@ -37,6 +37,12 @@ public:
     virtual void unbind() = 0;
 
     virtual void setType(Shaders_book& shaders) = 0;
+
+    /**
+     * \brief Use the shaders and fonts of the renderer drawing a cached entity
+     * Cached entities are shared between viewers, each of them having its own context.
+     */
+    virtual void useResources(Shaders_book& shaders, Font_Book& fonts) = 0;
     virtual void setModelMatrix(glm::mat4 model) = 0;
 
     virtual void setFillMode(bool fill) = 0;
@@ -8,6 +8,8 @@ GL_Pack::GL_Pack()
 
 GL_Pack::~GL_Pack()
 {
+    for(auto entity : _gl_entities)
+        delete entity;
 }
 
 int GL_Pack::packSize()
@@ -34,4 +36,5 @@ void GL_Pack::freePackGPU()
         (*it)->freeGPU();
         delete (*it);
     }
+    _gl_entities.clear();
 }
\ No newline at end of file
@@ -21,34 +21,26 @@ void Gradient_Entity::loadVertexData(float* vertices,int size,std::vector<int> &
     int new_size=_color_vertex_data.size()*sizeof(float);
     _jumps=jumps;
 
-    //--------VAO-----------
-    _vao.gen();
-
     //--------VBO ------
     _vbo.gen(colored_vertices, new_size);
 
     //--------layout--------
-    VertexBufferLayout layout;              // To be flexible with color,
-    layout.push<float>(3);                  // (x,y,z)
-    layout.push<float>(1);                  // (d)
-    layout.push<float>(4);                  // (r,g,b,a)
-
-    //--------attaching VB and (its)layout to VA---
-    _vao.addBuffer(_vbo,layout);
+    _layout=VertexBufferLayout();           // To be flexible with color,
+    _layout.push<float>(3);                  // (x,y,z)
+    _layout.push<float>(1);                  // (d)
+    _layout.push<float>(4);                  // (r,g,b,a)
 }
 
 void Gradient_Entity::bind()
 {
-    //---------bind--------------
-    _vbo.bind();
-    _vao.bind();
+    //---------attaching VB and (its)layout to the VA of the renderer---
+    VertexArray::setAttributes(_vbo,_layout);
 }
 
 void Gradient_Entity::unbind()
 {
     //---------unbind--------------
     _vbo.unbind();
-    _vao.unbind();
 }
 
 void Gradient_Entity::setType(Shaders_book& shaders)
@@ -56,6 +48,11 @@ void Gradient_Entity::setType(Shaders_book& shaders)
     _gradient_shader=shaders.gradient_shader;
 }
 
+void Gradient_Entity::useResources(Shaders_book& shaders, Font_Book& fonts)
+{
+    setType(shaders);
+}
+
 void Gradient_Entity::setModelMatrix(glm::mat4 model)
 {
     _model=model;
@@ -140,7 +137,6 @@ void Gradient_Entity::addTextData(glm::vec4 pos, std::string text_val, float fon
 void Gradient_Entity::freeGPU()
 {
     _vbo.freeGPU();
-    _vao.freeGPU();
 }
 
 void Gradient_Entity::draw(glm::mat4 _proj,glm::mat4 projB,glm::mat4 _view)
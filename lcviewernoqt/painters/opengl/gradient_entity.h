@@ -20,7 +20,7 @@ struct Linear_Pattern
 class Gradient_Entity : public GL_Entity
 {
 private:
-    VertexArray _vao;
+    VertexBufferLayout _layout;
     VertexBuffer _vbo;                       // GPU Buffer Objects (vertex data)
 
     glm::mat4 _model;                      // model matrix
@@ -43,6 +43,7 @@ public:
     void bind() override;
     void unbind() override;
     void setType(Shaders_book& shaders) override;
+    void useResources(Shaders_book& shaders, Font_Book& fonts) override;
     void setColor(float R,float G,float B,float A) override;
     void addLinearGradient(float x0,float y0,float x1,float y1) override;
     void addGradientColorPoint(float R,float G,float B,float A) override;
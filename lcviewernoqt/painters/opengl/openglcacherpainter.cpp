@@ -1,8 +1,8 @@
 #include "openglcacherpainter.h"
 
-OpenglCacherPainter::OpenglCacherPainter()
+OpenglCacherPainter::OpenglCacherPainter(std::shared_ptr<PackCache> packs)
 {
-    _cacher= new Cacher();
+    _cacher= new Cacher(std::move(packs));
     set_manager(_cacher);
 }
 
@@ -16,7 +16,10 @@ class OpenglCacherPainter : public OpenglPainter
 public:
     Cacher* _cacher;
 
-    OpenglCacherPainter();
+    /**
+     * \param packs cache shared with the other viewers of the document
+     */
+    OpenglCacherPainter(std::shared_ptr<PackCache> packs);
 
     double scale() override;
     void scale(double s) override;
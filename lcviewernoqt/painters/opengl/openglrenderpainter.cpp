@@ -1,12 +1,12 @@
 #include "openglrenderpainter.h"
 
-OpenglRenderPainter::OpenglRenderPainter(unsigned int width, unsigned int height)
+OpenglRenderPainter::OpenglRenderPainter(unsigned int width, unsigned int height, std::shared_ptr<PackCache> packs)
 {
     _renderer= new Renderer();
     set_manager(_renderer);
     new_device_size(width,height);
 
-    _cacher_painter=new OpenglCacherPainter();
+    _cacher_painter=new OpenglCacherPainter(std::move(packs));
 }
 
 void OpenglRenderPainter::create_resources()
@@ -22,7 +22,7 @@ class OpenglRenderPainter : public OpenglPainter
     LcPainter* _cacher_painter=NULL;
 
 public:
-    OpenglRenderPainter(unsigned int width, unsigned int height);
+    OpenglRenderPainter(unsigned int width, unsigned int height, std::shared_ptr<PackCache> packs);
     void new_device_size(unsigned int width, unsigned int height) override;
     void create_resources() override;
 
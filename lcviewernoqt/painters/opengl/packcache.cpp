@@ -0,0 +1,68 @@
+#include "packcache.h"
+
+using namespace lc::viewer::opengl;
+
+PackCache::PackCache()
+{
+}
+
+PackCache::~PackCache()
+{
+    // The share group lives as long as the application, the buffers must be freed here
+    _packs.each([](unsigned long id, GL_Pack* pack) {
+        pack->freePackGPU();
+        delete pack;
+    });
+}
+
+std::shared_ptr<PackCache> PackCache::forDocument(const std::shared_ptr<lc::storage::Document>& document)
+{
+    static std::map<const lc::storage::Document*, std::weak_ptr<PackCache>> caches;
+
+    // Forget the caches of the closed documents
+    for(auto it = caches.begin(); it != caches.end();)
+    {
+        if(it->second.expired())
+            it = caches.erase(it);
+        else
+            ++it;
+    }
+
+    auto& cache = caches[document.get()];
+    auto shared = cache.lock();
+    if(shared == nullptr)
+    {
+        shared = std::make_shared<PackCache>();
+        cache = shared;
+    }
+
+    return shared;
+}
+
+void PackCache::savePack(unsigned long id, GL_Pack* pack)
+{
+    erasePack(id);
+    _packs.insert(id, pack);
+}
+
+GL_Pack* PackCache::getPack(unsigned long id) const
+{
+    auto pack = _packs.find(id);
+
+    if(pack != nullptr)
+        return *pack;
+    else
+        return NULL;
+}
+
+void PackCache::erasePack(unsigned long id)
+{
+    auto pack = _packs.find(id);
+
+    if(pack != nullptr)
+    {
+        (*pack)->freePackGPU();
+        delete *pack;
+        _packs.erase(id);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef PACKCACHE_H
+#define PACKCACHE_H
+
+#include <cad/tools/idmap.h>
+
+#include <map>
+#include <memory>
+
+#include "gl_pack.h"
+
+namespace lc
+{
+namespace storage
+{
+class Document;
+}
+
+namespace viewer
+{
+namespace opengl
+{
+/**
+ * \brief Cached GL packs of the entities of a document, by entity ID
+ * The packs hold the tessellated entities and their vertex buffers, in user coordinates.
+ * Buffers are shared by all the OpenGL contexts of the application (Qt::AA_ShareOpenGLContexts),
+ * so one cache is used by every viewer of a document: model viewers, paper viewers and their painters.
+ * Shaders, fonts and vertex arrays belong to each context, they are taken from the renderer drawing the pack.
+ * The GPU buffers are freed by the destructor, the last owner must release the cache while an OpenGL context
+ * of the application is current.
+ */
+class PackCache
+{
+private:
+    lc::tools::IDMap<GL_Pack*> _packs;
+
+public:
+    PackCache();
+    ~PackCache();
+
+    PackCache(const PackCache&) = delete;
+    PackCache& operator=(const PackCache&) = delete;
+
+    /**
+     * \brief Cache shared by the viewers of a document
+     * The cache is released with the last painter or viewer using it.
+     */
+    static std::shared_ptr<PackCache> forDocument(const std::shared_ptr<lc::storage::Document>& document);
+
+    /**
+     * \brief Store the pack of an entity, replacing the previous one
+     */
+    void savePack(unsigned long id, GL_Pack* pack);
+
+    /**
+     * \return pack of the entity, NULL if not cached
+     */
+    GL_Pack* getPack(unsigned long id) const;
+
+    /**
+     * \brief Free the GPU buffers of a pack, an OpenGL context of the application must be current
+     */
+    void erasePack(unsigned long id);
+};
+}
+}
+}
+#endif // PACKCACHE_H
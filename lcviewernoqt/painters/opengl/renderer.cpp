@@ -1,4 +1,5 @@
 #include "renderer.h"
+#include <cad/tools/profiler.h>
 using namespace lc::viewer::opengl;
 
 Renderer::Renderer()
@@ -46,6 +47,9 @@ void Renderer::createResources()
 
     _cacherPtr->setFontBook(_fonts);
 
+    _vao.gen();
+    _vao.unbind();
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
@@ -210,9 +214,11 @@ GL_Text_Extend Renderer::getTextExtend(const char* text_val)
 
 void Renderer::render()
 {
+    LC_PROFILE_ZONE("Renderer::render");
     //load data to current entity
     readyCurrentEntity();
     // Send the _proj & _view matrix needed to draw
+    _vao.bind();
     getCurrentEntity()->draw(_proj,_projB,_view);
     //Free the GPU memory
     getCurrentEntity()->freeGPU();
@@ -227,12 +233,16 @@ void Renderer::renderCachedEntity(GL_Entity* cached_entity)
 {
     getCurrentEntity()->unbind();
     save();
+    // The pack may have been cached by another viewer
+    cached_entity->useResources(_shaders,_fonts);
+    _vao.bind();
     cached_entity->draw(_proj,_projB,_view);
     restore();
 }
 
 void Renderer::renderCachedPack(GL_Pack* pack)
 {
+    LC_PROFILE_ZONE("Renderer::renderCachedPack");
     int l=pack->packSize();
     GL_Entity* gl_entity_in_pack;
 
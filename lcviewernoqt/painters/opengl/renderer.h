@@ -39,6 +39,8 @@ private:
 
     Font_Book _fonts;
 
+    VertexArray _vao;                     //vertex array of this context, entities set their attributes on it
+
     Cacher* _cacherPtr;
 
 public:
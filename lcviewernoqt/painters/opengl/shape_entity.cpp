@@ -24,35 +24,27 @@ Shape_Entity::~Shape_Entity()
 
 void Shape_Entity::loadVertexData(float* vertices,int size,std::vector<int> &jumps)
 {
-    //--------VAO-----------
-    _vao.gen();
-
     //--------VBO ------
     _vbo.gen(vertices, size);
 
     _jumps=jumps;
 
     //--------layout--------
-    VertexBufferLayout layout;
-    layout.push<float>(3);      // (x,y,z)
-    layout.push<float>(1);      // (d)
-
-    //--------attaching VB and (its)layout to VA---
-    _vao.addBuffer(_vbo,layout);
+    _layout=VertexBufferLayout();
+    _layout.push<float>(3);      // (x,y,z)
+    _layout.push<float>(1);      // (d)
 }
 
 void Shape_Entity::bind()
 {
-    //---------bind--------------
-    _vbo.bind();
-    _vao.bind();
+    //---------attaching VB and (its)layout to the VA of the renderer---
+    VertexArray::setAttributes(_vbo,_layout);
 }
 
 void Shape_Entity::unbind()
 {
     //---------unbind--------------
     _vbo.unbind();
-    _vao.unbind();
 }
 
 void Shape_Entity::setType(Shaders_book& shaders)
@@ -86,6 +78,11 @@ void Shape_Entity::setType(Shaders_book& shaders)
     }
 }
 
+void Shape_Entity::useResources(Shaders_book& shaders, Font_Book& fonts)
+{
+    setType(shaders);
+}
+
 void Shape_Entity::setModelMatrix(glm::mat4 model)
 {
     _model=model;
@@ -153,7 +150,6 @@ void Shape_Entity::addTextData(glm::vec4 pos, std::string text_val, float font_s
 void Shape_Entity::freeGPU()
 {
     _vbo.freeGPU();
-    _vao.freeGPU();
 }
 
 void Shape_Entity::draw(glm::mat4 _proj,glm::mat4 projB,glm::mat4 _view)
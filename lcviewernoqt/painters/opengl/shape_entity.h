@@ -12,8 +12,8 @@ namespace opengl
 class Shape_Entity : public GL_Entity
 {
 private:
-    VertexArray _vao;                       //GPU Buffers Objects
-    VertexBuffer _vbo;
+    VertexBuffer _vbo;                      //GPU Buffers Objects
+    VertexBufferLayout _layout;
 
     std::vector<int> _jumps;               //vector to store jumps
 
@@ -42,6 +42,7 @@ public:
     void unbind() override;
 
     void setType(Shaders_book& shaders) override;
+    void useResources(Shaders_book& shaders, Font_Book& fonts) override;
     void setModelMatrix(glm::mat4 model) override;
     void setFillMode(bool fill) override;
     void setLineWidth(float width) override;
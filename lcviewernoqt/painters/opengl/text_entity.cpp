@@ -33,6 +33,12 @@ void Text_Entity::setType(Shaders_book& shaders)
     _shader=shaders.text_shader;
 }
 
+void Text_Entity::useResources(Shaders_book& shaders, Font_Book& fonts)
+{
+    setType(shaders);
+    _font= fonts.pickFont(_font_style, _font_type);
+}
+
 void Text_Entity::setModelMatrix(glm::mat4 model)
 {
     _model=model;
@@ -76,6 +82,8 @@ void Text_Entity::applyGradient(float* vertices,int size)
 void Text_Entity::setFont(Font_Book& fonts,const std::string& style, Font_Book::FontType fontType)
 {
     _font= fonts.pickFont(style, fontType);  //default
+    _font_style=style;
+    _font_type=fontType;
 }
 
 void Text_Entity::addTextData(glm::vec4 pos, std::string textval, float font_size, bool retain)
@@ -17,12 +17,15 @@ private:
     glm::mat4 _model;                      // model matrix
     bool _no_magnify;
     GL_Font* _font=NULL;
+    std::string _font_style;
+    Font_Book::FontType _font_type=Font_Book::FontType::REGULAR;
 
 public:
     Text_Entity();
     ~Text_Entity();
 
     void setType(Shaders_book& shaders) override;
+    void useResources(Shaders_book& shaders, Font_Book& fonts) override;
     void setModelMatrix(glm::mat4 model) override;
 
     void setFont(Font_Book& fonts,const std::string& style, Font_Book::FontType fontType = Font_Book::FontType::REGULAR) override;
@@ -17,6 +17,12 @@ void VertexArray::gen()
 }
 
 void VertexArray::addBuffer(const VertexBuffer& vb,const VertexBufferLayout& layout)
+{
+    bind();
+    setAttributes(vb, layout);
+}
+
+void VertexArray::setAttributes(const VertexBuffer& vb,const VertexBufferLayout& layout)
 {
     vb.bind();  //  layout of this vb (vertex buffer) (binding it for being sure its is the vb)
 
@@ -33,6 +39,11 @@ void VertexArray::addBuffer(const VertexBuffer& vb,const VertexBufferLayout& lay
 
         offset+=element.count * VertexBufferElement::getSizeOfType(element.type);
     }
+
+    for(int i=elements.size(); i<MAX_VERTEX_ATTRIBUTES; i++)
+    {
+        glDisableVertexAttribArray(i);
+    }
 }
 
 void VertexArray::bind() const
@@ -27,7 +27,17 @@ public:
     void unbind() const;
     void freeGPU() const;
     void addBuffer(const VertexBuffer& vb,const VertexBufferLayout& layout);
+
+    /**
+     * \brief Point the attributes of the bound vertex array to a buffer
+     * Vertex arrays can't be shared between contexts, entities shared by several viewers
+     * set their attributes on the vertex array of the renderer drawing them.
+     */
+    static void setAttributes(const VertexBuffer& vb,const VertexBufferLayout& layout);
 };
+
+// Largest number of vertex attributes used by an entity
+#define MAX_VERTEX_ATTRIBUTES 3
 }
 }
 }
@@ -1,4 +1,5 @@
 #include "vertexbuffer.h"
+#include <cad/tools/profiler.h>
 using namespace lc::viewer::opengl;
 
 VertexBuffer::VertexBuffer()
@@ -11,6 +12,7 @@ VertexBuffer::~VertexBuffer()
 
 void VertexBuffer::gen(const void* data,unsigned int size)
 {
+    LC_PROFILE_ZONE("VertexBuffer::upload");
     glGenBuffers(1,&_vb_id);
     glBindBuffer(GL_ARRAY_BUFFER,_vb_id);
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
@@ -50,7 +50,7 @@ public:
     {
         //static_assert(false);
     }
-    inline const std::vector<VertexBufferElement> getElements() const {
+    inline const std::vector<VertexBufferElement>& getElements() const {
         return _elements;
     }
     inline unsigned int getStride() const {
@@ -0,0 +1,52 @@
+-- Compare creating lines one by one with the bulk builder
+-- ./luacmdinterface -i file:bulkbenchmark.lua -o bulkbenchmark.png
+local count = 1000000
+local layer = document:layerByName("0")
+
+local function coordinates(i)
+    local x = (i % 1000) * 10
+    local y = math.floor(i / 1000) * 10
+    return x, y, x + 5, y + 5
+end
+
+-- One builder call and one entity userdata per line
+local start = microtime()
+local eb = lc.operation.EntityBuilder(document)
+local builder = lc.builder.LineBuilder()
+builder:setLayer(layer)
+for i = 0, count - 1 do
+    local x1, y1, x2, y2 = coordinates(i)
+    builder:newID()
+    builder:setStartPoint(lc.geo.Coordinate(x1, y1))
+    builder:setEndPoint(lc.geo.Coordinate(x2, y2))
+    eb:appendEntity(builder:build())
+end
+eb:execute()
+local single = microtime() - start
+print("LineBuilder: " .. count .. " lines in " .. single .. " s")
+
+-- One call for all the lines
+start = microtime()
+local values = {}
+for i = 0, count - 1 do
+    local x1, y1, x2, y2 = coordinates(i)
+    values[i * 4 + 1] = x1 + 20000
+    values[i * 4 + 2] = y1
+    values[i * 4 + 3] = x2 + 20000
+    values[i * 4 + 4] = y2
+end
+
+local bulk = lc.builder.BulkBuilder()
+bulk:setLayer(layer)
+bulk:appendLines(values)
+eb = lc.operation.EntityBuilder(document)
+eb:appendBulk(bulk)
+eb:execute()
+local packed = microtime() - start
+print("BulkBuilder: " .. bulk:size() .. " lines in " .. packed .. " s")
+print("Speed-up: " .. single / packed)
+
+-- Query the bulk lines as flat arrays
+start = microtime()
+local ids, bounds = document:queryArea(lc.geo.Area(lc.geo.Coordinate(20000, 0), lc.geo.Coordinate(30000, 10000)))
+print("queryArea: " .. #ids .. " entities, " .. #bounds .. " bounds in " .. (microtime() - start) .. " s")
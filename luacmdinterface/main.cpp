@@ -14,6 +14,7 @@
 #include <boost/filesystem.hpp>
 #include <managers/pluginmanager.h>
 #include <managers/luacustomentitymanager.h>
+#include <cad/tools/profiler.h>
 
 
 namespace po = boost::program_options;
@@ -92,6 +93,7 @@ int main(int argc, char** argv) {
     std::string fIn;
     std::string fOut = DEFAULT_OUT_FILENAME;
     std::string fType;
+    std::string fTrace;
     readBuffer = new std::string;
 
     // Read CMD options
@@ -102,7 +104,8 @@ int main(int argc, char** argv) {
     ("height,h", po::value<int>(&height), "(optional) Set output image height, example -h 200")
     ("ifile,i", po::value<std::string>(&fIn), "(required) Set LUA input file name, example: -i file:myFile.lua")
     ("ofile,o", po::value<std::string>(&fOut), "(optional) Set output filename, example -o out.png")
-    ("otype,t", po::value<std::string>(&fType), "(optional) output file type, example -t svg");
+    ("otype,t", po::value<std::string>(&fType), "(optional) output file type, example -t svg")
+    ("trace", po::value<std::string>(&fTrace), "(optional) Profile the script and the rendering, write a Chrome trace file, example --trace trace.json");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -163,6 +166,10 @@ int main(int argc, char** argv) {
     // Set device width/height
     _canvas->newDeviceSize(width, height);
 
+    if (!fTrace.empty()) {
+        lc::tools::Profiler::instance().setEnabled(true);
+    }
+
     // Render Lua Code
     kaguya::State luaState;
 
@@ -173,6 +180,7 @@ int main(int argc, char** argv) {
     lcLua.setF_openFileDialog(&openFileDialog);
     lcLua.addLuaLibs();
     lcLua.importLCKernel();
+    lcLua.importProfilerControl();
     lcLua.setDocument(_document);
 
     std::string luaCode = loadFile(fIn);
@@ -191,6 +199,7 @@ int main(int argc, char** argv) {
     }
 
     _canvas->autoScale(*lcPainter);
+    _canvas->waitForDrawables();
     _canvas->render(*lcPainter, VIEWER_BACKGROUND);
     _canvas->render(*lcPainter, VIEWER_DOCUMENT);
     _canvas->render(*lcPainter, VIEWER_FOREGROUND);
@@ -200,6 +209,16 @@ int main(int argc, char** argv) {
     }
     ofile->close();
 
+    if (!fTrace.empty()) {
+        lc::tools::Profiler::instance().setEnabled(false);
+        try {
+            lc::tools::Profiler::instance().writeChromeTrace(fTrace);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
     lc::lua::LuaCustomEntityManager::getInstance().removePlugins();
 
     delete lcPainter;
@@ -1,5 +1,9 @@
 #include "file.h"
 #include "libdxfrw/dxfimpl.h"
+#include "native/nativereader.h"
+#include "native/nativewriter.h"
+#include <cad/tools/profiler.h>
+#include <stdexcept>
 #ifdef LIBOPENCAD_ENABLED
 #include "libopencad_interface/libopencad.h"
 #endif
@@ -11,6 +15,9 @@ std::string File::getExtensionForFileType(Type type) {
     if(type >= LIBDXFRW_DXF_R12 && type <= LIBDXFRW_DXB_R2013) {
         x = "dxf";
     }
+    else if(type == LIBRECAD_NATIVE) {
+        x = "lcb";
+    }
     return x;
 }
 
@@ -18,21 +25,25 @@ std::map<std::string, std::string> File::getSupportedFileExtensions() {
     std::map<std::string, std::string> types;
     types.insert(std::pair<std::string, std::string>("dxf","DXF files"));
     types.insert(std::pair<std::string, std::string>("dwg","DWG files"));
+    types.insert(std::pair<std::string, std::string>("lcb","LibreCAD files"));
     return types;
 }
 
-File::Type File::open(lc::storage::Document_SPtr document, const std::string& path, File::Library library) {
+File::Type File::open(lc::storage::Document_SPtr document, const std::string& path, File::Library library,
+                      const ProgressCallback& progress) {
+    LC_PROFILE_ZONE("File::open");
     auto builder = std::make_shared<operation::Builder>(document, "Open file");
     File::Type version;
+    bool cancelled = false;
 
     switch(library) {
     case LIBDXFRW: {
         DXFimpl F(document, builder);
-        dxfRW R(path.c_str());
-        R.read(&F, true);
+        DRW::Version dxfVersion;
+        cancelled = !F.readDXF(path, progress, dxfVersion);
 
         /// @todo create better mapping
-        switch(R.getVersion()) {
+        switch(dxfVersion) {
         case DRW::UNKNOWNV: /// @todo handle this
             version = Type::LIBDXFRW_DXF_R12; /// @todo not supported ?
             break;
@@ -67,6 +78,15 @@ File::Type File::open(lc::storage::Document_SPtr document, const std::string& pa
         break;
     }
 
+    case NATIVE: {
+        // An invalid file throws before anything is built, the document is left unchanged
+        NativeReader reader(path, document);
+        reader.load(document, builder);
+        cancelled = progress && !progress(reader.size());
+        version = Type::LIBRECAD_NATIVE;
+        break;
+    }
+
 #ifdef LIBOPENCAD_ENABLED
     case LIBOPENCAD: {
         lc::persistence::LibOpenCad opencad(document, builder);
@@ -77,20 +97,35 @@ File::Type File::open(lc::storage::Document_SPtr document, const std::string& pa
 #endif
     }
 
-    builder->execute();
+    if(!cancelled) {
+        builder->execute();
+    }
     return version;
 }
 
 void File::save(lc::storage::Document_SPtr document, const std::string& path, File::Type type) {
+    LC_PROFILE_ZONE("File::save");
     if(type >= LIBDXFRW_DXF_R12 && type <= LIBDXFRW_DXB_R2013) {
         DXFimpl* F = new DXFimpl(std::move(document));
         F->writeDXF(path, type);
     }
+    else if(type == LIBRECAD_NATIVE) {
+        NativeWriter writer(std::move(document));
+
+        // Nothing is written rather than an incomplete drawing
+        auto unsupported = writer.unsupported();
+        if(unsupported > 0) {
+            throw std::runtime_error(std::to_string(unsupported) + " entities are not supported by the LibreCAD format");
+        }
+
+        writer.write(path);
+    }
 }
 
 std::map<File::Type, std::string> File::getAvailableFileTypes() {
     std::map<File::Type, std::string> types;
 
+    types.insert(std::pair<File::Type, std::string>(LIBRECAD_NATIVE, "LibreCAD"));
     types.insert(std::pair<File::Type, std::string>(LIBDXFRW_DXF_R2013, "DXF 2013 (libdxfrw)"));
     types.insert(std::pair<File::Type, std::string>(LIBDXFRW_DXF_R2010, "DXF 2010 (libdxfrw)"));
     types.insert(std::pair<File::Type, std::string>(LIBDXFRW_DXF_R2007, "DXF 2007 (libdxfrw)"));
@@ -117,6 +152,9 @@ std::map<File::Library, std::string> File::getAvailableLibrariesForFormat(std::s
     if(format == "dxf") {
         libraries.insert(std::pair<File::Library, std::string>(LIBDXFRW, "libdxfrw"));
     }
+    if(format == "lcb") {
+        libraries.insert(std::pair<File::Library, std::string>(NATIVE, "LibreCAD"));
+    }
     if(format == "dwg") {
 #ifdef LIBOPENCAD_ENABLED
         libraries.insert(std::pair<File::Library, std::string>(LIBOPENCAD, "libopencad"));
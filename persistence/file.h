@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cad/storage/document.h>
+#include <functional>
 
 namespace lc {
 namespace persistence {
@@ -23,16 +24,34 @@ public:
         LIBDXFRW_DXB_R2007,
         LIBDXFRW_DXB_R2010,
         LIBDXFRW_DXB_R2013,
-        LIBOPENCAD_DWG
+        LIBOPENCAD_DWG,
+        LIBRECAD_NATIVE
     };
 
     enum Library {
         LIBDXFRW,
         LIBOPENCAD,
+        NATIVE
     };
 
-    static Type open(lc::storage::Document_SPtr document, const std::string& path, Library library);
+    /**
+     * @brief Progress of a file import
+     * Called from the thread opening the file with the number of entities read so far.
+     * Return false to cancel the import, the document is then left unchanged.
+     */
+    typedef std::function<bool(unsigned int)> ProgressCallback;
 
+    /**
+     * @brief Load a file in the document
+     * @throw std::runtime_error if a native file is invalid, the document is then left unchanged
+     */
+    static Type open(lc::storage::Document_SPtr document, const std::string& path, Library library,
+                     const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief Save the document
+     * @throw std::runtime_error if the document can't be saved in this format, the file isn't written
+     */
     static void save(lc::storage::Document_SPtr document, const std::string& path, Type type);
 
     static std::map<Type, std::string> getAvailableFileTypes();
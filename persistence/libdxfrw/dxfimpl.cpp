@@ -33,9 +33,36 @@
 #include <cad/meta/customentitystorage.h>
 #include <cad/logger/logger.h>
 #include <cad/tools/maphelper.h>
+#include <cad/tools/threadpool.h>
+#include <cad/interface/entitydispatch.h>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
 
 using namespace lc::persistence;
 
+namespace {
+/**
+ * Number of entities converted by a thread pool task
+ */
+const size_t IMPORT_BATCH_SIZE = 256;
+
+/**
+ * Number of batches which can wait for the calling thread, per thread of the pool
+ */
+const size_t IMPORT_QUEUED_BATCHES = 4;
+
+/**
+ * Number of entities converted by a thread pool task during the export
+ */
+const size_t EXPORT_BATCH_SIZE = 1024;
+
+/**
+ * Number of converted batches waiting to be written, per thread of the pool
+ */
+const size_t EXPORT_QUEUED_BATCHES = 4;
+}
+
 const std::map<int, lc::Units> DXFimpl::_dxfToLCUnits = {
     {0, lc::Units::None},
     {1, lc::Units::Inch},
@@ -68,10 +95,131 @@ DXFimpl::DXFimpl(std::shared_ptr<lc::storage::Document> document, lc::operation:
     _builder(std::move(builder)),
     _entityBuilder(std::make_shared<lc::operation::EntityBuilder>(document)),
     _currentBlock(nullptr),
-    dxfW(nullptr) {
+    dxfW(nullptr),
+    _batches(IMPORT_QUEUED_BATCHES * lc::tools::ThreadPool::instance().size()),
+    _cancelled(false),
+    _encodeSection(0),
+    _encodeBegin(0),
+    _encodeQueueSize(EXPORT_QUEUED_BATCHES * lc::tools::ThreadPool::instance().size()) {
     _builder->append(_entityBuilder);
 }
 
+DXFimpl::DXFimpl(std::shared_ptr<lc::storage::Document> document) :
+    _document(std::move(document)),
+    dxfW(nullptr),
+    _batches(1),
+    _cancelled(false),
+    _encodeSection(0),
+    _encodeBegin(0),
+    _encodeQueueSize(EXPORT_QUEUED_BATCHES * lc::tools::ThreadPool::instance().size()) {
+}
+
+bool DXFimpl::readDXF(const std::string& filename, const lc::persistence::File::ProgressCallback& progress, DRW::Version& version) {
+    version = DRW::UNKNOWNV;
+    std::exception_ptr parserException;
+
+    std::thread parser([&]() {
+        try {
+            dxfRW reader(filename.c_str());
+            reader.read(this, true);
+            flushEntities();
+            version = reader.getVersion();
+        }
+        catch (...) {
+            parserException = std::current_exception();
+        }
+
+        _batches.close();
+    });
+
+    // Every batch is waited for, the tasks use this object
+    std::exception_ptr exception;
+    unsigned int nbEntities = 0;
+    std::future<std::shared_ptr<EntityBatch>> future;
+
+    while (_batches.pop(future)) {
+        try {
+            auto batch = future.get();
+            if (exception != nullptr || _cancelled) {
+                continue;
+            }
+
+            for (size_t i = 0; i < batch->records.size(); i++) {
+                auto entity = batch->records[i].threadSafe ? batch->entities[i] : batch->records[i].build();
+                _entityBuilder->appendEntity(entity);
+            }
+
+            nbEntities += batch->records.size();
+            if (progress && !progress(nbEntities)) {
+                _cancelled = true;
+                _batches.close();
+            }
+        }
+        catch (...) {
+            if (exception == nullptr) {
+                exception = std::current_exception();
+            }
+            _cancelled = true;
+            _batches.close();
+        }
+    }
+
+    parser.join();
+
+    if (exception != nullptr) {
+        std::rethrow_exception(exception);
+    }
+    if (parserException != nullptr) {
+        std::rethrow_exception(parserException);
+    }
+
+    return !_cancelled;
+}
+
+void DXFimpl::queueEntity(std::function<lc::entity::CADEntity_CSPtr()> build, bool threadSafe) {
+    if (_cancelled) {
+        return;
+    }
+
+    if (_batch == nullptr) {
+        _batch = std::make_shared<EntityBatch>();
+        _batch->records.reserve(IMPORT_BATCH_SIZE);
+    }
+
+    _batch->records.push_back({std::move(build), threadSafe});
+
+    if (_batch->records.size() >= IMPORT_BATCH_SIZE) {
+        flushEntities();
+    }
+}
+
+void DXFimpl::flushEntities() {
+    if (_batch == nullptr) {
+        return;
+    }
+
+    auto batch = std::move(_batch);
+    _batch = nullptr;
+
+    auto future = lc::tools::ThreadPool::instance().enqueue([batch]() {
+        batch->entities.resize(batch->records.size());
+
+        for (size_t i = 0; i < batch->records.size(); i++) {
+            if (batch->records[i].threadSafe) {
+                batch->entities[i] = batch->records[i].build();
+            }
+        }
+
+        return batch;
+    });
+
+    if (!_batches.push(std::move(future))) {
+        // Cancelled, the task must be done before this object goes away
+        future.wait();
+        _cancelled = true;
+    }
+}
+
 inline int DXFimpl::widthToInt(double wid) const {
     for (int i = 0; i < 24; i++) {
         if (lc::persistence::FileHelpers::intToLW(i).width() == wid) {
@@ -83,19 +231,19 @@ inline int DXFimpl::widthToInt(double wid) const {
 }
 
 void DXFimpl::setBlock(const int handle) {
-    LOG_WARNING << "setBlock " << handle;
+    LOG_TRACE << "setBlock " << handle;
 }
 
 void DXFimpl::addViewport(const DRW_Viewport& data) {
-    LOG_WARNING << "addViewport ";
+    LOG_TRACE << "addViewport ";
 }
 
 void DXFimpl::addVport(const DRW_Vport& data) {
-    LOG_WARNING << "addVport ";
+    LOG_TRACE << "addVport ";
 }
 
 void DXFimpl::addBlock(const DRW_Block& data) {
-    LOG_WARNING << "addBlock " << data.name;
+    LOG_TRACE << "addBlock " << data.name;
 
     _currentBlock = nullptr;
 
@@ -156,75 +304,93 @@ void DXFimpl::addBlock(const DRW_Block& data) {
 }
 
 void DXFimpl::endBlock() {
-    LOG_WARNING << "endBlock";
+    LOG_TRACE << "endBlock";
     _currentBlock = nullptr;
 }
 
 void DXFimpl::addLine(const DRW_Line& data) {
-    LOG_WARNING << "addLine";
-    lc::builder::LineBuilder builder;
+    LOG_TRACE << "addLine";
+    auto layer = getLayer(data);
+    auto block = getBlock(data);
 
-    builder.setMetaInfo(getMetaInfo(data));
-    builder.setBlock(getBlock(data));
-    builder.setLayer(getLayer(data));
-    builder.setStart(coord(data.basePoint));
-    builder.setEnd(coord(data.secPoint));
+    queueEntity([this, data, layer, block]() {
+        lc::builder::LineBuilder builder;
 
-    LOG_WARNING << "Block:" << builder.block();
-    _entityBuilder->appendEntity(builder.build());
+        builder.setMetaInfo(getMetaInfo(data));
+        builder.setBlock(block);
+        builder.setLayer(layer);
+        builder.setStart(coord(data.basePoint));
+        builder.setEnd(coord(data.secPoint));
+
+        return builder.build();
+    });
 }
 
 void DXFimpl::addCircle(const DRW_Circle& data) {
-    LOG_WARNING << "addCircle";
-    lc::builder::CircleBuilder builder;
+    LOG_TRACE << "addCircle";
+    auto layer = getLayer(data);
+    auto block = getBlock(data);
 
-    builder.setMetaInfo(getMetaInfo(data));
-    builder.setLayer(getLayer(data));
-    builder.setCenter(coord(data.basePoint));
-    builder.setRadius(data.radious);
-    builder.setBlock(getBlock(data));
+    queueEntity([this, data, layer, block]() {
+        lc::builder::CircleBuilder builder;
 
-    _entityBuilder->appendEntity(builder.build());
+        builder.setMetaInfo(getMetaInfo(data));
+        builder.setLayer(layer);
+        builder.setCenter(coord(data.basePoint));
+        builder.setRadius(data.radious);
+        builder.setBlock(block);
+
+        return builder.build();
+    });
 }
 
 void DXFimpl::addArc(const DRW_Arc& data) {
-    LOG_WARNING << "addArc";
-    lc::builder::ArcBuilder builder;
-
-    builder.setMetaInfo(getMetaInfo(data));
-    builder.setLayer(getLayer(data));
-    builder.setBlock(getBlock(data));
-    builder.setCenter(coord(data.basePoint));
-    builder.setRadius(data.radious);
-    builder.setStartAngle(data.staangle);
-    builder.setEndAngle(data.endangle);
-    builder.setIsCCW((bool) data.isccw);
-
-    _entityBuilder->appendEntity(builder.build());
+    LOG_TRACE << "addArc";
+    auto layer = getLayer(data);
+    auto block = getBlock(data);
+
+    queueEntity([this, data, layer, block]() {
+        lc::builder::ArcBuilder builder;
+
+        builder.setMetaInfo(getMetaInfo(data));
+        builder.setLayer(layer);
+        builder.setBlock(block);
+        builder.setCenter(coord(data.basePoint));
+        builder.setRadius(data.radious);
+        builder.setStartAngle(data.staangle);
+        builder.setEndAngle(data.endangle);
+        builder.setIsCCW((bool) data.isccw);
+
+        return builder.build();
+    });
 }
 
 void DXFimpl::addEllipse(const DRW_Ellipse& data) {
-    LOG_WARNING << "addEllipse";
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
+    LOG_TRACE << "addEllipse";
     auto layer = getLayer(data);
-
-    auto secPoint = coord(data.secPoint);
-    auto lcEllipse = std::make_shared<lc::entity::Ellipse>(coord(data.basePoint),
-                     secPoint,
-                     secPoint.magnitude() * data.ratio,
-                     data.staparam,
-                     data.endparam,
-                     data.isccw,
-                     layer,
-                     mf,
-                     getBlock(data)
-                                                          );
-
-    _entityBuilder->appendEntity(lcEllipse);
+    auto block = getBlock(data);
+
+    queueEntity([this, data, layer, block]() {
+        auto mf = getMetaInfo(data);
+
+        auto secPoint = coord(data.secPoint);
+        auto lcEllipse = std::make_shared<lc::entity::Ellipse>(coord(data.basePoint),
+                         secPoint,
+                         secPoint.magnitude() * data.ratio,
+                         data.staparam,
+                         data.endparam,
+                         data.isccw,
+                         layer,
+                         mf,
+                         block
+                                                              );
+
+        return lcEllipse;
+    });
 }
 
 void DXFimpl::addLayer(const DRW_Layer& data) {
-    LOG_WARNING << "addLayer " << data.name;
+    LOG_TRACE << "addLayer " << data.name;
     auto col = icol.intToColor(data.color);
 
     if (col == nullptr) {
@@ -237,7 +403,7 @@ void DXFimpl::addLayer(const DRW_Layer& data) {
         lw = getLcLineWidth<lc::meta::MetaLineWidthByValue>(DRW_LW_Conv::lineWidth::width00);
     }
 
-    auto lp = _document->linePatternByName(data.lineType);
+    auto lp = linePatternByName(data.lineType);
     auto isFrozen = (bool) ((unsigned int) data.flags & 1u);
 
     auto layer = std::make_shared<lc::meta::Layer>(data.name, lw->width(), col->color(), lp, isFrozen);
@@ -245,434 +411,489 @@ void DXFimpl::addLayer(const DRW_Layer& data) {
     if(data.name == "0") {
         auto al = std::make_shared<lc::operation::ReplaceLayer>(_document, _document->layerByName("0"), layer);
         _builder->append(al);
+        _layers[data.name] = layer;
     }
     else if (data.name.length() > 0 && (data.name.compare(0,1,"*") != 0)) {
         auto al = std::make_shared<lc::operation::AddLayer>(_document, layer);
         _builder->append(al);
+        _layers[data.name] = layer;
     }
 }
 
 void DXFimpl::addSpline(const DRW_Spline* data) {
-    LOG_WARNING << "addSpline";
+    LOG_TRACE << "addSpline";
     auto layer = getLayer(*data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-
-    // http://discourse.mcneel.com/t/creating-on-nurbscurve-from-control-points-and-knot-vector/12928/3
-    auto knotList = data->knotslist;
-    if (knotList.size()>=2) {
-        knotList.erase(knotList.begin());
-        knotList.pop_back();
-    }
-    auto lcSpline = std::make_shared<lc::entity::Spline>(coords(data->controllist),
-                    knotList,
-                    coords(data->fitlist),
-                    data->degree,
-                    false,
-                    data->tolfit,
-                    data->tgStart.x, data->tgStart.y, data->tgStart.z,
-                    data->tgEnd.x, data->tgEnd.y, data->tgEnd.z,
-                    data->normalVec.x, data->normalVec.y, data->normalVec.z,
-                    static_cast<lc::geo::Spline::splineflag>(data->flags),
-                    layer,
-                    mf,
-                    getBlock(*data)
-                                                        );
+    auto block = getBlock(*data);
 
-    _entityBuilder->appendEntity(lcSpline);
+    queueEntity([this, data = std::make_shared<const DRW_Spline>(*data), layer, block]() {
+        auto mf = getMetaInfo(*data);
+
+        // http://discourse.mcneel.com/t/creating-on-nurbscurve-from-control-points-and-knot-vector/12928/3
+        auto knotList = data->knotslist;
+        if (knotList.size()>=2) {
+            knotList.erase(knotList.begin());
+            knotList.pop_back();
+        }
+        auto lcSpline = std::make_shared<lc::entity::Spline>(coords(data->controllist),
+                        knotList,
+                        coords(data->fitlist),
+                        data->degree,
+                        false,
+                        data->tolfit,
+                        data->tgStart.x, data->tgStart.y, data->tgStart.z,
+                        data->tgEnd.x, data->tgEnd.y, data->tgEnd.z,
+                        data->normalVec.x, data->normalVec.y, data->normalVec.z,
+                        static_cast<lc::geo::Spline::splineflag>(data->flags),
+                        layer,
+                        mf,
+                        block
+                                                            );
+
+        return lcSpline;
+    });
 }
 
 void DXFimpl::addText(const DRW_Text& data) {
-    LOG_WARNING << "addText";
+    LOG_TRACE << "addText";
     auto layer = getLayer(data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
-    auto lcText = std::make_shared<lc::entity::Text>(coord(data.basePoint),
-                  data.text, data.height,
-                  data.angle * M_PI / 180, data.style,
-                  lc::TextConst::DrawingDirection(data.textgen),
-                  lc::TextConst::HAlign(data.alignH),
-                  lc::TextConst::VAlign(data.alignV),
-                  false,
-                  false,
-                  false,
-                  false,
-                  layer,
-                  mf,
-                  getBlock(data)
-                                                    );
-
-    _entityBuilder->appendEntity(lcText);
+    auto block = getBlock(data);
+
+    queueEntity([this, data, layer, block]() {
+        auto mf = getMetaInfo(data);
+        auto lcText = std::make_shared<lc::entity::Text>(coord(data.basePoint),
+                      data.text, data.height,
+                      data.angle * M_PI / 180, data.style,
+                      lc::TextConst::DrawingDirection(data.textgen),
+                      lc::TextConst::HAlign(data.alignH),
+                      lc::TextConst::VAlign(data.alignV),
+                      false,
+                      false,
+                      false,
+                      false,
+                      layer,
+                      mf,
+                      block
+                                                        );
+
+        return lcText;
+    });
 }
 
 void DXFimpl::addPoint(const DRW_Point& data) {
-    LOG_WARNING << "addPoint";
+    LOG_TRACE << "addPoint";
     auto layer = getLayer(data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
-    auto lcPoint = std::make_shared<lc::entity::Point>(coord(data.basePoint),
-                   layer,
-                   mf,
-                   getBlock(data)
-                                                      );
+    auto block = getBlock(data);
+
+    queueEntity([this, data, layer, block]() {
+        auto mf = getMetaInfo(data);
+        auto lcPoint = std::make_shared<lc::entity::Point>(coord(data.basePoint),
+                       layer,
+                       mf,
+                       block
+                                                          );
 
-    _entityBuilder->appendEntity(lcPoint);
+        return lcPoint;
+    });
 }
 
 void DXFimpl::addDimAlign(const DRW_DimAligned* data) {
-    LOG_WARNING << "addDimAlign";
+    LOG_TRACE << "addDimAlign";
     auto layer = getLayer(*data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimAligned = std::make_shared<lc::entity::DimAligned>(
-                            coord(data->getDefPoint()),
-                            coord(data->getTextPoint()),
-                            static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-                            data->getDir(),
-                            data->getTextLineFactor(),
-                            static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-                            data->getText(),
-                            coord(data->getDef1Point()),
-                            coord(data->getDef2Point()),
-                            layer,
-                            mf,
-                            getBlock(*data)
-                        );
-
-    _entityBuilder->appendEntity(lcDimAligned);
+    auto block = getBlock(*data);
+
+    queueEntity([this, data = std::make_shared<const DRW_DimAligned>(*data), layer, block]() {
+        auto mf = getMetaInfo(*data);
+        auto lcDimAligned = std::make_shared<lc::entity::DimAligned>(
+                                coord(data->getDefPoint()),
+                                coord(data->getTextPoint()),
+                                static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                                data->getDir(),
+                                data->getTextLineFactor(),
+                                static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                                data->getText(),
+                                coord(data->getDef1Point()),
+                                coord(data->getDef2Point()),
+                                layer,
+                                mf,
+                                block
+                            );
+
+        return lcDimAligned;
+    });
 }
 
 void DXFimpl::addDimLinear(const DRW_DimLinear* data) {
-    LOG_WARNING << "addDimLinear";
+    LOG_TRACE << "addDimLinear";
     auto layer = getLayer(*data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimLinear = std::make_shared<lc::entity::DimLinear>(
-                           coord(data->getDefPoint()),
-                           coord(data->getTextPoint()),
-                           static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-                           data->getDir(),
-                           data->getTextLineFactor(),
-                           static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-                           data->getText(),
-                           coord(data->getDef1Point()),
-                           coord(data->getDef2Point()),
-                           data->getAngle(),
-                           data->getOblique(),
-                           layer,
-                           mf,
-                           getBlock(*data)
-                       );
+    auto block = getBlock(*data);
+
+    queueEntity([this, data = std::make_shared<const DRW_DimLinear>(*data), layer, block]() {
+        auto mf = getMetaInfo(*data);
+        auto lcDimLinear = std::make_shared<lc::entity::DimLinear>(
+                               coord(data->getDefPoint()),
+                               coord(data->getTextPoint()),
+                               static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                               data->getDir(),
+                               data->getTextLineFactor(),
+                               static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                               data->getText(),
+                               coord(data->getDef1Point()),
+                               coord(data->getDef2Point()),
+                               data->getAngle(),
+                               data->getOblique(),
+                               layer,
+                               mf,
+                               block
+                           );
 
-    _entityBuilder->appendEntity(lcDimLinear);
+        return lcDimLinear;
+    });
 }
 
 void DXFimpl::addDimRadial(const DRW_DimRadial* data) {
-    LOG_WARNING << "addDimRadial";
+    LOG_TRACE << "addDimRadial";
     auto layer = getLayer(*data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto  lcDimRadial = std::make_shared<lc::entity::DimRadial>(
-                            coord(data->getCenterPoint()),
-                            coord(data->getTextPoint()),
-                            static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-                            data->getDir(),
-                            data->getTextLineFactor(),
-                            static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-                            data->getText(),
-                            coord(data->getDiameterPoint()),
-                            data->getLeaderLength(),
-                            layer,
-                            mf,
-                            getBlock(*data)
-                        );
-
-    _entityBuilder->appendEntity(lcDimRadial);
+    auto block = getBlock(*data);
+
+    queueEntity([this, data = std::make_shared<const DRW_DimRadial>(*data), layer, block]() {
+        auto mf = getMetaInfo(*data);
+        auto  lcDimRadial = std::make_shared<lc::entity::DimRadial>(
+                                coord(data->getCenterPoint()),
+                                coord(data->getTextPoint()),
+                                static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                                data->getDir(),
+                                data->getTextLineFactor(),
+                                static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                                data->getText(),
+                                coord(data->getDiameterPoint()),
+                                data->getLeaderLength(),
+                                layer,
+                                mf,
+                                block
+                            );
+
+        return lcDimRadial;
+    });
 }
 
 void DXFimpl::addDimDiametric(const DRW_DimDiametric* data) {
-    LOG_WARNING << "addDimDiametric";
+    LOG_TRACE << "addDimDiametric";
     auto layer = getLayer(*data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimDiametric = std::make_shared<lc::entity::DimDiametric>(
-                              coord(data->getDiameter1Point()),
-                              coord(data->getTextPoint()),
-                              static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-                              data->getDir(),
-                              data->getTextLineFactor(),
-                              static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-                              data->getText(),
-                              coord(data->getDiameter2Point()),
-                              data->getLeaderLength(),
-                              layer,
-                              mf,
-                              getBlock(*data)
-                          );
-
-    _entityBuilder->appendEntity(lcDimDiametric);
+    auto block = getBlock(*data);
+
+    queueEntity([this, data = std::make_shared<const DRW_DimDiametric>(*data), layer, block]() {
+        auto mf = getMetaInfo(*data);
+        auto lcDimDiametric = std::make_shared<lc::entity::DimDiametric>(
+                                  coord(data->getDiameter1Point()),
+                                  coord(data->getTextPoint()),
+                                  static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                                  data->getDir(),
+                                  data->getTextLineFactor(),
+                                  static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                                  data->getText(),
+                                  coord(data->getDiameter2Point()),
+                                  data->getLeaderLength(),
+                                  layer,
+                                  mf,
+                                  block
+                              );
+
+        return lcDimDiametric;
+    });
 }
 
 void DXFimpl::addDimAngular(const DRW_DimAngular* data) {
-    LOG_WARNING << "addDimAngular";
+    LOG_TRACE << "addDimAngular";
     auto layer = getLayer(*data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimAngular = std::make_shared<lc::entity::DimAngular>(
-                            coord(data->getDefPoint()),
-                            coord(data->getTextPoint()),
-                            static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-                            data->getDir(),
-                            data->getTextLineFactor(),
-                            static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-                            data->getText(),
-                            coord(data->getFirstLine1()),
-                            coord(data->getFirstLine2()),
-                            coord(data->getSecondLine1()),
-                            coord(data->getSecondLine2()),
-                            layer,
-                            mf,
-                            getBlock(*data)
-                        );
-
-    _entityBuilder->appendEntity(lcDimAngular);
+    auto block = getBlock(*data);
+
+    queueEntity([this, data = std::make_shared<const DRW_DimAngular>(*data), layer, block]() {
+        auto mf = getMetaInfo(*data);
+        auto lcDimAngular = std::make_shared<lc::entity::DimAngular>(
+                                coord(data->getDefPoint()),
+                                coord(data->getTextPoint()),
+                                static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                                data->getDir(),
+                                data->getTextLineFactor(),
+                                static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                                data->getText(),
+                                coord(data->getFirstLine1()),
+                                coord(data->getFirstLine2()),
+                                coord(data->getSecondLine1()),
+                                coord(data->getSecondLine2()),
+                                layer,
+                                mf,
+                                block
+                            );
+
+        return lcDimAngular;
+    });
 }
 
 void DXFimpl::addDimAngular3P(const DRW_DimAngular3p* data) {
-    LOG_WARNING << "addDimAngular3P";
+    LOG_TRACE << "addDimAngular3P";
 }
 
 void DXFimpl::addDimOrdinate(const DRW_DimOrdinate* data) {
-    LOG_WARNING << "addOrdinate";
+    LOG_TRACE << "addOrdinate";
 }
 
 void DXFimpl::addLWPolyline(const DRW_LWPolyline& data) {
-    LOG_WARNING << "addLWPolyline";
+    LOG_TRACE << "addLWPolyline";
     auto layer = getLayer(data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
-
-    std::vector<lc::entity::LWVertex2D> points;
-    for (const auto& i : data.vertlist) {
-        points.emplace_back(lc::geo::Coordinate(i->x, i->y), i->bulge, i->stawidth, i->endwidth);
-    }
-
-    auto isCLosed = (unsigned int) data.flags & 0x01u;
-    auto lcLWPolyline = std::make_shared<lc::entity::LWPolyline>(
-                            points,
-                            data.width,
-                            data.elevation,
-                            data.thickness,
-                            isCLosed,
-                            coord(data.extPoint),
-                            layer,
-                            mf,
-                            getBlock(data)
-                        );
-
-    _entityBuilder->appendEntity(lcLWPolyline);
+    auto block = getBlock(data);
+
+    queueEntity([this, data, layer, block]() {
+        auto mf = getMetaInfo(data);
+
+        std::vector<lc::entity::LWVertex2D> points;
+        for (const auto& i : data.vertlist) {
+            points.emplace_back(lc::geo::Coordinate(i->x, i->y), i->bulge, i->stawidth, i->endwidth);
+        }
+
+        auto isCLosed = (unsigned int) data.flags & 0x01u;
+        auto lcLWPolyline = std::make_shared<lc::entity::LWPolyline>(
+                                points,
+                                data.width,
+                                data.elevation,
+                                data.thickness,
+                                isCLosed,
+                                coord(data.extPoint),
+                                layer,
+                                mf,
+                                block
+                            );
+
+        return lcLWPolyline;
+    });
 }
 
 //Handle polyline as lwpolyline
 void DXFimpl::addPolyline(const DRW_Polyline& data) {
-    LOG_WARNING << "addPolyline";
+    LOG_TRACE << "addPolyline";
     auto layer = getLayer(data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
+    auto block = getBlock(data);
 
-    std::vector<lc::entity::LWVertex2D> points;
-    for (const auto& i : data.vertlist) {
-        points.emplace_back(coord(i->basePoint), i->bulge, i->stawidth, i->endwidth);
-    }
+    queueEntity([this, data, layer, block]() {
+        auto mf = getMetaInfo(data);
 
-    auto isCLosed = (unsigned int) data.flags & 0x01u;
+        std::vector<lc::entity::LWVertex2D> points;
+        for (const auto& i : data.vertlist) {
+            points.emplace_back(coord(i->basePoint), i->bulge, i->stawidth, i->endwidth);
+        }
+
+        auto isCLosed = (unsigned int) data.flags & 0x01u;
 
-    auto lcLWPolyline = std::make_shared<lc::entity::LWPolyline>(
-                            points,
-                            0.0,
-                            0.0,
-                            0.0,
-                            isCLosed,
-                            coord(data.extPoint),
-                            layer,
-                            mf,
-                            getBlock(data)
-                        );
+        auto lcLWPolyline = std::make_shared<lc::entity::LWPolyline>(
+                                points,
+                                0.0,
+                                0.0,
+                                0.0,
+                                isCLosed,
+                                coord(data.extPoint),
+                                layer,
+                                mf,
+                                block
+                            );
 
-    _entityBuilder->appendEntity(lcLWPolyline);
+        return lcLWPolyline;
+    });
 }
 
 void DXFimpl::addMText(const DRW_MText& data) {
-    LOG_WARNING << "addMText";
+    LOG_TRACE << "addMText";
     auto layer = getLayer(data);
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
-    lc::TextConst::HAlign halign;
-    lc::TextConst::VAlign valign;
-    //lc::TextConst::AttachmentPoint attachmentPoint = lc::TextConst::AttachmentPoint(data.textgen);
-    lc::TextConst::DrawingDirection drawingDir;
-    //lc::TextConst::LineSpacingStyle lineSpacingStyle;
-
-    switch (data.textgen % 3) {
-    default:
-    case 1:
-        halign = lc::TextConst::HAlign::HALeft;
-        break;
-    case 2:
-        halign = lc::TextConst::HAlign::HACenter;
-        break;
-    case 0:
-        halign = lc::TextConst::HAlign::HARight;
-        break;
-    }
+    auto block = getBlock(data);
+
+    queueEntity([this, data, layer, block]() {
+        auto mf = getMetaInfo(data);
+        lc::TextConst::HAlign halign;
+        lc::TextConst::VAlign valign;
+        //lc::TextConst::AttachmentPoint attachmentPoint = lc::TextConst::AttachmentPoint(data.textgen);
+        lc::TextConst::DrawingDirection drawingDir;
+        //lc::TextConst::LineSpacingStyle lineSpacingStyle;
+
+        switch (data.textgen % 3) {
+        default:
+        case 1:
+            halign = lc::TextConst::HAlign::HALeft;
+            break;
+        case 2:
+            halign = lc::TextConst::HAlign::HACenter;
+            break;
+        case 0:
+            halign = lc::TextConst::HAlign::HARight;
+            break;
+        }
 
-    switch ((int)(std::ceil(data.textgen / 3.0))) {
-    default:
-    case 1:
-        valign = lc::TextConst::VAlign::VATop;
-        break;
-    case 2:
-        valign = lc::TextConst::VAlign::VAMiddle;
-        break;
-    case 3:
-        valign = lc::TextConst::VAlign::VABottom;
-        break;
-    }
+        switch ((int)(std::ceil(data.textgen / 3.0))) {
+        default:
+        case 1:
+            valign = lc::TextConst::VAlign::VATop;
+            break;
+        case 2:
+            valign = lc::TextConst::VAlign::VAMiddle;
+            break;
+        case 3:
+            valign = lc::TextConst::VAlign::VABottom;
+            break;
+        }
 
-    if (data.alignH == 1) {
-        drawingDir = lc::TextConst::DrawingDirection::Backward;
-    }
-    else if (data.alignH == 3) {
-        drawingDir = lc::TextConst::DrawingDirection::UpsideDown;
-    }
-    else {
-        drawingDir = lc::TextConst::DrawingDirection::None;
-    }
+        if (data.alignH == 1) {
+            drawingDir = lc::TextConst::DrawingDirection::Backward;
+        }
+        else if (data.alignH == 3) {
+            drawingDir = lc::TextConst::DrawingDirection::UpsideDown;
+        }
+        else {
+            drawingDir = lc::TextConst::DrawingDirection::None;
+        }
 
-    // Uncomment when line spacing style has been implemented
-    /*if (data.alignV == 1) {
-        lineSpacingStyle = lc::TextConst::LineSpacingStyle::AtLeast;
-    }
-    else {
-        lineSpacingStyle = lc::TextConst::LineSpacingStyle::Exact;
-    }*/
-
-    auto lcText = std::make_shared<lc::entity::Text>(coord(data.basePoint),
-                  data.text, data.height,
-                  data.angle * M_PI / 180, data.style,
-                  lc::TextConst::DrawingDirection(drawingDir),
-                  lc::TextConst::HAlign(halign),
-                  lc::TextConst::VAlign(valign),
-                  false,
-                  false,
-                  false,
-                  false,
-                  layer,
-                  mf,
-                  getBlock(data)
-                                                    );
-
-    _entityBuilder->appendEntity(lcText);
+        // Uncomment when line spacing style has been implemented
+        /*if (data.alignV == 1) {
+            lineSpacingStyle = lc::TextConst::LineSpacingStyle::AtLeast;
+        }
+        else {
+            lineSpacingStyle = lc::TextConst::LineSpacingStyle::Exact;
+        }*/
+
+        auto lcText = std::make_shared<lc::entity::Text>(coord(data.basePoint),
+                      data.text, data.height,
+                      data.angle * M_PI / 180, data.style,
+                      lc::TextConst::DrawingDirection(drawingDir),
+                      lc::TextConst::HAlign(halign),
+                      lc::TextConst::VAlign(valign),
+                      false,
+                      false,
+                      false,
+                      false,
+                      layer,
+                      mf,
+                      block
+                                                        );
+
+        return lcText;
+    });
 }
 
 void DXFimpl::addHatch(const DRW_Hatch* data) {
     // Loop->objlist contains the 3 entities (copied) that define the hatch areas are the entities selected during hatch
     // loopList seems to contain the same entities, why??
-    LOG_WARNING << "addHatch ";
+    LOG_TRACE << "addHatch ";
     auto layer = getLayer(*data);
     auto mf = getMetaInfo(*data);
-    lc::geo::Region reg;
     auto lcHatch = std::make_shared<lc::entity::Hatch>(   layer,
                    mf,
                    getBlock(*data)
                                                       );
     lcHatch->setPatternName(data->name);
     lcHatch->setSolid(data->solid);
-    LOG_WARNING << "name " << data->name;
-    LOG_WARNING << "solid " << data->solid;
+    LOG_TRACE << "name " << data->name;
+    LOG_TRACE << "solid " << data->solid;
     if(!data->solid) {
         //Load pattern from dxf
         lcHatch->setPattern(lc::persistence::PatternProvider::Instance()->getPattern(data->name));
     }
-    LOG_WARNING << "associative " << data->associative;           /*!< associativity, code 71, associatve=1, non-assoc.=0 */
+    LOG_TRACE << "associative " << data->associative;           /*!< associativity, code 71, associatve=1, non-assoc.=0 */
     //lcHatch->setHatchStyle(data->hstyle);
     //lcHatch->setHatchPattern(data->hpattern);
-    LOG_WARNING << "double flag " << data->doubleflag;            /*!< hatch pattern double flag, code 77, double=1, single=0 */
-    LOG_WARNING << "loopsnum " <<data->loopsnum;              /*!< namber of boundary paths (loops), code 91 */
+    LOG_TRACE << "double flag " << data->doubleflag;            /*!< hatch pattern double flag, code 77, double=1, single=0 */
+    LOG_TRACE << "loopsnum " <<data->loopsnum;              /*!< namber of boundary paths (loops), code 91 */
     lcHatch->setAngle(data->angle);
     lcHatch->setScale(data->scale);
-    LOG_WARNING << "deflines " << data->deflines;              /*!< number of pattern definition lines, code 78 */
-    for (auto x : data->looplist) {
-        std::vector<lc::entity::CADEntity_CSPtr> loopData;
-        for(auto k : x->objlist) {
-            if(k->eType == DRW::ETYPE::LWPOLYLINE) { //done
-                auto data = std::dynamic_pointer_cast<DRW_LWPolyline>(k);
-                LOG_WARNING << "Polyline";
-                std::vector<lc::entity::LWVertex2D> points;
-                for (const auto& i : data->vertlist) {
-                    points.emplace_back(lc::geo::Coordinate(i->x, i->y), i->bulge, i->stawidth, i->endwidth);
-                }
-                auto isCLosed = (unsigned int) data->flags & 0x01u;
-                auto lcLWPolyline = std::make_shared<lc::entity::LWPolyline>(
-                                        points,
-                                        data->width,
-                                        data->elevation,
-                                        data->thickness,
-                                        isCLosed,
-                                        coord(data->extPoint),
-                                        layer
-                                    );
-                loopData.push_back(lcLWPolyline);
-            } else if(k->eType == DRW::ETYPE::LINE) { //done
-                auto data = std::dynamic_pointer_cast<DRW_Line>(k);
-                LOG_WARNING << "line";
-                lc::builder::LineBuilder builder;
-                builder.setStart(coord(data->basePoint));
-                builder.setEnd(coord(data->secPoint));
-                builder.setLayer(layer);
-                loopData.push_back(builder.build());
-            } else if(k->eType == DRW::ETYPE::ARC) { //done
-                auto data = std::dynamic_pointer_cast<DRW_Arc>(k);
-                lc::builder::ArcBuilder builder;
-                LOG_WARNING << data->staangle <<','<< data->endangle;
-                builder.setCenter(coord(data->basePoint));
-                builder.setRadius(data->radious);
-                builder.setStartAngle(data->staangle);
-                builder.setEndAngle(data->endangle);
-
-                builder.setIsCCW((bool) data->isccw);
-                builder.setLayer(layer);
-                loopData.push_back(builder.build());
-            } else if(k->eType == DRW::ETYPE::ELLIPSE) { //done
-                auto data = std::dynamic_pointer_cast<DRW_Ellipse>(k);
-                auto secPoint = coord(data->secPoint);
-                auto lcEllipse = std::make_shared<lc::entity::Ellipse>(coord(data->basePoint),
-                                 secPoint,
-                                 secPoint.magnitude() * data->ratio,
-                                 data->staparam,
-                                 data->endparam,
-                                 data->isccw,
-                                 layer
-                                                                      );
-                loopData.push_back(lcEllipse);
-            } else if(k->eType == DRW::ETYPE::SPLINE) {
-                auto data = std::dynamic_pointer_cast<DRW_Spline>(k);
-                auto knotList = data->knotslist;
-                if (knotList.size()>=2) {
-                    knotList.erase(knotList.begin());
-                    knotList.pop_back();
+    LOG_TRACE << "deflines " << data->deflines;              /*!< number of pattern definition lines, code 78 */
+    // The loop entities are owned by shared pointers, they stay valid after the parser is done with the hatch
+    std::vector<decltype(DRW_HatchLoop::objlist)> loops;
+    for (const auto& x : data->looplist) {
+        loops.push_back(x->objlist);
+    }
+    auto block = lcHatch->block();
+
+    queueEntity([this, lcHatch, loops, layer, mf, block]() {
+        lc::geo::Region reg;
+        for (const auto& x : loops) {
+            std::vector<lc::entity::CADEntity_CSPtr> loopData;
+            for(auto k : x) {
+                if(k->eType == DRW::ETYPE::LWPOLYLINE) { //done
+                    auto data = std::dynamic_pointer_cast<DRW_LWPolyline>(k);
+                    LOG_TRACE << "Polyline";
+                    std::vector<lc::entity::LWVertex2D> points;
+                    for (const auto& i : data->vertlist) {
+                        points.emplace_back(lc::geo::Coordinate(i->x, i->y), i->bulge, i->stawidth, i->endwidth);
+                    }
+                    auto isCLosed = (unsigned int) data->flags & 0x01u;
+                    auto lcLWPolyline = std::make_shared<lc::entity::LWPolyline>(
+                                            points,
+                                            data->width,
+                                            data->elevation,
+                                            data->thickness,
+                                            isCLosed,
+                                            coord(data->extPoint),
+                                            layer
+                                        );
+                    loopData.push_back(lcLWPolyline);
+                } else if(k->eType == DRW::ETYPE::LINE) { //done
+                    auto data = std::dynamic_pointer_cast<DRW_Line>(k);
+                    LOG_TRACE << "line";
+                    lc::builder::LineBuilder builder;
+                    builder.setStart(coord(data->basePoint));
+                    builder.setEnd(coord(data->secPoint));
+                    builder.setLayer(layer);
+                    loopData.push_back(builder.build());
+                } else if(k->eType == DRW::ETYPE::ARC) { //done
+                    auto data = std::dynamic_pointer_cast<DRW_Arc>(k);
+                    lc::builder::ArcBuilder builder;
+                    LOG_TRACE << data->staangle <<','<< data->endangle;
+                    builder.setCenter(coord(data->basePoint));
+                    builder.setRadius(data->radious);
+                    builder.setStartAngle(data->staangle);
+                    builder.setEndAngle(data->endangle);
+
+                    builder.setIsCCW((bool) data->isccw);
+                    builder.setLayer(layer);
+                    loopData.push_back(builder.build());
+                } else if(k->eType == DRW::ETYPE::ELLIPSE) { //done
+                    auto data = std::dynamic_pointer_cast<DRW_Ellipse>(k);
+                    auto secPoint = coord(data->secPoint);
+                    auto lcEllipse = std::make_shared<lc::entity::Ellipse>(coord(data->basePoint),
+                                     secPoint,
+                                     secPoint.magnitude() * data->ratio,
+                                     data->staparam,
+                                     data->endparam,
+                                     data->isccw,
+                                     layer
+                                                                          );
+                    loopData.push_back(lcEllipse);
+                } else if(k->eType == DRW::ETYPE::SPLINE) {
+                    auto data = std::dynamic_pointer_cast<DRW_Spline>(k);
+                    auto knotList = data->knotslist;
+                    if (knotList.size()>=2) {
+                        knotList.erase(knotList.begin());
+                        knotList.pop_back();
+                    }
+                    auto lcSpline = std::make_shared<lc::entity::Spline>(coords(data->controllist),
+                                    knotList,
+                                    coords(data->fitlist),
+                                    data->degree,
+                                    false,
+                                    data->tolfit,
+                                    data->tgStart.x, data->tgStart.y, data->tgStart.z,
+                                    data->tgEnd.x, data->tgEnd.y, data->tgEnd.z,
+                                    data->normalVec.x, data->normalVec.y, data->normalVec.z,
+                                    static_cast<lc::geo::Spline::splineflag>(data->flags),
+                                    layer,
+                                    mf,
+                                    block
+                                                                        );
+                    loopData.push_back(lcSpline);
                 }
-                auto lcSpline = std::make_shared<lc::entity::Spline>(coords(data->controllist),
-                                knotList,
-                                coords(data->fitlist),
-                                data->degree,
-                                false,
-                                data->tolfit,
-                                data->tgStart.x, data->tgStart.y, data->tgStart.z,
-                                data->tgEnd.x, data->tgEnd.y, data->tgEnd.z,
-                                data->normalVec.x, data->normalVec.y, data->normalVec.z,
-                                static_cast<lc::geo::Spline::splineflag>(data->flags),
-                                layer,
-                                mf,
-                                getBlock(*data)
-                                                                    );
-                loopData.push_back(lcSpline);
             }
+            lc::geo::Loop loop(loopData);
+            reg.addLoop(loop);
         }
-        lc::geo::Loop loop(loopData);
-        reg.addLoop(loop);
-    }
-    lcHatch->setRegion(reg);
-    _entityBuilder->appendEntity(lcHatch);
+        lcHatch->setRegion(reg);
+        return lcHatch;
+    });
 }
 
 lc::meta::Block_CSPtr DXFimpl::getBlock(const DRW_Entity& data) const {
@@ -692,22 +913,56 @@ lc::meta::Block_CSPtr DXFimpl::getBlock(const DRW_Entity& data) const {
 }
 
 lc::meta::Layer_CSPtr DXFimpl::getLayer(const DRW_Entity& data) const {
+    auto it = _layers.find(data.layer);
+    if (it != _layers.end()) {
+        return it->second;
+    }
+
     lc::meta::Layer_CSPtr layer = _document->layerByName(data.layer);
 
     if (layer==nullptr) {
         auto col = icol.intToColor(255);
         auto lw = getLcLineWidth<lc::meta::MetaLineWidthByValue>(DRW_LW_Conv::lineWidth::width00);
-        auto lp = _document->linePatternByName("CONTINUOUS");
+        auto lp = linePatternByName("CONTINUOUS");
         auto isFrozen = false;
         // we need it anyway so,
         layer = std::make_shared<lc::meta::Layer>(data.layer, lw->width(), col->color(), lp, isFrozen);
         auto al = std::make_shared<lc::operation::AddLayer>(_document, layer);
         _builder->append(al);
     }
+
+    _layers[data.layer] = layer;
     return layer;
 }
 
-lc::meta::MetaInfo_SPtr DXFimpl::getMetaInfo(const DRW_Entity& data) const {
+lc::meta::DxfLinePatternByValue_CSPtr DXFimpl::linePatternByName(const std::string& name) const {
+    {
+        std::lock_guard<std::mutex> lock(_linePatternsMutex);
+        auto it = _linePatterns.find(name);
+        if (it != _linePatterns.end()) {
+            return it->second;
+        }
+    }
+
+    return _document->linePatternByName(name);
+}
+
+lc::meta::MetaInfo_CSPtr DXFimpl::getMetaInfo(const DRW_Entity& data) const {
+    // Most entities share a few combinations of properties, create their MetaInfo once
+    auto key = std::make_tuple(static_cast<int>(data.lWeight), data.color, data.lineType);
+
+    std::lock_guard<std::mutex> lock(_metaInfosMutex);
+    auto it = _metaInfos.find(key);
+    if (it != _metaInfos.end()) {
+        return it->second;
+    }
+
+    auto metaInfo = lc::meta::MetaInfo::intern(createMetaInfo(data));
+    _metaInfos.emplace(key, metaInfo);
+    return metaInfo;
+}
+
+lc::meta::MetaInfo_SPtr DXFimpl::createMetaInfo(const DRW_Entity& data) const {
     std::shared_ptr<lc::meta::MetaInfo> mf = nullptr;
 
     // Try to find a entities meta line weight
@@ -744,7 +999,7 @@ lc::meta::MetaInfo_SPtr DXFimpl::getMetaInfo(const DRW_Entity& data) const {
         linePattern = std::make_shared<lc::meta::DxfLinePatternByBlock>();
     }
     else if (!(lc::tools::StringHelper::cmpCaseInsensetive()(data.lineType, SKIP_BYLAYER) || lc::tools::StringHelper::cmpCaseInsensetive()(data.lineType, SKIP_CONTINUOUS))) {
-        linePattern = _document->linePatternByName(data.lineType);
+        linePattern = linePatternByName(data.lineType);
     }
 
     if(linePattern != nullptr) {
@@ -772,7 +1027,11 @@ std::vector<lc::geo::Coordinate> DXFimpl::coords(std::vector<std::shared_ptr<DRW
 }
 
 void DXFimpl::addLType(const DRW_LType& data) {
-    std::make_shared<lc::operation::AddLinePattern>(_document, std::make_shared<lc::meta::DxfLinePatternByValue>(data.name, data.desc, data.path, data.length))->execute();
+    auto linePattern = std::make_shared<lc::meta::DxfLinePatternByValue>(data.name, data.desc, data.path, data.length);
+    _builder->append(std::make_shared<lc::operation::AddLinePattern>(_document, linePattern));
+
+    std::lock_guard<std::mutex> lock(_linePatternsMutex);
+    _linePatterns[data.name] = linePattern;
 }
 
 /**
@@ -781,31 +1040,34 @@ void DXFimpl::addLType(const DRW_LType& data) {
  * if linkImage isn't called as last, we miss a image during import
  */
 void DXFimpl::addImage(const DRW_Image* data) {
-    LOG_WARNING << "addImage";
+    LOG_TRACE << "addImage";
     imageMapCache.emplace_back(*data);
 }
 
 void DXFimpl::linkImage(const DRW_ImageDef *data) {
-    LOG_WARNING << "linkImage";
+    LOG_TRACE << "linkImage";
     for(auto image = imageMapCache.cbegin(); image != imageMapCache.cend() /* not hoisted */; /* no increment */ ) {
         if (image->ref == data->handle) {
-            auto layer = _document->layerByName(image->layer);
-
-            std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*image);
-            const lc::geo::Coordinate base(coord(image->basePoint));
-            const lc::geo::Coordinate uv(coord(image->secPoint));
-            const lc::geo::Coordinate vv(coord(image->vVector));
-
-            auto lcImage = std::make_shared<lc::entity::Image>(
-                               data->name,
-                               base, uv, vv,
-                               image->sizeu, image->sizev,
-                               image->brightness, image->contrast, image->fade,
-                               layer,
-                               mf,
-                               getBlock(*image)
-                           );
-            _entityBuilder->appendEntity(lcImage);
+            auto layer = getLayer(*image);
+            auto block = getBlock(*image);
+            auto name = data->name;
+
+            queueEntity([this, image = *image, name, layer, block]() {
+                auto mf = getMetaInfo(image);
+                const lc::geo::Coordinate base(coord(image.basePoint));
+                const lc::geo::Coordinate uv(coord(image.secPoint));
+                const lc::geo::Coordinate vv(coord(image.vVector));
+
+                return std::make_shared<lc::entity::Image>(
+                           name,
+                           base, uv, vv,
+                           image.sizeu, image.sizev,
+                           image.brightness, image.contrast, image.fade,
+                           layer,
+                           mf,
+                           block
+                       );
+            });
 
             image = imageMapCache.erase( image ) ; // advances iter
         } else {
@@ -815,29 +1077,33 @@ void DXFimpl::linkImage(const DRW_ImageDef *data) {
 }
 
 void DXFimpl::addInsert(const DRW_Insert& data) {
-    LOG_WARNING << "addInsert";
-    lc::builder::InsertBuilder builder;
-    builder.setMetaInfo(getMetaInfo(data));
-    builder.setBlock(getBlock(data));
+    LOG_TRACE << "addInsert";
     auto layer = getLayer(data);
-    builder.setLayer(layer);
-    builder.setCoordinate(coord(data.basePoint));
+    auto block = getBlock(data);
 
-    auto block=_document->blockByName(data.name);
-    if (block==nullptr) {
+    auto displayBlock = _document->blockByName(data.name);
+    if (displayBlock==nullptr) {
         // It requests block like V21_PAKNING , it is already defined or from other file??
         // These blocks were not declared in loading file
-        block = std::make_shared<lc::meta::Block>(data.name, geo::Coordinate());
+        displayBlock = std::make_shared<lc::meta::Block>(data.name, geo::Coordinate());
     }
-    _builder->append(std::make_shared<lc::operation::AddBlock>(_document, block));
+    _builder->append(std::make_shared<lc::operation::AddBlock>(_document, displayBlock));
 
     // May need to check if the block already exists: not sure
-    _handleBlock.insert(std::pair<int, lc::meta::Block_CSPtr>(data.parentHandle, block));
-
-    builder.setDisplayBlock(block);
-    builder.setDocument(_document);
-
-    _entityBuilder->appendEntity(builder.build());
+    _handleBlock.insert(std::pair<int, lc::meta::Block_CSPtr>(data.parentHandle, displayBlock));
+
+    // Inserts connect to the document signals, they are created by the calling thread
+    queueEntity([this, data, layer, block, displayBlock]() {
+        lc::builder::InsertBuilder builder;
+        builder.setMetaInfo(getMetaInfo(data));
+        builder.setBlock(block);
+        builder.setLayer(layer);
+        builder.setCoordinate(coord(data.basePoint));
+        builder.setDisplayBlock(displayBlock);
+        builder.setDocument(_document);
+
+        return builder.build();
+    }, false);
 }
 
 /*********************************************
@@ -910,113 +1176,25 @@ bool DXFimpl::writeDXF(const std::string& filename, lc::persistence::File::Type
 
     bool isBinary = type >= lc::persistence::File::LIBDXFRW_DXB_R12 && type < lc::persistence::File::LIBDXFRW_DXB_R2013;
 
-    bool success = dxfW->write(this, exportVersion, isBinary);
-    delete dxfW;
-
-    return success;
-}
-
-void DXFimpl::writePoint(const lc::entity::Point_CSPtr& p) {
-    DRW_Point point;
-    getEntityAttributes(&point, p);
-    point.basePoint.x = p->x();
-    point.basePoint.y = p->y();
-    dxfW->writePoint(&point);
-}
-
-void DXFimpl::writeLine(const lc::entity::Line_CSPtr& l) {
-    DRW_Line line;
-    getEntityAttributes(&line, l);
-    line.basePoint.x = l->start().x();
-    line.basePoint.y = l->start().y();
-    line.secPoint.x = l->end().x();
-    line.secPoint.y = l->end().y();
-    dxfW->writeLine(&line);
-}
-
-void DXFimpl::writeCircle(const lc::entity::Circle_CSPtr& c) {
-    DRW_Circle circle;
-    getEntityAttributes(&circle, c);
-    circle.basePoint.x = c->center().x();
-    circle.basePoint.y = c->center().y();
-    circle.radious = c->radius();
-    dxfW->writeCircle(&circle);
-}
+    prepareExport();
 
-void DXFimpl::writeArc(const lc::entity::Arc_CSPtr& a) {
-    DRW_Arc arc;
-    getEntityAttributes(&arc, a);
-    arc.basePoint.x = a->center().x();
-    arc.basePoint.y = a->center().y();
-    arc.radious = a->radius();
-    if (a->CCW()) {
-        arc.staangle = a->startAngle();
-        arc.endangle = a->endAngle();
-    } else {
-        arc.staangle = a->endAngle();
-        arc.endangle = a->startAngle();
-    }
-    dxfW->writeArc(&arc);
-}
-
-void DXFimpl::writeEllipse(const lc::entity::Ellipse_CSPtr& s) {
-    DRW_Ellipse el;
-    getEntityAttributes(&el, s);
-    el.basePoint.x = s->center().x();
-    el.basePoint.y = s->center().y();
-    el.secPoint.x = s->majorP().x();
-    el.secPoint.y = s->majorP().y();
-    el.ratio = 1/s->ratio();
-    if (s->isReversed()) {
-        el.staparam = s->endAngle();
-        el.endparam = s->startAngle();
-    } else {
-        el.staparam = s->startAngle();
-        el.endparam = s->endAngle();
-    }
-    dxfW->writeEllipse(&el);
-}
-
-void DXFimpl::writeSpline(const lc::entity::Spline_CSPtr& s) {
-    DRW_Spline sp;
-
-    getEntityAttributes(&sp, s);
-
-    sp.knotslist = s->knotPoints();
-    sp.normalVec = DRW_Coord(s->nX(), s->nY(), s->nZ());
-    sp.tgEnd = DRW_Coord(s->endTanX(), s->endTanY(), s->endTanZ());
-    sp.tgStart = DRW_Coord(s->startTanX(), s->startTanY(), s->startTanZ());
-    sp.degree = s->degree();
-
-    for(const auto& cp : s->controlPoints()) {
-        sp.controllist.push_back(std::make_shared<DRW_Coord>(cp.x(), cp.y(), cp.z()));
+    bool success;
+    try {
+        success = dxfW->write(this, exportVersion, isBinary);
     }
-
-    for(const auto& fp : s->fitPoints()) {
-        sp.fitlist.push_back(std::make_shared<DRW_Coord>(fp.x(), fp.y(), fp.z()));
+    catch (...) {
+        finishExport();
+        delete dxfW;
+        throw;
     }
 
-    sp.flags = s->flags();
-    sp.nknots = sp.knotslist.size();
-    sp.nfit = sp.fitlist.size();
-    sp.ncontrol = sp.controllist.size();
-
-    dxfW->writeSpline(&sp);
-}
-
-void DXFimpl::writeInsert(const lc::entity::Insert_CSPtr& i) {
-    DRW_Insert insert;
-    getEntityAttributes(&insert, i);
-
-    insert.name = i->displayBlock()->name();
-    insert.basePoint.x = i->position().x();
-    insert.basePoint.y = i->position().y();
-    insert.basePoint.z = i->position().z();
+    finishExport();
+    delete dxfW;
 
-    dxfW->writeInsert(&insert);
+    return success;
 }
 
-void DXFimpl::getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_CSPtr& entity) {
+void DXFimpl::getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_CSPtr& entity) const {
     auto layer_  = entity->layer();
 
     auto lpByValue = entity->metaInfo<lc::meta::DxfLinePatternByValue>(lc::meta::DxfLinePattern::LCMETANAME());
@@ -1034,8 +1212,7 @@ void DXFimpl::getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_C
         ent->color = BYBLOCK_COLOR;
     }
     else if(metaColorByValue != nullptr) {
-        lc::iColor col;
-        auto color_ = col.colorToInt(metaColorByValue->color());
+        auto color_ = icol.colorToInt(metaColorByValue->color());
         ent->color = color_;
     }
 
@@ -1335,100 +1512,271 @@ void DXFimpl::writeAppId() {
     dxfW->writeAppId(&ai);
 }
 
-void DXFimpl::writeDimension(const lc::entity::Dimension_CSPtr& d) {
+void DXFimpl::writeBlockRecords() {
+    for(const auto& block : _document->blocks()) {
+        dxfW->writeBlockRecord(block->name());
+    }
 }
 
-void DXFimpl::writeLWPolyline(const lc::entity::LWPolyline_CSPtr& p) {
-}
+/**
+ * Convert the entities to libdxfrw entities without writing them, it is used by the thread pool
+ * Dimensions, polylines, images and hatches are not exported yet.
+ */
+class DXFimpl::EntityEncoder : public lc::EntityDispatch {
+public:
+    EntityEncoder(const DXFimpl& dxf, EncodedEntities& entities) :
+        _dxf(dxf),
+        _entities(entities) {
+    }
 
-void DXFimpl::writeImage(const lc::entity::Image_CSPtr& i) {
-}
+    void visit(lc::entity::Line_CSPtr l) override {
+        auto line = create<DRW_Line>(l);
+        line->basePoint.x = l->start().x();
+        line->basePoint.y = l->start().y();
+        line->secPoint.x = l->end().x();
+        line->secPoint.y = l->end().y();
+    }
 
-void DXFimpl::writeText(const lc::entity::Text_CSPtr& t) {
-    DRW_Text tex;
-    getEntityAttributes(&tex, t);
+    void visit(lc::entity::Point_CSPtr p) override {
+        auto point = create<DRW_Point>(p);
+        point->basePoint.x = p->x();
+        point->basePoint.y = p->y();
+    }
 
-    tex.basePoint.x = t->insertion_point().x();
-    tex.basePoint.y = t->insertion_point().y();
-    tex.text = t->text_value();
-    tex.textgen = t->textgeneration();
-    tex.height = t->height();
-    tex.angle = t->angle() * 180 / M_PI;
-    tex.alignH = DRW_Text::HAlign(t->halign());
-    tex.alignV = DRW_Text::VAlign(t->valign());
+    void visit(lc::entity::Circle_CSPtr c) override {
+        auto circle = create<DRW_Circle>(c);
+        circle->basePoint.x = c->center().x();
+        circle->basePoint.y = c->center().y();
+        circle->radious = c->radius();
+    }
 
-    dxfW->writeText(&tex);
-}
+    void visit(lc::entity::Arc_CSPtr a) override {
+        auto arc = create<DRW_Arc>(a);
+        arc->basePoint.x = a->center().x();
+        arc->basePoint.y = a->center().y();
+        arc->radious = a->radius();
+        if (a->CCW()) {
+            arc->staangle = a->startAngle();
+            arc->endangle = a->endAngle();
+        } else {
+            arc->staangle = a->endAngle();
+            arc->endangle = a->startAngle();
+        }
+    }
 
-void DXFimpl::writeEntities() {
-    for(const auto& e :_document->entityContainer().asVector()) {
-        if(e->block() != nullptr) {
-            continue;
+    void visit(lc::entity::Ellipse_CSPtr s) override {
+        auto el = create<DRW_Ellipse>(s);
+        el->basePoint.x = s->center().x();
+        el->basePoint.y = s->center().y();
+        el->secPoint.x = s->majorP().x();
+        el->secPoint.y = s->majorP().y();
+        el->ratio = 1/s->ratio();
+        if (s->isReversed()) {
+            el->staparam = s->endAngle();
+            el->endparam = s->startAngle();
+        } else {
+            el->staparam = s->startAngle();
+            el->endparam = s->endAngle();
         }
+    }
 
-        writeEntity(e);
+    void visit(lc::entity::Text_CSPtr t) override {
+        auto tex = create<DRW_Text>(t);
+        tex->basePoint.x = t->insertion_point().x();
+        tex->basePoint.y = t->insertion_point().y();
+        tex->text = t->text_value();
+        tex->textgen = t->textgeneration();
+        tex->height = t->height();
+        tex->angle = t->angle() * 180 / M_PI;
+        tex->alignH = DRW_Text::HAlign(t->halign());
+        tex->alignV = DRW_Text::VAlign(t->valign());
     }
-}
 
-void DXFimpl::writeEntity(const lc::entity::CADEntity_CSPtr& entity) {
-    auto line = std::dynamic_pointer_cast<const lc::entity::Line>(entity);
-    if (line != nullptr) {
-        writeLine(line);
-        return;
+    void visit(lc::entity::Spline_CSPtr s) override {
+        auto sp = create<DRW_Spline>(s);
+        sp->knotslist = s->knotPoints();
+        sp->normalVec = DRW_Coord(s->nX(), s->nY(), s->nZ());
+        sp->tgEnd = DRW_Coord(s->endTanX(), s->endTanY(), s->endTanZ());
+        sp->tgStart = DRW_Coord(s->startTanX(), s->startTanY(), s->startTanZ());
+        sp->degree = s->degree();
+
+        for(const auto& cp : s->controlPoints()) {
+            sp->controllist.push_back(std::make_shared<DRW_Coord>(cp.x(), cp.y(), cp.z()));
+        }
+
+        for(const auto& fp : s->fitPoints()) {
+            sp->fitlist.push_back(std::make_shared<DRW_Coord>(fp.x(), fp.y(), fp.z()));
+        }
+
+        sp->flags = s->flags();
+        sp->nknots = sp->knotslist.size();
+        sp->nfit = sp->fitlist.size();
+        sp->ncontrol = sp->controllist.size();
     }
 
-    auto circle = std::dynamic_pointer_cast<const lc::entity::Circle>(entity);
-    if (circle != nullptr) {
-        writeCircle(circle);
-        return;
+    void visit(lc::entity::Insert_CSPtr i) override {
+        auto insert = create<DRW_Insert>(i);
+        insert->name = i->displayBlock()->name();
+        insert->basePoint.x = i->position().x();
+        insert->basePoint.y = i->position().y();
+        insert->basePoint.z = i->position().z();
     }
 
-    auto arc = std::dynamic_pointer_cast<const lc::entity::Arc>(entity);
-    if (arc != nullptr) {
-        writeArc(arc);
-        return;
+    void visit(lc::entity::DimAligned_CSPtr) override {}
+    void visit(lc::entity::DimAngular_CSPtr) override {}
+    void visit(lc::entity::DimDiametric_CSPtr) override {}
+    void visit(lc::entity::DimLinear_CSPtr) override {}
+    void visit(lc::entity::DimRadial_CSPtr) override {}
+    void visit(lc::entity::LWPolyline_CSPtr) override {}
+    void visit(lc::entity::Image_CSPtr) override {}
+    void visit(lc::entity::Hatch_CSPtr) override {}
+
+private:
+    template<typename T>
+    T* create(const lc::entity::CADEntity_CSPtr& entity) {
+        std::unique_ptr<T> drwEntity(new T());
+        auto result = drwEntity.get();
+        _entities.push_back(std::move(drwEntity));
+        _dxf.getEntityAttributes(result, entity);
+        return result;
     }
 
-    auto image = std::dynamic_pointer_cast<const lc::entity::Image>(entity);
-    if (image != nullptr) {
-        writeImage(image);
-        return;
+    const DXFimpl& _dxf;
+    EncodedEntities& _entities;
+};
+
+void DXFimpl::prepareExport() {
+    _exportBlocks = _document->blocks();
+    _exportSections.assign(_exportBlocks.size() + 1, std::vector<lc::entity::CADEntity_CSPtr>());
+    _encodeSection = 0;
+    _encodeBegin = 0;
+
+    std::unordered_map<std::string, size_t> sectionByBlock;
+    for(size_t i = 0; i < _exportBlocks.size(); i++) {
+        sectionByBlock[_exportBlocks[i]->name()] = i;
     }
 
-    auto lwPolyline = std::dynamic_pointer_cast<const lc::entity::LWPolyline>(entity);
-    if (lwPolyline != nullptr) {
-        writeLWPolyline(lwPolyline);
-        return;
+    auto& modelSpace = _exportSections.back();
+    _document->snapshot()->each([&](const lc::entity::CADEntity_CSPtr& entity) {
+        if(entity->block() == nullptr) {
+            modelSpace.push_back(entity);
+            return;
+        }
+
+        auto it = sectionByBlock.find(entity->block()->name());
+        if(it != sectionByBlock.end()) {
+            _exportSections[it->second].push_back(entity);
+        }
+    });
+
+    // The snapshot isn't ordered, write the entities in creation order
+    for(auto& section : _exportSections) {
+        std::sort(section.begin(), section.end(), [](const lc::entity::CADEntity_CSPtr& a, const lc::entity::CADEntity_CSPtr& b) {
+            return a->id() < b->id();
+        });
     }
+}
 
-    auto text = std::dynamic_pointer_cast<const lc::entity::Text>(entity);
-    if (text != nullptr) {
-        writeText(text);
-        return;
+void DXFimpl::queueEncoding() {
+    while(_encoded.size() < _encodeQueueSize && _encodeSection < _exportSections.size()) {
+        const auto& section = _exportSections[_encodeSection];
+        if(_encodeBegin >= section.size()) {
+            _encodeSection++;
+            _encodeBegin = 0;
+            continue;
+        }
+
+        size_t begin = _encodeBegin;
+        size_t end = std::min(begin + EXPORT_BATCH_SIZE, section.size());
+        _encodeBegin = end;
+
+        // The sections aren't modified until finishExport() waited for the tasks
+        auto entities = &section;
+        auto future = lc::tools::ThreadPool::instance().enqueue([this, entities, begin, end]() {
+            EncodedEntities encoded;
+            encoded.reserve(end - begin);
+
+            EntityEncoder encoder(*this, encoded);
+            for(size_t i = begin; i < end; i++) {
+                (*entities)[i]->dispatch(encoder);
+            }
+
+            return encoded;
+        });
+
+        _encoded.emplace_back(_encodeSection, std::move(future));
     }
+}
 
-    auto ellipse = std::dynamic_pointer_cast<const lc::entity::Ellipse>(entity);
-    if (ellipse != nullptr) {
-        writeEllipse(ellipse);
-        return;
+void DXFimpl::writeSection(size_t section) {
+    while(true) {
+        queueEncoding();
+
+        if(_encoded.empty() || _encoded.front().first > section) {
+            return;
+        }
+
+        auto batch = std::move(_encoded.front());
+        _encoded.pop_front();
+
+        auto entities = batch.second.get();
+        if(batch.first == section) {
+            for(const auto& entity : entities) {
+                writeEncodedEntity(entity.get());
+            }
+        }
     }
+}
 
-    auto insert = std::dynamic_pointer_cast<const lc::entity::Insert>(entity);
-    if (insert != nullptr) {
-        writeInsert(insert);
-        return;
+void DXFimpl::finishExport() {
+    for(auto& batch : _encoded) {
+        batch.second.wait();
     }
+
+    _encoded.clear();
+    _exportSections.clear();
+    _exportBlocks.clear();
 }
 
-void DXFimpl::writeBlockRecords() {
-    for(const auto& block : _document->blocks()) {
-        dxfW->writeBlockRecord(block->name());
+void DXFimpl::writeEncodedEntity(DRW_Entity* entity) {
+    switch(entity->eType) {
+    case DRW::LINE:
+        dxfW->writeLine(static_cast<DRW_Line*>(entity));
+        break;
+    case DRW::POINT:
+        dxfW->writePoint(static_cast<DRW_Point*>(entity));
+        break;
+    case DRW::CIRCLE:
+        dxfW->writeCircle(static_cast<DRW_Circle*>(entity));
+        break;
+    case DRW::ARC:
+        dxfW->writeArc(static_cast<DRW_Arc*>(entity));
+        break;
+    case DRW::ELLIPSE:
+        dxfW->writeEllipse(static_cast<DRW_Ellipse*>(entity));
+        break;
+    case DRW::TEXT:
+        dxfW->writeText(static_cast<DRW_Text*>(entity));
+        break;
+    case DRW::SPLINE:
+        dxfW->writeSpline(static_cast<DRW_Spline*>(entity));
+        break;
+    case DRW::INSERT:
+        dxfW->writeInsert(static_cast<DRW_Insert*>(entity));
+        break;
+    default:
+        break;
     }
 }
 
+void DXFimpl::writeEntities() {
+    writeSection(_exportBlocks.size());
+}
+
 void DXFimpl::writeBlocks() {
-    for(const auto& block : _document->blocks()) {
-        writeBlock(block);
+    for(size_t i = 0; i < _exportBlocks.size(); i++) {
+        writeBlock(_exportBlocks[i]);
+        writeSection(i);
     }
 }
 
@@ -1457,13 +1805,8 @@ void DXFimpl::writeBlock(const lc::meta::Block_CSPtr& block) {
     }
 
     dxfW->writeBlock(&drwBlock);
-
-    for(const auto& entity : _document->entitiesByBlock(block).asVector()) {
-        writeEntity(entity);
-    }
 }
 
-
 /*****************************************
  * EXTRA Utilities
  *****************************************/
@@ -21,6 +21,13 @@
 #include <tuple>
 #include <cad/meta/block.h>
 #include <cad/operations/builder.h>
+#include <cad/tools/boundedqueue.h>
+#include <cad/tools/string_helper.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
 
 #define BYBLOCK_COLOR 0
 #define LTYPE_BYBLOCK "ByBlock"
@@ -41,9 +48,21 @@ public:
 
     DXFimpl(std::shared_ptr<lc::storage::Document> document, lc::operation::Builder_SPtr builder);
 
-    DXFimpl(std::shared_ptr<lc::storage::Document> document) : _document(document) {}
+    DXFimpl(std::shared_ptr<lc::storage::Document> document);
 
     // READ FUNCTIONALITY
+    /**
+     * @brief Read a DXF file
+     * libdxfrw parses the file in its own thread. The parser callbacks queue the entities in batches,
+     * which are converted on the thread pool. The calling thread appends the converted entities
+     * to the entity builder in file order.
+     * @param filename file to read
+     * @param progress called by the calling thread after each batch, can be empty
+     * @param version DXF version of the file
+     * @return false if the import was cancelled
+     */
+    bool readDXF(const std::string& filename, const lc::persistence::File::ProgressCallback& progress, DRW::Version& version);
+
     void addHeader(const DRW_Header* data) override {}
 
     void addDimStyle(const DRW_Dimstyle& data) override {}
@@ -126,6 +145,12 @@ public:
 
 
     // WRITE FUNCTIONALITY
+    /**
+     * @brief Write a DXF file
+     * The entities of the last document snapshot are converted to libdxfrw entities on the thread pool,
+     * block by block and then the model space, in batches. libdxfrw writes the converted batches in order
+     * from the calling thread while the next ones are converted.
+     */
     bool writeDXF(const std::string& filename, lc::persistence::File::Type type);
 
     void writeHeader(DRW_Header& data) override {}
@@ -148,31 +173,7 @@ public:
 
     void writeAppId() override;
 
-    void getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_CSPtr& entity);
-
-    void writeEntity(const lc::entity::CADEntity_CSPtr& entity);
-
-    void writePoint(const lc::entity::Point_CSPtr& p);
-
-    void writeLine(const lc::entity::Line_CSPtr& l);
-
-    void writeCircle(const lc::entity::Circle_CSPtr& c);
-
-    void writeArc(const lc::entity::Arc_CSPtr& a);
-
-    void writeEllipse(const lc::entity::Ellipse_CSPtr& s);
-
-    void writeSpline(const lc::entity::Spline_CSPtr& s);
-
-    void writeDimension(const lc::entity::Dimension_CSPtr& d);
-
-    void writeLWPolyline(const lc::entity::LWPolyline_CSPtr& p);
-
-    void writeImage(const lc::entity::Image_CSPtr& i);
-
-    void writeText(const lc::entity::Text_CSPtr& t);
-
-    void writeInsert(const lc::entity::Insert_CSPtr& i);
+    void getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_CSPtr& entity) const;
 
     void writeLayer(const std::shared_ptr<const lc::meta::Layer>& layer);
 
@@ -218,6 +219,57 @@ public:
     lc::meta::Block_SPtr _currentBlock;
 
 private:
+    /**
+     * Entity read by the parser
+     * build() is called on the thread pool, or by the calling thread if the entity isn't thread safe to create
+     */
+    struct EntityRecord {
+        std::function<lc::entity::CADEntity_CSPtr()> build;
+        bool threadSafe;
+    };
+
+    struct EntityBatch {
+        std::vector<EntityRecord> records;
+        std::vector<lc::entity::CADEntity_CSPtr> entities;
+    };
+
+    /**
+     * Add an entity to the current batch, the layer and block must already be resolved
+     * as they depend on the state of the parser
+     */
+    void queueEntity(std::function<lc::entity::CADEntity_CSPtr()> build, bool threadSafe = true);
+
+    /**
+     * Send the current batch to the thread pool
+     */
+    void flushEntities();
+
+    typedef std::vector<std::unique_ptr<DRW_Entity>> EncodedEntities;
+
+    /**
+     * Entities to write, one section per block in the order of _exportBlocks, followed by the model space
+     */
+    void prepareExport();
+
+    /**
+     * Convert the next batches on the thread pool, up to the queue limit
+     */
+    void queueEncoding();
+
+    /**
+     * Write the converted entities of a section, the batches of the previous sections are dropped
+     */
+    void writeSection(size_t section);
+
+    /**
+     * Wait for the conversions still running and release the entities
+     */
+    void finishExport();
+
+    void writeEncodedEntity(DRW_Entity* entity);
+
+    lc::meta::DxfLinePatternByValue_CSPtr linePatternByName(const std::string& name) const;
+
     /**
     * Return the MetaInfo object from a DRW_Entity.
     * This is useful because most/all entities will share the same basic properties
@@ -226,7 +278,9 @@ private:
 
     dxfRW* dxfW;
 
-    lc::meta::MetaInfo_SPtr getMetaInfo(DRW_Entity const& data) const;
+    lc::meta::MetaInfo_CSPtr getMetaInfo(DRW_Entity const& data) const;
+
+    lc::meta::MetaInfo_SPtr createMetaInfo(DRW_Entity const& data) const;
 
     lc::meta::Block_CSPtr getBlock(DRW_Entity const& data) const;
 
@@ -247,6 +301,28 @@ private:
     //std::map<std::string, lc::meta::Block_CSPtr> _blocks;
     std::map<int, lc::meta::Block_CSPtr> _handleBlock;
 
+    // Layers and line patterns read from the file, they are only added to the document when the builder is executed
+    mutable std::map<std::string, lc::meta::Layer_CSPtr, lc::tools::StringHelper::cmpCaseInsensetive> _layers;
+    std::map<std::string, lc::meta::DxfLinePatternByValue_CSPtr, lc::tools::StringHelper::cmpCaseInsensetive> _linePatterns;
+    mutable std::mutex _linePatternsMutex;
+
+    // Interned MetaInfo by line weight, color and line type
+    mutable std::map<std::tuple<int, int, std::string>, lc::meta::MetaInfo_CSPtr> _metaInfos;
+    mutable std::mutex _metaInfosMutex;
+
+    std::shared_ptr<EntityBatch> _batch;
+    lc::tools::BoundedQueue<std::future<std::shared_ptr<EntityBatch>>> _batches;
+    std::atomic<bool> _cancelled;
+
+    class EntityEncoder;
+
+    std::vector<lc::meta::Block_CSPtr> _exportBlocks;
+    std::vector<std::vector<lc::entity::CADEntity_CSPtr>> _exportSections;
+    std::deque<std::pair<size_t, std::future<EncodedEntities>>> _encoded;
+    size_t _encodeSection;
+    size_t _encodeBegin;
+    size_t _encodeQueueSize;
+
     const static std::map<int, lc::Units> _dxfToLCUnits;
     const static std::map<lc::Units, int> _lcUnitsToDXF;
 };
@@ -0,0 +1,540 @@
+#include "journal.h"
+#include "nativeformat.h"
+#include "nativereader.h"
+#include "nativewriter.h"
+
+#include <cad/logger/logger.h>
+#include <cad/operations/blockops.h>
+#include <cad/operations/builder.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/layerops.h>
+#include <cad/operations/linepatternops.h>
+#include <cad/tools/string_helper.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace lc;
+using namespace lc::persistence;
+using namespace lc::persistence::native;
+
+namespace {
+uint32_t checksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void appendString(std::string& buffer, const std::string& value) {
+    auto length = static_cast<uint32_t>(value.size());
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    buffer += value;
+    buffer.resize((buffer.size() + 7) & ~size_t(7), '\0');
+}
+
+/**
+ * Read a string written by appendString()
+ * @return false if the string goes past the end
+ */
+bool readString(const char*& position, const char* end, std::string& value) {
+    uint32_t length;
+    if(static_cast<size_t>(end - position) < sizeof(length)) {
+        return false;
+    }
+    std::memcpy(&length, position, sizeof(length));
+
+    auto padded = (sizeof(length) + length + 7) & ~size_t(7);
+    if(static_cast<size_t>(end - position) < padded) {
+        return false;
+    }
+
+    value.assign(position + sizeof(length), length);
+    position += padded;
+    return true;
+}
+
+/**
+ * Replace a file, on POSIX systems the replacement is atomic
+ */
+void replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    std::remove(to.c_str());
+#endif
+    if(std::rename(from.c_str(), to.c_str()) != 0) {
+        throw std::runtime_error("Unable to replace " + to);
+    }
+}
+
+typedef std::map<std::string, meta::DocumentMetaType_CSPtr, tools::StringHelper::cmpCaseInsensetive> MetaTypeMap;
+
+/**
+ * Apply the final state of the journaled meta types and entities to the document
+ * nullptr means removed.
+ */
+void apply(const storage::Document_SPtr& document,
+           const MetaTypeMap& metaTypes,
+           const std::unordered_map<ID_DATATYPE, entity::CADEntity_CSPtr>& entities) {
+    auto builder = std::make_shared<operation::Builder>(document, "Recover");
+    auto existing = document->allMetaTypes();
+
+    auto find = [&existing](const std::string& id) -> meta::DocumentMetaType_CSPtr {
+        auto it = existing.find(id);
+        return it != existing.end() ? it->second : nullptr;
+    };
+
+    // Line patterns first, layers may use them
+    for(const auto& entry : metaTypes) {
+        auto old = std::dynamic_pointer_cast<const meta::DxfLinePattern>(find(entry.first));
+        auto linePattern = std::dynamic_pointer_cast<const meta::DxfLinePattern>(entry.second);
+
+        if(entry.second == nullptr && old != nullptr) {
+            builder->append(std::make_shared<operation::RemoveLinePattern>(document, old));
+        }
+        else if(linePattern != nullptr) {
+            if(old != nullptr) {
+                builder->append(std::make_shared<operation::ReplaceLinePattern>(document, old, linePattern));
+            }
+            else {
+                builder->append(std::make_shared<operation::AddLinePattern>(document, linePattern));
+            }
+        }
+    }
+
+    for(const auto& entry : metaTypes) {
+        auto old = std::dynamic_pointer_cast<const meta::Layer>(find(entry.first));
+        auto layer = std::dynamic_pointer_cast<const meta::Layer>(entry.second);
+
+        if(entry.second == nullptr && old != nullptr) {
+            builder->append(std::make_shared<operation::RemoveLayer>(document, old));
+        }
+        else if(layer != nullptr) {
+            if(old != nullptr) {
+                builder->append(std::make_shared<operation::ReplaceLayer>(document, old, layer));
+            }
+            else {
+                builder->append(std::make_shared<operation::AddLayer>(document, layer));
+            }
+        }
+    }
+
+    for(const auto& entry : metaTypes) {
+        auto old = std::dynamic_pointer_cast<const meta::Block>(find(entry.first));
+        auto block = std::dynamic_pointer_cast<const meta::Block>(entry.second);
+
+        if(entry.second == nullptr && old != nullptr) {
+            builder->append(std::make_shared<operation::RemoveBlock>(document, old));
+        }
+        else if(block != nullptr) {
+            if(old != nullptr) {
+                builder->append(std::make_shared<operation::ReplaceBlock>(document, old, block));
+            }
+            else {
+                builder->append(std::make_shared<operation::AddBlock>(document, block));
+            }
+        }
+    }
+
+    // Entities read from different records use different instances of the same layer or block,
+    // they are moved to the instance which will be in the document.
+    auto finalLayer = [&](const meta::Layer_CSPtr& layer) {
+        if(layer == nullptr) {
+            return layer;
+        }
+
+        auto it = metaTypes.find(layer->id());
+        if(it != metaTypes.end()) {
+            auto journaled = std::dynamic_pointer_cast<const meta::Layer>(it->second);
+            return journaled != nullptr ? journaled : layer;
+        }
+
+        auto current = document->layerByName(layer->name());
+        return current != nullptr ? current : layer;
+    };
+
+    auto finalBlock = [&](const meta::Block_CSPtr& block) {
+        if(block == nullptr) {
+            return block;
+        }
+
+        auto it = metaTypes.find(block->id());
+        if(it != metaTypes.end()) {
+            auto journaled = std::dynamic_pointer_cast<const meta::Block>(it->second);
+            return journaled != nullptr ? journaled : block;
+        }
+
+        auto current = document->blockByName(block->name());
+        return current != nullptr ? current : block;
+    };
+
+    auto removals = std::make_shared<operation::EntityBuilder>(document);
+    auto insertions = std::make_shared<operation::EntityBuilder>(document);
+    bool removed = false;
+
+    for(const auto& entry : entities) {
+        if(entry.second == nullptr) {
+            auto entity = document->entityByID(entry.first);
+            if(entity != nullptr) {
+                removals->appendEntity(entity);
+                removed = true;
+            }
+            continue;
+        }
+
+        auto entity = entry.second;
+        auto layer = finalLayer(entity->layer());
+        auto block = finalBlock(entity->block());
+
+        if(layer != entity->layer() || block != entity->block()) {
+            entity = entity->modify(layer, entity->metaInfo(), block);
+        }
+        insertions->appendEntity(entity);
+    }
+
+    if(removed) {
+        removals->appendOperation(std::make_shared<operation::Push>());
+        removals->appendOperation(std::make_shared<operation::Remove>());
+        builder->append(removals);
+    }
+    builder->append(insertions);
+
+    builder->execute();
+}
+}
+
+Journal::Journal(storage::Document_SPtr document, std::string path, std::chrono::milliseconds interval, size_t compactionSize) :
+    _document(std::move(document)),
+    _snapshotPath(path + ".lcb"),
+    _journalPath(path + ".lcj"),
+    _interval(interval),
+    _compactionSize(compactionSize),
+    _journalSize(0),
+    _sequence(0),
+    _committed(false),
+    _stop(false),
+    _flushRequests(0),
+    _flushesDone(0) {
+
+    _document->commitProcessEvent().connect<Journal, &Journal::on_CommitProcessEvent>(this);
+    _thread = std::thread(&Journal::run, this);
+}
+
+Journal::~Journal() {
+    _document->commitProcessEvent().disconnect<Journal, &Journal::on_CommitProcessEvent>(this);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wakeUp.notify_one();
+    _thread.join();
+
+    // The remaining snapshots are released with the members, on this thread
+}
+
+void Journal::on_CommitProcessEvent(const lc::event::CommitProcessEvent& event) {
+    releaseSnapshots();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _committed = true;
+    }
+    _wakeUp.notify_one();
+}
+
+void Journal::release(storage::DocumentSnapshot_CSPtr snapshot) {
+    if(snapshot == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _released.push_back(std::move(snapshot));
+}
+
+void Journal::releaseSnapshots() {
+    std::vector<storage::DocumentSnapshot_CSPtr> released;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        released.swap(_released);
+    }
+}
+
+void Journal::flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto request = ++_flushRequests;
+    _wakeUp.notify_one();
+    _flushed.wait(lock, [this, request]() {
+        return _flushesDone >= request;
+    });
+}
+
+void Journal::run() {
+    try {
+        // The old journal is removed first, it doesn't apply to the new snapshot
+        resetJournal();
+        auto snapshot = _document->snapshot();
+        compact(snapshot);
+        release(std::move(snapshot));
+    }
+    catch(const std::exception& e) {
+        LOG_ERROR << "Autosave: " << e.what();
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while(true) {
+        _wakeUp.wait_for(lock, _interval, [this]() {
+            return _committed || _stop || _flushRequests > _flushesDone;
+        });
+
+        _committed = false;
+        auto stop = _stop;
+        auto flushRequests = _flushRequests;
+        lock.unlock();
+
+        auto snapshot = _document->snapshot();
+        try {
+            write(snapshot);
+        }
+        catch(const std::exception& e) {
+            LOG_ERROR << "Autosave: " << e.what();
+        }
+        release(std::move(snapshot));
+
+        lock.lock();
+        _flushesDone = flushRequests;
+        _flushed.notify_all();
+
+        if(stop) {
+            break;
+        }
+    }
+}
+
+void Journal::write(const storage::DocumentSnapshot_CSPtr& snapshot) {
+    if(snapshot == _written || _written == nullptr || !_stream.is_open()) {
+        return;
+    }
+
+    std::vector<EntityID> removedEntities;
+    std::vector<entity::CADEntity_CSPtr> entities;
+    snapshot->diffEntities(*_written, [&](const entity::CADEntity_CSPtr& oldEntity, const entity::CADEntity_CSPtr& newEntity) {
+        if(newEntity != nullptr) {
+            entities.push_back(newEntity);
+        }
+        else {
+            removedEntities.push_back(oldEntity->id());
+        }
+    });
+
+    std::vector<std::string> removedMetaTypes;
+    std::vector<meta::DocumentMetaType_CSPtr> metaTypes;
+    snapshot->diffMetaTypes(*_written, [&](const meta::DocumentMetaType_CSPtr& oldMetaType, const meta::DocumentMetaType_CSPtr& newMetaType) {
+        if(newMetaType != nullptr) {
+            metaTypes.push_back(newMetaType);
+        }
+        else {
+            removedMetaTypes.push_back(oldMetaType->id());
+        }
+    });
+
+    std::string payload(reinterpret_cast<const char*>(removedEntities.data()), removedEntities.size() * sizeof(EntityID));
+    for(const auto& id : removedMetaTypes) {
+        appendString(payload, id);
+    }
+    for(const auto& metaType : metaTypes) {
+        appendString(payload, metaType->id());
+    }
+
+    std::string changes;
+    NativeWriter(metaTypes, entities).encode(changes);
+    payload += changes;
+
+    JournalRecord record = {};
+    record.sequence = ++_sequence;
+    record.size = payload.size();
+    record.checksum = checksum(payload.data(), payload.size());
+    record.removedEntities = static_cast<uint32_t>(removedEntities.size());
+    record.removedMetaTypes = static_cast<uint32_t>(removedMetaTypes.size());
+    record.changedMetaTypes = static_cast<uint32_t>(metaTypes.size());
+
+    _stream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    _stream.write(payload.data(), payload.size());
+    _stream.flush();
+
+    if(!_stream) {
+        throw std::runtime_error("Unable to write " + _journalPath);
+    }
+
+    _journalSize += sizeof(record) + payload.size();
+    release(std::move(_written));
+    _written = snapshot;
+
+    if(_journalSize > _compactionSize) {
+        compact(snapshot);
+        resetJournal();
+    }
+}
+
+void Journal::compact(const storage::DocumentSnapshot_CSPtr& snapshot) {
+    auto temporary = _snapshotPath + ".tmp";
+    NativeWriter(snapshot).write(temporary);
+    replaceFile(temporary, _snapshotPath);
+
+    release(std::move(_written));
+    _written = snapshot;
+}
+
+void Journal::resetJournal() {
+    _stream.close();
+    _stream.clear();
+    _stream.open(_journalPath, std::ios::binary | std::ios::trunc);
+
+    JournalHeader header = {};
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    _stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _stream.flush();
+
+    if(!_stream) {
+        throw std::runtime_error("Unable to write " + _journalPath);
+    }
+
+    _journalSize = sizeof(header);
+}
+
+bool Journal::recover(const storage::Document_SPtr& document, const std::string& path) {
+    bool recovered = false;
+
+    auto snapshotPath = path + ".lcb";
+    if(std::ifstream(snapshotPath).good()) {
+        NativeReader reader(snapshotPath, document);
+        auto builder = std::make_shared<operation::Builder>(document, "Recover");
+        reader.load(document, builder);
+        builder->execute();
+        recovered = true;
+    }
+
+    std::ifstream stream(path + ".lcj", std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    JournalHeader header;
+    if(data.size() < sizeof(header)) {
+        return recovered;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    if(std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+       header.byteOrder != BYTE_ORDER_MARK ||
+       header.version > VERSION) {
+        LOG_WARNING << "Autosave: " << path << ".lcj is not a valid journal";
+        return recovered;
+    }
+
+    MetaTypeMap metaTypes;
+    std::unordered_map<ID_DATATYPE, entity::CADEntity_CSPtr> entities;
+
+    auto position = data.data() + sizeof(header);
+    auto end = data.data() + data.size();
+    uint64_t sequence = 0;
+
+    while(static_cast<size_t>(end - position) >= sizeof(JournalRecord)) {
+        JournalRecord record;
+        std::memcpy(&record, position, sizeof(record));
+        position += sizeof(record);
+
+        if(record.size > static_cast<size_t>(end - position) ||
+           record.sequence <= sequence ||
+           checksum(position, record.size) != record.checksum) {
+            LOG_WARNING << "Autosave: the journal ends with an incomplete change, it was ignored";
+            break;
+        }
+
+        auto payload = position;
+        auto payloadEnd = position + record.size;
+        position = payloadEnd;
+        sequence = record.sequence;
+
+        if(record.removedEntities > record.size / sizeof(EntityID)) {
+            break;
+        }
+        std::vector<EntityID> removedEntities(record.removedEntities);
+        std::memcpy(removedEntities.data(), payload, removedEntities.size() * sizeof(EntityID));
+        payload += removedEntities.size() * sizeof(EntityID);
+
+        std::vector<std::string> removedMetaTypes(record.removedMetaTypes);
+        std::unordered_set<std::string> changedMetaTypes;
+        bool valid = true;
+
+        for(auto& id : removedMetaTypes) {
+            valid = valid && readString(payload, payloadEnd, id);
+        }
+        for(uint32_t i = 0; i < record.changedMetaTypes && valid; i++) {
+            std::string id;
+            valid = readString(payload, payloadEnd, id);
+            changedMetaTypes.insert(tools::StringHelper::tolower(id));
+        }
+
+        if(!valid) {
+            break;
+        }
+
+        std::unique_ptr<NativeReader> reader;
+        try {
+            reader.reset(new NativeReader(payload, payloadEnd - payload, document));
+        }
+        catch(const std::runtime_error& e) {
+            LOG_WARNING << "Autosave: " << e.what();
+            break;
+        }
+
+        for(const auto& id : removedEntities) {
+            entities[static_cast<ID_DATATYPE>(id)] = nullptr;
+        }
+        for(const auto& id : removedMetaTypes) {
+            metaTypes[id] = nullptr;
+        }
+
+        auto changed = [&](const meta::DocumentMetaType_CSPtr& metaType) {
+            if(changedMetaTypes.count(tools::StringHelper::tolower(metaType->id())) != 0) {
+                metaTypes[metaType->id()] = metaType;
+            }
+        };
+        for(const auto& linePattern : reader->linePatterns()) {
+            changed(linePattern);
+        }
+        for(const auto& layer : reader->layers()) {
+            changed(layer);
+        }
+        for(const auto& block : reader->blocks()) {
+            changed(block);
+        }
+
+        for(size_t i = 0; i < reader->size(); i++) {
+            auto entity = reader->entity(i);
+            entities[entity->id()] = entity;
+        }
+
+        recovered = true;
+    }
+
+    if(!metaTypes.empty() || !entities.empty()) {
+        apply(document, metaTypes, entities);
+    }
+
+    return recovered;
+}
+
+void Journal::discard(const std::string& path) {
+    std::remove((path + ".lcb").c_str());
+    std::remove((path + ".lcj").c_str());
+}
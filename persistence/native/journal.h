@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cad/events/commitprocessevent.h>
+#include <cad/storage/document.h>
+#include <cad/storage/documentsnapshot.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lc {
+namespace persistence {
+/**
+ * @brief Append only autosave journal of a document
+ * The journal keeps two files: path + ".lcb", a snapshot of the document in the native format,
+ * and path + ".lcj", the changes made since that snapshot.
+ *
+ * A background thread compares the last published DocumentSnapshot with the last one it wrote and appends
+ * the difference to the journal: new, modified and removed entities, layers, line patterns and blocks.
+ * Committing an operation only wakes this thread up, the edit thread never waits for the disk.
+ * Undo and redo are written at the next interval.
+ * When the journal grows over compactionSize, the snapshot file is rewritten and the journal restarts.
+ *
+ * Recovered entities keep their ID.
+ *
+ * Snapshots are never released by the journal thread: destroying entities such as inserts disconnects document
+ * signals, which must happen on the thread editing the document. The snapshots the journal is done with
+ * are released at the next commit or when the journal is destroyed.
+ */
+class Journal {
+public:
+    /**
+     * @brief Start journaling a document
+     * The current content of the document is written as the first snapshot, existing files are replaced.
+     * @param interval maximum time between two writes
+     * @param compactionSize size of the journal in bytes after which a new snapshot is written
+     */
+    Journal(storage::Document_SPtr document,
+            std::string path,
+            std::chrono::milliseconds interval = std::chrono::seconds(5),
+            size_t compactionSize = 64 * 1024 * 1024);
+
+    /**
+     * @brief Write the last changes and stop
+     */
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /**
+     * @brief Wait until the current state of the document is written
+     */
+    void flush();
+
+    /**
+     * @brief Restore a document from a snapshot and its journal
+     * The document should be empty. Changes at the end of the journal which were not completely written are ignored.
+     * @return false if there was nothing to recover
+     * @throw std::runtime_error if the snapshot can't be read
+     */
+    static bool recover(const storage::Document_SPtr& document, const std::string& path);
+
+    /**
+     * @brief Remove the files of a journal, once the document has been saved
+     * The journal must be destroyed first.
+     */
+    static void discard(const std::string& path);
+
+    void on_CommitProcessEvent(const lc::event::CommitProcessEvent& event);
+
+private:
+    void run();
+
+    /**
+     * @brief Append the changes since the last written snapshot
+     */
+    void write(const storage::DocumentSnapshot_CSPtr& snapshot);
+
+    /**
+     * @brief Write a new snapshot file and restart the journal
+     */
+    void compact(const storage::DocumentSnapshot_CSPtr& snapshot);
+
+    void resetJournal();
+
+    /**
+     * @brief Keep a snapshot until the thread editing the document releases it
+     */
+    void release(storage::DocumentSnapshot_CSPtr snapshot);
+
+    /**
+     * @brief Release the snapshots the journal thread is done with, on the calling thread
+     */
+    void releaseSnapshots();
+
+    storage::Document_SPtr _document;
+    std::string _snapshotPath;
+    std::string _journalPath;
+    std::chrono::milliseconds _interval;
+    size_t _compactionSize;
+
+    // Used by the journal thread only
+    storage::DocumentSnapshot_CSPtr _written;
+    std::ofstream _stream;
+    size_t _journalSize;
+    uint64_t _sequence;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    std::condition_variable _flushed;
+    bool _committed;
+    bool _stop;
+    unsigned long _flushRequests;
+    unsigned long _flushesDone;
+    std::vector<storage::DocumentSnapshot_CSPtr> _released;
+
+    std::thread _thread;
+};
+}
+}
@@ -0,0 +1,99 @@
+#include "mappedfile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace lc::persistence;
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path) :
+    _file(INVALID_HANDLE_VALUE),
+    _mapping(nullptr),
+    _data(nullptr),
+    _size(0) {
+
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(_file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Unable to open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(_file, &size)) {
+        CloseHandle(_file);
+        throw std::runtime_error("Unable to read the size of " + path);
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+
+    if(_size == 0) {
+        return;
+    }
+
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(_mapping != nullptr) {
+        _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    if(_data == nullptr) {
+        if(_mapping != nullptr) {
+            CloseHandle(_mapping);
+        }
+        CloseHandle(_file);
+        throw std::runtime_error("Unable to map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if(_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+    if(_mapping != nullptr) {
+        CloseHandle(_mapping);
+    }
+    CloseHandle(_file);
+}
+#else
+MappedFile::MappedFile(const std::string& path) :
+    _fd(-1),
+    _data(nullptr),
+    _size(0) {
+
+    _fd = ::open(path.c_str(), O_RDONLY);
+    if(_fd < 0) {
+        throw std::runtime_error("Unable to open " + path);
+    }
+
+    struct stat status;
+    if(fstat(_fd, &status) != 0) {
+        ::close(_fd);
+        throw std::runtime_error("Unable to read the size of " + path);
+    }
+    _size = static_cast<size_t>(status.st_size);
+
+    if(_size == 0) {
+        return;
+    }
+
+    auto data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if(data == MAP_FAILED) {
+        ::close(_fd);
+        throw std::runtime_error("Unable to map " + path);
+    }
+
+    _data = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile() {
+    if(_data != nullptr) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+    ::close(_fd);
+}
+#endif
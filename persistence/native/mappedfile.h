@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace lc {
+namespace persistence {
+/**
+ * @brief Read only memory mapping of a file
+ * Pages are loaded by the system when they are first read.
+ */
+class MappedFile {
+public:
+    /**
+     * @throw std::runtime_error if the file can't be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return _data;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+private:
+#ifdef _WIN32
+    void* _file;
+    void* _mapping;
+#else
+    int _fd;
+#endif
+    const char* _data;
+    size_t _size;
+};
+}
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * LibreCAD native binary format
+ *
+ * The file is a header followed by a table of sections. Every section starts at a multiple of 8 bytes,
+ * so the file can be mapped in memory and read in place.
+ * Numbers are stored in the byte order of the machine writing the file, the header contains a byte
+ * order mark and a file written on a machine with another byte order is rejected.
+ *
+ * Entities are stored in one table per type, column by column (all the layers, then all the meta infos...).
+ * Layers, blocks, line patterns, strings and meta infos are stored once and referenced by index.
+ * Entities are numbered across tables in the order of EntityTable, the spatial index, the bounds and the entity IDs use these numbers.
+ * The boundaries of the hatches are stored in a second set of entity tables, see BOUNDARY_TABLES.
+ *
+ * Version 2 added the entity IDs and the tables after LWPOLYLINE_TABLE, files of version 1 don't contain them.
+ */
+namespace lc {
+namespace persistence {
+namespace native {
+static const char MAGIC[8] = {'L', 'C', 'N', 'A', 'T', 'I', 'V', 'E'};
+static const uint32_t VERSION = 2;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// Reference to a layer, block, meta info or line pattern which isn't set
+static const uint32_t NONE = 0xFFFFFFFF;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+
+struct SectionEntry {
+    uint32_t type;
+    uint32_t count;
+    uint64_t offset;
+    uint64_t size;
+};
+
+enum SectionType : uint32_t {
+    STRINGS = 1,
+    LINE_PATTERNS,
+    DOUBLES,
+    LAYERS,
+    BLOCKS,
+    META_INFOS,
+    VERTICES,
+    BOUNDS,
+    SPATIAL_INDEX,
+    ENTITY_IDS,
+    HATCH_LOOPS,
+    LOOP_ENTITIES,
+    // Entity tables, one per EntityTable
+    ENTITY_TABLES = 100,
+    // Entities of the hatch loops, they are not part of the document
+    BOUNDARY_TABLES = 200
+};
+
+enum EntityTable : uint32_t {
+    LINE_TABLE,
+    CIRCLE_TABLE,
+    ARC_TABLE,
+    ELLIPSE_TABLE,
+    POINT_TABLE,
+    LWPOLYLINE_TABLE,
+    TEXT_TABLE,
+    SPLINE_TABLE,
+    DIM_ALIGNED_TABLE,
+    DIM_ANGULAR_TABLE,
+    DIM_DIAMETRIC_TABLE,
+    DIM_LINEAR_TABLE,
+    DIM_RADIAL_TABLE,
+    IMAGE_TABLE,
+    HATCH_TABLE,
+    INSERT_TABLE,
+    ENTITY_TABLE_COUNT
+};
+
+// First table of version 2
+static const uint32_t VERSION_2_TABLES = TEXT_TABLE;
+
+/**
+ * Columns of an entity table.
+ * The first three integer columns are layer, meta info and block, followed by the entity specific columns:
+ * Line: x1 y1 x2 y2
+ * Circle: cx cy radius
+ * Arc: cx cy radius startAngle endAngle | ccw
+ * Ellipse: cx cy majorX majorY minorRadius startAngle endAngle | reversed
+ * Point: x y
+ * LWPolyline: width elevation thickness extrusionX extrusionY extrusionZ | closed firstVertex vertexCount
+ * Text: x y height angle | text style drawingDirection hAlign vAlign flags (TextFlags)
+ * Spline: fitTolerance startTangentX startTangentY startTangentZ endTangentX endTangentY endTangentZ normalX normalY normalZ
+ *         | degree closed flags firstControlPoint controlPointCount firstKnot knotCount firstFitPoint fitPointCount
+ * Dimensions start with: definitionX definitionY textX textY textAngle lineSpacingFactor
+ *                        | attachmentPoint lineSpacingStyle explicitValue
+ * DimAligned: ... definition2X definition2Y definition3X definition3Y
+ * DimAngular: ... line11X line11Y line12X line12Y line21X line21Y line22X line22Y
+ * DimDiametric: ... definition2X definition2Y leader
+ * DimLinear: ... definition2X definition2Y definition3X definition3Y angle oblique
+ * DimRadial: ... definition2X definition2Y leader
+ * Image: baseX baseY uX uY vX vY width height brightness contrast fade | name
+ * Hatch: angle scale patternMinX patternMinY patternMaxX patternMaxY
+ *        | solid name patternName firstLoop loopCount firstSegment segmentCount
+ * Insert: x y | displayBlock
+ *
+ * text, style, explicitValue, name and patternName are strings. Spline points are x y z in DOUBLES, knots too.
+ * The segments of a hatch pattern are startX startY endX endY in DOUBLES.
+ * A hatch loop is a LoopRecord in HATCH_LOOPS, its entities are listed in LOOP_ENTITIES by number in the boundary tables.
+ */
+struct TableSchema {
+    uint32_t intColumns;
+    uint32_t doubleColumns;
+};
+
+static const uint32_t COMMON_INT_COLUMNS = 3;
+
+static const TableSchema TABLE_SCHEMAS[ENTITY_TABLE_COUNT] = {
+    {COMMON_INT_COLUMNS, 4},
+    {COMMON_INT_COLUMNS, 3},
+    {COMMON_INT_COLUMNS + 1, 5},
+    {COMMON_INT_COLUMNS + 1, 7},
+    {COMMON_INT_COLUMNS, 2},
+    {COMMON_INT_COLUMNS + 3, 6},
+    {COMMON_INT_COLUMNS + 6, 4},
+    {COMMON_INT_COLUMNS + 9, 10},
+    {COMMON_INT_COLUMNS + 3, 10},
+    {COMMON_INT_COLUMNS + 3, 14},
+    {COMMON_INT_COLUMNS + 3, 9},
+    {COMMON_INT_COLUMNS + 3, 12},
+    {COMMON_INT_COLUMNS + 3, 9},
+    {COMMON_INT_COLUMNS + 1, 11},
+    {COMMON_INT_COLUMNS + 7, 6},
+    {COMMON_INT_COLUMNS + 1, 2}
+};
+
+enum TextFlags : uint32_t {
+    TEXT_UNDERLINED = 1,
+    TEXT_STRIKETHROUGH = 2,
+    TEXT_BOLD = 4,
+    TEXT_ITALIC = 8
+};
+
+// Vertices of the polylines: x y bulge startWidth endWidth, one column each
+static const uint32_t VERTEX_COLUMNS = 5;
+
+// Entity bounds: minX minY maxX maxY, one column each
+static const uint32_t BOUNDS_COLUMNS = 4;
+
+// Entity IDs are stored as uint64_t, in the order of the entity numbers
+typedef uint64_t EntityID;
+
+struct LinePatternRecord {
+    uint32_t name;
+    uint32_t description;
+    uint32_t firstDash; // In DOUBLES
+    uint32_t dashCount;
+    double length;
+};
+
+struct LayerRecord {
+    uint32_t name;
+    uint32_t linePattern;
+    uint32_t frozen;
+    uint32_t reserved;
+    double width;
+    double color[4];
+};
+
+struct BlockRecord {
+    uint32_t name;
+    uint32_t reserved;
+    double base[2];
+};
+
+struct LoopRecord {
+    uint32_t firstEntity; // In LOOP_ENTITIES
+    uint32_t entityCount;
+};
+
+enum MetaKind : uint32_t {
+    META_NONE,
+    META_BY_VALUE,
+    META_BY_BLOCK
+};
+
+struct MetaInfoRecord {
+    uint32_t colorKind;
+    uint32_t widthKind;
+    uint32_t linePatternKind;
+    uint32_t linePattern;
+    double color[4];
+    double width;
+};
+
+/**
+ * Uniform grid over bounds, followed by
+ * uint32_t cellStart[columns * rows + 1], uint32_t entities[], uint32_t large[largeCount]
+ * Entities covering more than MAX_CELLS_PER_ENTITY cells are only stored in the large list.
+ */
+struct SpatialIndexHeader {
+    double bounds[4];
+    uint32_t columns;
+    uint32_t rows;
+    uint32_t largeCount;
+    uint32_t reserved;
+};
+
+static const uint32_t MAX_CELLS_PER_ENTITY = 64;
+
+/**
+ * Autosave journal
+ *
+ * A JournalHeader followed by records. A record is a JournalRecord followed by its payload:
+ * EntityID removed[removedEntities], the IDs of the removed meta types, the IDs of the new or modified
+ * meta types, and a native file holding the new and modified entities and meta types.
+ * Meta type IDs are a uint32_t length followed by the characters, padded to 8 bytes.
+ * The native file also contains the layers and blocks referenced by the entities, only the meta types
+ * listed as modified are changes.
+ *
+ * The checksum is the 32 bits FNV-1a hash of the payload. A record which is truncated or doesn't match
+ * its checksum ends the journal.
+ */
+static const char JOURNAL_MAGIC[8] = {'L', 'C', 'J', 'O', 'U', 'R', 'N', 'L'};
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+};
+
+struct JournalRecord {
+    uint64_t sequence;
+    uint64_t size;
+    uint32_t checksum;
+    uint32_t removedEntities;
+    uint32_t removedMetaTypes;
+    uint32_t changedMetaTypes;
+};
+}
+}
+}
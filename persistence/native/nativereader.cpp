@@ -0,0 +1,751 @@
+#include "nativereader.h"
+
+#include <cad/meta/metacolor.h>
+#include <cad/meta/metalinewidth.h>
+#include <cad/operations/blockops.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/layerops.h>
+#include <cad/operations/linepatternops.h>
+#include <cad/builders/insert.h>
+#include <cad/primitive/arc.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/dimaligned.h>
+#include <cad/primitive/dimangular.h>
+#include <cad/primitive/dimdiametric.h>
+#include <cad/primitive/dimlinear.h>
+#include <cad/primitive/dimradial.h>
+#include <cad/primitive/ellipse.h>
+#include <cad/primitive/hatch.h>
+#include <cad/primitive/image.h>
+#include <cad/primitive/insert.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/lwpolyline.h>
+#include <cad/primitive/point.h>
+#include <cad/primitive/spline.h>
+#include <cad/primitive/text.h>
+#include <cad/tools/threadpool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace lc;
+using namespace lc::persistence;
+using namespace lc::persistence::native;
+
+namespace {
+size_t align(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+std::runtime_error invalidFile(const std::string& reason) {
+    return std::runtime_error("Invalid LibreCAD file: " + reason);
+}
+
+/**
+ * Make sure new entities don't get an ID which was restored from the file
+ */
+void reserveID(ID_DATATYPE id) {
+    auto current = entity::ID::__idCounter.load();
+    while(current < id && !entity::ID::__idCounter.compare_exchange_weak(current, id)) {
+    }
+}
+}
+
+NativeReader::NativeReader(const std::string& path, storage::Document_SPtr document) :
+    _file(new MappedFile(path)),
+    _document(std::move(document)),
+    _data(_file->data()),
+    _dataSize(_file->size()),
+    _spatialIndex(nullptr) {
+    open();
+}
+
+NativeReader::NativeReader(const char* data, size_t size, storage::Document_SPtr document) :
+    _document(std::move(document)),
+    _data(data),
+    _dataSize(size),
+    _spatialIndex(nullptr) {
+    open();
+}
+
+void NativeReader::open() {
+    if(_dataSize < sizeof(FileHeader)) {
+        throw invalidFile("missing header");
+    }
+
+    auto header = reinterpret_cast<const FileHeader*>(_data);
+    if(std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw invalidFile("wrong magic number");
+    }
+    if(header->byteOrder != BYTE_ORDER_MARK) {
+        throw invalidFile("written with another byte order");
+    }
+    if(header->version > VERSION) {
+        throw invalidFile("version " + std::to_string(header->version) + " is not supported");
+    }
+    _version = header->version;
+
+    _sectionCount = header->sectionCount;
+    if(_sectionCount > (_dataSize - sizeof(FileHeader)) / sizeof(SectionEntry)) {
+        throw invalidFile("truncated section table");
+    }
+    _sections = reinterpret_cast<const SectionEntry*>(_data + sizeof(FileHeader));
+
+    for(uint32_t i = 0; i < _sectionCount; i++) {
+        const auto& entry = _sections[i];
+        if(entry.offset % 8 != 0 || entry.offset > _dataSize || entry.size > _dataSize - entry.offset) {
+            throw invalidFile("section " + std::to_string(entry.type) + " is outside of the file");
+        }
+    }
+
+    // Strings
+    auto strings = section(STRINGS);
+    _stringCount = strings->count;
+    auto offsetsSize = align((static_cast<size_t>(_stringCount) + 1) * sizeof(uint32_t));
+    _stringOffsets = reinterpret_cast<const uint32_t*>(sectionData<char>(STRINGS, offsetsSize));
+    _strings = reinterpret_cast<const char*>(_stringOffsets) + offsetsSize;
+    if(_stringOffsets[_stringCount] > strings->size - offsetsSize) {
+        throw invalidFile("truncated strings");
+    }
+
+    // With increasing offsets, every string ends before the last offset
+    for(uint32_t i = 0; i < _stringCount; i++) {
+        if(_stringOffsets[i] > _stringOffsets[i + 1]) {
+            throw invalidFile("wrong string offsets");
+        }
+    }
+
+    // Vertices
+    _vertexCount = section(VERTICES)->count;
+    auto vertices = sectionData<double>(VERTICES, _vertexCount * VERTEX_COLUMNS);
+    for(uint32_t i = 0; i < VERTEX_COLUMNS; i++) {
+        _vertices[i] = vertices + i * _vertexCount;
+    }
+
+    _doubleCount = section(DOUBLES)->count;
+    _doubles = sectionData<double>(DOUBLES, _doubleCount);
+
+    _tables = readTables(ENTITY_TABLES, _size);
+    _boundaryTables = readTables(BOUNDARY_TABLES, _boundarySize);
+
+    // Bounds
+    if(section(BOUNDS)->count != _size) {
+        throw invalidFile("bounds don't match the entities");
+    }
+    auto bounds = sectionData<double>(BOUNDS, _size * BOUNDS_COLUMNS);
+    for(uint32_t i = 0; i < BOUNDS_COLUMNS; i++) {
+        _bounds[i] = bounds + i * _size;
+    }
+
+    _ids = nullptr;
+    if(_version >= 2) {
+        if(section(ENTITY_IDS)->count != _size) {
+            throw invalidFile("IDs don't match the entities");
+        }
+        _ids = sectionData<EntityID>(ENTITY_IDS, _size);
+    }
+
+    // Spatial index
+    _spatialIndex = sectionData<SpatialIndexHeader>(SPATIAL_INDEX, 1);
+    auto cells = static_cast<size_t>(_spatialIndex->columns) * _spatialIndex->rows;
+    if(cells == 0) {
+        throw invalidFile("empty spatial index");
+    }
+
+    auto indexSection = section(SPATIAL_INDEX);
+    auto indexData = _data + indexSection->offset;
+    auto available = indexSection->size - sizeof(SpatialIndexHeader);
+
+    if(available < (cells + 1) * sizeof(uint32_t)) {
+        throw invalidFile("truncated spatial index");
+    }
+    _cellStart = reinterpret_cast<const uint32_t*>(indexData + sizeof(SpatialIndexHeader));
+
+    auto cellEntities = static_cast<size_t>(_cellStart[cells]);
+    auto cellStartSize = align((cells + 1) * sizeof(uint32_t));
+    auto cellEntitiesSize = align(cellEntities * sizeof(uint32_t));
+    if(available < cellStartSize + cellEntitiesSize + _spatialIndex->largeCount * sizeof(uint32_t)) {
+        throw invalidFile("truncated spatial index");
+    }
+    for(size_t i = 0; i < cells; i++) {
+        if(_cellStart[i] > _cellStart[i + 1]) {
+            throw invalidFile("wrong spatial index cells");
+        }
+    }
+    _cellEntities = reinterpret_cast<const uint32_t*>(reinterpret_cast<const char*>(_cellStart) + cellStartSize);
+    _largeEntities = reinterpret_cast<const uint32_t*>(reinterpret_cast<const char*>(_cellEntities) + cellEntitiesSize);
+
+    readLoops();
+    readMetaData();
+}
+
+std::vector<NativeReader::EntityTableView> NativeReader::readTables(uint32_t firstSection, size_t& size) const {
+    std::vector<EntityTableView> tables;
+    size = 0;
+
+    for(uint32_t table = 0; table < ENTITY_TABLE_COUNT; table++) {
+        const auto& schema = TABLE_SCHEMAS[table];
+        auto type = firstSection + table;
+
+        EntityTableView view;
+        view.first = size;
+        view.count = 0;
+
+        // Tables added in version 2 don't exist in older files
+        if(_version >= 2 || (firstSection == ENTITY_TABLES && table < VERSION_2_TABLES)) {
+            view.count = section(type)->count;
+        }
+
+        auto intColumnSize = align(view.count * sizeof(uint32_t));
+        auto data = view.count == 0 ? nullptr :
+                    sectionData<char>(type, intColumnSize * schema.intColumns + view.count * sizeof(double) * schema.doubleColumns);
+
+        for(uint32_t i = 0; i < schema.intColumns; i++) {
+            view.ints.push_back(reinterpret_cast<const uint32_t*>(data + i * intColumnSize));
+        }
+
+        auto doubles = reinterpret_cast<const double*>(data + schema.intColumns * intColumnSize);
+        for(uint32_t i = 0; i < schema.doubleColumns; i++) {
+            view.doubles.push_back(doubles + i * view.count);
+        }
+
+        size += view.count;
+        tables.push_back(view);
+    }
+
+    return tables;
+}
+
+void NativeReader::readLoops() {
+    if(_version < 2) {
+        return;
+    }
+
+    auto loopsCount = section(HATCH_LOOPS)->count;
+    auto loops = sectionData<LoopRecord>(HATCH_LOOPS, loopsCount);
+    auto loopEntitiesCount = section(LOOP_ENTITIES)->count;
+    auto loopEntities = sectionData<uint32_t>(LOOP_ENTITIES, loopEntitiesCount);
+
+    for(uint32_t i = 0; i < loopsCount; i++) {
+        const auto& record = loops[i];
+        if(record.firstEntity > loopEntitiesCount || record.entityCount > loopEntitiesCount - record.firstEntity) {
+            throw invalidFile("wrong hatch loop");
+        }
+
+        std::vector<uint32_t> entities(loopEntities + record.firstEntity, loopEntities + record.firstEntity + record.entityCount);
+        for(auto entity : entities) {
+            if(entity >= _boundarySize) {
+                throw invalidFile("wrong hatch loop entity");
+            }
+        }
+        _loops.push_back(std::move(entities));
+    }
+}
+
+const SectionEntry* NativeReader::section(uint32_t type) const {
+    auto entry = findSection(type);
+    if(entry == nullptr) {
+        throw invalidFile("missing section " + std::to_string(type));
+    }
+
+    return entry;
+}
+
+const SectionEntry* NativeReader::findSection(uint32_t type) const {
+    for(uint32_t i = 0; i < _sectionCount; i++) {
+        if(_sections[i].type == type) {
+            return &_sections[i];
+        }
+    }
+
+    return nullptr;
+}
+
+template<typename T>
+const T* NativeReader::sectionData(uint32_t type, size_t count) const {
+    auto entry = section(type);
+
+    if(entry->size < count * sizeof(T)) {
+        throw invalidFile("truncated section " + std::to_string(type));
+    }
+
+    return reinterpret_cast<const T*>(_data + entry->offset);
+}
+
+std::string NativeReader::string(uint32_t index) const {
+    if(index >= _stringCount) {
+        throw invalidFile("wrong string reference");
+    }
+
+    return std::string(_strings + _stringOffsets[index], _stringOffsets[index + 1] - _stringOffsets[index]);
+}
+
+void NativeReader::readMetaData() {
+    auto doublesCount = _doubleCount;
+    auto doubles = _doubles;
+
+    auto linePatternsCount = section(LINE_PATTERNS)->count;
+    auto linePatterns = sectionData<LinePatternRecord>(LINE_PATTERNS, linePatternsCount);
+    for(uint32_t i = 0; i < linePatternsCount; i++) {
+        const auto& record = linePatterns[i];
+
+        if(record.firstDash > doublesCount || record.dashCount > doublesCount - record.firstDash) {
+            throw invalidFile("wrong line pattern");
+        }
+
+        std::vector<double> path(doubles + record.firstDash, doubles + record.firstDash + record.dashCount);
+        _linePatterns.push_back(std::make_shared<const meta::DxfLinePatternByValue>(
+                                    string(record.name), string(record.description), path, record.length
+                                ));
+    }
+
+    auto linePattern = [this](uint32_t index) -> meta::DxfLinePatternByValue_CSPtr {
+        if(index == NONE) {
+            return nullptr;
+        }
+        if(index >= _linePatterns.size()) {
+            throw invalidFile("wrong line pattern reference");
+        }
+        return _linePatterns[index];
+    };
+
+    auto layersCount = section(LAYERS)->count;
+    auto layers = sectionData<LayerRecord>(LAYERS, layersCount);
+    for(uint32_t i = 0; i < layersCount; i++) {
+        const auto& record = layers[i];
+
+        _layers.push_back(std::make_shared<const meta::Layer>(
+                              string(record.name),
+                              meta::MetaLineWidthByValue(record.width),
+                              Color(record.color[0], record.color[1], record.color[2], record.color[3]),
+                              linePattern(record.linePattern),
+                              record.frozen != 0
+                          ));
+    }
+
+    auto blocksCount = section(BLOCKS)->count;
+    auto blocks = sectionData<BlockRecord>(BLOCKS, blocksCount);
+    for(uint32_t i = 0; i < blocksCount; i++) {
+        const auto& record = blocks[i];
+        _blocks.push_back(std::make_shared<const meta::Block>(string(record.name), geo::Coordinate(record.base[0], record.base[1])));
+    }
+
+    auto metaInfosCount = section(META_INFOS)->count;
+    auto metaInfos = sectionData<MetaInfoRecord>(META_INFOS, metaInfosCount);
+    for(uint32_t i = 0; i < metaInfosCount; i++) {
+        const auto& record = metaInfos[i];
+        auto metaInfo = meta::MetaInfo::create();
+
+        if(record.colorKind == META_BY_VALUE) {
+            metaInfo->add(std::make_shared<const meta::MetaColorByValue>(record.color[0], record.color[1], record.color[2], record.color[3]));
+        }
+        else if(record.colorKind == META_BY_BLOCK) {
+            metaInfo->add(std::make_shared<const meta::MetaColorByBlock>());
+        }
+
+        if(record.widthKind == META_BY_VALUE) {
+            metaInfo->add(std::make_shared<const meta::MetaLineWidthByValue>(record.width));
+        }
+        else if(record.widthKind == META_BY_BLOCK) {
+            metaInfo->add(std::make_shared<const meta::MetaLineWidthByBlock>());
+        }
+
+        if(record.linePatternKind == META_BY_VALUE) {
+            auto pattern = linePattern(record.linePattern);
+            if(pattern != nullptr) {
+                metaInfo->add(pattern);
+            }
+        }
+        else if(record.linePatternKind == META_BY_BLOCK) {
+            metaInfo->add(std::make_shared<const meta::DxfLinePatternByBlock>());
+        }
+
+        _metaInfos.push_back(meta::MetaInfo::intern(metaInfo));
+    }
+}
+
+size_t NativeReader::size() const {
+    return _size;
+}
+
+geo::Area NativeReader::bounds() const {
+    return geo::Area(
+               geo::Coordinate(_spatialIndex->bounds[0], _spatialIndex->bounds[1]),
+               geo::Coordinate(_spatialIndex->bounds[2], _spatialIndex->bounds[3])
+           );
+}
+
+const std::vector<meta::Layer_CSPtr>& NativeReader::layers() const {
+    return _layers;
+}
+
+const std::vector<meta::DxfLinePatternByValue_CSPtr>& NativeReader::linePatterns() const {
+    return _linePatterns;
+}
+
+const std::vector<meta::Block_CSPtr>& NativeReader::blocks() const {
+    return _blocks;
+}
+
+entity::CADEntity_CSPtr NativeReader::entity(size_t index) const {
+    if(index >= _size) {
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_entitiesMutex);
+        auto it = _entities.find(index);
+        if(it != _entities.end()) {
+            return it->second;
+        }
+    }
+
+    ID_DATATYPE id = 0;
+    if(_ids != nullptr) {
+        id = static_cast<ID_DATATYPE>(_ids[index]);
+        reserveID(id);
+    }
+
+    // Created without the lock, if two threads create the same entity the first one wins
+    auto entity = createEntity(_tables, index, id);
+
+    std::lock_guard<std::mutex> lock(_entitiesMutex);
+    return _entities.emplace(index, entity).first->second;
+}
+
+std::vector<geo::Coordinate> NativeReader::points(uint32_t first, uint32_t count) const {
+    if(first > _doubleCount || count > (_doubleCount - first) / 3) {
+        throw invalidFile("wrong point list");
+    }
+
+    std::vector<geo::Coordinate> result;
+    result.reserve(count);
+    for(auto i = first; i < first + count * 3; i += 3) {
+        result.emplace_back(_doubles[i], _doubles[i + 1], _doubles[i + 2]);
+    }
+    return result;
+}
+
+std::vector<double> NativeReader::doubles(uint32_t first, uint32_t count) const {
+    if(first > _doubleCount || count > _doubleCount - first) {
+        throw invalidFile("wrong double list");
+    }
+
+    return std::vector<double>(_doubles + first, _doubles + first + count);
+}
+
+entity::CADEntity_CSPtr NativeReader::createEntity(const std::vector<EntityTableView>& tables, size_t index, ID_DATATYPE id) const {
+    uint32_t table = 0;
+    while(index >= tables[table].first + tables[table].count) {
+        table++;
+    }
+
+    const auto& view = tables[table];
+    auto row = index - view.first;
+
+    auto reference = [row, &view](uint32_t column, size_t size) {
+        auto value = view.ints[column][row];
+        if(value != NONE && value >= size) {
+            throw invalidFile("wrong reference in entity table");
+        }
+        return value;
+    };
+
+    auto layerIndex = reference(0, _layers.size());
+    auto metaInfoIndex = reference(1, _metaInfos.size());
+    auto blockIndex = reference(2, _blocks.size());
+
+    auto layer = layerIndex != NONE ? _layers[layerIndex] : nullptr;
+    auto metaInfo = metaInfoIndex != NONE ? _metaInfos[metaInfoIndex] : nullptr;
+    auto block = blockIndex != NONE ? _blocks[blockIndex] : nullptr;
+
+    auto d = [row, &view](uint32_t column) {
+        return view.doubles[column][row];
+    };
+    auto i = [row, &view](uint32_t column) {
+        return view.ints[COMMON_INT_COLUMNS + column][row];
+    };
+    auto c = [&d](uint32_t column) {
+        return geo::Coordinate(d(column), d(column + 1));
+    };
+
+    // Columns shared by the dimensions
+    auto attachmentPoint = [&i]() {
+        return static_cast<TextConst::AttachmentPoint>(i(0));
+    };
+    auto lineSpacingStyle = [&i]() {
+        return static_cast<TextConst::LineSpacingStyle>(i(1));
+    };
+
+    entity::CADEntity_SPtr entity;
+
+    switch(table) {
+    case LINE_TABLE:
+        entity = std::make_shared<entity::Line>(c(0), c(2), layer, metaInfo, block);
+        break;
+
+    case CIRCLE_TABLE:
+        entity = std::make_shared<entity::Circle>(c(0), d(2), layer, metaInfo, block);
+        break;
+
+    case ARC_TABLE:
+        entity = std::make_shared<entity::Arc>(c(0), d(2), d(3), d(4), i(0) != 0, layer, metaInfo, block);
+        break;
+
+    case ELLIPSE_TABLE:
+        entity = std::make_shared<entity::Ellipse>(c(0), c(2), d(4), d(5), d(6), i(0) != 0, layer, metaInfo, block);
+        break;
+
+    case POINT_TABLE:
+        entity = std::make_shared<entity::Point>(d(0), d(1), layer, metaInfo, block);
+        break;
+
+    case LWPOLYLINE_TABLE: {
+        auto first = i(1);
+        auto count = i(2);
+        if(first > _vertexCount || count > _vertexCount - first) {
+            throw invalidFile("wrong polyline vertices");
+        }
+
+        std::vector<entity::LWVertex2D> vertices;
+        vertices.reserve(count);
+        for(auto v = first; v < first + count; v++) {
+            vertices.emplace_back(geo::Coordinate(_vertices[0][v], _vertices[1][v]), _vertices[2][v], _vertices[3][v], _vertices[4][v]);
+        }
+
+        entity = std::make_shared<entity::LWPolyline>(
+                     vertices, d(0), d(1), d(2), i(0) != 0, geo::Coordinate(d(3), d(4), d(5)), layer, metaInfo, block
+                 );
+        break;
+    }
+
+    case TEXT_TABLE:
+        entity = std::make_shared<entity::Text>(
+                     c(0), string(i(0)), d(2), d(3), string(i(1)),
+                     static_cast<TextConst::DrawingDirection>(i(2)),
+                     static_cast<TextConst::HAlign>(i(3)),
+                     static_cast<TextConst::VAlign>(i(4)),
+                     (i(5) & TEXT_UNDERLINED) != 0, (i(5) & TEXT_STRIKETHROUGH) != 0,
+                     (i(5) & TEXT_BOLD) != 0, (i(5) & TEXT_ITALIC) != 0,
+                     layer, metaInfo, block
+                 );
+        break;
+
+    case SPLINE_TABLE:
+        entity = std::make_shared<entity::Spline>(
+                     points(i(3), i(4)), doubles(i(5), i(6)), points(i(7), i(8)),
+                     static_cast<int>(i(0)), i(1) != 0, d(0),
+                     d(1), d(2), d(3), d(4), d(5), d(6), d(7), d(8), d(9),
+                     static_cast<geo::Spline::splineflag>(i(2)),
+                     layer, metaInfo, block
+                 );
+        break;
+
+    case DIM_ALIGNED_TABLE:
+        entity = std::make_shared<entity::DimAligned>(
+                     c(0), c(2), attachmentPoint(), d(4), d(5), lineSpacingStyle(), string(i(2)),
+                     c(6), c(8), layer, metaInfo, block
+                 );
+        break;
+
+    case DIM_ANGULAR_TABLE:
+        entity = std::make_shared<entity::DimAngular>(
+                     c(0), c(2), attachmentPoint(), d(4), d(5), lineSpacingStyle(), string(i(2)),
+                     c(6), c(8), c(10), c(12), layer, metaInfo, block
+                 );
+        break;
+
+    case DIM_DIAMETRIC_TABLE:
+        entity = std::make_shared<entity::DimDiametric>(
+                     c(0), c(2), attachmentPoint(), d(4), d(5), lineSpacingStyle(), string(i(2)),
+                     c(6), d(8), layer, metaInfo, block
+                 );
+        break;
+
+    case DIM_LINEAR_TABLE:
+        entity = std::make_shared<entity::DimLinear>(
+                     c(0), c(2), attachmentPoint(), d(4), d(5), lineSpacingStyle(), string(i(2)),
+                     c(6), c(8), d(10), d(11), layer, metaInfo, block
+                 );
+        break;
+
+    case DIM_RADIAL_TABLE:
+        entity = std::make_shared<entity::DimRadial>(
+                     c(0), c(2), attachmentPoint(), d(4), d(5), lineSpacingStyle(), string(i(2)),
+                     c(6), d(8), layer, metaInfo, block
+                 );
+        break;
+
+    case IMAGE_TABLE:
+        entity = std::make_shared<entity::Image>(
+                     string(i(0)), c(0), c(2), c(4), d(6), d(7), d(8), d(9), d(10), layer, metaInfo, block
+                 );
+        break;
+
+    case HATCH_TABLE: {
+        auto firstLoop = i(3);
+        auto loopCount = i(4);
+        if(firstLoop > _loops.size() || loopCount > _loops.size() - firstLoop) {
+            throw invalidFile("wrong hatch loops");
+        }
+
+        auto segmentCount = i(6);
+        if(segmentCount > _doubleCount / 4) {
+            throw invalidFile("wrong hatch pattern");
+        }
+        auto segments = doubles(i(5), segmentCount * 4);
+
+        objects::Pattern pattern;
+        pattern.name = string(i(2));
+        pattern.boundingBox = geo::Area(c(2), c(4));
+        for(size_t segment = 0; segment < segments.size(); segment += 4) {
+            pattern.segments.emplace_back(geo::Coordinate(segments[segment], segments[segment + 1]),
+                                          geo::Coordinate(segments[segment + 2], segments[segment + 3]));
+        }
+
+        geo::Region region;
+        for(auto loop = firstLoop; loop < firstLoop + loopCount; loop++) {
+            std::vector<entity::CADEntity_CSPtr> loopEntities;
+            for(auto boundary : _loops[loop]) {
+                auto boundaryEntity = createEntity(_boundaryTables, boundary, 0);
+                if(boundaryEntity != nullptr) {
+                    loopEntities.push_back(boundaryEntity);
+                }
+            }
+            if(!loopEntities.empty()) {
+                region.addLoop(geo::Loop(loopEntities));
+            }
+        }
+
+        auto hatch = std::make_shared<entity::Hatch>(layer, metaInfo, block);
+        hatch->setSolid(i(0));
+        hatch->setPatternName(string(i(1)));
+        hatch->setPattern(pattern);
+        hatch->setRegion(region);
+        hatch->setAngle(d(0));
+        hatch->setScale(d(1));
+        entity = hatch;
+        break;
+    }
+
+    case INSERT_TABLE: {
+        auto displayBlockIndex = i(0);
+        if(displayBlockIndex >= _blocks.size()) {
+            throw invalidFile("wrong insert block");
+        }
+        if(_document == nullptr) {
+            return nullptr;
+        }
+
+        builder::InsertBuilder builder;
+        builder.setLayer(layer);
+        builder.setMetaInfo(metaInfo);
+        builder.setBlock(block);
+        builder.setDisplayBlock(_blocks[displayBlockIndex]);
+        builder.setCoordinate(c(0));
+        builder.setDocument(_document);
+        if(id != 0) {
+            builder.setID(id);
+        }
+
+        std::lock_guard<std::mutex> lock(_insertMutex);
+        return builder.build();
+    }
+
+    default:
+        return nullptr;
+    }
+
+    if(id != 0) {
+        entity->setID(id);
+    }
+
+    return entity;
+}
+
+std::vector<entity::CADEntity_CSPtr> NativeReader::entitiesInArea(const geo::Area& area) const {
+    std::vector<uint32_t> candidates(_largeEntities, _largeEntities + _spatialIndex->largeCount);
+
+    const auto& index = *_spatialIndex;
+    double cellWidth = std::max((index.bounds[2] - index.bounds[0]) / index.columns, 1e-12);
+    double cellHeight = std::max((index.bounds[3] - index.bounds[1]) / index.rows, 1e-12);
+
+    auto cell = [](double value, double origin, double size, uint32_t count) {
+        auto cellIndex = static_cast<long long>(std::floor((value - origin) / size));
+        return static_cast<uint32_t>(std::min(std::max(cellIndex, 0LL), static_cast<long long>(count - 1)));
+    };
+
+    if(_size > 0 && area.overlaps(bounds())) {
+        auto minX = cell(area.minP().x(), index.bounds[0], cellWidth, index.columns);
+        auto maxX = cell(area.maxP().x(), index.bounds[0], cellWidth, index.columns);
+        auto minY = cell(area.minP().y(), index.bounds[1], cellHeight, index.rows);
+        auto maxY = cell(area.maxP().y(), index.bounds[1], cellHeight, index.rows);
+
+        for(auto y = minY; y <= maxY; y++) {
+            for(auto x = minX; x <= maxX; x++) {
+                auto cellIndex = y * index.columns + x;
+                candidates.insert(candidates.end(), _cellEntities + _cellStart[cellIndex], _cellEntities + _cellStart[cellIndex + 1]);
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<entity::CADEntity_CSPtr> entities;
+    for(auto candidate : candidates) {
+        if(candidate >= _size) {
+            continue;
+        }
+
+        geo::Area entityBounds(
+            geo::Coordinate(_bounds[0][candidate], _bounds[1][candidate]),
+            geo::Coordinate(_bounds[2][candidate], _bounds[3][candidate])
+        );
+
+        if(entityBounds.overlaps(area)) {
+            auto created = entity(candidate);
+            if(created != nullptr) {
+                entities.push_back(created);
+            }
+        }
+    }
+
+    return entities;
+}
+
+void NativeReader::load(const storage::Document_SPtr& document, const operation::Builder_SPtr& builder) const {
+    for(const auto& linePattern : _linePatterns) {
+        builder->append(std::make_shared<operation::AddLinePattern>(document, linePattern));
+    }
+
+    for(const auto& layer : _layers) {
+        if(layer->name() == "0") {
+            builder->append(std::make_shared<operation::ReplaceLayer>(document, document->layerByName("0"), layer));
+        }
+        else {
+            builder->append(std::make_shared<operation::AddLayer>(document, layer));
+        }
+    }
+
+    for(const auto& block : _blocks) {
+        builder->append(std::make_shared<operation::AddBlock>(document, block));
+    }
+
+    std::vector<entity::CADEntity_CSPtr> entities(_size);
+    tools::ThreadPool::instance().parallelFor(_size, 1024, [this, &entities](size_t begin, size_t end) {
+        for(auto i = begin; i < end; i++) {
+            entities[i] = entity(i);
+        }
+    });
+
+    auto entityBuilder = std::make_shared<operation::EntityBuilder>(document);
+    for(const auto& entity : entities) {
+        if(entity != nullptr) {
+            entityBuilder->appendEntity(entity);
+        }
+    }
+    builder->append(entityBuilder);
+}
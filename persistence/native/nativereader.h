@@ -0,0 +1,176 @@
+#pragma once
+
+#include "mappedfile.h"
+#include "nativeformat.h"
+
+#include <cad/base/cadentity.h>
+#include <cad/base/metainfo.h>
+#include <cad/geometry/geoarea.h>
+#include <cad/meta/block.h>
+#include <cad/meta/dxflinepattern.h>
+#include <cad/meta/layer.h>
+#include <cad/operations/builder.h>
+#include <cad/storage/document.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lc {
+namespace persistence {
+/**
+ * @brief Read a file in the LibreCAD native binary format
+ * The file is mapped in memory. Opening it only reads the header, the strings, layers, line patterns,
+ * blocks, meta infos and hatch loops. Entities are created when they are first requested and kept by the reader,
+ * the same entity is returned on each call.
+ * The entities keep the ID they had when the file was written.
+ * Inserts refer to the document they are added to, they can only be created by a reader given this document.
+ * The const functions can be called from any thread.
+ */
+class NativeReader {
+public:
+    /**
+     * @param document document the entities will be added to, needed to create inserts
+     * @throw std::runtime_error if the file can't be read or isn't a valid native file
+     */
+    explicit NativeReader(const std::string& path, storage::Document_SPtr document = nullptr);
+
+    /**
+     * @brief Read a file from memory
+     * The data isn't copied and must outlive the reader.
+     * @throw std::runtime_error if the data isn't a valid native file
+     */
+    NativeReader(const char* data, size_t size, storage::Document_SPtr document = nullptr);
+
+    /**
+     * @return number of entities in the file
+     */
+    size_t size() const;
+
+    /**
+     * @return area containing all the entities
+     */
+    geo::Area bounds() const;
+
+    /**
+     * @brief Return an entity, created on first access
+     * @param index entity number, between 0 and size()
+     * @return nullptr for an insert if the reader has no document
+     */
+    entity::CADEntity_CSPtr entity(size_t index) const;
+
+    /**
+     * @brief Return the entities whose bounding box overlaps the area
+     * Uses the spatial index of the file, only the returned entities are created.
+     */
+    std::vector<entity::CADEntity_CSPtr> entitiesInArea(const geo::Area& area) const;
+
+    const std::vector<meta::Layer_CSPtr>& layers() const;
+
+    const std::vector<meta::DxfLinePatternByValue_CSPtr>& linePatterns() const;
+
+    const std::vector<meta::Block_CSPtr>& blocks() const;
+
+    /**
+     * @brief Add the content of the file to the builder
+     * Layer "0" replaces the layer of the document. All entities are created on the thread pool.
+     * The document must be the one given to the constructor.
+     */
+    void load(const storage::Document_SPtr& document, const operation::Builder_SPtr& builder) const;
+
+private:
+    struct EntityTableView {
+        size_t first;
+        size_t count;
+        std::vector<const uint32_t*> ints;
+        std::vector<const double*> doubles;
+    };
+
+    void open();
+
+    /**
+     * @return the entity tables starting at the given section type
+     */
+    std::vector<EntityTableView> readTables(uint32_t firstSection, size_t& size) const;
+
+    void readLoops();
+
+    /**
+     * @throw std::runtime_error if the section is missing
+     */
+    const native::SectionEntry* section(uint32_t type) const;
+
+    /**
+     * @return nullptr if the section is missing
+     */
+    const native::SectionEntry* findSection(uint32_t type) const;
+
+    template<typename T>
+    const T* sectionData(uint32_t type, size_t count) const;
+
+    std::string string(uint32_t index) const;
+
+    /**
+     * @brief Create an entity of a set of tables
+     * @param id ID of the entity, 0 for a new ID
+     */
+    entity::CADEntity_CSPtr createEntity(const std::vector<EntityTableView>& tables, size_t index, ID_DATATYPE id) const;
+
+    /**
+     * @brief Return points stored in DOUBLES as x y z
+     */
+    std::vector<geo::Coordinate> points(uint32_t first, uint32_t count) const;
+
+    std::vector<double> doubles(uint32_t first, uint32_t count) const;
+
+    void readMetaData();
+
+    std::unique_ptr<MappedFile> _file;
+    storage::Document_SPtr _document;
+    const char* _data;
+    size_t _dataSize;
+    const native::SectionEntry* _sections;
+    uint32_t _sectionCount;
+    uint32_t _version;
+
+    const uint32_t* _stringOffsets;
+    const char* _strings;
+    uint32_t _stringCount;
+
+    const double* _doubles;
+    size_t _doubleCount;
+
+    const double* _vertices[native::VERTEX_COLUMNS];
+    size_t _vertexCount;
+
+    const double* _bounds[native::BOUNDS_COLUMNS];
+    size_t _size;
+
+    // nullptr in files of version 1
+    const native::EntityID* _ids;
+
+    const native::SpatialIndexHeader* _spatialIndex;
+    const uint32_t* _cellStart;
+    const uint32_t* _cellEntities;
+    const uint32_t* _largeEntities;
+
+    std::vector<EntityTableView> _tables;
+
+    // Hatch loops, as entities of the boundary tables
+    std::vector<EntityTableView> _boundaryTables;
+    size_t _boundarySize;
+    std::vector<std::vector<uint32_t>> _loops;
+
+    std::vector<meta::DxfLinePatternByValue_CSPtr> _linePatterns;
+    std::vector<meta::Layer_CSPtr> _layers;
+    std::vector<meta::Block_CSPtr> _blocks;
+    std::vector<meta::MetaInfo_CSPtr> _metaInfos;
+
+    mutable std::mutex _entitiesMutex;
+    // Inserts connect to the document events, which aren't thread safe
+    mutable std::mutex _insertMutex;
+    mutable std::unordered_map<size_t, entity::CADEntity_CSPtr> _entities;
+};
+}
+}
@@ -0,0 +1,859 @@
+#include "nativewriter.h"
+#include "nativeformat.h"
+
+#include <cad/meta/metacolor.h>
+#include <cad/meta/metalinewidth.h>
+#include <cad/primitive/arc.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/dimaligned.h>
+#include <cad/primitive/dimangular.h>
+#include <cad/primitive/dimdiametric.h>
+#include <cad/primitive/dimlinear.h>
+#include <cad/primitive/dimradial.h>
+#include <cad/primitive/ellipse.h>
+#include <cad/primitive/hatch.h>
+#include <cad/primitive/image.h>
+#include <cad/primitive/insert.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/lwpolyline.h>
+#include <cad/primitive/point.h>
+#include <cad/primitive/spline.h>
+#include <cad/primitive/text.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+
+using namespace lc;
+using namespace lc::persistence;
+using namespace lc::persistence::native;
+
+namespace {
+/**
+ * @return table of the entity, ENTITY_TABLE_COUNT if its type isn't supported
+ * Custom entities are stored as inserts.
+ */
+EntityTable tableOf(const entity::CADEntity_CSPtr& entity) {
+    const auto& e = *entity;
+
+    if(typeid(e) == typeid(entity::Line)) {
+        return LINE_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Circle)) {
+        return CIRCLE_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Arc)) {
+        return ARC_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Ellipse)) {
+        return ELLIPSE_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Point)) {
+        return POINT_TABLE;
+    }
+    if(typeid(e) == typeid(entity::LWPolyline)) {
+        return LWPOLYLINE_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Text)) {
+        return TEXT_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Spline)) {
+        return SPLINE_TABLE;
+    }
+    if(typeid(e) == typeid(entity::DimAligned)) {
+        return DIM_ALIGNED_TABLE;
+    }
+    if(typeid(e) == typeid(entity::DimAngular)) {
+        return DIM_ANGULAR_TABLE;
+    }
+    if(typeid(e) == typeid(entity::DimDiametric)) {
+        return DIM_DIAMETRIC_TABLE;
+    }
+    if(typeid(e) == typeid(entity::DimLinear)) {
+        return DIM_LINEAR_TABLE;
+    }
+    if(typeid(e) == typeid(entity::DimRadial)) {
+        return DIM_RADIAL_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Image)) {
+        return IMAGE_TABLE;
+    }
+    if(typeid(e) == typeid(entity::Hatch)) {
+        return HATCH_TABLE;
+    }
+    if(dynamic_cast<const entity::Insert*>(&e) != nullptr) {
+        return INSERT_TABLE;
+    }
+
+    return ENTITY_TABLE_COUNT;
+}
+
+/**
+ * Append the raw bytes of a vector, padded to 8 bytes
+ */
+template<typename T>
+void appendColumn(std::string& buffer, const std::vector<T>& column) {
+    buffer.append(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    buffer.resize((buffer.size() + 7) & ~size_t(7), '\0');
+}
+
+struct EntityTableData {
+    std::vector<std::vector<uint32_t>> ints;
+    std::vector<std::vector<double>> doubles;
+    std::vector<geo::Area> bounds;
+    std::vector<EntityID> ids;
+
+    explicit EntityTableData(const TableSchema& schema) :
+        ints(schema.intColumns),
+        doubles(schema.doubleColumns) {
+    }
+
+    size_t size() const {
+        return bounds.size();
+    }
+};
+
+/**
+ * Collects the sections of the file before writing them
+ */
+class FileBuilder {
+public:
+    FileBuilder() {
+        for(uint32_t i = 0; i < ENTITY_TABLE_COUNT; i++) {
+            _tables.emplace_back(TABLE_SCHEMAS[i]);
+            _boundaryTables.emplace_back(TABLE_SCHEMAS[i]);
+        }
+        _vertices.resize(VERTEX_COLUMNS);
+    }
+
+    uint32_t string(const std::string& value) {
+        auto it = _stringIndex.find(value);
+        if(it != _stringIndex.end()) {
+            return it->second;
+        }
+
+        auto index = static_cast<uint32_t>(_strings.size());
+        _strings.push_back(value);
+        _stringIndex.emplace(value, index);
+        return index;
+    }
+
+    uint32_t linePattern(const meta::DxfLinePatternByValue_CSPtr& linePattern) {
+        if(linePattern == nullptr) {
+            return NONE;
+        }
+
+        auto it = _linePatternIndex.find(linePattern->name());
+        if(it != _linePatternIndex.end()) {
+            return it->second;
+        }
+
+        LinePatternRecord record;
+        record.name = string(linePattern->name());
+        record.description = string(linePattern->description());
+        record.firstDash = static_cast<uint32_t>(_doubles.size());
+        record.dashCount = static_cast<uint32_t>(linePattern->path().size());
+        record.length = linePattern->length();
+        _doubles.insert(_doubles.end(), linePattern->path().begin(), linePattern->path().end());
+
+        auto index = static_cast<uint32_t>(_linePatterns.size());
+        _linePatterns.push_back(record);
+        _linePatternIndex.emplace(linePattern->name(), index);
+        return index;
+    }
+
+    uint32_t layer(const meta::Layer_CSPtr& layer) {
+        if(layer == nullptr) {
+            return NONE;
+        }
+
+        auto it = _layerIndex.find(layer.get());
+        if(it != _layerIndex.end()) {
+            return it->second;
+        }
+
+        LayerRecord record = {};
+        record.name = string(layer->name());
+        record.linePattern = linePattern(layer->linePattern());
+        record.frozen = layer->isFrozen() ? 1 : 0;
+        record.width = layer->lineWidth().width();
+
+        auto color = layer->color();
+        record.color[0] = color.red();
+        record.color[1] = color.green();
+        record.color[2] = color.blue();
+        record.color[3] = color.alpha();
+
+        auto index = static_cast<uint32_t>(_layers.size());
+        _layers.push_back(record);
+        _layerIndex.emplace(layer.get(), index);
+        return index;
+    }
+
+    uint32_t block(const meta::Block_CSPtr& block) {
+        if(block == nullptr) {
+            return NONE;
+        }
+
+        auto it = _blockIndex.find(block.get());
+        if(it != _blockIndex.end()) {
+            return it->second;
+        }
+
+        BlockRecord record = {};
+        record.name = string(block->name());
+        record.base[0] = block->base().x();
+        record.base[1] = block->base().y();
+
+        auto index = static_cast<uint32_t>(_blocks.size());
+        _blocks.push_back(record);
+        _blockIndex.emplace(block.get(), index);
+        return index;
+    }
+
+    /**
+     * MetaInfo is interned by the entities, so identical meta infos are usually the same instance
+     */
+    uint32_t metaInfo(const meta::MetaInfo_CSPtr& metaInfo) {
+        if(metaInfo == nullptr || metaInfo->empty()) {
+            return NONE;
+        }
+
+        auto it = _metaInfoIndex.find(metaInfo.get());
+        if(it != _metaInfoIndex.end()) {
+            return it->second;
+        }
+
+        MetaInfoRecord record = {};
+        record.linePattern = NONE;
+
+        auto color = metaInfo->find(meta::MetaColor::LCMETANAME());
+        if(color != metaInfo->end()) {
+            if(auto byValue = std::dynamic_pointer_cast<const meta::MetaColorByValue>(color->second)) {
+                record.colorKind = META_BY_VALUE;
+                record.color[0] = byValue->red();
+                record.color[1] = byValue->green();
+                record.color[2] = byValue->blue();
+                record.color[3] = byValue->alpha();
+            }
+            else if(std::dynamic_pointer_cast<const meta::MetaColorByBlock>(color->second) != nullptr) {
+                record.colorKind = META_BY_BLOCK;
+            }
+        }
+
+        auto width = metaInfo->find(meta::MetaLineWidth::LCMETANAME());
+        if(width != metaInfo->end()) {
+            if(auto byValue = std::dynamic_pointer_cast<const meta::MetaLineWidthByValue>(width->second)) {
+                record.widthKind = META_BY_VALUE;
+                record.width = byValue->width();
+            }
+            else if(std::dynamic_pointer_cast<const meta::MetaLineWidthByBlock>(width->second) != nullptr) {
+                record.widthKind = META_BY_BLOCK;
+            }
+        }
+
+        auto pattern = metaInfo->find(meta::DxfLinePattern::LCMETANAME());
+        if(pattern != metaInfo->end()) {
+            if(auto byValue = std::dynamic_pointer_cast<const meta::DxfLinePatternByValue>(pattern->second)) {
+                record.linePatternKind = META_BY_VALUE;
+                record.linePattern = linePattern(byValue);
+            }
+            else if(std::dynamic_pointer_cast<const meta::DxfLinePatternByBlock>(pattern->second) != nullptr) {
+                record.linePatternKind = META_BY_BLOCK;
+            }
+        }
+
+        auto index = static_cast<uint32_t>(_metaInfos.size());
+        _metaInfos.push_back(record);
+        _metaInfoIndex.emplace(metaInfo.get(), index);
+        return index;
+    }
+
+    /**
+     * @return false if the entity type isn't supported
+     */
+    bool addEntity(const entity::CADEntity_CSPtr& entity) {
+        auto table = tableOf(entity);
+        if(table == ENTITY_TABLE_COUNT) {
+            return false;
+        }
+
+        append(_tables, table, entity);
+        return true;
+    }
+
+    std::string build() {
+        std::vector<std::pair<SectionEntry, std::string>> sections;
+
+        auto addSection = [&sections](SectionType type, size_t count, std::string&& data) {
+            SectionEntry entry = {};
+            entry.type = type;
+            entry.count = static_cast<uint32_t>(count);
+            sections.emplace_back(entry, std::move(data));
+        };
+
+        // Strings: offsets followed by the characters
+        {
+            std::vector<uint32_t> offsets;
+            std::string characters;
+            for(const auto& value : _strings) {
+                offsets.push_back(static_cast<uint32_t>(characters.size()));
+                characters += value;
+            }
+            offsets.push_back(static_cast<uint32_t>(characters.size()));
+
+            std::string data;
+            appendColumn(data, offsets);
+            data += characters;
+            addSection(STRINGS, _strings.size(), std::move(data));
+        }
+
+        std::string data;
+        appendColumn(data, _doubles);
+        addSection(DOUBLES, _doubles.size(), std::move(data));
+
+        data.clear();
+        appendColumn(data, _linePatterns);
+        addSection(LINE_PATTERNS, _linePatterns.size(), std::move(data));
+
+        data.clear();
+        appendColumn(data, _layers);
+        addSection(LAYERS, _layers.size(), std::move(data));
+
+        data.clear();
+        appendColumn(data, _blocks);
+        addSection(BLOCKS, _blocks.size(), std::move(data));
+
+        data.clear();
+        appendColumn(data, _metaInfos);
+        addSection(META_INFOS, _metaInfos.size(), std::move(data));
+
+        data.clear();
+        for(const auto& column : _vertices) {
+            appendColumn(data, column);
+        }
+        addSection(VERTICES, _vertices[0].size(), std::move(data));
+
+        std::vector<geo::Area> bounds;
+        std::vector<EntityID> ids;
+        std::vector<uint32_t> firstBoundary;
+        uint32_t boundaryCount = 0;
+        for(uint32_t table = 0; table < ENTITY_TABLE_COUNT; table++) {
+            auto& tableData = _tables[table];
+            addSection(static_cast<SectionType>(ENTITY_TABLES + table), tableData.size(), tableSection(tableData));
+
+            bounds.insert(bounds.end(), tableData.bounds.begin(), tableData.bounds.end());
+            ids.insert(ids.end(), tableData.ids.begin(), tableData.ids.end());
+
+            auto& boundaryData = _boundaryTables[table];
+            addSection(static_cast<SectionType>(BOUNDARY_TABLES + table), boundaryData.size(), tableSection(boundaryData));
+            firstBoundary.push_back(boundaryCount);
+            boundaryCount += static_cast<uint32_t>(boundaryData.size());
+        }
+
+        data.clear();
+        appendColumn(data, _loops);
+        addSection(HATCH_LOOPS, _loops.size(), std::move(data));
+
+        // Boundary entities are numbered across the boundary tables, like the entities
+        std::vector<uint32_t> loopEntities;
+        for(const auto& entity : _loopEntities) {
+            loopEntities.push_back(firstBoundary[entity.first] + entity.second);
+        }
+        data.clear();
+        appendColumn(data, loopEntities);
+        addSection(LOOP_ENTITIES, loopEntities.size(), std::move(data));
+
+        data.clear();
+        std::vector<std::vector<double>> boundsColumns(BOUNDS_COLUMNS);
+        for(const auto& area : bounds) {
+            boundsColumns[0].push_back(area.minP().x());
+            boundsColumns[1].push_back(area.minP().y());
+            boundsColumns[2].push_back(area.maxP().x());
+            boundsColumns[3].push_back(area.maxP().y());
+        }
+        for(const auto& column : boundsColumns) {
+            appendColumn(data, column);
+        }
+        addSection(BOUNDS, bounds.size(), std::move(data));
+
+        addSection(SPATIAL_INDEX, bounds.size(), spatialIndex(bounds));
+
+        data.clear();
+        appendColumn(data, ids);
+        addSection(ENTITY_IDS, ids.size(), std::move(data));
+
+        return assemble(sections);
+    }
+
+private:
+    /**
+     * Add a row to an entity table
+     * @return row of the entity in the table
+     */
+    uint32_t append(std::vector<EntityTableData>& tables, EntityTable table, const entity::CADEntity_CSPtr& entity) {
+        std::vector<uint32_t> ints;
+        std::vector<double> doubles;
+
+        switch(table) {
+        case LINE_TABLE: {
+            auto line = std::static_pointer_cast<const entity::Line>(entity);
+            doubles = {line->start().x(), line->start().y(), line->end().x(), line->end().y()};
+            break;
+        }
+
+        case CIRCLE_TABLE: {
+            auto circle = std::static_pointer_cast<const entity::Circle>(entity);
+            doubles = {circle->center().x(), circle->center().y(), circle->radius()};
+            break;
+        }
+
+        case ARC_TABLE: {
+            auto arc = std::static_pointer_cast<const entity::Arc>(entity);
+            ints = {arc->CCW() ? 1u : 0u};
+            doubles = {arc->center().x(), arc->center().y(), arc->radius(), arc->startAngle(), arc->endAngle()};
+            break;
+        }
+
+        case ELLIPSE_TABLE: {
+            auto ellipse = std::static_pointer_cast<const entity::Ellipse>(entity);
+            ints = {ellipse->isReversed() ? 1u : 0u};
+            doubles = {
+                ellipse->center().x(), ellipse->center().y(),
+                ellipse->majorP().x(), ellipse->majorP().y(),
+                ellipse->minorRadius(), ellipse->startAngle(), ellipse->endAngle()
+            };
+            break;
+        }
+
+        case POINT_TABLE: {
+            auto point = std::static_pointer_cast<const entity::Point>(entity);
+            doubles = {point->x(), point->y()};
+            break;
+        }
+
+        case LWPOLYLINE_TABLE: {
+            auto polyline = std::static_pointer_cast<const entity::LWPolyline>(entity);
+            ints = {
+                polyline->closed() ? 1u : 0u,
+                static_cast<uint32_t>(_vertices[0].size()),
+                static_cast<uint32_t>(polyline->vertex().size())
+            };
+            doubles = {
+                polyline->width(), polyline->elevation(), polyline->tickness(),
+                polyline->extrusionDirection().x(), polyline->extrusionDirection().y(), polyline->extrusionDirection().z()
+            };
+
+            for(const auto& vertex : polyline->vertex()) {
+                _vertices[0].push_back(vertex.location().x());
+                _vertices[1].push_back(vertex.location().y());
+                _vertices[2].push_back(vertex.bulge());
+                _vertices[3].push_back(vertex.startWidth());
+                _vertices[4].push_back(vertex.endWidth());
+            }
+            break;
+        }
+
+        case TEXT_TABLE: {
+            auto text = std::static_pointer_cast<const entity::Text>(entity);
+            uint32_t flags = (text->underlined() ? TEXT_UNDERLINED : 0) |
+                             (text->strikethrough() ? TEXT_STRIKETHROUGH : 0) |
+                             (text->bold() ? TEXT_BOLD : 0) |
+                             (text->italic() ? TEXT_ITALIC : 0);
+            ints = {
+                string(text->text_value()), string(text->style()),
+                static_cast<uint32_t>(text->textgeneration()),
+                static_cast<uint32_t>(text->halign()),
+                static_cast<uint32_t>(text->valign()),
+                flags
+            };
+            doubles = {text->insertion_point().x(), text->insertion_point().y(), text->height(), text->angle()};
+            break;
+        }
+
+        case SPLINE_TABLE: {
+            auto spline = std::static_pointer_cast<const entity::Spline>(entity);
+            ints = {static_cast<uint32_t>(spline->degree()), spline->closed() ? 1u : 0u, static_cast<uint32_t>(spline->flags())};
+            appendPoints(ints, spline->controlPoints());
+            ints.push_back(static_cast<uint32_t>(_doubles.size()));
+            ints.push_back(static_cast<uint32_t>(spline->knotPoints().size()));
+            _doubles.insert(_doubles.end(), spline->knotPoints().begin(), spline->knotPoints().end());
+            appendPoints(ints, spline->fitPoints());
+
+            doubles = {
+                spline->fitTolerance(),
+                spline->startTanX(), spline->startTanY(), spline->startTanZ(),
+                spline->endTanX(), spline->endTanY(), spline->endTanZ(),
+                spline->nX(), spline->nY(), spline->nZ()
+            };
+            break;
+        }
+
+        case DIM_ALIGNED_TABLE: {
+            auto dimension = std::static_pointer_cast<const entity::DimAligned>(entity);
+            appendDimension(*dimension, ints, doubles);
+            doubles.insert(doubles.end(), {
+                dimension->definitionPoint2().x(), dimension->definitionPoint2().y(),
+                dimension->definitionPoint3().x(), dimension->definitionPoint3().y()
+            });
+            break;
+        }
+
+        case DIM_ANGULAR_TABLE: {
+            auto dimension = std::static_pointer_cast<const entity::DimAngular>(entity);
+            appendDimension(*dimension, ints, doubles);
+            doubles.insert(doubles.end(), {
+                dimension->defLine11().x(), dimension->defLine11().y(),
+                dimension->defLine12().x(), dimension->defLine12().y(),
+                dimension->defLine21().x(), dimension->defLine21().y(),
+                dimension->defLine22().x(), dimension->defLine22().y()
+            });
+            break;
+        }
+
+        case DIM_DIAMETRIC_TABLE: {
+            auto dimension = std::static_pointer_cast<const entity::DimDiametric>(entity);
+            appendDimension(*dimension, ints, doubles);
+            doubles.insert(doubles.end(), {
+                dimension->definitionPoint2().x(), dimension->definitionPoint2().y(), dimension->leader()
+            });
+            break;
+        }
+
+        case DIM_LINEAR_TABLE: {
+            auto dimension = std::static_pointer_cast<const entity::DimLinear>(entity);
+            appendDimension(*dimension, ints, doubles);
+            doubles.insert(doubles.end(), {
+                dimension->definitionPoint2().x(), dimension->definitionPoint2().y(),
+                dimension->definitionPoint3().x(), dimension->definitionPoint3().y(),
+                dimension->angle(), dimension->oblique()
+            });
+            break;
+        }
+
+        case DIM_RADIAL_TABLE: {
+            auto dimension = std::static_pointer_cast<const entity::DimRadial>(entity);
+            appendDimension(*dimension, ints, doubles);
+            doubles.insert(doubles.end(), {
+                dimension->definitionPoint2().x(), dimension->definitionPoint2().y(), dimension->leader()
+            });
+            break;
+        }
+
+        case IMAGE_TABLE: {
+            auto image = std::static_pointer_cast<const entity::Image>(entity);
+            ints = {string(image->name())};
+            doubles = {
+                image->base().x(), image->base().y(),
+                image->uv().x(), image->uv().y(),
+                image->vv().x(), image->vv().y(),
+                image->width(), image->height(),
+                image->brightness(), image->contrast(), image->fade()
+            };
+            break;
+        }
+
+        case HATCH_TABLE: {
+            auto hatch = std::static_pointer_cast<const entity::Hatch>(entity);
+            const auto& pattern = hatch->getPattern();
+            const auto& loops = hatch->getRegion().loopList();
+
+            ints = {
+                hatch->isSolid() ? 1u : 0u,
+                string(hatch->getPatternName()),
+                string(pattern.name),
+                static_cast<uint32_t>(_loops.size()),
+                static_cast<uint32_t>(loops.size()),
+                static_cast<uint32_t>(_doubles.size()),
+                static_cast<uint32_t>(pattern.segments.size())
+            };
+
+            for(const auto& segment : pattern.segments) {
+                _doubles.insert(_doubles.end(), {segment.start().x(), segment.start().y(), segment.end().x(), segment.end().y()});
+            }
+
+            doubles = {
+                hatch->getAngle(), hatch->getScale(),
+                pattern.boundingBox.minP().x(), pattern.boundingBox.minP().y(),
+                pattern.boundingBox.maxP().x(), pattern.boundingBox.maxP().y()
+            };
+
+            for(const auto& loop : loops) {
+                LoopRecord record;
+                record.firstEntity = static_cast<uint32_t>(_loopEntities.size());
+                record.entityCount = 0;
+
+                for(const auto& boundary : loop.entities()) {
+                    auto boundaryTable = tableOf(boundary);
+                    if(boundaryTable == ENTITY_TABLE_COUNT || boundaryTable == HATCH_TABLE || boundaryTable == INSERT_TABLE) {
+                        continue;
+                    }
+
+                    auto row = append(_boundaryTables, boundaryTable, boundary);
+                    _loopEntities.emplace_back(boundaryTable, row);
+                    record.entityCount++;
+                }
+
+                _loops.push_back(record);
+            }
+            break;
+        }
+
+        case INSERT_TABLE: {
+            auto insert = std::static_pointer_cast<const entity::Insert>(entity);
+            ints = {block(insert->displayBlock())};
+            doubles = {insert->position().x(), insert->position().y()};
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        auto& data = tables[table];
+        data.ints[0].push_back(layer(entity->layer()));
+        data.ints[1].push_back(metaInfo(entity->metaInfo()));
+        data.ints[2].push_back(block(entity->block()));
+
+        for(size_t i = 0; i < ints.size(); i++) {
+            data.ints[COMMON_INT_COLUMNS + i].push_back(ints[i]);
+        }
+        for(size_t i = 0; i < doubles.size(); i++) {
+            data.doubles[i].push_back(doubles[i]);
+        }
+        data.bounds.push_back(entity->boundingBox());
+        data.ids.push_back(entity->id());
+
+        return static_cast<uint32_t>(data.size() - 1);
+    }
+
+    /**
+     * Add the first point and the number of points to ints, the points to DOUBLES
+     */
+    void appendPoints(std::vector<uint32_t>& ints, const std::vector<geo::Coordinate>& points) {
+        ints.push_back(static_cast<uint32_t>(_doubles.size()));
+        ints.push_back(static_cast<uint32_t>(points.size()));
+
+        for(const auto& point : points) {
+            _doubles.insert(_doubles.end(), {point.x(), point.y(), point.z()});
+        }
+    }
+
+    void appendDimension(const entity::Dimension& dimension, std::vector<uint32_t>& ints, std::vector<double>& doubles) {
+        ints = {
+            static_cast<uint32_t>(dimension.attachmentPoint()),
+            static_cast<uint32_t>(dimension.lineSpacingStyle()),
+            string(dimension.explicitValue())
+        };
+        doubles = {
+            dimension.definitionPoint().x(), dimension.definitionPoint().y(),
+            dimension.middleOfText().x(), dimension.middleOfText().y(),
+            dimension.textAngle(), dimension.lineSpacingFactor()
+        };
+    }
+
+    static std::string tableSection(const EntityTableData& table) {
+        std::string data;
+        for(const auto& column : table.ints) {
+            appendColumn(data, column);
+        }
+        for(const auto& column : table.doubles) {
+            appendColumn(data, column);
+        }
+        return data;
+    }
+
+    /**
+     * Uniform grid with about 8 entities per cell
+     */
+    static std::string spatialIndex(const std::vector<geo::Area>& bounds) {
+        SpatialIndexHeader header = {};
+
+        if(!bounds.empty()) {
+            auto all = bounds.front();
+            for(const auto& area : bounds) {
+                all = all.merge(area);
+            }
+
+            header.bounds[0] = all.minP().x();
+            header.bounds[1] = all.minP().y();
+            header.bounds[2] = all.maxP().x();
+            header.bounds[3] = all.maxP().y();
+        }
+
+        auto cellsPerSide = static_cast<uint32_t>(std::ceil(std::sqrt(bounds.size() / 8.)));
+        header.columns = std::min(std::max(cellsPerSide, 1u), 1024u);
+        header.rows = header.columns;
+
+        double cellWidth = std::max((header.bounds[2] - header.bounds[0]) / header.columns, 1e-12);
+        double cellHeight = std::max((header.bounds[3] - header.bounds[1]) / header.rows, 1e-12);
+
+        auto cell = [](double value, double origin, double size, uint32_t count) {
+            auto index = static_cast<long long>(std::floor((value - origin) / size));
+            return static_cast<uint32_t>(std::min(std::max(index, 0LL), static_cast<long long>(count - 1)));
+        };
+
+        std::vector<std::vector<uint32_t>> cells(header.columns * header.rows);
+        std::vector<uint32_t> large;
+
+        for(uint32_t i = 0; i < bounds.size(); i++) {
+            const auto& area = bounds[i];
+            auto minX = cell(area.minP().x(), header.bounds[0], cellWidth, header.columns);
+            auto maxX = cell(area.maxP().x(), header.bounds[0], cellWidth, header.columns);
+            auto minY = cell(area.minP().y(), header.bounds[1], cellHeight, header.rows);
+            auto maxY = cell(area.maxP().y(), header.bounds[1], cellHeight, header.rows);
+
+            if((maxX - minX + 1) * (maxY - minY + 1) > MAX_CELLS_PER_ENTITY) {
+                large.push_back(i);
+                continue;
+            }
+
+            for(auto y = minY; y <= maxY; y++) {
+                for(auto x = minX; x <= maxX; x++) {
+                    cells[y * header.columns + x].push_back(i);
+                }
+            }
+        }
+
+        header.largeCount = static_cast<uint32_t>(large.size());
+
+        std::vector<uint32_t> cellStart;
+        std::vector<uint32_t> entities;
+        for(const auto& content : cells) {
+            cellStart.push_back(static_cast<uint32_t>(entities.size()));
+            entities.insert(entities.end(), content.begin(), content.end());
+        }
+        cellStart.push_back(static_cast<uint32_t>(entities.size()));
+
+        std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+        appendColumn(data, cellStart);
+        appendColumn(data, entities);
+        appendColumn(data, large);
+        return data;
+    }
+
+    static std::string assemble(std::vector<std::pair<SectionEntry, std::string>>& sections) {
+        FileHeader header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.sectionCount = static_cast<uint32_t>(sections.size());
+
+        uint64_t offset = sizeof(FileHeader) + sections.size() * sizeof(SectionEntry);
+        for(auto& section : sections) {
+            offset = (offset + 7) & ~uint64_t(7);
+            section.first.offset = offset;
+            section.first.size = section.second.size();
+            offset += section.second.size();
+        }
+
+        std::string data;
+        data.reserve(offset);
+        data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        for(const auto& section : sections) {
+            data.append(reinterpret_cast<const char*>(&section.first), sizeof(SectionEntry));
+        }
+
+        for(const auto& section : sections) {
+            data.resize(section.first.offset, '\0');
+            data += section.second;
+        }
+
+        return data;
+    }
+
+    std::vector<std::string> _strings;
+    std::unordered_map<std::string, uint32_t> _stringIndex;
+
+    std::vector<double> _doubles;
+
+    std::vector<LinePatternRecord> _linePatterns;
+    std::unordered_map<std::string, uint32_t> _linePatternIndex;
+
+    std::vector<LayerRecord> _layers;
+    std::unordered_map<const meta::Layer*, uint32_t> _layerIndex;
+
+    std::vector<BlockRecord> _blocks;
+    std::unordered_map<const meta::Block*, uint32_t> _blockIndex;
+
+    std::vector<MetaInfoRecord> _metaInfos;
+    std::unordered_map<const meta::MetaInfo*, uint32_t> _metaInfoIndex;
+
+    std::vector<std::vector<double>> _vertices;
+    std::vector<EntityTableData> _tables;
+    std::vector<EntityTableData> _boundaryTables;
+
+    std::vector<LoopRecord> _loops;
+    std::vector<std::pair<EntityTable, uint32_t>> _loopEntities;
+};
+}
+
+NativeWriter::NativeWriter(const storage::Document_SPtr& document) :
+    NativeWriter(document->snapshot()) {
+}
+
+NativeWriter::NativeWriter(const storage::DocumentSnapshot_CSPtr& snapshot) {
+    _metaTypes = snapshot->allMetaTypes();
+
+    snapshot->each([this](const entity::CADEntity_CSPtr& entity) {
+        _entities.push_back(entity);
+    });
+}
+
+NativeWriter::NativeWriter(std::vector<meta::DocumentMetaType_CSPtr> metaTypes, std::vector<entity::CADEntity_CSPtr> entities) :
+    _metaTypes(std::move(metaTypes)),
+    _entities(std::move(entities)) {
+}
+
+unsigned int NativeWriter::write(const std::string& path) {
+    std::string data;
+    auto unsupported = encode(data);
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), data.size());
+
+    if(!stream) {
+        throw std::runtime_error("Unable to write " + path);
+    }
+
+    return unsupported;
+}
+
+unsigned int NativeWriter::encode(std::string& data) const {
+    FileBuilder builder;
+    unsigned int unsupported = 0;
+
+    // Layers, line patterns and blocks are written even when they are not used
+    for(const auto& metaType : _metaTypes) {
+        if(auto linePattern = std::dynamic_pointer_cast<const meta::DxfLinePatternByValue>(metaType)) {
+            builder.linePattern(linePattern);
+        }
+        else if(auto layer = std::dynamic_pointer_cast<const meta::Layer>(metaType)) {
+            builder.layer(layer);
+        }
+        else if(auto block = std::dynamic_pointer_cast<const meta::Block>(metaType)) {
+            builder.block(block);
+        }
+    }
+
+    for(const auto& entity : _entities) {
+        if(!builder.addEntity(entity)) {
+            unsupported++;
+        }
+    }
+
+    data = builder.build();
+
+    return unsupported;
+}
+
+unsigned int NativeWriter::unsupported() const {
+    return static_cast<unsigned int>(std::count_if(_entities.begin(), _entities.end(), [](const entity::CADEntity_CSPtr& entity) {
+        return tableOf(entity) == ENTITY_TABLE_COUNT;
+    }));
+}
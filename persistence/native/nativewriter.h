@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cad/storage/document.h>
+#include <cad/storage/documentsnapshot.h>
+#include <string>
+#include <vector>
+
+namespace lc {
+namespace persistence {
+/**
+ * @brief Write a document in the LibreCAD native binary format
+ * See nativeformat.h for the layout.
+ * All the entity types of the kernel are supported, custom entities are written as inserts.
+ * The entities keep their ID.
+ */
+class NativeWriter {
+public:
+    /**
+     * @brief Write the last snapshot of the document
+     * The writer doesn't lock the document, it can be used from any thread.
+     */
+    explicit NativeWriter(const storage::Document_SPtr& document);
+
+    explicit NativeWriter(const storage::DocumentSnapshot_CSPtr& snapshot);
+
+    /**
+     * @brief Write a set of entities and meta types
+     * Layers, line patterns and blocks used by the entities are written too.
+     */
+    NativeWriter(std::vector<meta::DocumentMetaType_CSPtr> metaTypes, std::vector<entity::CADEntity_CSPtr> entities);
+
+    /**
+     * @brief Write the file
+     * @return number of entities which were not written because their type isn't supported
+     * @throw std::runtime_error if the file can't be written
+     */
+    unsigned int write(const std::string& path);
+
+    /**
+     * @brief Encode the file in memory
+     * @return number of entities which were not written because their type isn't supported
+     */
+    unsigned int encode(std::string& data) const;
+
+    /**
+     * @return number of entities which would not be written because their type isn't supported
+     */
+    unsigned int unsupported() const;
+
+private:
+    std::vector<meta::DocumentMetaType_CSPtr> _metaTypes;
+    std::vector<entity::CADEntity_CSPtr> _entities;
+};
+}
+}
@@ -0,0 +1,149 @@
+#include "patternCache.h"
+#include <boost/filesystem.hpp>
+#include <cad/logger/logger.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+using namespace lc::persistence;
+
+namespace {
+const char CACHE_MAGIC[8] = {'L', 'C', 'P', 'A', 'T', 'T', 'R', 'N'};
+const uint32_t CACHE_VERSION = 1;
+const uint32_t CACHE_BYTE_ORDER_MARK = 0x01020304;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    double bounds[4];
+    uint64_t segmentCount;
+};
+
+/**
+ * 64 bits FNV-1a hash
+ */
+uint64_t hash(const std::string& data) {
+    uint64_t result = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        result ^= c;
+        result *= 1099511628211ull;
+    }
+    return result;
+}
+}
+
+PatternCache::PatternCache(std::string directory) :
+    _directory(std::move(directory)) {
+}
+
+std::string PatternCache::cachePath(const std::string& source) const {
+    std::ifstream stream(source, std::ios::binary);
+    if (!stream) {
+        return "";
+    }
+
+    std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.lcpat", static_cast<unsigned long long>(hash(content)));
+    return (boost::filesystem::path(_directory) / name).string();
+}
+
+bool PatternCache::load(const std::string& source, lc::objects::Pattern& pattern) const {
+    auto path = cachePath(source);
+    if (path.empty()) {
+        return false;
+    }
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return false;
+    }
+
+    CacheHeader header;
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        !std::equal(header.magic, header.magic + sizeof(header.magic), CACHE_MAGIC) ||
+        header.version != CACHE_VERSION ||
+        header.byteOrder != CACHE_BYTE_ORDER_MARK) {
+        return false;
+    }
+
+    // The segment count must match the rest of the file, checked without overflowing
+    auto dataStart = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    auto dataSize = static_cast<uint64_t>(stream.tellg() - dataStart);
+    const uint64_t segmentSize = 4 * sizeof(double);
+    if (header.segmentCount > dataSize / segmentSize || header.segmentCount * segmentSize != dataSize) {
+        return false;
+    }
+    stream.seekg(dataStart);
+
+    std::vector<double> values(header.segmentCount * 4);
+    if (!stream.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(double))) {
+        return false;
+    }
+
+    pattern.boundingBox = lc::geo::Area(lc::geo::Coordinate(header.bounds[0], header.bounds[1]),
+                                        lc::geo::Coordinate(header.bounds[2], header.bounds[3]));
+    pattern.segments.clear();
+    pattern.segments.reserve(header.segmentCount);
+    for (size_t i = 0; i < values.size(); i += 4) {
+        pattern.segments.emplace_back(lc::geo::Coordinate(values[i], values[i + 1]),
+                                      lc::geo::Coordinate(values[i + 2], values[i + 3]));
+    }
+
+    return true;
+}
+
+void PatternCache::save(const std::string& source, const lc::objects::Pattern& pattern) const {
+    auto path = cachePath(source);
+    if (path.empty()) {
+        return;
+    }
+
+    CacheHeader header = {};
+    std::copy(CACHE_MAGIC, CACHE_MAGIC + sizeof(CACHE_MAGIC), header.magic);
+    header.version = CACHE_VERSION;
+    header.byteOrder = CACHE_BYTE_ORDER_MARK;
+    header.bounds[0] = pattern.boundingBox.minP().x();
+    header.bounds[1] = pattern.boundingBox.minP().y();
+    header.bounds[2] = pattern.boundingBox.maxP().x();
+    header.bounds[3] = pattern.boundingBox.maxP().y();
+    header.segmentCount = pattern.segments.size();
+
+    std::vector<double> values;
+    values.reserve(pattern.segments.size() * 4);
+    for (const auto& segment : pattern.segments) {
+        values.push_back(segment.start().x());
+        values.push_back(segment.start().y());
+        values.push_back(segment.end().x());
+        values.push_back(segment.end().y());
+    }
+
+    // Written to a temporary file first, another instance may read the cache at the same time
+    auto temporaryPath = path + "." + boost::filesystem::unique_path().string() + ".tmp";
+    try {
+        boost::filesystem::create_directories(_directory);
+
+        {
+            std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+            if (!stream) {
+                throw std::runtime_error("Can't write " + temporaryPath);
+            }
+        }
+
+        boost::filesystem::rename(temporaryPath, path);
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING << "Pattern cache: " << e.what() << std::endl;
+        boost::system::error_code error;
+        boost::filesystem::remove(temporaryPath, error);
+    }
+}
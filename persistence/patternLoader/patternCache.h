@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cad/objects/pattern.h>
+#include <string>
+
+namespace lc {
+namespace persistence {
+/**
+ * @brief Compiled hatch patterns stored on disk
+ * A pattern is stored in a small binary file named after the hash of its source file,
+ * a modified source file is compiled again.
+ * The name of the pattern isn't stored.
+ */
+class PatternCache {
+public:
+    /**
+     * @param directory directory of the cache files, created when the first pattern is saved
+     */
+    explicit PatternCache(std::string directory);
+
+    /**
+     * @brief Read the compiled pattern of a source file
+     * @return false if the pattern isn't in the cache or if the cache file is invalid
+     */
+    bool load(const std::string& source, lc::objects::Pattern& pattern) const;
+
+    /**
+     * @brief Store the compiled pattern of a source file
+     * Errors are logged, the pattern will be compiled again next time.
+     */
+    void save(const std::string& source, const lc::objects::Pattern& pattern) const;
+
+private:
+    /**
+     * @return path of the cache file of a source file, empty if the source can't be read
+     */
+    std::string cachePath(const std::string& source) const;
+
+    std::string _directory;
+};
+}
+}
@@ -2,12 +2,27 @@
 #include <build_constants.h>
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
+#include <cad/geometry/georegion.h>
 #include <cad/logger/logger.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
 #include <algorithm>
 #include "../file.h"
 
 using namespace lc::persistence;
 
+namespace {
+std::string defaultCachePath() {
+    boost::system::error_code error;
+    auto temporaryPath = boost::filesystem::temp_directory_path(error);
+    if (error) {
+        return "";
+    }
+
+    return (temporaryPath / "librecad-patterns").string();
+}
+}
+
 PatternProvider* PatternProvider::Instance() {
     if (!instance) {
         instance = new PatternProvider;
@@ -16,11 +31,17 @@ PatternProvider* PatternProvider::Instance() {
     return instance;
 }
 
-PatternProvider::PatternProvider() {
+PatternProvider::PatternProvider() :
+    PatternProvider(PATTERN_RESOURCE_PATH, defaultCachePath()) {
+}
+
+PatternProvider::PatternProvider(const std::string& patternPath, const std::string& cachePath) :
+    _cache(cachePath),
+    _stop(false) {
     //load all patterns path
     std::string filename;
-    if(boost::filesystem::exists(PATTERN_RESOURCE_PATH))
-        for(auto& entry : boost::make_iterator_range(boost::filesystem::directory_iterator(PATTERN_RESOURCE_PATH), {})) {
+    if(boost::filesystem::exists(patternPath))
+        for(auto& entry : boost::make_iterator_range(boost::filesystem::directory_iterator(patternPath), {})) {
             boost::filesystem::path pathObj(entry);
             if(pathObj.has_stem())
             {
@@ -28,47 +49,82 @@ PatternProvider::PatternProvider() {
                 filename =  pathObj.stem().string();
                 std::transform(filename.begin(), filename.end(),filename.begin(), ::tolower);
                 LOG_INFO << "Pattern:" << filename << "-" << entry << std::endl;
-                _patternLocation[filename] = entry.path().string();
+                _patterns[filename].reset(new Entry());
+                _patterns[filename]->path = entry.path().string();
             }
         }
     //Create empty to load if nothing exists
-    Pattern x;
-    x.name = "NULL";
-    _patterns["NULL"] = x;
+    _nullPattern.name = "NULL";
+}
+
+PatternProvider::~PatternProvider() {
+    _stop = true;
+    if (_preload.valid()) {
+        _preload.wait();
+    }
 }
 
-#include <iostream>
-void PatternProvider::loadPattern(std::string filename) {
-    auto storageManager = std::make_shared<lc::storage::StorageManagerImpl>();
-    auto document = std::make_shared<lc::storage::DocumentImpl>(storageManager);
-    auto availableLibraries = File::getAvailableLibrariesForFormat("dxf");
-    lc::persistence::File::open(document, _patternLocation.at(filename), availableLibraries.begin()->first);
-    auto entityContainer = document->entitiesByBlock(nullptr);
-    Pattern x;
-    x.name = filename;
-    x.boundingBox = entityContainer.boundingBox();
-    x.entities = entityContainer.asVector();
-    _patterns[filename] = x;
-    LOG_INFO << "Pattern Loaded " << filename << std::endl;
+void PatternProvider::preload() {
+    if (_preload.valid()) {
+        return;
+    }
+
+    _preload = std::async(std::launch::async, [this]() {
+        for (auto& pattern : _patterns) {
+            if (_stop) {
+                return;
+            }
+
+            std::call_once(pattern.second->loaded, &PatternProvider::loadPattern, this, std::cref(pattern.first), std::ref(*pattern.second));
+        }
+    });
+}
+
+void PatternProvider::loadPattern(const std::string& name, Entry& entry) {
+    entry.pattern.name = name;
+
+    if (_cache.load(entry.path, entry.pattern)) {
+        LOG_INFO << "Pattern Loaded from cache " << name << std::endl;
+        return;
+    }
+
+    try {
+        auto storageManager = std::make_shared<lc::storage::StorageManagerImpl>();
+        auto document = std::make_shared<lc::storage::DocumentImpl>(storageManager);
+        auto availableLibraries = File::getAvailableLibrariesForFormat("dxf");
+        if (availableLibraries.empty()) {
+            throw std::runtime_error("no DXF library");
+        }
+        lc::persistence::File::open(document, entry.path, availableLibraries.begin()->first);
+        auto entityContainer = document->entitiesByBlock(nullptr);
+
+        entry.pattern.boundingBox = entityContainer.boundingBox();
+        for (const auto& entity : entityContainer.asVector()) {
+            lc::geo::tessellate(entity, entry.pattern.segments);
+        }
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING << "Can't load pattern " << name << ": " << e.what() << std::endl;
+        entry.pattern.segments.clear();
+        return;
+    }
+
+    _cache.save(entry.path, entry.pattern);
+    LOG_INFO << "Pattern Loaded " << name << std::endl;
 }
 
 const Pattern& PatternProvider::getPattern(std::string filename) {
     //Upper case it
     std::transform(filename.begin(), filename.end(),filename.begin(), ::tolower);
-    try {
-        auto pos = _patterns.find(filename);
-        if (pos == _patterns.end()) {
-            auto filePath = _patternLocation.at(filename);
-            // Load the pattern
-            loadPattern(filename);
-            return _patterns.at(filename);
-        } else {
-            return pos->second;
-        }
-    } catch(const std::out_of_range& e) {
-        //Unsupported pattern, return whatever is in cache
-        return _patterns.begin()->second;
+
+    auto pos = _patterns.find(filename);
+    if (pos == _patterns.end()) {
+        //Unsupported pattern
+        return _nullPattern;
     }
+
+    std::call_once(pos->second->loaded, &PatternProvider::loadPattern, this, std::cref(pos->first), std::ref(*pos->second));
+    return pos->second->pattern;
 };
 
 PatternProvider* PatternProvider::instance = nullptr;
@@ -1,28 +1,67 @@
 #pragma once
-#include <string>
+#include <atomic>
+#include <future>
 #include <map>
-#include <cad/base/cadentity.h>
-#include <cad/storage/documentimpl.h>
-#include <cad/storage/storagemanagerimpl.h>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <cad/objects/pattern.h>
+#include "patternCache.h"
 
 namespace lc {
 namespace persistence {
 typedef struct lc::objects::Pattern Pattern;
 
+/**
+ * @brief Hatch patterns library
+ * Patterns are DXF files in the pattern directory, named after the pattern.
+ * A pattern is read the first time it is used, or by preload(), and its compiled form is kept
+ * in a PatternCache so the DXF file is only parsed again when it changes.
+ */
 class PatternProvider {
 public:
     static PatternProvider* Instance();
+
+    /**
+     * @param patternPath directory of the pattern files
+     * @param cachePath directory of the compiled patterns
+     */
+    PatternProvider(const std::string& patternPath, const std::string& cachePath);
+
+    ~PatternProvider();
+
+    /**
+     * @brief Return a pattern by name
+     * The pattern is loaded by the calling thread if needed, if preload() is loading it the call waits.
+     * Unknown patterns return an empty pattern named NULL.
+     */
     const Pattern& getPattern(std::string);
 
+    /**
+     * @brief Load all the patterns in a background thread
+     */
+    void preload();
+
 private:
+    struct Entry {
+        std::string path;
+        std::once_flag loaded;
+        Pattern pattern;
+    };
+
     PatternProvider();
     PatternProvider(PatternProvider const&)=delete;
     PatternProvider& operator=(PatternProvider const&)=delete;
-    void loadPattern(std::string);
+    void loadPattern(const std::string& name, Entry& entry);
     static PatternProvider* instance;
-    std::map<std::string, std::string> _patternLocation;
-    std::map<std::string, Pattern> _patterns;
+
+    PatternCache _cache;
+    // Filled by the constructor, the entries are not added or removed afterwards
+    std::map<std::string, std::unique_ptr<Entry>> _patterns;
+    Pattern _nullPattern;
+
+    std::future<void> _preload;
+    std::atomic<bool> _stop;
 };
 
 }
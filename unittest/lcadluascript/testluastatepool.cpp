@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <luastatepool.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/line.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+
+using namespace lc;
+
+namespace {
+storage::Document_SPtr createDocument(unsigned int nbLines) {
+    auto document = std::make_shared<storage::DocumentImpl>(std::make_shared<storage::StorageManagerImpl>());
+
+    auto builder = std::make_shared<operation::EntityBuilder>(document);
+    for(unsigned int i = 0; i < nbLines; i++) {
+        builder->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., i), geo::Coordinate(10., i),
+                                                             document->layerByName("0")));
+    }
+    builder->execute();
+
+    return document;
+}
+}
+
+TEST(LuaStatePoolTest, CommitBatch) {
+    auto document = createDocument(3);
+    lua::LuaStatePool pool(2);
+
+    // Draw a line as long as the number of entities of the snapshot
+    auto future = pool.run(R"(
+        local builder = lc.builder.LineBuilder()
+        builder:setLayer(snapshot:layerByName("0"))
+        builder:setStartPoint(lc.geo.Coordinate(0, -1))
+        builder:setEndPoint(lc.geo.Coordinate(snapshot:size(), -1))
+        batch:append(builder:build())
+    )", document->snapshot());
+
+    // The snapshot isn't changed by later edits
+    auto builder = std::make_shared<operation::EntityBuilder>(document);
+    builder->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 5.), geo::Coordinate(1., 5.),
+                                                         document->layerByName("0")));
+    builder->execute();
+
+    auto batch = future.get();
+    ASSERT_EQ("", batch.error());
+    ASSERT_EQ(1, batch.size());
+
+    // The snapshot comes back with the batch, to be released on this thread
+    EXPECT_EQ(3, batch.snapshot()->size());
+
+    batch.entityBuilder(document)->execute();
+    EXPECT_EQ(5, document->entityContainer().asVector().size());
+
+    auto line = std::dynamic_pointer_cast<const entity::Line>(batch.entities()[0]);
+    ASSERT_NE(nullptr, line);
+    EXPECT_EQ(geo::Coordinate(3., -1.), line->end());
+    EXPECT_NE(nullptr, document->entityContainer().entityByID(line->id()));
+}
+
+TEST(LuaStatePoolTest, Sandbox) {
+    auto snapshot = createDocument(1)->snapshot();
+    lua::LuaStatePool pool(1);
+
+    EXPECT_NE("", pool.run("io.open('file', 'w')", snapshot).get().error());
+    EXPECT_NE("", pool.run("os.exit()", snapshot).get().error());
+    EXPECT_NE("", pool.run("dofile('file.lua')", snapshot).get().error());
+    EXPECT_NE("", pool.run("document:entityContainer()", snapshot).get().error());
+
+    // The profiler can be fed, not controlled or written to a file
+    EXPECT_NE("", pool.run("lc.profiler.writeChromeTrace('x')", snapshot).get().error());
+    EXPECT_NE("", pool.run("lc.profiler.setEnabled(false)", snapshot).get().error());
+    EXPECT_NE("", pool.run("lc.profiler.clear()", snapshot).get().error());
+    EXPECT_EQ("", pool.run("lc.profiler.count('count', 1)", snapshot).get().error());
+
+    // Text chunks can be loaded, bytecode can't, even when asked
+    EXPECT_EQ("", pool.run("assert(load('return 1')() == 1)", snapshot).get().error());
+    EXPECT_EQ("", pool.run("assert(load('return x', 'chunk', 't', {x = 2})() == 2)", snapshot).get().error());
+    EXPECT_EQ("", pool.run(R"(
+        local chunk, error = load(string.dump(function() return 1 end), 'bytecode', 'b')
+        assert(chunk == nil and error ~= nil)
+    )", snapshot).get().error());
+
+    std::string bytecode;
+    {
+        auto L = luaL_newstate();
+        luaL_openlibs(L);
+        luaL_dostring(L, "return string.dump(function() batch:append(nil) end)");
+        size_t size;
+        auto data = lua_tolstring(L, -1, &size);
+        bytecode.assign(data, size);
+        lua_close(L);
+    }
+    EXPECT_NE("", pool.run(bytecode, snapshot).get().error());
+}
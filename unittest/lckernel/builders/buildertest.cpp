@@ -9,6 +9,8 @@
 #include <cad/storage/documentimpl.h>
 #include <cad/storage/storagemanagerimpl.h>
 #include <cad/meta/dxflinepattern.h>
+#include <cad/builders/bulk.h>
+#include <cad/primitive/lwpolyline.h>
 
 TEST(BuilderTest, Line) {
     auto layer = std::make_shared<lc::meta::Layer>();
@@ -174,4 +176,56 @@ TEST(BuilderTest, DxfLinePatternByValue) {
     EXPECT_EQ(description, lp->description());
     EXPECT_EQ(initialPath, lp->path());
     EXPECT_EQ(11, lp->length());
-}
\ No newline at end of file
+}
+
+TEST(BuilderTest, Bulk) {
+    auto layer = std::make_shared<lc::meta::Layer>();
+    auto block = std::make_shared<lc::meta::Block>("Test Block", lc::geo::Coordinate());
+
+    lc::builder::BulkBuilder builder;
+    EXPECT_THROW(builder.appendLines({0, 0, 1, 1}), std::runtime_error);
+
+    builder.setLayer(layer);
+    builder.setBlock(block);
+    EXPECT_EQ(2, builder.appendLines({0, 0, 1, 1, 2, 2, 3, 3}));
+    EXPECT_EQ(1, builder.appendCircles({5, 5, 2}));
+    EXPECT_EQ(1, builder.appendArcs({0, 0, 1, 0, 1.5}, true));
+    EXPECT_EQ(2, builder.appendPolylines({0, 0, 1, 0, 1, 1, 5, 5, 6, 6}, {3, 2}, false));
+    EXPECT_THROW(builder.appendLines({0, 0, 1}), std::runtime_error);
+    EXPECT_THROW(builder.appendPolylines({0, 0, 1, 0}, {3}, false), std::runtime_error);
+
+    const auto& entities = builder.entities();
+    ASSERT_EQ(6, entities.size());
+    for(const auto& entity : entities) {
+        EXPECT_EQ(layer, entity->layer());
+        EXPECT_EQ(block, entity->block());
+    }
+
+    auto line = std::dynamic_pointer_cast<const lc::entity::Line>(entities[1]);
+    ASSERT_NE(nullptr, line);
+    EXPECT_EQ(lc::geo::Coordinate(2, 2), line->start());
+    EXPECT_EQ(lc::geo::Coordinate(3, 3), line->end());
+
+    auto circle = std::dynamic_pointer_cast<const lc::entity::Circle>(entities[2]);
+    ASSERT_NE(nullptr, circle);
+    EXPECT_EQ(2, circle->radius());
+
+    auto arc = std::dynamic_pointer_cast<const lc::entity::Arc>(entities[3]);
+    ASSERT_NE(nullptr, arc);
+    EXPECT_EQ(1.5, arc->endAngle());
+    EXPECT_TRUE(arc->CCW());
+
+    auto polyline = std::dynamic_pointer_cast<const lc::entity::LWPolyline>(entities[5]);
+    ASSERT_NE(nullptr, polyline);
+    ASSERT_EQ(2, polyline->vertex().size());
+    EXPECT_EQ(lc::geo::Coordinate(6, 6), polyline->vertex()[1].location());
+
+    builder.clear();
+    EXPECT_EQ(0, builder.size());
+
+    // Space is reserved for one entity per polyline, not per vertex
+    lc::builder::BulkBuilder polylines;
+    polylines.setLayer(layer);
+    EXPECT_EQ(1, polylines.appendPolylines(std::vector<double>(2000, 0.), {1000}, true));
+    EXPECT_LT(polylines.entities().capacity(), 1000);
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <cad/geometry/georegion.h>
+#include <random>
+#include <thread>
 
 using namespace lc;
 using namespace geo;
@@ -22,3 +24,217 @@ TEST(lc__geo__RegionTest, creation) {
     ASSERT_FALSE(reg.isPointInside(lc::geo::Coordinate(95, 95)));
     ASSERT_FALSE(reg.isPointInside(lc::geo::Coordinate(1000, 1000)));
 }
+
+namespace {
+Loop square(double x, double y, double size) {
+    std::vector<lc::entity::CADEntity_CSPtr> loopData;
+    std::vector<geo::Coordinate> corners {
+        geo::Coordinate(x, y), geo::Coordinate(x + size, y), geo::Coordinate(x + size, y + size), geo::Coordinate(x, y + size)
+    };
+
+    for (size_t i = 0; i < corners.size(); i++) {
+        loopData.push_back(std::make_shared<lc::entity::Line>(corners[i], corners[(i + 1) % corners.size()], nullptr));
+    }
+
+    return Loop(loopData);
+}
+}
+
+TEST(lc__geo__RegionTest, hole) {
+    Region reg;
+    reg.addLoop(square(0, 0, 100));
+    reg.addLoop(square(25, 25, 50));
+
+    EXPECT_TRUE(reg.isPointInside(lc::geo::Coordinate(10, 10)));
+    EXPECT_FALSE(reg.isPointInside(lc::geo::Coordinate(50, 50)));
+    EXPECT_FALSE(reg.isPointInside(lc::geo::Coordinate(150, 50)));
+    EXPECT_NEAR(100 * 100 - 50 * 50, reg.Area(), 1e-6);
+    EXPECT_EQ(4 * 4, reg.trapezoids().size());
+}
+
+TEST(lc__geo__RegionTest, clip) {
+    Region reg;
+    reg.addLoop(square(0, 0, 100));
+    reg.addLoop(square(25, 25, 50));
+
+    auto parts = reg.clip(lc::geo::Vector(lc::geo::Coordinate(-10, 50), lc::geo::Coordinate(110, 50)));
+    ASSERT_EQ(2, parts.size());
+    EXPECT_NEAR(0, parts[0].start().x(), 1e-9);
+    EXPECT_NEAR(25, parts[0].end().x(), 1e-9);
+    EXPECT_NEAR(75, parts[1].start().x(), 1e-9);
+    EXPECT_NEAR(100, parts[1].end().x(), 1e-9);
+
+    EXPECT_EQ(0, reg.clip(lc::geo::Vector(lc::geo::Coordinate(30, 30), lc::geo::Coordinate(70, 70))).size());
+    EXPECT_EQ(1, reg.clip(lc::geo::Vector(lc::geo::Coordinate(5, 5), lc::geo::Coordinate(20, 5))).size());
+}
+
+TEST(lc__geo__RegionTest, circleArea) {
+    std::vector<lc::entity::CADEntity_CSPtr> loopData;
+    loopData.push_back(std::make_shared<lc::entity::Circle>(geo::Coordinate(0, 0), 10, nullptr));
+    Region reg(loopData);
+
+    EXPECT_NEAR(M_PI * 100, reg.Area(), M_PI * 100 * 1e-2);
+    EXPECT_TRUE(reg.isPointInside(geo::Coordinate(9, 0)));
+    EXPECT_FALSE(reg.isPointInside(geo::Coordinate(9, 9)));
+}
+
+TEST(lc__geo__RegionTest, edgeIndex) {
+    Region reg;
+    std::vector<lc::entity::CADEntity_CSPtr> circle;
+    circle.push_back(std::make_shared<lc::entity::Circle>(geo::Coordinate(0, 0), 100, nullptr));
+    reg.addLoop(Loop(circle));
+    reg.addLoop(square(-20, -20, 40));
+    reg.addLoop(square(-200, 150, 30));
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> coordinate(-250, 250);
+
+    // Compare with the crossings of all edges
+    auto edges = reg.edges();
+    for (int i = 0; i < 10000; i++) {
+        geo::Coordinate point(coordinate(random), coordinate(random));
+        bool inside = false;
+
+        for (const auto& edge : *edges) {
+            const auto& p1 = edge.start();
+            const auto& p2 = edge.end();
+            if ((p1.y() > point.y()) != (p2.y() > point.y()) &&
+                p1.x() + (point.y() - p1.y()) * (p2.x() - p1.x()) / (p2.y() - p1.y()) > point.x()) {
+                inside = !inside;
+            }
+        }
+
+        ASSERT_EQ(inside, reg.isPointInside(point)) << point;
+    }
+}
+
+TEST(lc__geo__RegionTest, addLoopAfterQuery) {
+    Region reg;
+    reg.addLoop(square(0, 0, 100));
+    ASSERT_TRUE(reg.isPointInside(geo::Coordinate(50, 50)));
+
+    // The copy shares the index, adding a loop to the original doesn't change it
+    Region copy = reg;
+    reg.addLoop(square(25, 25, 50));
+    EXPECT_FALSE(reg.isPointInside(geo::Coordinate(50, 50)));
+    EXPECT_EQ(8, reg.edges()->size());
+    EXPECT_TRUE(copy.isPointInside(geo::Coordinate(50, 50)));
+    EXPECT_EQ(4, copy.edges()->size());
+}
+
+TEST(lc__geo__RegionTest, manyLoops) {
+    Region reg;
+    for (int i = 0; i < 5000; i++) {
+        reg.addLoop(square(i * 20, 0, 10));
+    }
+
+    EXPECT_EQ(20000, reg.edges()->size());
+    EXPECT_TRUE(reg.isPointInside(geo::Coordinate(4999 * 20 + 5, 5)));
+    EXPECT_FALSE(reg.isPointInside(geo::Coordinate(4999 * 20 - 5, 5)));
+}
+
+TEST(lc__geo__RegionTest, concurrentFirstQuery) {
+    Region reg;
+    for (int i = 0; i < 100; i++) {
+        reg.addLoop(square(i * 20, 0, 10));
+    }
+
+    // All threads build the index together, they must share the one which was stored
+    std::vector<std::shared_ptr<const std::vector<Vector>>> edges(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < edges.size(); i++) {
+        threads.emplace_back([&reg, &edges, i]() {
+            edges[i] = reg.edges();
+            reg.clip(Vector(Coordinate(-10, 5), Coordinate(2010, 5)));
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& e : edges) {
+        EXPECT_EQ(edges.front(), e);
+        EXPECT_EQ(400, e->size());
+    }
+    EXPECT_EQ(edges.front(), reg.edges());
+}
+
+TEST(lc__geo__RegionTest, booleans) {
+    Region a;
+    a.addLoop(square(0, 0, 100));
+    Region b;
+    b.addLoop(square(50, 50, 100));
+
+    auto united = a.unite(b);
+    EXPECT_EQ(1, united.numLoops());
+    EXPECT_NEAR(100 * 100 * 2 - 50 * 50, united.Area(), 1e-6);
+    EXPECT_TRUE(united.isPointInside(geo::Coordinate(125, 125)));
+    EXPECT_FALSE(united.isPointInside(geo::Coordinate(125, 25)));
+
+    auto intersection = a.intersect(b);
+    EXPECT_EQ(1, intersection.numLoops());
+    EXPECT_EQ(4, intersection.loopList()[0].entities().size());
+    EXPECT_NEAR(50 * 50, intersection.Area(), 1e-6);
+
+    auto difference = a.subtract(b);
+    EXPECT_EQ(1, difference.numLoops());
+    EXPECT_NEAR(100 * 100 - 50 * 50, difference.Area(), 1e-6);
+    EXPECT_FALSE(difference.isPointInside(geo::Coordinate(75, 75)));
+
+    Region far;
+    far.addLoop(square(500, 500, 10));
+    EXPECT_EQ(0, a.intersect(far).numLoops());
+    EXPECT_EQ(2, a.unite(far).numLoops());
+    EXPECT_EQ(0, a.subtract(a).numLoops());
+}
+
+TEST(lc__geo__RegionTest, booleansSharedEdges) {
+    Region a;
+    a.addLoop(square(0, 0, 100));
+    Region b;
+    b.addLoop(square(100, 0, 100));
+    Region inner;
+    inner.addLoop(square(0, 0, 50));
+
+    auto united = a.unite(b);
+    EXPECT_EQ(1, united.numLoops());
+    EXPECT_NEAR(2 * 100 * 100, united.Area(), 1e-6);
+    EXPECT_TRUE(united.isPointInside(geo::Coordinate(100, 50)));
+
+    EXPECT_EQ(0, a.intersect(b).numLoops());
+    EXPECT_NEAR(50 * 50, a.intersect(inner).Area(), 1e-6);
+
+    // Subtracting a square touching the border leaves an L shape, not a hole
+    auto difference = a.subtract(inner);
+    EXPECT_EQ(1, difference.numLoops());
+    EXPECT_NEAR(100 * 100 - 50 * 50, difference.Area(), 1e-6);
+
+    // Subtracting an inner square leaves a hole
+    Region hole;
+    hole.addLoop(square(25, 25, 50));
+    auto ring = a.subtract(hole);
+    EXPECT_EQ(2, ring.numLoops());
+    EXPECT_NEAR(100 * 100 - 50 * 50, ring.Area(), 1e-6);
+    EXPECT_FALSE(ring.isPointInside(geo::Coordinate(50, 50)));
+}
+
+TEST(lc__geo__RegionTest, booleansCurves) {
+    std::vector<lc::entity::CADEntity_CSPtr> circle1;
+    circle1.push_back(std::make_shared<lc::entity::Circle>(geo::Coordinate(0, 0), 10, nullptr));
+    std::vector<lc::entity::CADEntity_CSPtr> circle2;
+    circle2.push_back(std::make_shared<lc::entity::Circle>(geo::Coordinate(10, 0), 10, nullptr));
+    Region a(circle1);
+    Region b(circle2);
+
+    // Two circles through each other's centre overlap on (2pi/3 - sin(2pi/3)) r^2
+    auto lens = (2. * M_PI / 3. - std::sin(2. * M_PI / 3.)) * 100.;
+    auto intersection = a.intersect(b);
+    auto united = a.unite(b);
+
+    EXPECT_EQ(1, intersection.numLoops());
+    EXPECT_NEAR(lens, intersection.Area(), lens * 1e-2);
+    EXPECT_EQ(1, united.numLoops());
+    EXPECT_NEAR(a.Area() + b.Area() - intersection.Area(), united.Area(), 1e-6);
+    EXPECT_NEAR(a.Area() - intersection.Area(), a.subtract(b).Area(), 1e-6);
+}
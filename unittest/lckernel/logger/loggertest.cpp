@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <cad/logger/logger.h>
+
+#include <fstream>
+#include <string>
+
+namespace {
+int evaluations = 0;
+
+int evaluate() {
+    return ++evaluations;
+}
+}
+
+TEST(LoggerTest, LevelCheckedBeforeFormatting) {
+    auto level = lc::log::Logger::level();
+    lc::log::Logger::setLevel(lc::log::LOG_SEVERITY_ERROR);
+    evaluations = 0;
+
+    LOG_TRACE << "trace " << evaluate();
+    LOG_DEBUG << "debug " << evaluate();
+    LOG_WARNING << "warning " << evaluate();
+    EXPECT_EQ(0, evaluations);
+
+    if (evaluations == 0)
+        LOG_INFO << evaluate();
+    else
+        evaluate();
+    EXPECT_EQ(0, evaluations);
+
+    lc::log::Logger::setLevel(lc::log::LOG_SEVERITY_TRACE);
+    LOG_ERROR << "error " << evaluate();
+    EXPECT_EQ(1, evaluations);
+
+#if LC_LOG_MIN_LEVEL > 0
+    LOG_TRACE << "not compiled " << evaluate();
+    EXPECT_EQ(1, evaluations);
+#endif
+
+    lc::log::Logger::setLevel(level);
+}
+
+TEST(LoggerTest, RecordsNotDropped) {
+    LOGGER->flush();
+
+    // More records than the sink queue can hold, info records are not written to the console
+    const int count = 20000;
+    for (int i = 0; i < count; i++) {
+        LOG_INFO << "LoggerTest.RecordsNotDropped " << i;
+    }
+    LOGGER->flush();
+
+    std::ifstream log("sample.log");
+    ASSERT_TRUE(log.is_open());
+
+    int found = 0;
+    std::string line;
+    while (std::getline(log, line)) {
+        if (line.find("LoggerTest.RecordsNotDropped") != std::string::npos) {
+            found++;
+        }
+    }
+    EXPECT_EQ(count, found);
+}
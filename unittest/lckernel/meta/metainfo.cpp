@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <cad/base/metainfo.h>
+#include <cad/meta/dxflinepattern.h>
+#include <cad/meta/metacolor.h>
+#include <cad/meta/metalinewidth.h>
+#include <cad/primitive/line.h>
+
+using namespace lc;
+
+namespace {
+meta::MetaInfo_SPtr createMetaInfo(double r, double width) {
+    auto metaInfo = meta::MetaInfo::create();
+    metaInfo->add(std::make_shared<meta::MetaColorByValue>(r, 0., 0.));
+    metaInfo->add(std::make_shared<meta::MetaLineWidthByValue>(width));
+    return metaInfo;
+}
+}
+
+TEST(MetaInfoTest, Intern) {
+    auto first = meta::MetaInfo::intern(createMetaInfo(1., 0.5));
+    auto second = meta::MetaInfo::intern(createMetaInfo(1., 0.5));
+    auto other = meta::MetaInfo::intern(createMetaInfo(0.5, 0.5));
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(first, meta::MetaInfo::intern(first));
+    EXPECT_EQ(nullptr, meta::MetaInfo::intern(nullptr));
+
+    auto empty = meta::MetaInfo::create();
+    EXPECT_EQ(empty, meta::MetaInfo::intern(empty));
+
+    // The pool keeps its own copy, changing the original doesn't change the interned instance
+    auto original = createMetaInfo(0.25, 1.);
+    auto interned = meta::MetaInfo::intern(original);
+    original->add(std::make_shared<meta::DxfLinePatternByBlock>());
+    EXPECT_EQ(2, interned->size());
+    EXPECT_NE(interned, meta::MetaInfo::intern(original));
+}
+
+TEST(MetaInfoTest, InternExactValues) {
+    // Equal with 6 decimals
+    EXPECT_NE(meta::MetaInfo::intern(createMetaInfo(0.1, 0.5)), meta::MetaInfo::intern(createMetaInfo(0.1000001, 0.5)));
+    EXPECT_NE(meta::MetaInfo::intern(createMetaInfo(1., 0.25)), meta::MetaInfo::intern(createMetaInfo(1., 0.2500001)));
+}
+
+TEST(MetaInfoTest, InternSameNamedLinePatterns) {
+    auto dashed = std::make_shared<meta::DxfLinePatternByValue>("DASHED", "- -", std::vector<double>{1., -0.5}, 1.5);
+    auto longDashed = std::make_shared<meta::DxfLinePatternByValue>("DASHED", "-- --", std::vector<double>{2., -0.5}, 2.5);
+
+    auto first = meta::MetaInfo::create();
+    first->add(dashed);
+    auto second = meta::MetaInfo::create();
+    second->add(longDashed);
+
+    auto firstInterned = meta::MetaInfo::intern(first);
+    auto secondInterned = meta::MetaInfo::intern(second);
+    ASSERT_NE(firstInterned, secondInterned);
+
+    auto linePattern = [](const meta::MetaInfo_CSPtr& metaInfo) {
+        return std::dynamic_pointer_cast<const meta::DxfLinePatternByValue>(metaInfo->find(meta::DxfLinePattern::LCMETANAME())->second);
+    };
+    EXPECT_EQ(dashed, linePattern(firstInterned));
+    EXPECT_EQ(longDashed, linePattern(secondInterned));
+
+    auto same = meta::MetaInfo::create();
+    same->add(dashed);
+    EXPECT_EQ(firstInterned, meta::MetaInfo::intern(same));
+}
+
+TEST(MetaInfoTest, EntitiesShareMetaInfo) {
+    auto layer = std::make_shared<const meta::Layer>();
+    std::vector<entity::Line_CSPtr> lines;
+
+    for (int i = 0; i < 100; i++) {
+        lines.push_back(std::make_shared<entity::Line>(geo::Coordinate(i, 0), geo::Coordinate(i, 1), layer, createMetaInfo(1., 0.5)));
+    }
+
+    for (const auto& line : lines) {
+        EXPECT_EQ(lines.front()->metaInfo(), line->metaInfo());
+    }
+}
+
+TEST(MetaInfoTest, Slot) {
+    auto colorSlot = meta::MetaInfo::slot(meta::MetaColor::LCMETANAME());
+    auto lineWidthSlot = meta::MetaInfo::slot(meta::MetaLineWidth::LCMETANAME());
+    auto linePatternSlot = meta::MetaInfo::slot(meta::DxfLinePattern::LCMETANAME());
+
+    EXPECT_EQ(colorSlot, meta::MetaInfo::slot(meta::MetaColor::LCMETANAME()));
+    EXPECT_NE(colorSlot, lineWidthSlot);
+
+    auto line = std::make_shared<entity::Line>(geo::Coordinate(0, 0), geo::Coordinate(1, 1), std::make_shared<const meta::Layer>(), createMetaInfo(1., 0.5));
+
+    auto color = line->metaInfoBySlot<meta::MetaColorByValue>(colorSlot);
+    ASSERT_NE(nullptr, color);
+    EXPECT_EQ(1., color->red());
+    EXPECT_EQ(line->metaInfo<meta::MetaColorByValue>(meta::MetaColor::LCMETANAME()), color);
+
+    auto width = line->metaInfoBySlot<meta::MetaLineWidthByValue>(lineWidthSlot);
+    ASSERT_NE(nullptr, width);
+    EXPECT_EQ(0.5, width->width());
+
+    EXPECT_EQ(nullptr, line->metaInfoBySlot<meta::DxfLinePattern>(linePatternSlot));
+    EXPECT_EQ(nullptr, line->metaInfoBySlot<meta::MetaColorByBlock>(colorSlot));
+}
@@ -325,4 +325,49 @@ TEST(EntityBuilderTest, SelectByLayer) {
 
     EXPECT_TRUE((firstEntity_isExpected1 && secondEntity_isExpected2) ||
                 (firstEntity_isExpected2 && secondEntity_isExpected1));
-}
\ No newline at end of file
+}
+TEST(EntityBuilderTest, MoveLargeSet) {
+    auto storageManager = std::make_shared<lc::storage::StorageManagerImpl>();
+    auto document = std::make_shared<lc::storage::DocumentImpl>(storageManager);
+    auto layer = std::make_shared<const lc::meta::Layer>();
+    auto offset = lc::geo::Coordinate(10, 20);
+    const unsigned int nbEntities = 10000;
+
+    std::vector<lc::entity::Line_CSPtr> lines;
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    for (unsigned int i = 0; i < nbEntities; i++) {
+        auto line = std::make_shared<lc::entity::Line>(
+                        lc::geo::Coordinate(i, 0),
+                        lc::geo::Coordinate(i, 100),
+                        layer,
+                        nullptr
+                    );
+        lines.push_back(line);
+        builder->appendEntity(line);
+    }
+    builder->execute();
+
+    builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    for (const auto& line : lines) {
+        builder->appendEntity(line);
+    }
+    builder->appendOperation(std::make_shared<lc::operation::Push>());
+    builder->appendOperation(std::make_shared<lc::operation::Move>(offset));
+    builder->execute();
+
+    EXPECT_EQ(nbEntities, document->entityContainer().asVector().size());
+
+    for (const auto& line : lines) {
+        auto moved = std::dynamic_pointer_cast<const lc::entity::Line>(document->entityByID(line->id()));
+        ASSERT_NE(nullptr, moved) << "Moved entity not found";
+        EXPECT_EQ(line->start() + offset, moved->start());
+        EXPECT_EQ(line->end() + offset, moved->end());
+    }
+
+    builder->undo();
+
+    EXPECT_EQ(nbEntities, document->entityContainer().asVector().size());
+    for (const auto& line : lines) {
+        EXPECT_EQ(line, document->entityByID(line->id())) << "EntityBuilder didn't undo move";
+    }
+}
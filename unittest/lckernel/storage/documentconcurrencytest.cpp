@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/entityops.h>
+#include <cad/primitive/line.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(DocumentConcurrencyTest, ReadWhileWriting) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto layer = document->layerByName("0");
+    std::atomic<bool> done(false);
+    std::atomic<unsigned int> errors(0);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&, i]() {
+            ID_DATATYPE id = i;
+
+            while (!done) {
+                document->entityByID(id++ % 1000);
+                document->entitiesByLayer(layer).asVector();
+
+                if (document->layerByName("0") == nullptr) {
+                    errors++;
+                }
+
+                // A snapshot must stay consistent while the document changes
+                auto snapshot = document->snapshot();
+                auto entities = snapshot->asVector();
+                if (entities.size() != snapshot->size()) {
+                    errors++;
+                }
+
+                for (const auto& entity : entities) {
+                    if (snapshot->entityByID(entity->id()) != entity) {
+                        errors++;
+                    }
+                }
+
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<lc::entity::CADEntity_CSPtr> lines;
+    for (int i = 0; i < 50; i++) {
+        auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+        for (int j = 0; j < 20; j++) {
+            auto line = std::make_shared<lc::entity::Line>(
+                            lc::geo::Coordinate(i, j),
+                            lc::geo::Coordinate(i + 1, j + 1),
+                            layer,
+                            nullptr
+                        );
+            builder->appendEntity(line);
+            lines.push_back(line);
+        }
+        builder->execute();
+
+        if (i % 2 == 1) {
+            auto remove = std::make_shared<lc::operation::EntityBuilder>(document);
+            for (int j = 0; j < 10; j++) {
+                remove->appendEntity(lines.back());
+                lines.pop_back();
+            }
+            remove->appendOperation(std::make_shared<lc::operation::Push>());
+            remove->appendOperation(std::make_shared<lc::operation::Remove>());
+            remove->execute();
+        }
+    }
+
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(0, errors);
+    EXPECT_EQ(lines.size(), document->snapshot()->size());
+    EXPECT_EQ(lines.size(), document->entityContainer().asVector().size());
+}
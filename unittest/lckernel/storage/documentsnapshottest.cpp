@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/storage/undomanagerimpl.h>
+#include <cad/storage/persistentmap.h>
+#include <cad/storage/entityquery.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/line.h>
+#include <map>
+#include <random>
+
+namespace {
+lc::entity::Line_CSPtr createLine(double x, double y) {
+    return std::make_shared<lc::entity::Line>(
+               lc::geo::Coordinate(x, y),
+               lc::geo::Coordinate(x + 1, y + 1),
+               std::make_shared<const lc::meta::Layer>(),
+               nullptr
+           );
+}
+}
+
+TEST(PersistentMapTest, InsertErase) {
+    lc::storage::PersistentMap<unsigned long, int> map;
+    std::map<unsigned long, int> reference;
+    std::mt19937 random(42);
+
+    for (int i = 0; i < 20000; i++) {
+        unsigned long key = random() % 5000;
+
+        if (random() % 3 == 0) {
+            EXPECT_EQ(reference.erase(key) == 1, map.erase(key));
+        }
+        else {
+            map.insert(key, i);
+            reference[key] = i;
+        }
+    }
+
+    ASSERT_EQ(reference.size(), map.size());
+
+    for (unsigned long key = 0; key < 5000; key++) {
+        auto value = map.find(key);
+        auto it = reference.find(key);
+
+        if (it == reference.end()) {
+            EXPECT_EQ(nullptr, value);
+        }
+        else {
+            ASSERT_NE(nullptr, value);
+            EXPECT_EQ(it->second, *value);
+        }
+    }
+}
+
+TEST(PersistentMapTest, StructuralSharing) {
+    lc::storage::PersistentMap<unsigned long, int> map;
+
+    for (unsigned long i = 0; i < 1000; i++) {
+        map.insert(i, i);
+    }
+
+    auto copy = map;
+
+    for (unsigned long i = 0; i < 1000; i += 2) {
+        map.erase(i);
+    }
+    map.insert(5000, 1);
+    map.insert(1, -1);
+
+    EXPECT_EQ(1000, copy.size());
+    EXPECT_EQ(501, map.size());
+
+    for (unsigned long i = 0; i < 1000; i++) {
+        ASSERT_NE(nullptr, copy.find(i));
+        EXPECT_EQ(i, *copy.find(i));
+    }
+    EXPECT_EQ(nullptr, copy.find(5000));
+    EXPECT_EQ(-1, *map.find(1));
+}
+
+TEST(PersistentMapTest, Diff) {
+    lc::storage::PersistentMap<unsigned long, int> map;
+    std::map<unsigned long, int> reference;
+    std::mt19937 random(7);
+
+    for (unsigned long i = 0; i < 3000; i++) {
+        map.insert(i * 37, i);
+        reference[i * 37] = i;
+    }
+
+    for (int round = 0; round < 20; round++) {
+        auto previous = map;
+        auto previousReference = reference;
+
+        for (int i = 0; i < 50; i++) {
+            // Large keys share their low bits with small ones and end up in deeper nodes
+            unsigned long key = (random() % 4000) * 37 + (random() % 2 == 0 ? 0 : (1ul << 40));
+
+            if (random() % 3 == 0) {
+                map.erase(key);
+                reference.erase(key);
+            }
+            else {
+                map.insert(key, round * 1000 + i);
+                reference[key] = round * 1000 + i;
+            }
+        }
+
+        std::map<unsigned long, std::pair<int, int>> expected;
+        for (const auto& entry : previousReference) {
+            auto it = reference.find(entry.first);
+            if (it == reference.end()) {
+                expected[entry.first] = {entry.second, -1};
+            }
+            else if (it->second != entry.second) {
+                expected[entry.first] = {entry.second, it->second};
+            }
+        }
+        for (const auto& entry : reference) {
+            if (previousReference.count(entry.first) == 0) {
+                expected[entry.first] = {-1, entry.second};
+            }
+        }
+
+        std::map<unsigned long, std::pair<int, int>> changes;
+        map.diff(previous, [&changes](unsigned long key, const int* oldValue, const int* newValue) {
+            EXPECT_EQ(0, changes.count(key));
+            changes[key] = {oldValue != nullptr ? *oldValue : -1, newValue != nullptr ? *newValue : -1};
+        });
+
+        EXPECT_EQ(expected, changes);
+    }
+
+    int count = 0;
+    map.diff(map, [&count](unsigned long, const int*, const int*) {
+        count++;
+    });
+    EXPECT_EQ(0, count);
+
+    map.diff(lc::storage::PersistentMap<unsigned long, int>(), [&count](unsigned long, const int* oldValue, const int*) {
+        EXPECT_EQ(nullptr, oldValue);
+        count++;
+    });
+    EXPECT_EQ(reference.size(), count);
+}
+
+TEST(DocumentSnapshotTest, Commit) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto empty = document->snapshot();
+
+    ASSERT_NE(nullptr, empty);
+    EXPECT_EQ(0, empty->size());
+    EXPECT_NE(nullptr, empty->layerByName("0"));
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    for (int i = 0; i < 1000; i++) {
+        builder->appendEntity(createLine(i * 10, 0));
+    }
+    builder->execute();
+
+    auto snapshot = document->snapshot();
+    EXPECT_EQ(0, empty->size()) << "Published snapshot was modified";
+    EXPECT_EQ(1000, snapshot->size());
+    EXPECT_EQ(1000, snapshot->asVector().size());
+    EXPECT_EQ(10, snapshot->entitiesWithinAndCrossingAreaFast(lc::geo::Area(lc::geo::Coordinate(-0.5, -0.5), lc::geo::Coordinate(95.5, 2))).size());
+
+    for (const auto& entity : document->entityContainer().asVector()) {
+        EXPECT_EQ(entity, snapshot->entityByID(entity->id()));
+    }
+
+    auto moved = std::make_shared<lc::operation::EntityBuilder>(document);
+    for (const auto& entity : document->entityContainer().asVector()) {
+        moved->appendEntity(entity);
+    }
+    moved->appendOperation(std::make_shared<lc::operation::Push>());
+    moved->appendOperation(std::make_shared<lc::operation::Move>(lc::geo::Coordinate(0, 100)));
+    moved->execute();
+
+    auto movedSnapshot = document->snapshot();
+    EXPECT_EQ(1000, movedSnapshot->size());
+    EXPECT_EQ(0, movedSnapshot->entitiesWithinAndCrossingAreaFast(lc::geo::Area(lc::geo::Coordinate(-0.5, -0.5), lc::geo::Coordinate(95.5, 2))).size());
+    EXPECT_EQ(10, snapshot->entitiesWithinAndCrossingAreaFast(lc::geo::Area(lc::geo::Coordinate(-0.5, -0.5), lc::geo::Coordinate(95.5, 2))).size());
+}
+
+TEST(DocumentSnapshotTest, UndoRedo) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(10);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    for (int i = 0; i < 100; i++) {
+        builder->appendEntity(createLine(i, i));
+    }
+    builder->execute();
+    EXPECT_EQ(100, document->snapshot()->size());
+
+    undoManager->undo();
+    EXPECT_EQ(0, document->snapshot()->size());
+
+    undoManager->redo();
+    EXPECT_EQ(100, document->snapshot()->size());
+
+    document->commitProcessEvent().disconnect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+}
+
+TEST(EntityQueryTest, Filters) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto layer0 = document->layerByName("0");
+    auto layer1 = std::make_shared<const lc::meta::Layer>("1");
+    auto block = std::make_shared<const lc::meta::Block>("Block", lc::geo::Coordinate());
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    for (int i = 0; i < 100; i++) {
+        auto layer = i % 2 == 0 ? layer0 : layer1;
+        builder->appendEntity(std::make_shared<lc::entity::Line>(lc::geo::Coordinate(i * 10, 0), lc::geo::Coordinate(i * 10 + 1, 1), layer));
+    }
+    for (int i = 0; i < 5; i++) {
+        builder->appendEntity(std::make_shared<lc::entity::Line>(lc::geo::Coordinate(i, 0), lc::geo::Coordinate(i, 1), layer0, nullptr, block));
+    }
+    builder->execute();
+
+    lc::storage::EntityQuery all(document);
+    EXPECT_EQ(100, all.count());
+    EXPECT_EQ(100, all.ids().size());
+
+    lc::storage::EntityQuery area(document);
+    area.setArea(lc::geo::Area(lc::geo::Coordinate(-0.5, -0.5), lc::geo::Coordinate(95.5, 2)));
+    EXPECT_EQ(10, area.count());
+
+    area.setLayer(layer1);
+    auto entities = area.asVector();
+    EXPECT_EQ(5, entities.size());
+    for (const auto& entity : entities) {
+        EXPECT_EQ(layer1, entity->layer());
+    }
+
+    lc::storage::EntityQuery blockQuery(document);
+    blockQuery.setBlock(block);
+    EXPECT_EQ(5, blockQuery.count());
+
+    // The query keeps reading the snapshot it was created with
+    auto remove = std::make_shared<lc::operation::EntityBuilder>(document);
+    remove->appendEntity(entities[0]);
+    remove->appendOperation(std::make_shared<lc::operation::Push>());
+    remove->appendOperation(std::make_shared<lc::operation::Remove>());
+    remove->execute();
+
+    EXPECT_EQ(100, all.count());
+    EXPECT_EQ(99, lc::storage::EntityQuery(document).count());
+}
+
+TEST(EntityQueryTest, BlocksAndStop) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto layer = document->layerByName("0");
+    auto block1 = std::make_shared<const lc::meta::Block>("Block1", lc::geo::Coordinate());
+    auto block2 = std::make_shared<const lc::meta::Block>("Block2", lc::geo::Coordinate());
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    for (int i = 0; i < 50; i++) {
+        builder->appendEntity(createLine(i * 10, 0));
+    }
+    for (int i = 0; i < 20; i++) {
+        auto block = i % 4 == 0 ? block1 : block2;
+        builder->appendEntity(std::make_shared<lc::entity::Line>(lc::geo::Coordinate(i, 0), lc::geo::Coordinate(i, 1), layer, nullptr, block));
+    }
+    builder->execute();
+
+    lc::storage::EntityQuery block1Query(document);
+    block1Query.setBlock(block1);
+    auto block1Entities = block1Query.asVector();
+    ASSERT_EQ(5, block1Entities.size());
+    for (const auto& entity : block1Entities) {
+        EXPECT_EQ(block1, entity->block());
+    }
+
+    lc::storage::EntityQuery block2Query(document);
+    block2Query.setBlock(block2);
+    EXPECT_EQ(15, block2Query.count());
+
+    // Moved and removed block entities leave the index of their block
+    auto move = std::make_shared<lc::operation::EntityBuilder>(document);
+    move->appendEntity(block1Entities[0]);
+    move->appendOperation(std::make_shared<lc::operation::Push>());
+    move->appendOperation(std::make_shared<lc::operation::Move>(lc::geo::Coordinate(0, 100)));
+    move->execute();
+
+    lc::storage::EntityQuery movedQuery(document);
+    movedQuery.setBlock(block1);
+    EXPECT_EQ(5, movedQuery.count());
+    EXPECT_EQ(50, lc::storage::EntityQuery(document).count());
+
+    auto remove = std::make_shared<lc::operation::EntityBuilder>(document);
+    remove->appendEntity(block1Entities[1]);
+    remove->appendOperation(std::make_shared<lc::operation::Push>());
+    remove->appendOperation(std::make_shared<lc::operation::Remove>());
+    remove->execute();
+
+    lc::storage::EntityQuery changedQuery(document);
+    changedQuery.setBlock(block1);
+    EXPECT_EQ(4, changedQuery.count());
+    EXPECT_EQ(5, block1Query.count());
+
+    // The walk stops as soon as func returns false
+    lc::storage::EntityQuery area(document);
+    area.setArea(lc::geo::Area(lc::geo::Coordinate(-1, -1), lc::geo::Coordinate(1000, 2)));
+    for (auto query : {lc::storage::EntityQuery(document), area, block2Query}) {
+        size_t visited = 0;
+        EXPECT_FALSE(query.eachWhile([&visited](const lc::entity::CADEntity_CSPtr&) {
+            return ++visited < 3;
+        }));
+        EXPECT_EQ(3, visited);
+
+        visited = 0;
+        EXPECT_TRUE(query.eachWhile([&visited](const lc::entity::CADEntity_CSPtr&) {
+            visited++;
+            return true;
+        }));
+        EXPECT_EQ(query.count(), visited);
+    }
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/line.h>
+
+TEST(StorageManagerTest, Indexes) {
+    lc::storage::StorageManagerImpl storageManager;
+    auto layer1 = std::make_shared<const lc::meta::Layer>("1");
+    auto layer2 = std::make_shared<const lc::meta::Layer>("2");
+    auto block = std::make_shared<const lc::meta::Block>("block");
+
+    std::vector<lc::entity::CADEntity_CSPtr> entities;
+    for (int i = 0; i < 10; i++) {
+        entities.push_back(std::make_shared<lc::entity::Line>(lc::geo::Coordinate(i, 0), lc::geo::Coordinate(i, 10), layer1));
+        entities.push_back(std::make_shared<lc::entity::Circle>(lc::geo::Coordinate(i, 0), 1, layer2));
+    }
+    storageManager.insertEntities(entities);
+
+    auto blockLine = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0, 0), lc::geo::Coordinate(1, 1), layer1, nullptr, block);
+    storageManager.insertEntity(blockLine);
+
+    EXPECT_EQ(10, storageManager.entitiesByLayer(layer1).asVector().size());
+    EXPECT_EQ(10, storageManager.entitiesByLayer(layer2).asVector().size());
+    EXPECT_EQ(10, storageManager.entitiesByType(typeid(lc::entity::Line)).asVector().size());
+    EXPECT_EQ(10, storageManager.entitiesByType(typeid(lc::entity::Circle)).asVector().size());
+    EXPECT_EQ(1, storageManager.entitiesByBlock(block).asVector().size());
+
+    EXPECT_EQ(blockLine, storageManager.entityByID(blockLine->id()));
+    EXPECT_EQ(entities[3], storageManager.entityByID(entities[3]->id()));
+
+    // Remove with a newer version of the entity, on another layer
+    auto moved = entities[0]->modify(layer2, nullptr, nullptr);
+    storageManager.removeEntity(moved);
+    EXPECT_EQ(nullptr, storageManager.entityByID(entities[0]->id()));
+    EXPECT_EQ(9, storageManager.entitiesByLayer(layer1).asVector().size());
+    EXPECT_EQ(10, storageManager.entitiesByLayer(layer2).asVector().size());
+    EXPECT_EQ(9, storageManager.entitiesByType(typeid(lc::entity::Line)).asVector().size());
+
+    storageManager.insertEntity(moved);
+    EXPECT_EQ(11, storageManager.entitiesByLayer(layer2).asVector().size());
+
+    storageManager.removeEntity(blockLine);
+    EXPECT_EQ(nullptr, storageManager.entityByID(blockLine->id()));
+    EXPECT_EQ(0, storageManager.entitiesByBlock(block).asVector().size());
+}
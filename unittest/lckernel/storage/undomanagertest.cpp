@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/storage/undomanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/line.h>
+
+namespace {
+lc::operation::EntityBuilder_SPtr addLines(const lc::storage::Document_SPtr& document, unsigned int nbLines) {
+    auto layer = std::make_shared<const lc::meta::Layer>();
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+
+    for (unsigned int i = 0; i < nbLines; i++) {
+        builder->appendEntity(std::make_shared<lc::entity::Line>(
+                                  lc::geo::Coordinate(i, 0),
+                                  lc::geo::Coordinate(i, 100),
+                                  layer,
+                                  nullptr
+                              ));
+    }
+
+    builder->execute();
+    return builder;
+}
+}
+
+TEST(UndoManagerTest, MemoryUsage) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(10);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+
+    EXPECT_EQ(0, undoManager->memoryUsage());
+
+    auto builder = addLines(document, 100);
+    auto line = document->entityContainer().asVector().front();
+    EXPECT_EQ(builder->memoryUsage() + 100 * line->memoryUsage(), undoManager->memoryUsage());
+
+    undoManager->undo();
+    EXPECT_EQ(builder->memoryUsage() + 100 * line->memoryUsage(), undoManager->memoryUsage()) << "Redo level not counted";
+
+    undoManager->removeUndoables();
+    EXPECT_EQ(0, undoManager->memoryUsage());
+
+    document->commitProcessEvent().disconnect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+}
+
+TEST(UndoManagerTest, SharedEntities) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(10);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+
+    auto line = std::make_shared<lc::entity::Line>(
+                    lc::geo::Coordinate(0, 0),
+                    lc::geo::Coordinate(100, 100),
+                    std::make_shared<const lc::meta::Layer>(),
+                    nullptr
+                );
+
+    auto builder1 = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder1->appendEntity(line);
+    builder1->execute();
+
+    // The same entity is kept by both operations
+    auto builder2 = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder2->appendEntity(line);
+    builder2->execute();
+
+    EXPECT_EQ(builder1->memoryUsage() + builder2->memoryUsage() + line->memoryUsage(), undoManager->memoryUsage());
+
+    document->commitProcessEvent().disconnect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+}
+
+TEST(UndoManagerTest, MemoryBudget) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(10);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+
+    for (int i = 0; i < 5; i++) {
+        addLines(document, 100);
+    }
+    EXPECT_EQ(5, undoManager->undoLevels());
+
+    auto levelUsage = undoManager->memoryUsage() / 5;
+    undoManager->setMaximumBytes(levelUsage * 2);
+
+    EXPECT_EQ(2, undoManager->undoLevels());
+    EXPECT_LE(undoManager->memoryUsage(), levelUsage * 2);
+
+    // The last operation is kept even when it exceeds the budget
+    undoManager->setMaximumBytes(1);
+    EXPECT_EQ(1, undoManager->undoLevels());
+    EXPECT_TRUE(undoManager->canUndo());
+
+    // New operations release redo levels
+    undoManager->undo();
+    EXPECT_TRUE(undoManager->canRedo());
+    addLines(document, 10);
+    EXPECT_FALSE(undoManager->canRedo());
+
+    document->commitProcessEvent().disconnect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+}
+
+TEST(UndoManagerTest, MaximumLevels) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(3);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+
+    for (int i = 0; i < 5; i++) {
+        addLines(document, 10);
+    }
+
+    EXPECT_EQ(3, undoManager->undoLevels());
+
+    document->commitProcessEvent().disconnect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <cad/tools/boundedqueue.h>
+#include <thread>
+#include <vector>
+
+TEST(BoundedQueueTest, ProducerConsumer) {
+    lc::tools::BoundedQueue<int> queue(4);
+    std::vector<int> values;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < 1000; i++) {
+            queue.push(std::move(i));
+        }
+        queue.close();
+    });
+
+    int value;
+    while (queue.pop(value)) {
+        values.push_back(value);
+    }
+    producer.join();
+
+    ASSERT_EQ(1000, values.size());
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(i, values[i]);
+    }
+}
+
+TEST(BoundedQueueTest, CloseWakesProducer) {
+    lc::tools::BoundedQueue<int> queue(1);
+    EXPECT_TRUE(queue.push(1));
+
+    bool pushed = true;
+    std::thread producer([&queue, &pushed]() {
+        // Blocks, the queue is full
+        pushed = queue.push(2);
+    });
+
+    queue.close();
+    producer.join();
+
+    EXPECT_FALSE(pushed);
+    EXPECT_TRUE(queue.closed());
+
+    // Values queued before closing can still be taken
+    int value;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(queue.pop(value));
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <cad/tools/idmap.h>
+
+#include <map>
+#include <random>
+
+using namespace lc::tools;
+
+namespace {
+void expectEqual(const std::map<ID_DATATYPE, int>& reference, const IDMap<int>& map) {
+    EXPECT_EQ(reference.size(), map.size());
+
+    for(const auto& value : reference) {
+        auto found = map.find(value.first);
+        ASSERT_NE(nullptr, found);
+        EXPECT_EQ(value.second, *found);
+    }
+
+    size_t count = 0;
+    map.each([&](ID_DATATYPE id, int value) {
+        auto it = reference.find(id);
+        ASSERT_NE(reference.end(), it);
+        EXPECT_EQ(it->second, value);
+        count++;
+    });
+    EXPECT_EQ(reference.size(), count);
+}
+}
+
+TEST(IDMapTest, InsertFind) {
+    IDMap<int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(nullptr, map.find(1));
+
+    EXPECT_TRUE(map.insert(1, 10));
+    EXPECT_TRUE(map.insert(2, 20));
+    EXPECT_FALSE(map.insert(1, 11));
+
+    EXPECT_EQ(2, map.size());
+    EXPECT_EQ(11, *map.find(1));
+    EXPECT_EQ(20, *map.find(2));
+    EXPECT_EQ(nullptr, map.find(3));
+    EXPECT_FALSE(map.contains(3));
+    EXPECT_EQ(2, map.size());
+
+    EXPECT_TRUE(map.erase(1));
+    EXPECT_FALSE(map.erase(1));
+    EXPECT_EQ(nullptr, map.find(1));
+    EXPECT_EQ(20, *map.find(2));
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(nullptr, map.find(2));
+}
+
+TEST(IDMapTest, SharedPointers) {
+    auto value = std::make_shared<int>(1);
+    IDMap<std::shared_ptr<int>> map;
+    map.insert(1, value);
+    EXPECT_EQ(2, value.use_count());
+
+    map.erase(1);
+    EXPECT_EQ(1, value.use_count());
+}
+
+TEST(IDMapTest, Random) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<ID_DATATYPE> id(0, 5000);
+    std::uniform_int_distribution<int> operation(0, 2);
+
+    IDMap<int> map;
+    std::map<ID_DATATYPE, int> reference;
+
+    for(int i = 0; i < 100000; i++) {
+        auto key = id(random);
+        if(operation(random) == 0) {
+            EXPECT_EQ(reference.erase(key) == 1, map.erase(key));
+        }
+        else {
+            EXPECT_EQ(reference.find(key) == reference.end(), map.insert(key, i));
+            reference[key] = i;
+        }
+    }
+    expectEqual(reference, map);
+
+    // Consecutive IDs, as given by the ID generator
+    map.clear();
+    reference.clear();
+    map.reserve(10000);
+    for(ID_DATATYPE key = 1000; key < 11000; key++) {
+        map.insert(key, static_cast<int>(key));
+        reference[key] = static_cast<int>(key);
+    }
+    for(ID_DATATYPE key = 1000; key < 11000; key += 3) {
+        map.erase(key);
+        reference.erase(key);
+    }
+    expectEqual(reference, map);
+}
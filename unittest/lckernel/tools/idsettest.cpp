@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <cad/tools/idset.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+
+using namespace lc::tools;
+
+namespace {
+/**
+ * Random IDs, some of them far apart so the sets have several pages
+ */
+void fill(std::mt19937& random, IDSet& set, std::set<ID_DATATYPE>& reference, size_t count) {
+    std::uniform_int_distribution<ID_DATATYPE> id(0, 20000);
+    std::uniform_int_distribution<int> far(0, 9);
+
+    for(size_t i = 0; i < count; i++) {
+        auto value = id(random);
+        if(far(random) == 0) {
+            value += 1ul << 40;
+        }
+
+        EXPECT_EQ(reference.insert(value).second, set.insert(value));
+    }
+}
+
+void expectEqual(const std::set<ID_DATATYPE>& reference, const IDSet& set) {
+    EXPECT_EQ(reference.size(), set.size());
+    EXPECT_EQ(std::vector<ID_DATATYPE>(reference.begin(), reference.end()), set.ids());
+}
+}
+
+TEST(IDSetTest, InsertErase) {
+    IDSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.insert(5));
+    EXPECT_FALSE(set.insert(5));
+    EXPECT_TRUE(set.insert(IDSet::PAGE_SIZE + 63));
+    EXPECT_TRUE(set.contains(5));
+    EXPECT_FALSE(set.contains(6));
+    EXPECT_EQ(2, set.size());
+
+    EXPECT_FALSE(set.toggle(5));
+    EXPECT_FALSE(set.contains(5));
+    EXPECT_TRUE(set.toggle(5));
+    EXPECT_TRUE(set.erase(5));
+    EXPECT_FALSE(set.erase(5));
+    EXPECT_TRUE(set.erase(IDSet::PAGE_SIZE + 63));
+    EXPECT_TRUE(set.empty());
+}
+
+TEST(IDSetTest, BulkOperations) {
+    std::mt19937 random(42);
+
+    for(int iteration = 0; iteration < 20; iteration++) {
+        IDSet a, b;
+        std::set<ID_DATATYPE> ra, rb;
+        fill(random, a, ra, 3000);
+        fill(random, b, rb, 3000);
+        expectEqual(ra, a);
+
+        std::set<ID_DATATYPE> expected;
+        std::set_union(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(expected, expected.end()));
+        IDSet united = a;
+        expectEqual(expected, united.unite(b));
+
+        expected.clear();
+        std::set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(expected, expected.end()));
+        IDSet difference = a;
+        expectEqual(expected, difference.subtract(b));
+
+        expected.clear();
+        std::set_symmetric_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), std::inserter(expected, expected.end()));
+        IDSet toggled = a;
+        expectEqual(expected, toggled.toggle(b));
+
+        // Toggling twice gives the set back, empty pages are dropped
+        EXPECT_TRUE(toggled.toggle(b) == a);
+        EXPECT_TRUE(IDSet(a).subtract(a).empty());
+        EXPECT_TRUE(IDSet(a).toggle(a) == IDSet());
+    }
+}
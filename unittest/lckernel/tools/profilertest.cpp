@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <cad/tools/profiler.h>
+#include <thread>
+
+using lc::tools::Profiler;
+
+TEST(ProfilerTest, Disabled) {
+    auto& profiler = Profiler::instance();
+    profiler.setEnabled(false);
+    profiler.clear();
+
+    {
+        LC_PROFILE_ZONE("Disabled");
+        LC_PROFILE_COUNT("Counter", 1);
+        LC_PROFILE_GAUGE("Gauge", 2);
+    }
+
+    EXPECT_EQ(0, profiler.size());
+}
+
+TEST(ProfilerTest, ChromeTrace) {
+    auto& profiler = Profiler::instance();
+    profiler.clear();
+    profiler.setEnabled(true);
+
+    {
+        LC_PROFILE_ZONE("Outer");
+        std::thread([]() {
+            LC_PROFILE_ZONE("Worker \"zone\"");
+        }).join();
+        LC_PROFILE_COUNT("Counter", 2);
+        LC_PROFILE_COUNT("Counter", 3);
+        LC_PROFILE_GAUGE("Gauge", 7);
+    }
+
+    profiler.setEnabled(false);
+    EXPECT_EQ(5, profiler.size());
+
+    auto trace = profiler.chromeTrace();
+    EXPECT_EQ(0, trace.find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.find("{\"name\":\"Outer\",\"ph\":\"X\""));
+    EXPECT_NE(std::string::npos, trace.find("\"Worker \\\"zone\\\"\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"Counter\",\"ph\":\"C\""));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"value\":5}"));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"value\":7}"));
+
+    profiler.clear();
+    EXPECT_EQ(0, profiler.size());
+}
+
+TEST(ProfilerTest, ZoneDuration) {
+    auto& profiler = Profiler::instance();
+    profiler.clear();
+    profiler.setEnabled(true);
+
+    auto start = Profiler::Clock::now();
+    profiler.addZone("Zone", start, start + std::chrono::microseconds(30));
+    profiler.addZone("Zone", start, start + std::chrono::microseconds(12));
+    profiler.addZone("Other", start, start + std::chrono::microseconds(100));
+    LC_PROFILE_COUNT("Zone", 1000);
+
+    profiler.setEnabled(false);
+    EXPECT_NEAR(42., profiler.zoneDuration("Zone"), 0.01);
+    EXPECT_NEAR(100., profiler.zoneDuration("Other"), 0.01);
+    EXPECT_EQ(0., profiler.zoneDuration("Missing"));
+
+    profiler.clear();
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <cad/tools/threadpool.h>
+#include <atomic>
+#include <stdexcept>
+
+TEST(ThreadPoolTest, Enqueue) {
+    lc::tools::ThreadPool pool(2);
+
+    auto result = pool.enqueue([]() {
+        return 42;
+    });
+
+    EXPECT_EQ(42, result.get());
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+    lc::tools::ThreadPool pool(4);
+    std::vector<int> values(100000, 0);
+
+    pool.parallelFor(values.size(), 100, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++) {
+            values[i]++;
+        }
+    });
+
+    for (auto value : values) {
+        ASSERT_EQ(1, value) << "Item processed zero or multiple times";
+    }
+}
+
+TEST(ThreadPoolTest, NestedParallelFor) {
+    lc::tools::ThreadPool pool(2);
+    std::atomic<int> count(0);
+
+    pool.parallelFor(8, 1, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++) {
+            pool.parallelFor(1000, 10, [&](size_t begin, size_t end) {
+                count += end - begin;
+            });
+        }
+    });
+
+    EXPECT_EQ(8000, count);
+}
+
+TEST(ThreadPoolTest, Exception) {
+    lc::tools::ThreadPool pool(2);
+
+    EXPECT_THROW(pool.parallelFor(1000, 10, [](size_t begin, size_t end) {
+        if (begin == 0) {
+            throw std::runtime_error("error");
+        }
+    }), std::runtime_error);
+}
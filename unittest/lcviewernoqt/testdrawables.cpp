@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "documentcanvas.h"
+#include "drawitems/lcvcircle.h"
+#include "drawitems/lcvhatch.h"
+#include "drawitems/lcvline.h"
+#include "drawitems/lcvpoint.h"
+
+#include <cad/meta/layer.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/hatch.h>
+#include <cad/primitive/line.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/point.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/tools/threadpool.h>
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+TEST(DrawablesTest, AsDrawable) {
+    auto layer = std::make_shared<lc::meta::Layer>();
+
+    auto line = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0, 0), lc::geo::Coordinate(10, 10), layer);
+    auto lineDrawable = lc::viewer::DocumentCanvas::asDrawable(line);
+    EXPECT_NE(nullptr, std::dynamic_pointer_cast<lc::viewer::LCVLine>(lineDrawable));
+    EXPECT_EQ(line, lineDrawable->entity());
+    EXPECT_TRUE(lineDrawable->cacheable());
+
+    auto circle = std::make_shared<lc::entity::Circle>(lc::geo::Coordinate(0, 0), 5., layer);
+    EXPECT_NE(nullptr, std::dynamic_pointer_cast<lc::viewer::LCVCircle>(lc::viewer::DocumentCanvas::asDrawable(circle)));
+
+    // Points have a constant size on screen
+    auto point = std::make_shared<lc::entity::Point>(lc::geo::Coordinate(1, 1), layer);
+    auto pointDrawable = lc::viewer::DocumentCanvas::asDrawable(point);
+    EXPECT_NE(nullptr, std::dynamic_pointer_cast<lc::viewer::LCVPoint>(pointDrawable));
+    EXPECT_FALSE(pointDrawable->cacheable());
+
+    EXPECT_EQ(nullptr, lc::viewer::DocumentCanvas::asDrawable(nullptr));
+}
+
+
+TEST(DrawablesTest, PendingHatch) {
+    auto layer = std::make_shared<lc::meta::Layer>();
+    auto& pool = lc::tools::ThreadPool::instance();
+
+    // Keep the workers busy, the fill of the hatch can't be computed
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<std::future<void>> busy;
+    for(unsigned int i = 0; i < pool.size(); i++) {
+        busy.push_back(pool.enqueue([released]() {
+            released.wait();
+        }));
+    }
+
+    std::vector<lc::entity::CADEntity_CSPtr> loop = {
+        std::make_shared<lc::entity::Circle>(lc::geo::Coordinate(0, 0), 5., layer)
+    };
+    auto hatch = std::make_shared<lc::entity::Hatch>(layer);
+    hatch->setRegion(lc::geo::Region(loop));
+    hatch->setSolid(1);
+
+    std::promise<void> ready;
+    auto drawable = lc::viewer::DocumentCanvas::asDrawable(hatch, [&ready]() {
+        ready.set_value();
+    });
+    ASSERT_NE(nullptr, std::dynamic_pointer_cast<lc::viewer::LCVHatch>(drawable));
+    EXPECT_TRUE(drawable->pending());
+
+    release.set_value();
+    ASSERT_EQ(std::future_status::ready, ready.get_future().wait_for(std::chrono::seconds(10)));
+    EXPECT_FALSE(drawable->pending());
+
+    for(auto& task : busy) {
+        task.get();
+    }
+}
+
+TEST(DrawablesTest, CanvasReadyFlag) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto canvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+    auto layer = document->layerByName("0");
+
+    std::vector<lc::entity::CADEntity_CSPtr> loop = {
+        std::make_shared<lc::entity::Circle>(lc::geo::Coordinate(0, 0), 5., layer)
+    };
+    auto hatch = std::make_shared<lc::entity::Hatch>(layer);
+    hatch->setRegion(lc::geo::Region(loop));
+    hatch->setSolid(1);
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(hatch);
+    builder->execute();
+
+    // The worker only sets a flag, the UI thread polls it
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while(!canvas->takeDrawablesReady()) {
+        ASSERT_LT(std::chrono::steady_clock::now(), timeout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(canvas->takeDrawablesReady());
+}
@@ -233,3 +233,37 @@ TEST(SelectionTest, DeselectAddTo) {
 
     EXPECT_TRUE(i == docCanvas->selectedDrawables().size());
 }
+
+TEST(SelectionTest, InverseSelection) {
+    auto storageManager = std::make_shared<lc::storage::StorageManagerImpl>();
+    auto document = std::make_shared<lc::storage::DocumentImpl>(storageManager);
+    auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+
+    auto layer = std::make_shared<lc::meta::Layer>();
+    std::shared_ptr<lc::operation::AddLayer> al = std::make_shared<lc::operation::AddLayer>(document, layer);
+    al->execute();
+
+    auto first = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0,0,0), lc::geo::Coordinate(0, 10, 0), layer);
+    auto second = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(10,0,0), lc::geo::Coordinate(10, 10, 0), layer);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(first);
+    builder->appendEntity(second);
+    builder->execute();
+
+    docCanvas->makeSelection(0, 0, 5, 10, true);
+    docCanvas->closeSelection();
+    EXPECT_EQ(std::vector<ID_DATATYPE>({first->id()}), docCanvas->lastSelectionChange().added);
+
+    docCanvas->inverseSelection();
+
+    EXPECT_EQ(1, docCanvas->selectedDrawables().size());
+    EXPECT_TRUE(docCanvas->selection().contains(second->id()));
+    EXPECT_FALSE(docCanvas->getDrawable(first)->selected());
+    EXPECT_TRUE(docCanvas->getDrawable(second)->selected());
+    EXPECT_EQ(std::vector<ID_DATATYPE>({second->id()}), docCanvas->lastSelectionChange().added);
+    EXPECT_EQ(std::vector<ID_DATATYPE>({first->id()}), docCanvas->lastSelectionChange().removed);
+
+    docCanvas->removeSelection();
+    EXPECT_TRUE(docCanvas->selection().empty());
+    EXPECT_FALSE(docCanvas->getDrawable(second)->selected());
+}
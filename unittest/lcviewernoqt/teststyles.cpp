@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "documentcanvas.h"
+#include "painters/lcpainter.h"
+
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/meta/layer.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/layerops.h>
+#include <cad/primitive/line.h>
+
+#include <map>
+
+namespace {
+struct Stroke {
+    lc::Color color;
+    double width;
+};
+
+/**
+ * Painter recording the color and width of each stroke, without drawing
+ * When caching is enabled, the width is the one of the cached entity and the color the one of the render call.
+ */
+class RecordingPainter : public lc::viewer::LcPainter {
+public:
+    explicit RecordingPainter(bool caching) :
+        _caching(caching),
+        _cachingEntity(false),
+        _width(1.),
+        _cachingWidth(0.) {
+    }
+
+    std::vector<Stroke> strokes;
+
+    void create_resources() override {}
+    void new_device_size(unsigned int width, unsigned int height) override {}
+    void new_path() override {}
+    void close_path() override {}
+    void new_sub_path() override {}
+    void clear(double r, double g, double b) override {}
+    void clear(double r, double g, double b, double a) override {}
+    void move_to(double x, double y) override {}
+    void line_to(double x, double y) override {}
+    void lineWidthCompensation(double lwc) override {}
+
+    void line_width(double lineWidth) override {
+        _width = lineWidth;
+    }
+
+    double scale() override {
+        return 1.;
+    }
+
+    void scale(double s) override {}
+    void rotate(double r) override {}
+    void arc(double x, double y, double r, double start, double end) override {}
+    void arcNegative(double x, double y, double r, double start, double end) override {}
+    void circle(double x, double y, double r) override {}
+    void ellipse(double cx, double cy, double rx, double ry, double sa, double ea, double ra) override {}
+    void rectangle(double x1, double y1, double w, double h) override {}
+
+    void stroke() override {
+        if (_cachingEntity) {
+            _cachingWidth = _width;
+        }
+        else {
+            strokes.push_back({_color, _width});
+        }
+    }
+
+    void source_rgb(double r, double g, double b) override {
+        _color = lc::Color(r, g, b);
+    }
+
+    void source_rgba(double r, double g, double b, double a) override {
+        _color = lc::Color(r, g, b, a);
+    }
+
+    void translate(double x, double y) override {}
+    void user_to_device(double* x, double* y) override {}
+    void device_to_user(double* x, double* y) override {}
+    void user_to_device_distance(double* dx, double* dy) override {}
+    void device_to_user_distance(double* dx, double* dy) override {}
+    void font_size(double size, bool deviceCoords) override {}
+    void select_font_face(const char* text_val, const char* font_type) override {}
+    void text(const char* text_val) override {}
+
+    lc::viewer::TextExtends text_extends(const char* text_val) override {
+        return lc::viewer::TextExtends();
+    }
+
+    void quadratic_curve_to(double x1, double y1, double x2, double y2) override {}
+    void curve_to(double x1, double y1, double x2, double y2, double x3, double y3) override {}
+    void save() override {}
+    void restore() override {}
+
+    long pattern_create_linear(double x1, double y1, double x2, double y2) override {
+        return 0;
+    }
+
+    void pattern_add_color_stop_rgba(long pat, double offset, double r, double g, double b, double a) override {}
+    void set_pattern_source(long pat) override {}
+    void pattern_destroy(long pat) override {}
+    void fill() override {}
+    void point(double x, double y, double size, bool deviceCoords) override {}
+    void reset_transformations() override {}
+
+    unsigned char* data() override {
+        return nullptr;
+    }
+
+    void set_dash(const double* dashes, const int num_dashes, double offset, bool scaled) override {}
+    void dash_destroy() override {}
+
+    long image_create(const std::string& file) override {
+        return 0;
+    }
+
+    void image_destroy(long image) override {}
+    void image(long image, double uvx, double vy, double vvx, double vvy, double x, double y) override {}
+    void disable_antialias() override {}
+    void enable_antialias() override {}
+    void getTranslate(double* x, double* y) override {}
+
+    bool isCachingEnabled() override {
+        return _caching;
+    }
+
+    void startcaching() override {
+        _cachingEntity = true;
+    }
+
+    void finishcaching(unsigned long id) override {
+        _cachedWidths[id] = _cachingWidth;
+        _cachingEntity = false;
+    }
+
+    LcPainter* getCacherpainter() override {
+        return this;
+    }
+
+    bool isEntityCached(unsigned long id) override {
+        return _cachedWidths.find(id) != _cachedWidths.end();
+    }
+
+    void renderEntityCached(unsigned long id) override {
+        strokes.push_back({_color, _cachedWidths[id]});
+    }
+
+    void deleteEntityCached(unsigned long id) override {
+        _cachedWidths.erase(id);
+    }
+
+    std::vector<std::string> getFontList() const override {
+        return std::vector<std::string>();
+    }
+
+    void addFontsFromPath(const std::vector<std::string>& paths) override {}
+
+private:
+    bool _caching;
+    bool _cachingEntity;
+    lc::Color _color;
+    double _width;
+    double _cachingWidth;
+    std::map<unsigned long, double> _cachedWidths;
+};
+
+void checkLayerChange(bool caching) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto canvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+
+    auto red = std::make_shared<lc::meta::Layer>("Layer", lc::meta::MetaLineWidthByValue(1.), lc::Color(1., 0., 0.));
+    std::make_shared<lc::operation::AddLayer>(document, red)->execute();
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(10., 10.), red));
+    builder->execute();
+
+    RecordingPainter painter(caching);
+    canvas->setPainter(&painter);
+    canvas->newDeviceSize(100, 100);
+
+    canvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    ASSERT_EQ(1, painter.strokes.size());
+    EXPECT_DOUBLE_EQ(1., painter.strokes[0].color.red());
+    EXPECT_DOUBLE_EQ(0., painter.strokes[0].color.blue());
+    auto redWidth = painter.strokes[0].width;
+
+    auto blue = std::make_shared<lc::meta::Layer>("Layer", lc::meta::MetaLineWidthByValue(2.), lc::Color(0., 0., 1.));
+    std::make_shared<lc::operation::ReplaceLayer>(document, red, blue)->execute();
+
+    painter.strokes.clear();
+    canvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    ASSERT_EQ(1, painter.strokes.size());
+    EXPECT_DOUBLE_EQ(0., painter.strokes[0].color.red());
+    EXPECT_DOUBLE_EQ(1., painter.strokes[0].color.blue());
+    EXPECT_GT(painter.strokes[0].width, redWidth);
+
+    canvas->setPainter(nullptr);
+}
+}
+
+TEST(StylesTest, LayerChangeIsDrawn) {
+    checkLayerChange(false);
+}
+
+TEST(StylesTest, LayerChangeIsDrawnCached) {
+    checkLayerChange(true);
+}
@@ -0,0 +1,180 @@
+#include "documentfixture.h"
+
+#include <cad/builders/insert.h>
+#include <cad/operations/blockops.h>
+#include <cad/operations/builder.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/layerops.h>
+#include <cad/operations/linepatternops.h>
+#include <cad/meta/metacolor.h>
+#include <cad/meta/metalinewidth.h>
+#include <cad/primitive/arc.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/dimaligned.h>
+#include <cad/primitive/dimangular.h>
+#include <cad/primitive/dimdiametric.h>
+#include <cad/primitive/dimlinear.h>
+#include <cad/primitive/dimradial.h>
+#include <cad/primitive/ellipse.h>
+#include <cad/primitive/hatch.h>
+#include <cad/primitive/image.h>
+#include <cad/primitive/insert.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/lwpolyline.h>
+#include <cad/primitive/point.h>
+#include <cad/primitive/spline.h>
+#include <cad/primitive/text.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace lc;
+
+storage::Document_SPtr createDocument() {
+    auto document = std::make_shared<storage::DocumentImpl>(std::make_shared<storage::StorageManagerImpl>());
+    for(auto& block : document->blocks()) {
+        document->removeDocumentMetaType(block);
+    }
+    return document;
+}
+
+storage::Document_SPtr createDrawing() {
+    auto document = createDocument();
+    auto builder = std::make_shared<operation::Builder>(document, "Test");
+
+    auto linePattern = std::make_shared<meta::DxfLinePatternByValue>("DASHED", "- -", std::vector<double>{1., -0.5}, 1.5);
+    auto layer = std::make_shared<meta::Layer>("1", meta::MetaLineWidthByValue(0.5), Color(1., 0., 0.), linePattern);
+    auto block = std::make_shared<meta::Block>("Block", geo::Coordinate(1., 2.));
+
+    builder->append(std::make_shared<operation::AddLinePattern>(document, linePattern));
+    builder->append(std::make_shared<operation::AddLayer>(document, layer));
+    builder->append(std::make_shared<operation::AddBlock>(document, block));
+
+    auto metaInfo = meta::MetaInfo::create();
+    metaInfo->add(std::make_shared<meta::MetaColorByValue>(0., 1., 0.));
+    metaInfo->add(std::make_shared<meta::MetaLineWidthByValue>(0.25));
+    metaInfo->add(linePattern);
+
+    auto byBlock = meta::MetaInfo::create();
+    byBlock->add(std::make_shared<meta::MetaColorByBlock>());
+
+    std::vector<entity::LWVertex2D> vertices = {
+        entity::LWVertex2D(geo::Coordinate(0., 0.)),
+        entity::LWVertex2D(geo::Coordinate(10., 0.), 0.5),
+        entity::LWVertex2D(geo::Coordinate(10., 10.), 0., 0.1, 0.2)
+    };
+
+    // The entities added after the point are above y = 30
+    auto addEntities = std::make_shared<operation::EntityBuilder>(document);
+    addEntities->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(10., 5.), layer, metaInfo));
+    addEntities->appendEntity(std::make_shared<entity::Circle>(geo::Coordinate(20., 0.), 5., layer));
+    addEntities->appendEntity(std::make_shared<entity::Arc>(geo::Coordinate(40., 0.), 5., 0., 2., true, layer));
+    addEntities->appendEntity(std::make_shared<entity::Ellipse>(geo::Coordinate(60., 0.), geo::Coordinate(5., 2.), 1.,
+                                                                0.5, 4., true, layer));
+    addEntities->appendEntity(std::make_shared<entity::Point>(geo::Coordinate(80., 3.), layer));
+    addEntities->appendEntity(std::make_shared<entity::LWPolyline>(vertices, 0., 0., 0., true,
+                                                                   geo::Coordinate(0., 0., 1.), layer));
+    addEntities->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(1., 1.),
+                                                             layer, byBlock, block));
+
+    addEntities->appendEntity(std::make_shared<entity::Text>(geo::Coordinate(5., 35.), "Text", 2., 0.5, "STANDARD",
+                                                             TextConst::None, TextConst::HACenter, TextConst::VAMiddle,
+                                                             true, false, false, true, layer));
+
+    std::vector<geo::Coordinate> controlPoints = {
+        geo::Coordinate(20., 30.), geo::Coordinate(25., 40.), geo::Coordinate(30., 30.), geo::Coordinate(35., 40.)
+    };
+    addEntities->appendEntity(std::make_shared<entity::Spline>(controlPoints, std::vector<double>(), std::vector<geo::Coordinate>(),
+                                                               3, false, 0., 0., 0., 0., 0., 0., 0., 0., 0., 1.,
+                                                               static_cast<geo::Spline::splineflag>(1), layer));
+
+    addEntities->appendEntity(std::make_shared<entity::DimAligned>(geo::Coordinate(40., 35.), geo::Coordinate(45., 37.),
+                                                                   TextConst::Middle_center, 0., 1., TextConst::AtLeast,
+                                                                   "<>", geo::Coordinate(40., 30.), geo::Coordinate(50., 30.),
+                                                                   layer));
+    addEntities->appendEntity(std::make_shared<entity::DimAngular>(geo::Coordinate(55., 35.), geo::Coordinate(60., 38.),
+                                                                   TextConst::Top_center, 0., 1., TextConst::Exact,
+                                                                   "Angle", geo::Coordinate(55., 30.),
+                                                                   geo::Coordinate(65., 30.), geo::Coordinate(55., 30.),
+                                                                   geo::Coordinate(60., 40.), layer));
+    addEntities->appendEntity(std::make_shared<entity::DimDiametric>(geo::Coordinate(70., 30.), geo::Coordinate(72., 34.),
+                                                                     TextConst::Middle_left, 0., 1., TextConst::AtLeast,
+                                                                     "<>", geo::Coordinate(74., 38.), 2., layer));
+    addEntities->appendEntity(std::make_shared<entity::DimLinear>(geo::Coordinate(0., 50.), geo::Coordinate(5., 52.),
+                                                                  TextConst::Bottom_center, 0., 1., TextConst::AtLeast,
+                                                                  "<>", geo::Coordinate(0., 45.), geo::Coordinate(10., 45.),
+                                                                  0.2, 0.1, layer));
+    addEntities->appendEntity(std::make_shared<entity::DimRadial>(geo::Coordinate(20., 50.), geo::Coordinate(22., 54.),
+                                                                  TextConst::Middle_right, 0., 1., TextConst::AtLeast,
+                                                                  "<>", geo::Coordinate(24., 56.), 3., layer));
+    addEntities->appendEntity(std::make_shared<entity::Image>("image.png", geo::Coordinate(30., 50.), geo::Coordinate(1., 0.),
+                                                              geo::Coordinate(0., 1.), 10., 5., 50., 60., 10., layer));
+
+    std::vector<entity::CADEntity_CSPtr> outerLoop = {
+        std::make_shared<entity::Line>(geo::Coordinate(50., 50.), geo::Coordinate(60., 50.), layer),
+        std::make_shared<entity::Line>(geo::Coordinate(60., 50.), geo::Coordinate(60., 60.), layer),
+        std::make_shared<entity::Line>(geo::Coordinate(60., 60.), geo::Coordinate(50., 60.), layer),
+        std::make_shared<entity::Line>(geo::Coordinate(50., 60.), geo::Coordinate(50., 50.), layer)
+    };
+    geo::Region region(outerLoop);
+    region.addLoop(geo::Loop({std::make_shared<entity::Circle>(geo::Coordinate(55., 55.), 2., layer)}));
+
+    objects::Pattern pattern;
+    pattern.name = "ANSI31";
+    pattern.boundingBox = geo::Area(geo::Coordinate(0., 0.), geo::Coordinate(1., 1.));
+    pattern.segments.emplace_back(geo::Coordinate(0., 0.), geo::Coordinate(1., 1.));
+
+    auto hatch = std::make_shared<entity::Hatch>(layer);
+    hatch->setRegion(region);
+    hatch->setPattern(pattern);
+    hatch->setPatternName("ANSI31");
+    hatch->setSolid(0);
+    hatch->setAngle(0.5);
+    hatch->setScale(2.);
+    addEntities->appendEntity(hatch);
+
+    builder->append(addEntities);
+    builder->execute();
+
+    // Added once the block entities are in the document, for its bounding box
+    builder::InsertBuilder insertBuilder;
+    insertBuilder.setLayer(layer);
+    insertBuilder.setDisplayBlock(block);
+    insertBuilder.setCoordinate(geo::Coordinate(70., 50.));
+    insertBuilder.setDocument(document);
+
+    auto addInsert = std::make_shared<operation::EntityBuilder>(document);
+    addInsert->appendEntity(insertBuilder.build());
+    addInsert->execute();
+
+    return document;
+}
+
+std::vector<std::string> describe(const storage::Document_SPtr& document, bool ids) {
+    std::vector<entity::CADEntity_CSPtr> entities = document->entityContainer().asVector();
+    for(const auto& block : document->blocks()) {
+        auto blockEntities = document->entitiesByBlock(block).asVector();
+        entities.insert(entities.end(), blockEntities.begin(), blockEntities.end());
+    }
+
+    std::vector<std::string> descriptions;
+    for(const auto& entity : entities) {
+        auto box = entity->boundingBox();
+        std::ostringstream description;
+        description.precision(10);
+        if(ids) {
+            description << entity->id() << " ";
+        }
+        description << typeid(*entity).name() << " "
+                    << box.minP().x() << " " << box.minP().y() << " "
+                    << box.maxP().x() << " " << box.maxP().y() << " "
+                    << entity->layer()->name() << " "
+                    << (entity->block() == nullptr ? "" : entity->block()->name());
+        descriptions.push_back(description.str());
+    }
+
+    std::sort(descriptions.begin(), descriptions.end());
+    return descriptions;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cad/storage/document.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Create an empty document, without the default blocks
+ */
+lc::storage::Document_SPtr createDocument();
+
+/**
+ * @brief Create a document with a layer, a line pattern, a block and an entity of each kernel type
+ */
+lc::storage::Document_SPtr createDrawing();
+
+/**
+ * @brief Describe all the entities of a document, including the entities of blocks
+ * A description is made of the type, bounding box, layer and block of the entity, the list is sorted.
+ * @param ids Start the descriptions with the entity IDs
+ */
+std::vector<std::string> describe(const lc::storage::Document_SPtr& document, bool ids = false);
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <native/journal.h>
+#include <native/nativeformat.h>
+#include <cad/operations/builder.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/layerops.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/line.h>
+#include <cad/storage/undomanagerimpl.h>
+#include "documentfixture.h"
+
+#include <fstream>
+
+using namespace lc;
+
+namespace {
+const char* JOURNAL_PATH = "journaltest";
+
+/**
+ * Add, move, remove entities, change a layer and undo the last operation
+ */
+void edit(const storage::Document_SPtr& document) {
+    auto undoManager = std::make_shared<storage::UndoManagerImpl>(10);
+    document->commitProcessEvent().connect<storage::UndoManagerImpl, &storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+
+    auto layer = std::make_shared<const meta::Layer>("1", meta::MetaLineWidthByValue(0.5), Color(1., 0., 0.));
+    std::make_shared<operation::AddLayer>(document, layer)->execute();
+
+    auto addEntities = std::make_shared<operation::EntityBuilder>(document);
+    for(int i = 0; i < 100; i++) {
+        addEntities->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(i, 0.), geo::Coordinate(i, 10.), layer));
+        addEntities->appendEntity(std::make_shared<entity::Circle>(geo::Coordinate(i, 20.), 1., document->layerByName("0")));
+    }
+    addEntities->execute();
+
+    auto entities = document->entityContainer().asVector();
+
+    auto move = std::make_shared<operation::EntityBuilder>(document);
+    move->appendEntity(entities[0]);
+    move->appendEntity(entities[1]);
+    move->appendOperation(std::make_shared<operation::Push>());
+    move->appendOperation(std::make_shared<operation::Move>(geo::Coordinate(0., 100.)));
+    move->execute();
+
+    auto remove = std::make_shared<operation::EntityBuilder>(document);
+    remove->appendEntity(entities[2]);
+    remove->appendOperation(std::make_shared<operation::Push>());
+    remove->appendOperation(std::make_shared<operation::Remove>());
+    remove->execute();
+
+    auto newLayer = std::make_shared<const meta::Layer>("1", meta::MetaLineWidthByValue(0.5), Color(0.5, 0., 0.));
+    std::make_shared<operation::ReplaceLayer>(document, layer, newLayer)->execute();
+
+    auto undone = std::make_shared<operation::EntityBuilder>(document);
+    undone->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(-5., -5.), newLayer));
+    undone->execute();
+    undoManager->undo();
+
+    document->commitProcessEvent().disconnect<storage::UndoManagerImpl, &storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+}
+}
+
+TEST(JournalTest, Recover) {
+    auto document = createDocument();
+    {
+        persistence::Journal journal(document, JOURNAL_PATH, std::chrono::milliseconds(10));
+        journal.flush();
+        edit(document);
+        journal.flush();
+    }
+
+    auto recovered = createDocument();
+    EXPECT_TRUE(persistence::Journal::recover(recovered, JOURNAL_PATH));
+    EXPECT_EQ(199, recovered->entityContainer().asVector().size());
+    EXPECT_EQ(describe(document, true), describe(recovered, true));
+    EXPECT_EQ(0.5, recovered->layerByName("1")->color().red());
+
+    persistence::Journal::discard(JOURNAL_PATH);
+    EXPECT_FALSE(persistence::Journal::recover(createDocument(), JOURNAL_PATH));
+}
+
+TEST(JournalTest, SnapshotsReleasedOnCommit) {
+    auto document = createDocument();
+    auto addLine = [&document]() {
+        auto builder = std::make_shared<operation::EntityBuilder>(document);
+        builder->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(-5., -5.),
+                                                             document->layerByName("0")));
+        builder->execute();
+    };
+
+    {
+        persistence::Journal journal(document, JOURNAL_PATH, std::chrono::milliseconds(10));
+        journal.flush();
+        std::weak_ptr<const storage::DocumentSnapshot> first = document->snapshot();
+
+        // The journal thread is done with the first snapshot, it is kept for the thread editing the document
+        addLine();
+        journal.flush();
+        EXPECT_FALSE(first.expired());
+
+        addLine();
+        EXPECT_TRUE(first.expired());
+    }
+
+    persistence::Journal::discard(JOURNAL_PATH);
+}
+
+TEST(JournalTest, AllEntityTypes) {
+    auto document = createDrawing();
+    {
+        persistence::Journal journal(document, JOURNAL_PATH, std::chrono::milliseconds(10));
+        journal.flush();
+
+        auto addLine = std::make_shared<operation::EntityBuilder>(document);
+        addLine->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(-5., -5.),
+                                                             document->layerByName("1")));
+        addLine->execute();
+        journal.flush();
+    }
+
+    auto recovered = createDocument();
+    EXPECT_TRUE(persistence::Journal::recover(recovered, JOURNAL_PATH));
+    EXPECT_EQ(describe(document, true), describe(recovered, true));
+
+    persistence::Journal::discard(JOURNAL_PATH);
+}
+
+TEST(JournalTest, IncompleteRecord) {
+    auto document = createDocument();
+    {
+        persistence::Journal journal(document, JOURNAL_PATH, std::chrono::milliseconds(10));
+        journal.flush();
+        edit(document);
+    }
+
+    // Crash while writing a record
+    {
+        std::ofstream stream(std::string(JOURNAL_PATH) + ".lcj", std::ios::binary | std::ios::app);
+        persistence::native::JournalRecord record = {};
+        record.sequence = 1000;
+        record.size = 4096;
+        stream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        stream << "Incomplete";
+    }
+
+    auto recovered = createDocument();
+    EXPECT_TRUE(persistence::Journal::recover(recovered, JOURNAL_PATH));
+    EXPECT_EQ(describe(document, true), describe(recovered, true));
+
+    persistence::Journal::discard(JOURNAL_PATH);
+}
+
+TEST(JournalTest, Compaction) {
+    auto document = createDocument();
+    {
+        persistence::Journal journal(document, JOURNAL_PATH, std::chrono::milliseconds(10), 0);
+        edit(document);
+        journal.flush();
+
+        std::ifstream stream(std::string(JOURNAL_PATH) + ".lcj", std::ios::binary | std::ios::ate);
+        EXPECT_EQ(sizeof(persistence::native::JournalHeader), stream.tellg());
+    }
+
+    auto recovered = createDocument();
+    EXPECT_TRUE(persistence::Journal::recover(recovered, JOURNAL_PATH));
+    EXPECT_EQ(describe(document, true), describe(recovered, true));
+
+    persistence::Journal::discard(JOURNAL_PATH);
+}
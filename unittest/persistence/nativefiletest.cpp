@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <file.h>
+#include <native/nativereader.h>
+#include <native/nativewriter.h>
+#include <cad/builders/insert.h>
+#include <cad/meta/metacolor.h>
+#include <cad/meta/metalinewidth.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/hatch.h>
+#include <cad/primitive/insert.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/spline.h>
+#include <cad/primitive/text.h>
+#include "documentfixture.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace lc;
+
+namespace {
+const char* NATIVE_FILE = "nativefiletest.lcb";
+const char* DXF_FILE = "nativefiletest.dxf";
+}
+
+TEST(NativeFileTest, RoundTrip) {
+    auto document = createDrawing();
+    EXPECT_EQ(0, persistence::NativeWriter(document).write(NATIVE_FILE));
+
+    auto loaded = createDocument();
+    EXPECT_EQ(persistence::File::LIBRECAD_NATIVE, persistence::File::open(loaded, NATIVE_FILE, persistence::File::NATIVE));
+    EXPECT_EQ(describe(document, true), describe(loaded, true));
+
+    auto layer = loaded->layerByName("1");
+    ASSERT_NE(nullptr, layer);
+    EXPECT_EQ(0.5, layer->lineWidth().width());
+    EXPECT_EQ(1., layer->color().red());
+    ASSERT_NE(nullptr, layer->linePattern());
+    EXPECT_EQ("DASHED", layer->linePattern()->name());
+    EXPECT_EQ(2, layer->linePattern()->path().size());
+
+    ASSERT_EQ(1, loaded->blocks().size());
+    auto block = *loaded->blocks().begin();
+    EXPECT_EQ(geo::Coordinate(1., 2.), block->base());
+
+    auto blockEntities = loaded->entitiesByBlock(block).asVector();
+    ASSERT_EQ(1, blockEntities.size());
+    EXPECT_NE(nullptr, blockEntities[0]->metaInfo<meta::MetaColorByBlock>(meta::MetaColor::LCMETANAME()));
+
+    for(const auto& entity : loaded->entityContainer().asVector()) {
+        auto line = std::dynamic_pointer_cast<const entity::Line>(entity);
+        if(line == nullptr) {
+            continue;
+        }
+
+        auto color = line->metaInfo<meta::MetaColorByValue>(meta::MetaColor::LCMETANAME());
+        ASSERT_NE(nullptr, color);
+        EXPECT_EQ(1., color->green());
+
+        auto width = line->metaInfo<meta::MetaLineWidthByValue>(meta::MetaLineWidth::LCMETANAME());
+        ASSERT_NE(nullptr, width);
+        EXPECT_EQ(0.25, width->width());
+    }
+
+    for(const auto& entity : loaded->entityContainer().asVector()) {
+        if(auto text = std::dynamic_pointer_cast<const entity::Text>(entity)) {
+            EXPECT_EQ("Text", text->text_value());
+            EXPECT_EQ(TextConst::HACenter, text->halign());
+            EXPECT_TRUE(text->underlined());
+            EXPECT_TRUE(text->italic());
+            EXPECT_FALSE(text->bold());
+        }
+        else if(auto spline = std::dynamic_pointer_cast<const entity::Spline>(entity)) {
+            EXPECT_EQ(4, spline->controlPoints().size());
+            EXPECT_EQ(3, spline->degree());
+        }
+        else if(auto hatch = std::dynamic_pointer_cast<const entity::Hatch>(entity)) {
+            EXPECT_EQ("ANSI31", hatch->getPatternName());
+            EXPECT_EQ(1, hatch->getPattern().segments.size());
+            ASSERT_EQ(2, hatch->getRegion().loopList().size());
+            EXPECT_EQ(4, hatch->getRegion().loopList()[0].entities().size());
+        }
+        else if(auto insert = std::dynamic_pointer_cast<const entity::Insert>(entity)) {
+            EXPECT_EQ(block, insert->displayBlock());
+            EXPECT_EQ(loaded, insert->document());
+        }
+    }
+
+    std::remove(NATIVE_FILE);
+}
+
+TEST(NativeFileTest, DxfRoundTrip) {
+    persistence::File::save(createDrawing(), DXF_FILE, persistence::File::LIBDXFRW_DXF_R2000);
+
+    auto dxf = createDocument();
+    persistence::File::open(dxf, DXF_FILE, persistence::File::LIBDXFRW);
+    persistence::File::save(dxf, NATIVE_FILE, persistence::File::LIBRECAD_NATIVE);
+
+    auto native = createDocument();
+    persistence::File::open(native, NATIVE_FILE, persistence::File::NATIVE);
+    EXPECT_EQ(describe(dxf), describe(native));
+
+    persistence::File::save(native, DXF_FILE, persistence::File::LIBDXFRW_DXF_R2000);
+
+    auto result = createDocument();
+    persistence::File::open(result, DXF_FILE, persistence::File::LIBDXFRW);
+    EXPECT_EQ(describe(dxf), describe(result));
+
+    std::remove(NATIVE_FILE);
+    std::remove(DXF_FILE);
+}
+
+TEST(NativeFileTest, Lazy) {
+    auto document = createDrawing();
+    EXPECT_EQ(0, persistence::NativeWriter(document).write(NATIVE_FILE));
+
+    {
+        persistence::NativeReader reader(NATIVE_FILE, document);
+        ASSERT_EQ(document->entityContainer().asVector().size() + 1, reader.size());
+        EXPECT_EQ(reader.entity(3), reader.entity(3));
+
+        auto bounds = reader.bounds();
+        EXPECT_DOUBLE_EQ(0., bounds.minP().x());
+        EXPECT_DOUBLE_EQ(80., bounds.maxP().x());
+
+        // Only the circle and the arc are between x = 24 and x = 39 under y = 1
+        auto entities = reader.entitiesInArea(geo::Area(geo::Coordinate(24., -1.), geo::Coordinate(39., 1.)));
+        EXPECT_EQ(2, entities.size());
+
+        entities = reader.entitiesInArea(bounds);
+        EXPECT_EQ(reader.size(), entities.size());
+    }
+
+    std::remove(NATIVE_FILE);
+}
+
+TEST(NativeFileTest, Invalid) {
+    FILE* file = std::fopen(NATIVE_FILE, "wb");
+    ASSERT_NE(nullptr, file);
+    std::fputs("Not a LibreCAD file", file);
+    std::fclose(file);
+
+    EXPECT_THROW(persistence::NativeReader reader(NATIVE_FILE), std::runtime_error);
+
+    std::remove(NATIVE_FILE);
+}
+
+TEST(NativeFileTest, Truncated) {
+    std::string data;
+    persistence::NativeWriter(createDrawing()).encode(data);
+
+    FILE* file = std::fopen(NATIVE_FILE, "wb");
+    ASSERT_NE(nullptr, file);
+    std::fwrite(data.data(), 1, data.size() / 2, file);
+    std::fclose(file);
+
+    // The error reaches the caller instead of opening an empty drawing
+    auto document = createDocument();
+    EXPECT_THROW(persistence::File::open(document, NATIVE_FILE, persistence::File::NATIVE), std::runtime_error);
+    EXPECT_TRUE(document->entityContainer().asVector().empty());
+
+    std::remove(NATIVE_FILE);
+}
+
+TEST(NativeFileTest, WrongOffsets) {
+    std::string data;
+    persistence::NativeWriter(createDrawing()).encode(data);
+
+    auto header = reinterpret_cast<const persistence::native::FileHeader*>(data.data());
+    auto sections = reinterpret_cast<const persistence::native::SectionEntry*>(data.data() + sizeof(*header));
+
+    auto sectionOffset = [&](uint32_t type) {
+        for(uint32_t i = 0; i < header->sectionCount; i++) {
+            if(sections[i].type == type) {
+                return static_cast<size_t>(sections[i].offset);
+            }
+        }
+        return size_t(0);
+    };
+
+    // The first offset is after the next one
+    auto corrupt = [&](size_t offset) {
+        auto copy = data;
+        uint32_t value = 0xFFFF;
+        std::memcpy(&copy[offset], &value, sizeof(value));
+        return copy;
+    };
+
+    auto strings = corrupt(sectionOffset(persistence::native::STRINGS));
+    EXPECT_THROW(persistence::NativeReader(strings.data(), strings.size()), std::runtime_error);
+
+    auto spatialIndex = corrupt(sectionOffset(persistence::native::SPATIAL_INDEX) + sizeof(persistence::native::SpatialIndexHeader));
+    EXPECT_THROW(persistence::NativeReader(spatialIndex.data(), spatialIndex.size()), std::runtime_error);
+
+    EXPECT_NO_THROW(persistence::NativeReader(data.data(), data.size()));
+}
+
+TEST(NativeFileTest, Version1) {
+    auto document = createDocument();
+    auto line = std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(10., 5.), document->layerByName("0"));
+    auto addLine = std::make_shared<operation::EntityBuilder>(document);
+    addLine->appendEntity(line);
+    addLine->execute();
+
+    std::string data;
+    persistence::NativeWriter(document).encode(data);
+
+    // Version 1 files have no entity IDs, the sections added by version 2 are ignored
+    auto header = reinterpret_cast<persistence::native::FileHeader*>(&data[0]);
+    header->version = 1;
+
+    persistence::NativeReader reader(data.data(), data.size());
+    ASSERT_EQ(1, reader.size());
+    EXPECT_EQ(line->boundingBox().maxP(), reader.entity(0)->boundingBox().maxP());
+    EXPECT_NE(line->id(), reader.entity(0)->id());
+}
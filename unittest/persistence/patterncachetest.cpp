@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <patternLoader/patternCache.h>
+#include <boost/filesystem.hpp>
+#include <cstdint>
+#include <fstream>
+
+using namespace lc;
+
+namespace {
+const char* CACHE_PATH = "patterncachetest";
+const char* SOURCE_PATH = "patterncachetest.dxf";
+
+void writeSource(const std::string& content) {
+    std::ofstream stream(SOURCE_PATH, std::ios::binary | std::ios::trunc);
+    stream << content;
+}
+}
+
+TEST(PatternCacheTest, LoadSaved) {
+    boost::filesystem::remove_all(CACHE_PATH);
+    writeSource("pattern");
+
+    persistence::PatternCache cache(CACHE_PATH);
+    objects::Pattern pattern;
+    EXPECT_FALSE(cache.load(SOURCE_PATH, pattern));
+
+    pattern.boundingBox = geo::Area(geo::Coordinate(0., 0.), geo::Coordinate(10., 5.));
+    pattern.segments.emplace_back(geo::Coordinate(0., 0.), geo::Coordinate(10., 5.));
+    pattern.segments.emplace_back(geo::Coordinate(1., 2.), geo::Coordinate(3., 4.));
+    cache.save(SOURCE_PATH, pattern);
+
+    objects::Pattern loaded;
+    ASSERT_TRUE(cache.load(SOURCE_PATH, loaded));
+    EXPECT_EQ(pattern.boundingBox.maxP(), loaded.boundingBox.maxP());
+    ASSERT_EQ(2, loaded.segments.size());
+    EXPECT_EQ(geo::Coordinate(1., 2.), loaded.segments[1].start());
+    EXPECT_EQ(geo::Coordinate(3., 4.), loaded.segments[1].end());
+
+    // A modified source is compiled again
+    writeSource("modified pattern");
+    EXPECT_FALSE(cache.load(SOURCE_PATH, loaded));
+
+    boost::filesystem::remove_all(CACHE_PATH);
+    boost::filesystem::remove(SOURCE_PATH);
+}
+
+TEST(PatternCacheTest, WrongSegmentCount) {
+    boost::filesystem::remove_all(CACHE_PATH);
+    writeSource("pattern");
+
+    persistence::PatternCache cache(CACHE_PATH);
+    objects::Pattern pattern;
+    pattern.segments.emplace_back(geo::Coordinate(0., 0.), geo::Coordinate(10., 5.));
+    cache.save(SOURCE_PATH, pattern);
+
+    auto cacheFile = boost::filesystem::directory_iterator(CACHE_PATH)->path().string();
+    auto setSegmentCount = [&cacheFile](uint64_t segmentCount) {
+        // After the magic, version, byte order and bounds
+        std::fstream stream(cacheFile, std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(8 + 4 + 4 + 4 * sizeof(double));
+        stream.write(reinterpret_cast<const char*>(&segmentCount), sizeof(segmentCount));
+    };
+
+    objects::Pattern loaded;
+    EXPECT_TRUE(cache.load(SOURCE_PATH, loaded));
+
+    setSegmentCount(2);
+    EXPECT_FALSE(cache.load(SOURCE_PATH, loaded));
+
+    // segmentCount * 4 * sizeof(double) overflows to 0
+    setSegmentCount(uint64_t(1) << 59);
+    EXPECT_FALSE(cache.load(SOURCE_PATH, loaded));
+
+    setSegmentCount(0);
+    EXPECT_FALSE(cache.load(SOURCE_PATH, loaded));
+
+    boost::filesystem::remove_all(CACHE_PATH);
+    boost::filesystem::remove(SOURCE_PATH);
+}
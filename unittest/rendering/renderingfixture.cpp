@@ -0,0 +1,97 @@
+#include "renderingfixture.h"
+
+#include <dirent.h>
+#ifndef WIN32
+#include <sys/types.h>
+#endif
+
+#include <boost/program_options.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace po = boost::program_options;
+
+namespace {
+void readConfig(RenderingFixture& fixture, const std::string& configFile) {
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("imageW", po::value<int>(&fixture.imageW), "Image width (in pixels)")
+    ("imageH", po::value<int>(&fixture.imageH), "Image height (in pixels)")
+    ("x", po::value<int>(&fixture.x), "Canvas base")
+    ("y", po::value<int>(&fixture.y), "Canvas base")
+    ("w", po::value<int>(&fixture.w), "Canvas width")
+    ("h", po::value<int>(&fixture.h), "Canvas height")
+    ("tolerance", po::value<int>(&fixture.tolerance), "Tolerance (between 0 and 100)")
+    ("budget", po::value<double>(&fixture.budget), "Maximum time of a warm frame (in ms)")
+    ("coldBudget", po::value<double>(&fixture.coldBudget), "Maximum time of the first frame (in ms)")
+    ("frames", po::value<int>(&fixture.frames), "Number of warm frames");
+
+    po::variables_map vm;
+    std::ifstream configStream(configFile.c_str());
+    po::store(po::parse_config_file(configStream, desc), vm);
+    po::notify(vm);
+}
+}
+
+std::vector<RenderingFixture> renderingFixtures(const std::string& directory) {
+    dirent** files = nullptr;
+    int nbFiles = scandir(directory.c_str(), &files, nullptr, alphasort);
+    if(nbFiles < 0) {
+        perror("Error");
+        throw std::runtime_error("Cannot open rendering resources dir " + directory);
+    }
+
+    std::vector<RenderingFixture> fixtures;
+    unsigned int testNumber = 0;
+    bool dxfFound = false;
+    bool pngFound = false;
+    bool configFound = false;
+
+    for(auto i = 0; i < nbFiles; i++) {
+        unsigned int newNumber;
+        char extension[256];
+
+        if(sscanf(files[i]->d_name, "%u.%255s", &newNumber, extension) != 2) {
+            continue;
+        }
+
+        if(newNumber != testNumber) {
+            testNumber = newNumber;
+            dxfFound = false;
+            pngFound = false;
+            configFound = false;
+        }
+
+        if(strcmp(extension, "dxf") == 0) {
+            dxfFound = true;
+        }
+        else if(strcmp(extension, "png") == 0) {
+            pngFound = true;
+        }
+        else if(strcmp(extension, "cfg") == 0) {
+            configFound = true;
+        }
+
+        if(dxfFound && pngFound && configFound) {
+            RenderingFixture fixture;
+            fixture.number = newNumber;
+            fixture.base = directory + std::to_string(newNumber);
+            readConfig(fixture, fixture.base + ".cfg");
+            fixtures.push_back(fixture);
+
+            dxfFound = false; //Prevent adding the case more than once
+            pngFound = false;
+            configFound = false;
+        }
+    }
+
+    for(auto i = 0; i < nbFiles; i++) {
+        free(files[i]);
+    }
+    free(files);
+
+    return fixtures;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Rendering test case of unittest/rendering/res
+ * A case is made of N.dxf, the expected image N.png and N.cfg, which sets the members below.
+ */
+struct RenderingFixture {
+    unsigned int number = 0;
+    std::string base; // Path of the files, without extension
+
+    int imageW = 100;
+    int imageH = 100;
+    int x = 0;
+    int y = 0;
+    int w = 100;
+    int h = 100;
+    int tolerance = 0; // Between 0 and 100
+
+    // Frame time budgets in milliseconds, 0 disables the check
+    double budget = 0.;
+    double coldBudget = 0.;
+    int frames = 5; // Number of warm frames rendered by the performance tests
+
+    std::string dxfFile() const {
+        return base + ".dxf";
+    }
+
+    std::string expectedFile() const {
+        return base + ".png";
+    }
+};
+
+/**
+ * @brief Read the complete test cases of a directory, ordered by number
+ * @throw std::runtime_error if the directory can't be read
+ */
+std::vector<RenderingFixture> renderingFixtures(const std::string& directory);
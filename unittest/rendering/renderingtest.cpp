@@ -1,10 +1,5 @@
 #include <gtest/gtest.h>
 
-#include <dirent.h>
-#ifndef WIN32
-#include <sys/types.h>
-#endif
-
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <cad/storage/documentimpl.h>
 #include <cad/storage/storagemanagerimpl.h>
@@ -12,30 +7,8 @@
 #include <painters/lccairopainter.tcc>
 #include <file.h>
 #include <drawables/gradientbackground.h>
-#include <boost/program_options/variables_map.hpp>
-#include <boost/program_options/options_description.hpp>
-#include <boost/program_options.hpp>
-#include <fstream>
-
-#define DEFAULT_IMAGE_WIDTH 100
-#define DEFAULT_IMAGE_HEIGHT 100
-#define DEFAULT_X 0
-#define DEFAULT_Y 0
-#define DEFAULT_W 100
-#define DEFAULT_H 100
-#define DEFAULT_TOLERANCE 0
-
-namespace po = boost::program_options;
-
-void resetConfig(int* imageWidth, int* imageHeight, int* x, int* y, int* w, int* h, int* tolerance) {
-    *imageWidth = DEFAULT_IMAGE_WIDTH;
-    *imageHeight = DEFAULT_IMAGE_HEIGHT;
-    *x = DEFAULT_X;
-    *y = DEFAULT_Y;
-    *w = DEFAULT_W;
-    *h = DEFAULT_H;
-    *tolerance = DEFAULT_TOLERANCE;
-}
+#include <stdexcept>
+#include "renderingfixture.h"
 
 void render(const std::string& dxf, const std::string& output, unsigned int imageWidth, unsigned int imageHeight,
             int x, int y, int w, int h) {
@@ -57,6 +30,7 @@ void render(const std::string& dxf, const std::string& output, unsigned int imag
     lc::persistence::File::open(_document, dxf, lc::persistence::File::LIBDXFRW);
 
     _canvas->setDisplayArea(*lcPainter, lc::geo::Area(lc::geo::Coordinate(x, y), w, h));
+    _canvas->waitForDrawables();
     _canvas->render(*lcPainter, VIEWER_BACKGROUND);
     _canvas->render(*lcPainter, VIEWER_DOCUMENT);
     _canvas->render(*lcPainter, VIEWER_FOREGROUND);
@@ -109,92 +83,26 @@ bool checkRender(const std::string& image1, const std::string& image2, float tol
 }
 
 TEST(RenderingTest, Test) {
-    int imageW;
-    int imageH;
-    int x;
-    int y;
-    int w;
-    int h;
-    int tolerance;
-
-    resetConfig(&imageW, &imageH, &x, &y, &w, &h, &tolerance);
-
-    po::variables_map vm;
-    po::options_description desc("Allowed options");
-    desc.add_options()
-    ("imageW", po::value<int>(&imageW), "Image width (in pixels)")
-    ("imageH", po::value<int>(&imageH), "Image height (in pixels)")
-    ("x", po::value<int>(&x), "Canvas base")
-    ("y", po::value<int>(&y), "Canvas base")
-    ("w", po::value<int>(&w), "Canvas width")
-    ("h", po::value<int>(&h), "Canvas height")
-    ("tolerance", po::value<int>(&tolerance), "Tolerance (between 0 and 100)");
-
-    dirent** files = NULL;
-
     const char* resDir = SOURCE_DIR "/rendering/res/";
     std::cout << "Opening resources from " << resDir << std::endl;
-    int nbFiles = scandir(resDir, &files, NULL, alphasort);
-    if(nbFiles < 0) {
-        perror("Error");
-        FAIL() << "Cannot open rendering resources dir.";
-    }
-
-    unsigned int testNumber = 0;
-    bool dxfFound = false;
-    bool pngFound = false;
-    bool configFound = false;
-
-    for(auto i = 0; i < nbFiles; i++) {
-        unsigned int newNumber;
-        char extension[256];
-
-        if(sscanf(files[i]->d_name, "%u.%s", &newNumber, extension) != 2) {
-            continue;
-        }
-
-        if(newNumber != testNumber) {
-            testNumber = newNumber;
-            dxfFound = false;
-            pngFound = false;
-            configFound = false;
-        }
 
-        if(strcmp(extension, "dxf") == 0) {
-            dxfFound = true;
-        }
-        else if(strcmp(extension, "png") == 0) {
-            pngFound = true;
-        }
-        else if(strcmp(extension, "cfg") == 0) {
-            configFound = true;
-        }
-
-        if(dxfFound && pngFound && configFound) {
-            auto base = std::string(resDir) + std::to_string(newNumber);
-            auto expectedFile = base + ".png";
-            auto dxfFile = base + ".dxf";
-            auto resultFile = base + ".out";
-            auto configFile = base + ".cfg";
-
-            resetConfig(&imageW, &imageH, &x, &y, &w, &h, &tolerance);
-            vm = po::variables_map();
-            std::ifstream configStream(configFile.c_str());
-
-            po::store(po::parse_config_file(configStream, desc), vm);
-            po::notify(vm);
+    std::vector<RenderingFixture> fixtures;
+    try {
+        fixtures = renderingFixtures(resDir);
+    }
+    catch(const std::runtime_error& e) {
+        FAIL() << e.what();
+    }
 
-            std::cout << "Running rendering test " << newNumber << std::endl;
-            std::cout << "Size " << imageW << "*" << imageH << std::endl;
-            std::cout << "Box " << x << ";" << y << " - " << w << "*" << h << std::endl;
-            std::cout << "Tolerance " << tolerance << std::endl;
+    for(const auto& fixture : fixtures) {
+        auto resultFile = fixture.base + ".out";
 
-            render(dxfFile, resultFile, imageW, imageH, x, y, w, h);
-            ASSERT_TRUE(checkRender(expectedFile, resultFile, tolerance)) << "Failed with " << expectedFile;
+        std::cout << "Running rendering test " << fixture.number << std::endl;
+        std::cout << "Size " << fixture.imageW << "*" << fixture.imageH << std::endl;
+        std::cout << "Box " << fixture.x << ";" << fixture.y << " - " << fixture.w << "*" << fixture.h << std::endl;
+        std::cout << "Tolerance " << fixture.tolerance << std::endl;
 
-            dxfFound = false; //Prevent running the test more than once
-            pngFound = false;
-            configFound = false;
-        }
+        render(fixture.dxfFile(), resultFile, fixture.imageW, fixture.imageH, fixture.x, fixture.y, fixture.w, fixture.h);
+        ASSERT_TRUE(checkRender(fixture.expectedFile(), resultFile, fixture.tolerance)) << "Failed with " << fixture.expectedFile();
     }
 }
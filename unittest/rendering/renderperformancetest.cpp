@@ -0,0 +1,407 @@
+#include <gtest/gtest.h>
+
+#ifdef WITH_EGL
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <painters/createpainter.h>
+#endif
+
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/tools/profiler.h>
+#include <documentcanvas.h>
+#include <painters/lccairopainter.tcc>
+#include <file.h>
+#include <generators.h>
+#include "renderingfixture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+/*
+ * Renders each case of rendering/res and a large synthetic drawing at several zoom and pan positions,
+ * through every available painter.
+ * The first frame of a new painter is cold: nothing is cached, OpenGL painters tessellate and upload every
+ * visible entity. The next frames are warm, the median of them is reported.
+ *
+ * The total frame times are measured with the profiler disabled. The phases are measured by rendering
+ * the same frames again with the profiler zones enabled.
+ *
+ * Frames exceeding the budget or coldBudget of the case fail the test. Set LC_RENDER_BUDGET_SCALE to scale
+ * the budgets on slower machines or debug builds.
+ * The timings are printed and recorded as test properties, see --gtest_output=xml.
+ */
+
+using lc::tools::Profiler;
+using lc::viewer::LcPainter;
+
+namespace {
+struct Phase {
+    const char* name;
+    const char* zone;
+};
+
+// Zones may nest: uploads are part of tessellation or draw
+const Phase PHASES[] = {
+    {"query", "DocumentCanvas::query"},
+    {"style", "DocumentCanvas::style"},
+    {"tessellation", "DocumentCanvas::tessellate"},
+    {"upload", "VertexBuffer::upload"},
+    {"draw", "DocumentCanvas::draw"}
+};
+const size_t NB_PHASES = sizeof(PHASES) / sizeof(PHASES[0]);
+
+/**
+ * View relative to the box of the case
+ * zoom > 1 shows a smaller area, the pan is a fraction of the box size
+ */
+struct View {
+    const char* name;
+    double zoom;
+    double panX;
+    double panY;
+};
+
+const View VIEWS[] = {
+    {"fit", 1., 0., 0.},
+    {"zoomIn2", 2., 0., 0.},
+    {"zoomIn8", 8., 0., 0.},
+    {"zoomOut4", 0.25, 0., 0.},
+    {"panLeft", 1., -0.5, 0.},
+    {"panRight", 1., 0.5, 0.},
+    {"panUp", 1., 0., 0.5},
+    {"panDown", 1., 0., -0.5}
+};
+
+struct FrameTiming {
+    double total = 0.; // ms
+    double phases[NB_PHASES] = {};
+};
+
+class PainterBackend {
+public:
+    virtual ~PainterBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    /**
+     * @return false if the backend can't be used on this machine
+     */
+    virtual bool available() const {
+        return true;
+    }
+
+    /**
+     * @brief Create a painter with empty caches
+     */
+    virtual LcPainter* createPainter() = 0;
+
+    /**
+     * @brief Wait for the end of the frame
+     */
+    virtual void finish() {
+    }
+};
+
+class CairoBackend : public PainterBackend {
+public:
+    CairoBackend(unsigned int width, unsigned int height) :
+        _width(width),
+        _height(height),
+        _data(cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width) * height) {
+    }
+
+    const char* name() const override {
+        return "cairo";
+    }
+
+    LcPainter* createPainter() override {
+        return new LcCairoPainter<CairoPainter::backend::Image>(_data.data(), _width, _height);
+    }
+
+private:
+    unsigned int _width;
+    unsigned int _height;
+    std::vector<unsigned char> _data;
+};
+
+#ifdef WITH_EGL
+/**
+ * OpenGL painter drawing in an EGL pbuffer, without window system
+ * With Mesa, EGL_PLATFORM=surfaceless allows running it without display server.
+ */
+class OpenGLBackend : public PainterBackend {
+public:
+    OpenGLBackend(unsigned int width, unsigned int height) :
+        _width(width),
+        _height(height),
+        _display(eglGetDisplay(EGL_DEFAULT_DISPLAY)),
+        _surface(EGL_NO_SURFACE),
+        _context(EGL_NO_CONTEXT),
+        _available(false) {
+        if(_display == EGL_NO_DISPLAY || eglInitialize(_display, nullptr, nullptr) != EGL_TRUE) {
+            _display = EGL_NO_DISPLAY;
+            return;
+        }
+
+        const EGLint configAttributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+        EGLConfig config;
+        EGLint nbConfigs = 0;
+        if(eglChooseConfig(_display, configAttributes, &config, 1, &nbConfigs) != EGL_TRUE || nbConfigs == 0) {
+            return;
+        }
+
+        const EGLint surfaceAttributes[] = {
+            EGL_WIDTH, (EGLint) width,
+            EGL_HEIGHT, (EGLint) height,
+            EGL_NONE
+        };
+        _surface = eglCreatePbufferSurface(_display, config, surfaceAttributes);
+        eglBindAPI(EGL_OPENGL_API);
+        _context = eglCreateContext(_display, config, EGL_NO_CONTEXT, nullptr);
+
+        _available = _surface != EGL_NO_SURFACE &&
+                     _context != EGL_NO_CONTEXT &&
+                     eglMakeCurrent(_display, _surface, _surface, _context) == EGL_TRUE;
+    }
+
+    ~OpenGLBackend() override {
+        if(_display == EGL_NO_DISPLAY) {
+            return;
+        }
+
+        eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if(_context != EGL_NO_CONTEXT) {
+            eglDestroyContext(_display, _context);
+        }
+        if(_surface != EGL_NO_SURFACE) {
+            eglDestroySurface(_display, _surface);
+        }
+        eglTerminate(_display);
+    }
+
+    const char* name() const override {
+        return "opengl";
+    }
+
+    bool available() const override {
+        return _available;
+    }
+
+    LcPainter* createPainter() override {
+        // A new pack cache, every entity is tessellated again
+        auto painter = lc::viewer::createOpenGLPainter(nullptr, _width, _height);
+        painter->create_resources();
+        return painter;
+    }
+
+    void finish() override {
+        glFinish();
+    }
+
+private:
+    unsigned int _width;
+    unsigned int _height;
+    EGLDisplay _display;
+    EGLSurface _surface;
+    EGLContext _context;
+    bool _available;
+};
+#endif
+
+double budgetScale() {
+    auto scale = std::getenv("LC_RENDER_BUDGET_SCALE");
+    return scale == nullptr ? 1. : std::atof(scale);
+}
+
+lc::geo::Area viewArea(const RenderingFixture& fixture, const View& view) {
+    double w = fixture.w / view.zoom;
+    double h = fixture.h / view.zoom;
+    double centerX = fixture.x + fixture.w / 2. + view.panX * fixture.w;
+    double centerY = fixture.y + fixture.h / 2. + view.panY * fixture.h;
+
+    return lc::geo::Area(lc::geo::Coordinate(centerX - w / 2., centerY - h / 2.), w, h);
+}
+
+FrameTiming renderFrame(lc::viewer::DocumentCanvas& canvas, LcPainter& painter, PainterBackend& backend) {
+    auto& profiler = Profiler::instance();
+    profiler.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    canvas.render(painter, lc::viewer::VIEWER_BACKGROUND);
+    canvas.render(painter, lc::viewer::VIEWER_DOCUMENT);
+    canvas.render(painter, lc::viewer::VIEWER_FOREGROUND);
+    backend.finish();
+    auto end = std::chrono::steady_clock::now();
+
+    FrameTiming timing;
+    timing.total = std::chrono::duration<double, std::milli>(end - start).count();
+    for(size_t i = 0; i < NB_PHASES; i++) {
+        timing.phases[i] = profiler.zoneDuration(PHASES[i].zone) / 1000.;
+    }
+
+    return timing;
+}
+
+struct ViewTiming {
+    FrameTiming cold;
+    FrameTiming warm; // Median warm frame
+};
+
+/**
+ * @brief Render the cold frame and the warm frames of a view with a new painter
+ */
+ViewTiming renderView(lc::viewer::DocumentCanvas& canvas, PainterBackend& backend, const lc::geo::Area& area, int frames) {
+    std::unique_ptr<LcPainter> painter(backend.createPainter());
+    canvas.setPainter(painter.get());
+    canvas.setDisplayArea(*painter, area);
+
+    ViewTiming timing;
+    timing.cold = renderFrame(canvas, *painter, backend);
+
+    std::vector<FrameTiming> warmFrames;
+    for(int i = 0; i < frames; i++) {
+        warmFrames.push_back(renderFrame(canvas, *painter, backend));
+    }
+    std::sort(warmFrames.begin(), warmFrames.end(), [](const FrameTiming& a, const FrameTiming& b) {
+        return a.total < b.total;
+    });
+    timing.warm = warmFrames[warmFrames.size() / 2];
+
+    canvas.setPainter(nullptr);
+    return timing;
+}
+
+void report(const std::string& key, const FrameTiming& timing) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3) << key << ": " << timing.total << " ms (";
+    ::testing::Test::RecordProperty(key + ".total", std::to_string(timing.total));
+
+    for(size_t i = 0; i < NB_PHASES; i++) {
+        line << (i == 0 ? "" : ", ") << PHASES[i].name << " " << timing.phases[i];
+        ::testing::Test::RecordProperty(key + "." + PHASES[i].name, std::to_string(timing.phases[i]));
+    }
+
+    std::cout << line.str() << ")" << std::endl;
+}
+
+/**
+ * @param name Prefix of the reported keys, after the painter name
+ */
+void measure(const std::string& name, const RenderingFixture& fixture, const lc::storage::Document_SPtr& document,
+             PainterBackend& backend) {
+    auto canvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+    canvas->newDeviceSize(fixture.imageW, fixture.imageH);
+    // Cold frames would otherwise draw the boundaries of the hatches which are still being filled
+    canvas->waitForDrawables();
+
+    auto& profiler = Profiler::instance();
+    auto scale = budgetScale();
+    auto frames = std::max(1, fixture.frames);
+
+    for(const auto& view : VIEWS) {
+        auto area = viewArea(fixture, view);
+        auto key = std::string(backend.name()) + "." + name + "." + view.name;
+
+        // Zones read the clock twice each, they would be part of the totals
+        profiler.setEnabled(false);
+        auto timing = renderView(*canvas, backend, area, frames);
+
+        profiler.setEnabled(true);
+        auto profiled = renderView(*canvas, backend, area, frames);
+        std::copy(profiled.cold.phases, profiled.cold.phases + NB_PHASES, timing.cold.phases);
+        std::copy(profiled.warm.phases, profiled.warm.phases + NB_PHASES, timing.warm.phases);
+
+        report(key + ".cold", timing.cold);
+        report(key + ".warm", timing.warm);
+
+        if(fixture.coldBudget > 0.) {
+            EXPECT_LE(timing.cold.total, fixture.coldBudget * scale) << "Cold frame over budget: " << key;
+        }
+        if(fixture.budget > 0.) {
+            EXPECT_LE(timing.warm.total, fixture.budget * scale) << "Warm frame over budget: " << key;
+        }
+    }
+}
+
+/**
+ * @brief Measure a drawing with every available painter
+ */
+void measureAllBackends(const std::string& name, const RenderingFixture& fixture, const lc::storage::Document_SPtr& document) {
+    auto& profiler = Profiler::instance();
+    auto wasEnabled = profiler.enabled();
+
+    std::vector<std::unique_ptr<PainterBackend>> backends;
+    backends.emplace_back(new CairoBackend(fixture.imageW, fixture.imageH));
+#ifdef WITH_EGL
+    backends.emplace_back(new OpenGLBackend(fixture.imageW, fixture.imageH));
+#endif
+
+    for(const auto& backend : backends) {
+        if(!backend->available()) {
+            std::cout << "Skipping " << backend->name() << " painter, it is not available" << std::endl;
+            continue;
+        }
+
+        measure(name, fixture, document, *backend);
+    }
+
+    profiler.clear();
+    profiler.setEnabled(wasEnabled);
+}
+}
+
+TEST(RenderingTest, Performance) {
+    std::vector<RenderingFixture> fixtures;
+    try {
+        fixtures = renderingFixtures(SOURCE_DIR "/rendering/res/");
+    }
+    catch(const std::runtime_error& e) {
+        FAIL() << e.what();
+    }
+
+    for(const auto& fixture : fixtures) {
+        auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+        lc::persistence::File::open(document, fixture.dxfFile(), lc::persistence::File::LIBDXFRW);
+
+        measureAllBackends(std::to_string(fixture.number), fixture, document);
+    }
+}
+
+/*
+ * Drawing of the benchmarks with every kind of entity, a few hundred thousand in total.
+ * No budget is set, the timings are reported for comparisons between builds.
+ */
+TEST(RenderingTest, PerformanceSynthetic) {
+    auto document = lc::benchmark::createDocument();
+    auto layer = document->layerByName("0");
+    lc::benchmark::addEntities(document, lc::benchmark::uniformLines(layer, 100000));
+    lc::benchmark::addEntities(document, lc::benchmark::denseArcs(layer, 50000));
+    lc::benchmark::addEntities(document, lc::benchmark::longPolylines(layer, 200, 500));
+    lc::benchmark::addEntities(document, lc::benchmark::hatches(layer, 1000));
+    lc::benchmark::addEntities(document, lc::benchmark::texts(layer, 2000));
+    lc::benchmark::addBlockHeavyDrawing(document, 20, 50, 20);
+
+    RenderingFixture fixture;
+    fixture.imageW = 1920;
+    fixture.imageH = 1080;
+    fixture.w = static_cast<int>(lc::benchmark::DRAWING_SIZE);
+    fixture.h = static_cast<int>(lc::benchmark::DRAWING_SIZE);
+    fixture.frames = 3;
+
+    measureAllBackends("synthetic", fixture, document);
+}